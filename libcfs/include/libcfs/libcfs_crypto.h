@@ -146,6 +146,18 @@ static inline unsigned char cfs_crypto_hash_alg(const char *algname)
 	return CFS_HASH_ALG_UNKNOWN;
 }
 
+/**
+ * Whether the digests of two buffers hashed with \a hash_alg can be combined
+ * into the digest of both with cfs_crypto_hash_combine()
+ */
+static inline
+bool cfs_crypto_hash_combinable(enum cfs_crypto_hash_alg hash_alg)
+{
+	return hash_alg == CFS_HASH_ALG_ADLER32 ||
+	       hash_alg == CFS_HASH_ALG_CRC32 ||
+	       hash_alg == CFS_HASH_ALG_CRC32C;
+}
+
 int cfs_crypto_hash_digest(enum cfs_crypto_hash_alg hash_alg,
 			   const void *buf, unsigned int buf_len,
 			   unsigned char *key, unsigned int key_len,
@@ -164,7 +176,15 @@ int cfs_crypto_hash_update(struct cfs_crypto_hash_desc *desc, const void *buf,
 			   unsigned int buf_len);
 int cfs_crypto_hash_final(struct cfs_crypto_hash_desc *desc,
 			  unsigned char *hash, unsigned int *hash_len);
+int cfs_crypto_hash_digest_page(struct cfs_crypto_hash_desc *desc,
+				struct page *page, unsigned int offset,
+				unsigned int len, unsigned char *hash,
+				unsigned int *hash_len);
+int cfs_crypto_hash_combine(enum cfs_crypto_hash_alg hash_alg, __u32 *cksum,
+			    __u32 cksum2, unsigned int len2);
 int cfs_crypto_register(void);
 void cfs_crypto_unregister(void);
+int cfs_crypto_test_hashes(void);
 int cfs_crypto_hash_speed(enum cfs_crypto_hash_alg hash_alg);
+int cfs_crypto_hash_page_speed(enum cfs_crypto_hash_alg hash_alg);
 #endif
@@ -662,11 +662,26 @@ void cfs_hash_bd_del_locked(cfs_hash_t *hs, cfs_hash_bd_t *bd,
 void cfs_hash_bd_move_locked(cfs_hash_t *hs, cfs_hash_bd_t *bd_old,
 			     cfs_hash_bd_t *bd_new, struct hlist_node *hnode);
 
+/**
+ * Decrement \a condition, and return 1 with the bucket locked exclusively
+ * if it dropped to zero, like atomic_dec_and_lock().
+ */
 static inline int cfs_hash_bd_dec_and_lock(cfs_hash_t *hs, cfs_hash_bd_t *bd,
 					   atomic_t *condition)
 {
-	LASSERT(cfs_hash_with_spin_bktlock(hs));
-	return atomic_dec_and_lock(condition, &bd->bd_bucket->hsb_lock.spin);
+	if (cfs_hash_with_spin_bktlock(hs))
+		return atomic_dec_and_lock(condition,
+					   &bd->bd_bucket->hsb_lock.spin);
+
+	LASSERT(cfs_hash_with_rw_bktlock(hs));
+	if (atomic_add_unless(condition, -1, 1))
+		return 0;
+
+	cfs_hash_bd_lock(hs, bd, 1);
+	if (atomic_dec_and_test(condition))
+		return 1;
+	cfs_hash_bd_unlock(hs, bd, 1);
+	return 0;
 }
 
 static inline struct hlist_head *cfs_hash_bd_hhead(cfs_hash_t *hs,
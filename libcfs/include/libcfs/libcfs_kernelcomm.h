@@ -64,6 +64,9 @@ struct kuc_hdr {
 } __attribute__((aligned(sizeof(__u64))));
 
 #define KUC_CHANGELOG_MSG_MAXSIZE (sizeof(struct kuc_hdr)+CR_MAXSIZE)
+/* Size of a CL_RECORDS message, half the default pipe capacity so the
+ * sender can fill the next batch while the reader consumes one */
+#define KUC_CHANGELOG_BATCH_MAXSIZE 32768
 
 #define KUC_MAGIC  0x191C /*Lustre9etLinC */
 #define KUC_FL_BLOCK 0x01   /* Wait for send */
@@ -112,10 +112,13 @@ int libcfs_ukuc_get_rfd(lustre_kernelcomm *link)
 int libcfs_ukuc_msg_get(lustre_kernelcomm *link, char *buf, int maxsize,
                         int transport)
 {
-        struct kuc_hdr *kuch;
-        int rc = 0;
+	struct kuc_hdr *kuch;
+	int rc = 0;
+	int len;
 
-        memset(buf, 0, maxsize);
+	/* Only the header needs clearing: a caller may pass a large buffer
+	 * (HAL_MAXSIZE for copytools) and zeroing it per message is costly */
+	memset(buf, 0, lhsz);
 
         CDEBUG(D_KUC, "Waiting for message from kernel on fd %d\n",
                link->lk_rfd);
@@ -145,18 +148,29 @@ int libcfs_ukuc_msg_get(lustre_kernelcomm *link, char *buf, int maxsize,
                         break;
                 }
 
-                /* Read payload */
-                rc = read(link->lk_rfd, buf + lhsz, kuch->kuc_msglen - lhsz);
-                if (rc < 0) {
-                        rc = -errno;
-                        break;
-                }
-                if (rc < (kuch->kuc_msglen - lhsz)) {
-                        CERROR("short read: got %d of %d bytes\n",
-                               rc, kuch->kuc_msglen);
-                        rc = -EPROTO;
-                        break;
-                }
+		/* Read payload. Messages larger than PIPE_BUF (changelog
+		 * batches) are not written atomically and may take several
+		 * reads. */
+		for (len = lhsz; len < kuch->kuc_msglen; len += rc) {
+			rc = read(link->lk_rfd, buf + len,
+				  kuch->kuc_msglen - len);
+			if (rc < 0 && errno == EINTR) {
+				rc = 0;
+				continue;
+			}
+			if (rc <= 0)
+				break;
+		}
+		if (rc < 0) {
+			rc = -errno;
+			break;
+		}
+		if (len < kuch->kuc_msglen) {
+			CERROR("short read: got %d of %d bytes\n",
+			       len, kuch->kuc_msglen);
+			rc = -EPROTO;
+			break;
+		}
 
                 if (kuch->kuc_transport == transport ||
                     kuch->kuc_transport == KUC_TRANSPORT_GENERIC) {
@@ -36,6 +36,20 @@
  *  Array of hash algorithm speed in MByte per second
  */
 static int cfs_crypto_hash_speeds[CFS_HASH_ALG_MAX];
+/**
+ *  Array of hash algorithm speed in MByte per second, when each page is
+ *  hashed separately and the page hashes are combined
+ */
+static int cfs_crypto_hash_page_speeds[CFS_HASH_ALG_MAX];
+
+/* reflected CRC polynomials, and the modulus of Adler-32 */
+#define CFS_CRC32_POLY		0xedb88320
+#define CFS_CRC32C_POLY		0x82f63b78
+#define CFS_ADLER32_BASE	65521
+
+/* x^(2^n) modulo the CRC polynomials, see cfs_crypto_crc_x2n_init() */
+static u32 cfs_crypto_crc32_x2n[32];
+static u32 cfs_crypto_crc32c_x2n[32];
 
 /**
  * Initialize the state descriptor for the specified hash algorithm.
@@ -279,6 +293,227 @@ free:
 }
 EXPORT_SYMBOL(cfs_crypto_hash_final);
 
+/**
+ * Compute the hash digest of data within the given \a page alone
+ *
+ * Unlike cfs_crypto_hash_update_page(), the digest of the page is returned
+ * and \a hdesc is reset, ready to hash another page with the same algorithm
+ * and key.  This is used to hash the pages of a bulk RPC separately, then
+ * cfs_crypto_hash_combine() the page digests into the digest of the RPC.
+ * \a hdesc still has to be freed with cfs_crypto_hash_final().
+ *
+ * \param[in] hdesc	hash state descriptor
+ * \param[in] page	data page on which to compute the hash
+ * \param[in] offset	offset within \a page at which to start hash
+ * \param[in] len	length of data on which to compute hash
+ * \param[out] hash	pointer to hash buffer to store hash digest
+ * \param[in,out] hash_len size of \a hash buffer
+ *
+ * \retval		0 for success
+ * \retval		-EOVERFLOW if hash_len is too small for the hash digest
+ * \retval		negative errno for other errors from lower layers
+ */
+int cfs_crypto_hash_digest_page(struct cfs_crypto_hash_desc *hdesc,
+				struct page *page, unsigned int offset,
+				unsigned int len, unsigned char *hash,
+				unsigned int *hash_len)
+{
+	struct hash_desc	*desc = (struct hash_desc *)hdesc;
+	struct scatterlist	 sl;
+	int			 size = crypto_hash_digestsize(desc->tfm);
+	int			 err;
+
+	if (*hash_len < size)
+		return -EOVERFLOW;
+
+	sg_init_table(&sl, 1);
+	sg_set_page(&sl, page, len, offset & ~CFS_PAGE_MASK);
+
+	err = crypto_hash_digest(desc, &sl, sl.length, hash);
+	if (err == 0)
+		*hash_len = size;
+
+	return err;
+}
+EXPORT_SYMBOL(cfs_crypto_hash_digest_page);
+
+/* \a a times \a b modulo the reflected CRC polynomial \a poly, \a a != 0 */
+static u32 cfs_crypto_crc_multmodp(u32 a, u32 b, u32 poly)
+{
+	u32 m = 1U << 31;
+	u32 p = 0;
+
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0)
+				break;
+		}
+		m >>= 1;
+		b = b & 1 ? (b >> 1) ^ poly : b >> 1;
+	}
+	return p;
+}
+
+static void cfs_crypto_crc_x2n_init(u32 *x2n, u32 poly)
+{
+	u32 p = 1U << 30;	/* x^1 */
+	int i;
+
+	x2n[0] = p;
+	for (i = 1; i < 32; i++)
+		x2n[i] = p = cfs_crypto_crc_multmodp(p, p, poly);
+}
+
+/* CRC register \a crc after \a len more zero bytes */
+static u32 cfs_crypto_crc_shift(u32 crc, unsigned int len, const u32 *x2n,
+				u32 poly)
+{
+	u32		p = 1U << 31;	/* x^0 */
+	unsigned int	k = 3;		/* bytes to bits */
+
+	for (; len != 0; len >>= 1, k++)
+		if (len & 1)
+			p = cfs_crypto_crc_multmodp(x2n[k & 31], p, poly);
+
+	return cfs_crypto_crc_multmodp(p, crc, poly);
+}
+
+static u32 cfs_crypto_adler32_combine(u32 adler1, u32 adler2,
+				      unsigned int len2)
+{
+	u32 rem = len2 % CFS_ADLER32_BASE;
+	u32 sum1 = adler1 & 0xffff;
+	u32 sum2 = rem * sum1 % CFS_ADLER32_BASE;
+
+	sum1 += (adler2 & 0xffff) + CFS_ADLER32_BASE - 1;
+	sum2 += (adler1 >> 16) + (adler2 >> 16) + CFS_ADLER32_BASE - rem;
+	if (sum1 >= CFS_ADLER32_BASE)
+		sum1 -= CFS_ADLER32_BASE;
+	if (sum1 >= CFS_ADLER32_BASE)
+		sum1 -= CFS_ADLER32_BASE;
+	if (sum2 >= CFS_ADLER32_BASE << 1)
+		sum2 -= CFS_ADLER32_BASE << 1;
+	if (sum2 >= CFS_ADLER32_BASE)
+		sum2 -= CFS_ADLER32_BASE;
+
+	return sum1 | (sum2 << 16);
+}
+
+/**
+ * Combine the checksums of two adjacent buffers
+ *
+ * Compute the checksum of buffer A followed by buffer B from the checksums
+ * of A and B, computed separately with the default initial value, without
+ * reading the data again.  This is exact, so the pages of a bulk RPC can be
+ * checksummed separately, e.g. to reuse the checksum of a page that did not
+ * change, yet the peer gets the same checksum as if the RPC was hashed as
+ * a whole.  The checksums are 4-byte digests, as returned by
+ * cfs_crypto_hash_final() and stored in a __u32.
+ *
+ * \param[in] hash_alg	hash algorithm id, CFS_HASH_ALG_{ADLER32,CRC32,CRC32C}
+ * \param[in,out] cksum	checksum of A, replaced by the checksum of A and B
+ * \param[in] cksum2	checksum of B
+ * \param[in] len2	length of B in bytes
+ *
+ * \retval		0 for success
+ * \retval		-EOPNOTSUPP if \a hash_alg digests cannot be combined
+ */
+int cfs_crypto_hash_combine(enum cfs_crypto_hash_alg hash_alg, __u32 *cksum,
+			    __u32 cksum2, unsigned int len2)
+{
+	u32 crc1 = le32_to_cpu((__force __le32)*cksum);
+	u32 crc2 = le32_to_cpu((__force __le32)cksum2);
+
+	switch (hash_alg) {
+	case CFS_HASH_ALG_ADLER32:
+		*cksum = cfs_crypto_adler32_combine(*cksum, cksum2, len2);
+		return 0;
+	case CFS_HASH_ALG_CRC32:
+		/* seeded with 0 and no final XOR, so it is linear */
+		crc1 = cfs_crypto_crc_shift(crc1, len2, cfs_crypto_crc32_x2n,
+					    CFS_CRC32_POLY) ^ crc2;
+		break;
+	case CFS_HASH_ALG_CRC32C:
+		crc1 = cfs_crypto_crc_shift(crc1, len2, cfs_crypto_crc32c_x2n,
+					    CFS_CRC32C_POLY) ^ crc2;
+		break;
+	default:
+		return -EOPNOTSUPP;
+	}
+
+	*cksum = (__force __u32)cpu_to_le32(crc1);
+	return 0;
+}
+EXPORT_SYMBOL(cfs_crypto_hash_combine);
+
+/**
+ * Check cfs_crypto_hash_combine() against the digest of a whole buffer
+ *
+ * Hash a buffer as a whole, then in two parts split at a few offsets, and
+ * check that combining the digests of the parts gives the digest of the
+ * whole buffer, as osc_checksum_bulk() relies on.
+ *
+ * \param[in] hash_alg	hash algorithm id whose digests can be combined
+ *
+ * \retval		0 if the combined digests match
+ * \retval		-EIO if a combined digest is wrong
+ * \retval		negative errno for other errors
+ */
+static int cfs_crypto_combine_test(enum cfs_crypto_hash_alg hash_alg)
+{
+	static const unsigned int splits[] = { 1, 1000, PAGE_SIZE };
+	unsigned int	buf_len = 2 * PAGE_SIZE + 100;
+	unsigned char	*buf;
+	unsigned int	hash_len;
+	unsigned int	i;
+	__u32		whole;
+	__u32		cksum;
+	__u32		cksum2;
+	int		err;
+
+	buf = kmalloc(buf_len, GFP_KERNEL);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < buf_len; i++)
+		buf[i] = i * 7 + (i >> 8);
+
+	hash_len = sizeof(whole);
+	err = cfs_crypto_hash_digest(hash_alg, buf, buf_len, NULL, 0,
+				     (unsigned char *)&whole, &hash_len);
+
+	for (i = 0; i < ARRAY_SIZE(splits) && err == 0; i++) {
+		hash_len = sizeof(cksum);
+		err = cfs_crypto_hash_digest(hash_alg, buf, splits[i], NULL, 0,
+					     (unsigned char *)&cksum,
+					     &hash_len);
+		if (err != 0)
+			break;
+
+		hash_len = sizeof(cksum2);
+		err = cfs_crypto_hash_digest(hash_alg, buf + splits[i],
+					     buf_len - splits[i], NULL, 0,
+					     (unsigned char *)&cksum2,
+					     &hash_len);
+		if (err != 0)
+			break;
+
+		err = cfs_crypto_hash_combine(hash_alg, &cksum, cksum2,
+					      buf_len - splits[i]);
+		if (err == 0 && cksum != whole) {
+			CERROR("Crypto hash algorithm %s: combined digest %#x "
+			       "of %u + %u bytes differs from %#x\n",
+			       cfs_crypto_hash_name(hash_alg), cksum,
+			       splits[i], buf_len - splits[i], whole);
+			err = -EIO;
+		}
+	}
+
+	kfree(buf);
+	return err;
+}
+
 /**
  * Compute the speed of specified hash function
  *
@@ -286,12 +521,17 @@ EXPORT_SYMBOL(cfs_crypto_hash_final);
  * The speed is stored internally in the cfs_crypto_hash_speeds[] array, and
  * is available through the cfs_crypto_hash_speed() function.
  *
+ * With \a per_page, each page is hashed separately and the page digests are
+ * combined with cfs_crypto_hash_combine(), as osc_checksum_bulk() does, and
+ * the speed is stored in cfs_crypto_hash_page_speeds[] instead.
+ *
  * \param[in] hash_alg	hash algorithm id (CFS_HASH_ALG_*)
- * \param[in] buf	data buffer on which to compute the hash
- * \param[in] buf_len	length of \buf on which to compute hash
+ * \param[in] per_page	hash each page separately
  */
-static void cfs_crypto_performance_test(enum cfs_crypto_hash_alg hash_alg)
+static void cfs_crypto_performance_test(enum cfs_crypto_hash_alg hash_alg,
+					bool per_page)
 {
+	int			*speeds;
 	int			buf_len = max(PAGE_SIZE, 1048576UL);
 	void			*buf;
 	unsigned long		start, end;
@@ -299,6 +539,11 @@ static void cfs_crypto_performance_test(enum cfs_crypto_hash_alg hash_alg)
 	struct page		*page;
 	unsigned char		hash[CFS_CRYPTO_HASH_DIGESTSIZE_MAX];
 	unsigned int		hash_len = sizeof(hash);
+	__u32			cksum = 0;
+	__u32			page_cksum;
+
+	speeds = per_page ? cfs_crypto_hash_page_speeds :
+			    cfs_crypto_hash_speeds;
 
 	page = alloc_page(GFP_KERNEL);
 	if (page == NULL) {
@@ -323,13 +568,31 @@ static void cfs_crypto_performance_test(enum cfs_crypto_hash_alg hash_alg)
 		}
 
 		for (i = 0; i < buf_len / PAGE_SIZE; i++) {
-			err = cfs_crypto_hash_update_page(hdesc, page, 0,
-							  PAGE_SIZE);
+			if (per_page) {
+				hash_len = sizeof(page_cksum);
+				err = cfs_crypto_hash_digest_page(hdesc, page,
+					0, PAGE_SIZE,
+					(unsigned char *)&page_cksum,
+					&hash_len);
+				if (err == 0 && i == 0)
+					cksum = page_cksum;
+				else if (err == 0)
+					err = cfs_crypto_hash_combine(hash_alg,
+						&cksum, page_cksum, PAGE_SIZE);
+			} else {
+				err = cfs_crypto_hash_update_page(hdesc, page,
+								  0, PAGE_SIZE);
+			}
 			if (err != 0)
 				break;
 		}
 
-		err = cfs_crypto_hash_final(hdesc, hash, &hash_len);
+		if (per_page) {
+			cfs_crypto_hash_final(hdesc, NULL, NULL);
+		} else {
+			hash_len = sizeof(hash);
+			err = cfs_crypto_hash_final(hdesc, hash, &hash_len);
+		}
 		if (err != 0)
 			break;
 	}
@@ -337,18 +600,19 @@ static void cfs_crypto_performance_test(enum cfs_crypto_hash_alg hash_alg)
 	__free_page(page);
 out_err:
 	if (err != 0) {
-		cfs_crypto_hash_speeds[hash_alg] = err;
-		CDEBUG(D_INFO, "Crypto hash algorithm %s test error: rc = %d\n",
-		       cfs_crypto_hash_name(hash_alg), err);
+		speeds[hash_alg] = err;
+		CDEBUG(D_INFO, "Crypto hash algorithm %s%s test error: "
+		       "rc = %d\n", cfs_crypto_hash_name(hash_alg),
+		       per_page ? " per page" : "", err);
 	} else {
 		unsigned long   tmp;
 
 		tmp = ((bcount * buf_len / jiffies_to_msecs(end - start)) *
 		       1000) / (1024 * 1024);
-		cfs_crypto_hash_speeds[hash_alg] = (int)tmp;
-		CDEBUG(D_CONFIG, "Crypto hash algorithm %s speed = %d MB/s\n",
+		speeds[hash_alg] = (int)tmp;
+		CDEBUG(D_CONFIG, "Crypto hash algorithm %s%s speed = %d MB/s\n",
 		       cfs_crypto_hash_name(hash_alg),
-		       cfs_crypto_hash_speeds[hash_alg]);
+		       per_page ? " per page" : "", speeds[hash_alg]);
 	}
 }
 
@@ -373,6 +637,25 @@ int cfs_crypto_hash_speed(enum cfs_crypto_hash_alg hash_alg)
 }
 EXPORT_SYMBOL(cfs_crypto_hash_speed);
 
+/**
+ * hash speed in Mbytes per second when hashing each page separately
+ *
+ * \param[in] hash_alg	hash algorithm id (CFS_HASH_ALG_*)
+ *
+ * \retval		positive speed of the hash function in MB/s
+ * \retval		-ENOENT if \a hash_alg is unsupported
+ * \retval		0 if the digests of \a hash_alg cannot be combined
+ * \retval		negative errno if \a hash_alg speed is unavailable
+ */
+int cfs_crypto_hash_page_speed(enum cfs_crypto_hash_alg hash_alg)
+{
+	if (hash_alg < CFS_HASH_ALG_MAX)
+		return cfs_crypto_hash_page_speeds[hash_alg];
+
+	return -ENOENT;
+}
+EXPORT_SYMBOL(cfs_crypto_hash_page_speed);
+
 /**
  * Run the performance test for all hash algorithms.
  *
@@ -385,18 +668,35 @@ EXPORT_SYMBOL(cfs_crypto_hash_speed);
  * engines), this speed only represents an estimate of the actual speed under
  * actual usage, but is reasonable for comparing available algorithms.
  *
- * The actual speeds are available via cfs_crypto_hash_speed() for later
- * comparison.
+ * The algorithms whose digests can be combined are also tested hashing
+ * each page separately, once cfs_crypto_combine_test() has checked that
+ * their combined digests are right.  Otherwise the error is stored as
+ * their per-page speed, and the pages of their RPCs are not hashed
+ * separately.
+ *
+ * The actual speeds are available via cfs_crypto_hash_speed() and
+ * cfs_crypto_hash_page_speed() for later comparison, and are shown in
+ * /proc/sys/lnet/crypto_hash_speed, which runs the test again when written.
  *
  * \retval		0 on success
  * \retval		-ENOMEM if no memory is available for test buffer
  */
-static int cfs_crypto_test_hashes(void)
+int cfs_crypto_test_hashes(void)
 {
 	enum cfs_crypto_hash_alg hash_alg;
-
-	for (hash_alg = 0; hash_alg < CFS_HASH_ALG_MAX; hash_alg++)
-		cfs_crypto_performance_test(hash_alg);
+	int			 rc;
+
+	for (hash_alg = 0; hash_alg < CFS_HASH_ALG_MAX; hash_alg++) {
+		cfs_crypto_performance_test(hash_alg, false);
+		if (!cfs_crypto_hash_combinable(hash_alg))
+			continue;
+
+		rc = cfs_crypto_combine_test(hash_alg);
+		if (rc == 0)
+			cfs_crypto_performance_test(hash_alg, true);
+		else
+			cfs_crypto_hash_page_speeds[hash_alg] = rc;
+	}
 
 	return 0;
 }
@@ -424,6 +724,9 @@ int cfs_crypto_register(void)
 {
 	request_module("crc32c");
 
+	cfs_crypto_crc_x2n_init(cfs_crypto_crc32_x2n, CFS_CRC32_POLY);
+	cfs_crypto_crc_x2n_init(cfs_crypto_crc32c_x2n, CFS_CRC32C_POLY);
+
 	adler32 = cfs_crypto_adler32_register();
 
 #ifdef HAVE_CRC32
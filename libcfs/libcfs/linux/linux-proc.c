@@ -64,6 +64,7 @@
 # define DEBUG_SUBSYSTEM S_LNET
 
 #include <libcfs/libcfs.h>
+#include <libcfs/libcfs_crypto.h>
 #include <asm/div64.h>
 #include "tracefile.h"
 
@@ -376,6 +377,52 @@ proc_cpt_table(struct ctl_table *table, int write, void __user *buffer,
 				     __proc_cpt_table);
 }
 
+static int __proc_crypto_hash_speed(void *data, int write,
+				    loff_t pos, void __user *buffer, int nob)
+{
+	enum cfs_crypto_hash_alg  hash_alg;
+	char			 *buf;
+	int			  len = 1024;
+	int			  rc = 0;
+
+	if (write) {
+		/* run the benchmark again, e.g. after changing CPU frequency
+		 * or loading another crypto module */
+		cfs_crypto_test_hashes();
+		return 0;
+	}
+
+	LIBCFS_ALLOC(buf, len);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	/* MB/s hashing RPCs of 1MB as a whole, or each page separately */
+	rc = snprintf(buf, len, "%-8s %8s %8s\n", "hash", "stream", "page");
+	for (hash_alg = CFS_HASH_ALG_NULL + 1; hash_alg < CFS_HASH_ALG_MAX;
+	     hash_alg++) {
+		rc += snprintf(buf + rc, len - rc, "%-8s %8d %8d\n",
+			       cfs_crypto_hash_name(hash_alg),
+			       cfs_crypto_hash_speed(hash_alg),
+			       cfs_crypto_hash_page_speed(hash_alg));
+	}
+
+	if (pos >= rc)
+		rc = 0;
+	else
+		rc = cfs_trace_copyout_string(buffer, nob, buf + pos, NULL);
+
+	LIBCFS_FREE(buf, len);
+	return rc;
+}
+
+static int
+proc_crypto_hash_speed(struct ctl_table *table, int write,
+		       void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	return lprocfs_call_handler(table->data, write, ppos, buffer, lenp,
+				     __proc_crypto_hash_speed);
+}
+
 static struct ctl_table lnet_table[] = {
 	/*
 	 * NB No .strategy entries have been provided since sysctl(8) prefers
@@ -449,6 +496,13 @@ static struct ctl_table lnet_table[] = {
 		.mode		= 0444,
 		.proc_handler	= &proc_cpt_table,
 	},
+	{
+		INIT_CTL_NAME
+		.procname	= "crypto_hash_speed",
+		.maxlen		= 128,
+		.mode		= 0644,
+		.proc_handler	= &proc_crypto_hash_speed,
+	},
 	{
 		INIT_CTL_NAME
 		.procname	= "upcall",
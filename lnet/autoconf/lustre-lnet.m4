@@ -447,6 +447,43 @@ sk_data_ready, [
 EXTRA_KCFLAGS="$tmp_flags"
 ]) # LN_CONFIG_SK_DATA_READY
 
+#
+# LN_CONFIG_SK_BUSY_LOOP
+#
+# 3.11 introduced socket busy polling with sk_can_busy_loop()/sk_busy_loop()
+#
+AC_DEFUN([LN_CONFIG_SK_BUSY_LOOP], [
+LB_CHECK_COMPILE([if kernel supports socket busy polling],
+sk_busy_loop, [
+	#include <net/busy_poll.h>
+],[
+	struct sock *sk = NULL;
+
+	if (sk_can_busy_loop(sk))
+		sk_busy_loop(sk, 1);
+],[
+	AC_DEFINE(HAVE_SK_BUSY_LOOP, 1,
+		[sk_busy_loop is available])
+])
+]) # LN_CONFIG_SK_BUSY_LOOP
+
+#
+# LN_CONFIG_SK_INCOMING_CPU
+#
+# 3.19 records the CPU which last received a packet for a socket
+#
+AC_DEFUN([LN_CONFIG_SK_INCOMING_CPU], [
+LB_CHECK_COMPILE([if 'struct sock' has 'sk_incoming_cpu'],
+sk_incoming_cpu, [
+	#include <net/sock.h>
+],[
+	((struct sock *)0)->sk_incoming_cpu = 0;
+],[
+	AC_DEFINE(HAVE_SK_INCOMING_CPU, 1,
+		[struct sock has sk_incoming_cpu])
+])
+]) # LN_CONFIG_SK_INCOMING_CPU
+
 #
 # LN_PROG_LINUX
 #
@@ -463,8 +500,12 @@ LN_CONFIG_O2IB
 LN_CONFIG_GNILND
 # 2.6.36
 LN_CONFIG_TCP_SENDPAGE
+# 3.11
+LN_CONFIG_SK_BUSY_LOOP
 # 3.15
 LN_CONFIG_SK_DATA_READY
+# 3.19
+LN_CONFIG_SK_INCOMING_CPU
 ]) # LN_PROG_LINUX
 
 #
@@ -557,6 +557,16 @@ struct lnet_match_table *lnet_mt_of_attach(unsigned int index,
 					   lnet_ins_pos_t pos);
 int lnet_mt_match_md(struct lnet_match_table *mtable,
 		     struct lnet_match_info *info, struct lnet_msg *msg);
+void lnet_mt_grow(struct lnet_match_table *mtable);
+
+static inline int
+lnet_mt_need_grow(struct lnet_match_table *mtable)
+{
+	/* NB: can be called w/o lock, lnet_mt_grow() checks it again */
+	return mtable->mt_mhash_bits < LNET_MT_HASH_BITS_MAX &&
+	       mtable->mt_nme > (LNET_MT_HASH_LOAD << mtable->mt_mhash_bits) &&
+	       lnet_ptl_is_unique(the_lnet.ln_portals[mtable->mt_portal]);
+}
 
 /* portals match/attach functions */
 void lnet_ptl_attach_md(lnet_me_t *me, lnet_libmd_t *md,
@@ -488,6 +488,10 @@ struct lnet_match_info {
 #define LNET_MT_BITS_U64		6	/* 2^6 bits */
 #define LNET_MT_EXHAUSTED_BITS		(LNET_MT_HASH_BITS - LNET_MT_BITS_U64)
 #define LNET_MT_EXHAUSTED_BMAP		((1 << LNET_MT_EXHAUSTED_BITS) + 1)
+/* ME hash of unique portal grows up to this many bits ... */
+#define LNET_MT_HASH_BITS_MAX		14
+/* ... once there are more than this many MEs per hash chain on average */
+#define LNET_MT_HASH_LOAD		4
 
 /* portal match table */
 struct lnet_match_table {
@@ -500,6 +504,11 @@ struct lnet_match_table {
 	/* bitmap to flag whether MEs on mt_hash are exhausted or not */
 	__u64			mt_exhausted[LNET_MT_EXHAUSTED_BMAP];
 	struct list_head	*mt_mhash;      /* matching hash */
+	/* mt_mhash has (1 << mt_mhash_bits) + 1 entries, it is always
+	 * LNET_MT_HASH_BITS for wildcard portal, and grows with the number
+	 * of MEs for unique portal */
+	unsigned int		mt_mhash_bits;
+	unsigned int		mt_nme;		/* # MEs on mt_mhash */
 };
 
 /* these are only useful for wildcard portal */
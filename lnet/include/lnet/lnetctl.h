@@ -43,6 +43,17 @@ enum {
 #define LNET_GET_BIT		(1 << 2)
 #define LNET_REPLY_BIT		(1 << 3)
 
+/** distribution of the latency added by a delay rule */
+enum lnet_delay_dist {
+	/** within la_jitter_us of the latency, all values equally likely */
+	LNET_DELAY_DIST_UNIFORM	= 0,
+	/** normal around the latency, la_jitter_us being the deviation */
+	LNET_DELAY_DIST_NORMAL	= 1,
+};
+
+/** messages of a delay rule may be received out of order */
+#define LNET_DELAY_F_REORDER	(1 << 0)
+
 /** ioctl parameter for LNet fault simulation */
 struct lnet_fault_attr {
 	/**
@@ -91,6 +102,21 @@ struct lnet_fault_attr {
 			__u32			la_interval;
 			/** latency to delay */
 			__u32			la_latency;
+			/** microseconds added to la_latency */
+			__u32			la_latency_us;
+			/** variation of the latency, in microseconds */
+			__u32			la_jitter_us;
+			/** enum lnet_delay_dist */
+			__u32			la_dist;
+			/**
+			 * KiB/s received between each pair of NIDs matching
+			 * this rule, 0 for no limit
+			 */
+			__u32			la_bandwidth;
+			/** KiB that may be received at once above it */
+			__u32			la_burst;
+			/** LNET_DELAY_F_* */
+			__u32			la_flags;
 		} delay;
 		__u64			space[8];
 	} u;
@@ -117,6 +143,13 @@ struct lnet_fault_stat {
 		struct {
 			/** total # delayed messages */
 			__u64			ls_delayed;
+			/** total payload bytes of delayed messages */
+			__u64			ls_bytes;
+			/**
+			 * # messages received before a message delayed
+			 * earlier by this rule
+			 */
+			__u64			ls_reordered;
 		} delay;
 		__u64			space[8];
 	} u;
@@ -493,8 +493,12 @@ typedef struct {
         int                     png_time;               /* time */
         int                     png_loop;               /* loop */
         int                     png_flags;              /* reserved flags */
+	int			png_posted;		/* # idle MDs posted by
+							 * each test unit */
 } lst_test_ping_param_t;
 
+#define LST_PING_POSTED_MAX	(64 * 1024)	/* max png_posted */
+
 typedef struct {
         __u32 errors;
         __u32 rpcs_sent;
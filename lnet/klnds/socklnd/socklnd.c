@@ -1261,6 +1261,17 @@ ksocknal_create_conn(lnet_ni_t *ni, ksock_route_t *route,
         peer->ksnp_send_keepalive = 0;
         peer->ksnp_error = 0;
 
+	if (*ksocknal_tunables.ksnd_rx_affinity) {
+		/* HELLO has been received, so the socket knows which CPU
+		 * the NIC delivers its packets to; schedule it there if that
+		 * CPT has scheduler threads */
+		int rx_cpt = ksocknal_lib_rx_cpt(conn);
+
+		if (rx_cpt >= 0 &&
+		    ksocknal_data.ksnd_sched_info[rx_cpt]->ksi_nthreads > 0)
+			cpt = rx_cpt;
+	}
+
 	sched = ksocknal_choose_scheduler_locked(cpt);
         sched->kss_nconns++;
         conn->ksnc_scheduler = sched;
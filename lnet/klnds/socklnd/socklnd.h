@@ -48,6 +48,9 @@
 #include <linux/unistd.h>
 #include <net/sock.h>
 #include <net/tcp.h>
+#ifdef HAVE_SK_BUSY_LOOP
+#include <net/busy_poll.h>
+#endif
 
 #include <libcfs/libcfs.h>
 #include <lnet/lnet.h>
@@ -158,6 +161,8 @@ typedef struct
         unsigned int     *ksnd_zc_min_payload;  /* minimum zero copy payload size */
         int              *ksnd_zc_recv;         /* enable ZC receive (for Chelsio TOE) */
         int              *ksnd_zc_recv_min_nfrags; /* minimum # of fragments to enable ZC receive */
+	int		 *ksnd_busy_poll;	/* usecs to spin before sleeping */
+	int		 *ksnd_rx_affinity;	/* schedule conns on RX CPT */
 #ifdef CPU_AFFINITY
         int              *ksnd_irq_affinity;    /* enable IRQ affinity? */
 #endif
@@ -684,6 +689,8 @@ extern void ksocknal_lib_tunables_fini(void);
 extern void ksocknal_lib_csum_tx(ksock_tx_t *tx);
 
 extern int ksocknal_lib_memory_pressure(ksock_conn_t *conn);
+extern void ksocknal_lib_busy_poll(ksock_conn_t *conn);
+extern int ksocknal_lib_rx_cpt(ksock_conn_t *conn);
 extern int ksocknal_lib_bind_thread_to_cpu(int id);
 
 #endif /* _SOCKLND_SOCKLND_H_ */
@@ -1383,6 +1383,48 @@ ksocknal_sched_cansleep(ksock_sched_t *sched)
 	return rc;
 }
 
+/*
+ * Spin for up to busy_poll usecs waiting for more data on \a conn, which
+ * the scheduler has just drained, instead of descheduling it and going to
+ * sleep.  A reply to a small RPC then avoids the interrupt-to-wakeup
+ * latency.  Called and returns with kss_lock held; returns non-zero if
+ * \a conn became ready for receive.
+ */
+static int
+ksocknal_sched_busy_poll(ksock_sched_t *sched, ksock_conn_t *conn)
+{
+	ktime_t deadline;
+
+	/* only spin when there is nothing else to do */
+	if (conn->ksnc_closing ||
+	    !list_empty(&sched->kss_rx_conns) ||
+	    !list_empty(&sched->kss_tx_conns))
+		return 0;
+
+	deadline = ktime_add_us(ktime_get(), *ksocknal_tunables.ksnd_busy_poll);
+	spin_unlock_bh(&sched->kss_lock);
+
+	/* conn is still rx_scheduled, so ksocknal_read_callback() only sets
+	 * ksnc_rx_ready and leaves it to me */
+	while (!need_resched() && !ksocknal_data.ksnd_shuttingdown &&
+	       !conn->ksnc_closing) {
+		ksocknal_lib_busy_poll(conn);
+
+		if (conn->ksnc_rx_ready ||
+		    !list_empty(&sched->kss_rx_conns) ||
+		    !list_empty(&sched->kss_tx_conns))
+			break;
+
+		if (ktime_compare(ktime_get(), deadline) >= 0)
+			break;
+
+		cpu_relax();
+	}
+
+	spin_lock_bh(&sched->kss_lock);
+	return conn->ksnc_rx_ready;
+}
+
 int ksocknal_scheduler(void *arg)
 {
 	struct ksock_sched_info	*info;
@@ -1442,7 +1484,9 @@ int ksocknal_scheduler(void *arg)
                                  * I change its state (under lock) to signal
                                  * it can be rescheduled */
                                 conn->ksnc_rx_state = SOCKNAL_RX_PARSE_WAIT;
-                        } else if (conn->ksnc_rx_ready) {
+                        } else if (conn->ksnc_rx_ready ||
+				   (*ksocknal_tunables.ksnd_busy_poll > 0 &&
+				    ksocknal_sched_busy_poll(sched, conn))) {
                                 /* reschedule for rx */
 				list_add_tail(&conn->ksnc_rx_list,
                                                    &sched->kss_rx_conns);
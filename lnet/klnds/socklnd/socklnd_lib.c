@@ -147,6 +147,24 @@ static struct ctl_table ksocknal_ctl_table[] = {
 		.proc_handler	= &proc_dointvec,
 		INIT_STRATEGY
 	},
+	{
+		INIT_CTL_NAME
+		.procname	= "busy_poll",
+		.data		= &ksocknal_tunables.ksnd_busy_poll,
+		.maxlen		= sizeof (int),
+		.mode		= 0644,
+		.proc_handler	= &proc_dointvec,
+		INIT_STRATEGY
+	},
+	{
+		INIT_CTL_NAME
+		.procname	= "rx_affinity",
+		.data		= &ksocknal_tunables.ksnd_rx_affinity,
+		.maxlen		= sizeof (int),
+		.mode		= 0644,
+		.proc_handler	= &proc_dointvec,
+		INIT_STRATEGY
+	},
 	{
 		INIT_CTL_NAME
 		.procname	= "typed",
@@ -828,6 +846,12 @@ ksocknal_lib_setup_sock (struct socket *sock)
                 return (rc);
         }
 
+#ifdef HAVE_SK_BUSY_LOOP
+	/* let ksocknal_lib_busy_poll() spin on the device queue */
+	if (*ksocknal_tunables.ksnd_busy_poll > 0)
+		sock->sk->sk_ll_usec = *ksocknal_tunables.ksnd_busy_poll;
+#endif
+
 /* TCP_BACKOFF_* sockopt tunables unsupported in stock kernels */
 #ifdef SOCKNAL_BACKOFF
         if (*ksocknal_tunables.ksnd_backoff_init > 0) {
@@ -1066,6 +1090,38 @@ ksocknal_lib_reset_callback(struct socket *sock, ksock_conn_t *conn)
         return ;
 }
 
+/*
+ * Poll the device queue feeding \a conn's socket for new packets, so a
+ * scheduler about to sleep can pick up a reply without waiting for the
+ * interrupt and wakeup.
+ */
+void
+ksocknal_lib_busy_poll(ksock_conn_t *conn)
+{
+#ifdef HAVE_SK_BUSY_LOOP
+	struct sock *sk = conn->ksnc_sock->sk;
+
+	if (sk_can_busy_loop(sk))
+		sk_busy_loop(sk, 1);
+#endif
+}
+
+/*
+ * Return the CPT of the CPU which last received a packet for \a conn,
+ * or -1 if the kernel doesn't track it.
+ */
+int
+ksocknal_lib_rx_cpt(ksock_conn_t *conn)
+{
+#ifdef HAVE_SK_INCOMING_CPU
+	int cpu = conn->ksnc_sock->sk->sk_incoming_cpu;
+
+	if (cpu >= 0 && cpu < nr_cpu_ids && cpu_online(cpu))
+		return cfs_cpt_of_cpu(lnet_cpt_table(), cpu);
+#endif
+	return -1;
+}
+
 int
 ksocknal_lib_memory_pressure(ksock_conn_t *conn)
 {
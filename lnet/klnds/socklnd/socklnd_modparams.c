@@ -138,6 +138,14 @@ static unsigned int zc_recv_min_nfrags = 16;
 CFS_MODULE_PARM(zc_recv_min_nfrags, "i", int, 0644,
                 "minimum # of fragments to enable ZC recv");
 
+static int busy_poll;
+CFS_MODULE_PARM(busy_poll, "i", int, 0644,
+		"usecs a scheduler busy-polls its last socket before sleeping");
+
+static int rx_affinity;
+CFS_MODULE_PARM(rx_affinity, "i", int, 0644,
+		"schedule connections on the CPT which receives their packets");
+
 #ifdef SOCKNAL_BACKOFF
 static int backoff_init = 3;
 CFS_MODULE_PARM(backoff_init, "i", int, 0644,
@@ -187,6 +195,8 @@ int ksocknal_tunables_init(void)
         ksocknal_tunables.ksnd_zc_min_payload     = &zc_min_payload;
         ksocknal_tunables.ksnd_zc_recv            = &zc_recv;
         ksocknal_tunables.ksnd_zc_recv_min_nfrags = &zc_recv_min_nfrags;
+	ksocknal_tunables.ksnd_busy_poll	  = &busy_poll;
+	ksocknal_tunables.ksnd_rx_affinity	  = &rx_affinity;
 
 #ifdef CPU_AFFINITY
 	if (enable_irq_affinity) {
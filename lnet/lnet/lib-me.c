@@ -93,6 +93,9 @@ LNetMEAttach(unsigned int portal,
 	if (mtable == NULL) /* can't match portal type */
 		return -EPERM;
 
+	if (lnet_mt_need_grow(mtable))
+		lnet_mt_grow(mtable);
+
 	me = lnet_me_alloc();
 	if (me == NULL)
 		return -ENOMEM;
@@ -118,6 +121,7 @@ LNetMEAttach(unsigned int portal,
 		list_add_tail(&me->me_list, head);
 	else
 		list_add(&me->me_list, head);
+	mtable->mt_nme++;
 
 	lnet_me2handle(handle, me);
 
@@ -200,6 +204,7 @@ LNetMEInsert(lnet_handle_me_t current_meh,
 		list_add(&new_me->me_list, &current_me->me_list);
 	else
 		list_add_tail(&new_me->me_list, &current_me->me_list);
+	ptl->ptl_mtables[cpt]->mt_nme++;
 
 	lnet_me2handle(handle, new_me);
 
@@ -262,7 +267,10 @@ EXPORT_SYMBOL(LNetMEUnlink);
 void
 lnet_me_unlink(lnet_me_t *me)
 {
+	struct lnet_portal *ptl = the_lnet.ln_portals[me->me_portal];
+
 	list_del(&me->me_list);
+	ptl->ptl_mtables[lnet_cpt_of_cookie(me->me_lh.lh_cookie)]->mt_nme--;
 
 	if (me->me_md != NULL) {
 		lnet_libmd_t *md = me->me_md;
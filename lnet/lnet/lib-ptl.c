@@ -366,11 +366,94 @@ lnet_mt_match_head(struct lnet_match_table *mtable,
 		unsigned long hash = mbits + id.nid + id.pid;
 
 		LASSERT(lnet_ptl_is_unique(ptl));
-		hash = hash_long(hash, LNET_MT_HASH_BITS);
+		hash = hash_long(hash, mtable->mt_mhash_bits);
 		return &mtable->mt_mhash[hash];
 	}
 }
 
+static struct list_head *
+lnet_mt_hash_alloc(int cpt, unsigned int bits)
+{
+	struct list_head	*mhash;
+	int			i;
+
+	/* the extra entry is for MEs with ignore bits */
+	LIBCFS_CPT_ALLOC(mhash, lnet_cpt_table(), cpt,
+			 sizeof(*mhash) * ((1 << bits) + 1));
+	if (mhash == NULL)
+		return NULL;
+
+	for (i = 0; i < (1 << bits) + 1; i++)
+		INIT_LIST_HEAD(&mhash[i]);
+
+	return mhash;
+}
+
+static void
+lnet_mt_hash_free(struct list_head *mhash, unsigned int bits)
+{
+	LIBCFS_FREE(mhash, sizeof(*mhash) * ((1 << bits) + 1));
+}
+
+/**
+ * Double the ME hash of a unique portal match-table.
+ *
+ * Replies and bulk buffers are posted on unique portals, one ME per RPC,
+ * so a node with many RPCs in flight can have tens of thousands of MEs on
+ * a single match-table and a fixed size hash would make every incoming
+ * message walk a long chain.  Called w/o lock before attaching a new ME,
+ * the new hash is allocated first and MEs are rehashed with hold of
+ * lnet_res_lock, so matching is never blocked by the allocation.  If the
+ * allocation fails the current hash is simply kept.
+ */
+void
+lnet_mt_grow(struct lnet_match_table *mtable)
+{
+	struct list_head	*mhash;
+	struct list_head	*old;
+	unsigned int		bits = mtable->mt_mhash_bits; /* w/o lock */
+	int			i;
+
+	mhash = lnet_mt_hash_alloc(mtable->mt_cpt, bits + 1);
+	if (mhash == NULL)
+		return;
+
+	lnet_res_lock(mtable->mt_cpt);
+	if (mtable->mt_mhash_bits != bits || !lnet_mt_need_grow(mtable)) {
+		/* raced with another thread */
+		lnet_res_unlock(mtable->mt_cpt);
+		lnet_mt_hash_free(mhash, bits + 1);
+		return;
+	}
+
+	old = mtable->mt_mhash;
+	mtable->mt_mhash = mhash;
+	mtable->mt_mhash_bits = bits + 1;
+
+	/* unique portal has no ME with ignore bits, so only the hashed
+	 * entries need to be moved, order is kept within each chain */
+	for (i = 0; i < (1 << bits); i++) {
+		while (!list_empty(&old[i])) {
+			struct list_head *head;
+			lnet_me_t	 *me;
+
+			me = list_entry(old[i].next, lnet_me_t, me_list);
+			head = lnet_mt_match_head(mtable, me->me_match_id,
+						  me->me_match_bits);
+			me->me_pos = head - &mhash[0];
+			list_move_tail(&me->me_list, head);
+		}
+	}
+	LASSERT(list_empty(&old[1 << bits]));
+	lnet_res_unlock(mtable->mt_cpt);
+
+	CDEBUG(D_NET, "Portal %d match-table %d: %u MEs, hash grows to %u\n",
+	       mtable->mt_portal, mtable->mt_cpt, mtable->mt_nme,
+	       1 << (bits + 1));
+
+	lnet_mt_hash_free(old, bits);
+}
+
 int
 lnet_mt_match_md(struct lnet_match_table *mtable,
 		 struct lnet_match_info *info, struct lnet_msg *msg)
@@ -381,8 +464,10 @@ lnet_mt_match_md(struct lnet_match_table *mtable,
 	int			exhausted = 0;
 	int			rc;
 
-	/* any ME with ignore bits? */
-	if (!list_empty(&mtable->mt_mhash[LNET_MT_HASH_IGNORE]))
+	/* any ME with ignore bits? only wildcard portal can have them, the
+	 * last entry of a grown unique portal hash is a regular chain */
+	if (lnet_ptl_is_wildcard(the_lnet.ln_portals[mtable->mt_portal]) &&
+	    !list_empty(&mtable->mt_mhash[LNET_MT_HASH_IGNORE]))
 		head = &mtable->mt_mhash[LNET_MT_HASH_IGNORE];
 	else
 		head = lnet_mt_match_head(mtable, info->mi_id, info->mi_mbits);
@@ -735,7 +820,7 @@ lnet_ptl_cleanup(struct lnet_portal *ptl)
 
 		mhash = mtable->mt_mhash;
 		/* cleanup ME */
-		for (j = 0; j < LNET_MT_HASH_SIZE + 1; j++) {
+		for (j = 0; j < (1 << mtable->mt_mhash_bits) + 1; j++) {
 			while (!list_empty(&mhash[j])) {
 				me = list_entry(mhash[j].next,
 						lnet_me_t, me_list);
@@ -744,8 +829,7 @@ lnet_ptl_cleanup(struct lnet_portal *ptl)
 				lnet_me_free(me);
 			}
 		}
-		/* the extra entry is for MEs with ignore bits */
-		LIBCFS_FREE(mhash, sizeof(*mhash) * (LNET_MT_HASH_SIZE + 1));
+		lnet_mt_hash_free(mhash, mtable->mt_mhash_bits);
 	}
 
 	cfs_percpt_free(ptl->ptl_mtables);
@@ -758,7 +842,6 @@ lnet_ptl_setup(struct lnet_portal *ptl, int index)
 	struct lnet_match_table	*mtable;
 	struct list_head	*mhash;
 	int			i;
-	int			j;
 
 	ptl->ptl_mtables = cfs_percpt_alloc(lnet_cpt_table(),
 					    sizeof(struct lnet_match_table));
@@ -772,9 +855,7 @@ lnet_ptl_setup(struct lnet_portal *ptl, int index)
 	INIT_LIST_HEAD(&ptl->ptl_msg_stealing);
 	spin_lock_init(&ptl->ptl_lock);
 	cfs_percpt_for_each(mtable, i, ptl->ptl_mtables) {
-		/* the extra entry is for MEs with ignore bits */
-		LIBCFS_CPT_ALLOC(mhash, lnet_cpt_table(), i,
-				 sizeof(*mhash) * (LNET_MT_HASH_SIZE + 1));
+		mhash = lnet_mt_hash_alloc(i, LNET_MT_HASH_BITS);
 		if (mhash == NULL) {
 			CERROR("Failed to create match hash for portal %d\n",
 			       index);
@@ -785,8 +866,7 @@ lnet_ptl_setup(struct lnet_portal *ptl, int index)
 		       sizeof(mtable->mt_exhausted[0]) *
 		       LNET_MT_EXHAUSTED_BMAP);
 		mtable->mt_mhash = mhash;
-		for (j = 0; j < LNET_MT_HASH_SIZE + 1; j++)
-			INIT_LIST_HEAD(&mhash[j]);
+		mtable->mt_mhash_bits = LNET_MT_HASH_BITS;
 
 		mtable->mt_portal = index;
 		mtable->mt_cpt = i;
@@ -422,6 +422,23 @@ struct lnet_delay_rule {
 	struct lnet_fault_stat	dl_stat;
 	/** timer to wakeup delay_daemon */
 	struct timer_list	dl_timer;
+	/** struct lnet_delay_link of each pair of NIDs matching this rule */
+	struct list_head	dl_links;
+};
+
+/**
+ * Messages received from one NID by another one through a delay rule, which
+ * has a bandwidth or keeps messages in order.
+ */
+struct lnet_delay_link {
+	/** chain on lnet_delay_rule::dl_links */
+	struct list_head	dk_list;
+	lnet_nid_t		dk_src;
+	lnet_nid_t		dk_dst;
+	/** ns until which the link is busy receiving the queued messages */
+	__s64			dk_busy;
+	/** jiffies to send the last delayed message of this link */
+	unsigned long		dk_last_send;
 };
 
 struct delay_daemon_data {
@@ -453,15 +470,170 @@ round_timeout(cfs_time_t timeout)
 static void
 delay_rule_decref(struct lnet_delay_rule *rule)
 {
+	struct lnet_delay_link *link;
+
 	if (atomic_dec_and_test(&rule->dl_refcount)) {
 		LASSERT(list_empty(&rule->dl_sched_link));
 		LASSERT(list_empty(&rule->dl_msg_list));
 		LASSERT(list_empty(&rule->dl_link));
 
+		while (!list_empty(&rule->dl_links)) {
+			link = list_entry(rule->dl_links.next,
+					  struct lnet_delay_link, dk_list);
+			list_del(&link->dk_list);
+			CFS_FREE_PTR(link);
+		}
 		CFS_FREE_PTR(rule);
 	}
 }
 
+/** rule only has a latency in seconds, as before bandwidth and jitter */
+static inline bool
+delay_rule_is_simple(struct lnet_fault_attr *attr)
+{
+	return attr->u.delay.la_latency_us == 0 &&
+	       attr->u.delay.la_jitter_us == 0 &&
+	       attr->u.delay.la_bandwidth == 0;
+}
+
+/**
+ * Find the link of \a rule from \a src to \a dst, create it if it doesn't
+ * exist yet.  Called with rule::dl_lock held.
+ *
+ * \retval NULL if out of memory, the message is then delayed regardless of
+ *	   the others of its link
+ */
+static struct lnet_delay_link *
+delay_link_get(struct lnet_delay_rule *rule, lnet_nid_t src, lnet_nid_t dst)
+{
+	struct lnet_delay_link *link;
+
+	list_for_each_entry(link, &rule->dl_links, dk_list) {
+		if (link->dk_src == src && link->dk_dst == dst)
+			return link;
+	}
+
+	LIBCFS_ALLOC_ATOMIC(link, sizeof(*link));
+	if (link == NULL)
+		return NULL;
+
+	link->dk_src = src;
+	link->dk_dst = dst;
+	link->dk_busy = 0;
+	link->dk_last_send = cfs_time_current();
+	list_add(&link->dk_list, &rule->dl_links);
+	return link;
+}
+
+/** microseconds of latency for the next message of \a attr */
+static __s64
+delay_latency_us(struct lnet_fault_attr *attr)
+{
+	__s64	latency;
+	__s64	jitter = attr->u.delay.la_jitter_us;
+	__s64	sum = 0;
+	int	i;
+
+	latency = (__s64)attr->u.delay.la_latency * USEC_PER_SEC +
+		  attr->u.delay.la_latency_us;
+	if (jitter == 0)
+		return latency;
+
+	if (attr->u.delay.la_dist == LNET_DELAY_DIST_NORMAL) {
+		/* the sum of 12 uniform variables in [0, 1000] is close to
+		 * a normal distribution, of mean 6000 and deviation 1000 */
+		for (i = 0; i < 12; i++)
+			sum += cfs_rand() % 1001;
+		latency += div_s64((sum - 6000) * jitter, 1000);
+	} else {
+		latency += (__s64)(cfs_rand() % (2 * (__u32)jitter + 1)) -
+			   jitter;
+	}
+
+	return max_t(__s64, latency, 0);
+}
+
+/**
+ * jiffies to receive \a msg, which is delayed by \a rule.  The time it takes
+ * to go through a link of limited bandwidth is added to the latency: the
+ * bucket of the link holds la_burst KiB, filled at la_bandwidth KiB/s.
+ * Called with rule::dl_lock held.
+ */
+static unsigned long
+delay_msg_send_time(struct lnet_delay_rule *rule, lnet_nid_t src,
+		    lnet_nid_t dst, struct lnet_msg *msg)
+{
+	struct lnet_fault_attr	*attr = &rule->dl_attr;
+	struct lnet_delay_link	*link = NULL;
+	unsigned long		 send;
+	__s64			 delay;
+	__u32			 rem;
+
+	if (delay_rule_is_simple(attr))
+		return round_timeout(cfs_time_shift(attr->u.delay.la_latency));
+
+	delay = delay_latency_us(attr);
+	if (attr->u.delay.la_bandwidth != 0 ||
+	    !(attr->u.delay.la_flags & LNET_DELAY_F_REORDER))
+		link = delay_link_get(rule, src, dst);
+
+	if (link != NULL && attr->u.delay.la_bandwidth != 0) {
+		__u64	bw = attr->u.delay.la_bandwidth;
+		__s64	now = ktime_to_ns(ktime_get());
+		__s64	burst;
+
+		burst = div64_u64((__u64)attr->u.delay.la_burst * NSEC_PER_SEC,
+				  bw);
+		link->dk_busy = max(link->dk_busy, now - burst);
+		link->dk_busy += div64_u64((__u64)(msg->msg_len +
+						   sizeof(lnet_hdr_t)) *
+					   NSEC_PER_SEC, bw * 1024);
+		if (link->dk_busy > now)
+			delay += div_s64(link->dk_busy - now, NSEC_PER_USEC);
+	}
+
+	send = cfs_time_current() +
+	       cfs_time_seconds(div_u64_rem(delay, USEC_PER_SEC, &rem)) +
+	       usecs_to_jiffies(rem);
+
+	if (link != NULL) {
+		if (!(attr->u.delay.la_flags & LNET_DELAY_F_REORDER) &&
+		    cfs_time_before(send, link->dk_last_send))
+			send = link->dk_last_send;
+		link->dk_last_send = send;
+	}
+
+	return send;
+}
+
+/**
+ * Queue \a msg on \a rule, ordered by the time to receive it, and rearm the
+ * timer if it is the first one to receive.  A message queued ahead of others
+ * overtakes them and is counted as reordered.  Called with rule::dl_lock held.
+ */
+static void
+delay_msg_queue(struct lnet_delay_rule *rule, struct lnet_msg *msg)
+{
+	struct list_head	*pos;
+	struct lnet_msg		*tmp;
+
+	list_for_each_prev(pos, &rule->dl_msg_list) {
+		tmp = list_entry(pos, struct lnet_msg, msg_list);
+		if (cfs_time_aftereq(msg->msg_delay_send,
+				     tmp->msg_delay_send))
+			break;
+	}
+	if (pos != rule->dl_msg_list.prev)
+		rule->dl_stat.u.delay.ls_reordered++;
+	list_add(&msg->msg_list, pos);
+
+	if (rule->dl_msg_send == -1 ||
+	    cfs_time_before(msg->msg_delay_send, rule->dl_msg_send)) {
+		rule->dl_msg_send = msg->msg_delay_send;
+		mod_timer(&rule->dl_timer, rule->dl_msg_send);
+	}
+}
+
 /**
  * check source/destination NID, portal, message type and delay rate,
  * decide whether should delay this message or not
@@ -521,14 +693,10 @@ delay_rule_match(struct lnet_delay_rule *rule, lnet_nid_t src,
 	/* delay this message, update counters */
 	lnet_fault_stat_inc(&rule->dl_stat, type);
 	rule->dl_stat.u.delay.ls_delayed++;
+	rule->dl_stat.u.delay.ls_bytes += msg->msg_len;
 
-	list_add_tail(&msg->msg_list, &rule->dl_msg_list);
-	msg->msg_delay_send = round_timeout(
-			cfs_time_shift(attr->u.delay.la_latency));
-	if (rule->dl_msg_send == -1) {
-		rule->dl_msg_send = msg->msg_delay_send;
-		mod_timer(&rule->dl_timer, rule->dl_msg_send);
-	}
+	msg->msg_delay_send = delay_msg_send_time(rule, src, dst, msg);
+	delay_msg_queue(rule, msg);
 
 	spin_unlock(&rule->dl_lock);
 	return true;
@@ -737,8 +905,21 @@ lnet_delay_rule_add(struct lnet_fault_attr *attr)
 		RETURN(-EINVAL);
 	}
 
-	if (attr->u.delay.la_latency == 0) {
-		CDEBUG(D_NET, "delay latency cannot be zero\n");
+	if (attr->u.delay.la_latency == 0 &&
+	    attr->u.delay.la_latency_us == 0 &&
+	    attr->u.delay.la_bandwidth == 0) {
+		CDEBUG(D_NET, "delay latency and bandwidth cannot be zero\n");
+		RETURN(-EINVAL);
+	}
+
+	if (attr->u.delay.la_dist > LNET_DELAY_DIST_NORMAL ||
+	    attr->u.delay.la_jitter_us >= (1U << 30) ||
+	    attr->u.delay.la_burst >= (1U << 20) ||
+	    (attr->u.delay.la_flags & ~LNET_DELAY_F_REORDER) != 0) {
+		CDEBUG(D_NET, "invalid delay distribution %u, jitter %u, "
+		       "burst %u or flags %#x\n", attr->u.delay.la_dist,
+		       attr->u.delay.la_jitter_us, attr->u.delay.la_burst,
+		       attr->u.delay.la_flags);
 		RETURN(-EINVAL);
 	}
 
@@ -775,6 +956,7 @@ lnet_delay_rule_add(struct lnet_fault_attr *attr)
 	spin_lock_init(&rule->dl_lock);
 	INIT_LIST_HEAD(&rule->dl_msg_list);
 	INIT_LIST_HEAD(&rule->dl_sched_link);
+	INIT_LIST_HEAD(&rule->dl_links);
 
 	rule->dl_attr = *attr;
 	if (attr->u.delay.la_interval != 0) {
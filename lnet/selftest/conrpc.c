@@ -777,8 +777,14 @@ lstcon_pingrpc_prep(lst_test_ping_param_t *param, srpc_test_reqst_t *req)
 {
         test_ping_req_t *prq = &req->tsr_u.ping;
 
+	if (param == NULL) { /* no parameter from lst */
+		memset(prq, 0, sizeof(*prq));
+		return 0;
+	}
+
         prq->png_size   = param->png_size;
         prq->png_flags  = param->png_flags;
+	prq->png_posted = param->png_posted;
         /* TODO dest */
         return 0;
 }
@@ -893,7 +899,8 @@ lstcon_testrpc_prep(lstcon_node_t *nd, int transop, unsigned feats,
         switch (test->tes_type) {
         case LST_TEST_PING:
                 trq->tsr_service = SRPC_SERVICE_PING;
-		rc = lstcon_pingrpc_prep((lst_test_ping_param_t *)
+		rc = lstcon_pingrpc_prep(test->tes_paramlen == 0 ? NULL :
+					 (lst_test_ping_param_t *)
 					 &test->tes_param[0], trq);
 		break;
 
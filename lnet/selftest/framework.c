@@ -737,6 +737,7 @@ sfw_unpack_addtest_req(srpc_msg_t *msg)
 
                 __swab32s(&ping->png_size);
                 __swab32s(&ping->png_flags);
+		__swab32s(&ping->png_posted);
                 return;
         }
 
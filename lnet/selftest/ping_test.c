@@ -43,6 +43,7 @@
 #include "selftest.h"
 
 #define LST_PING_TEST_MAGIC     0xbabeface
+#define LST_PING_RTT_BUCKETS	32
 
 static int ping_srv_workitems = SFW_TEST_WI_MAX;
 CFS_MODULE_PARM(ping_srv_workitems, "i", int, 0644, "# PING server workitems");
@@ -50,38 +51,158 @@ CFS_MODULE_PARM(ping_srv_workitems, "i", int, 0644, "# PING server workitems");
 typedef struct {
 	spinlock_t	pnd_lock;	/* serialize */
 	int		pnd_counter;	/* sequence counter */
+	__u64		pnd_rtt_usec;	/* total round-trip time */
+	__u64		pnd_nrtt;	/* # replies in pnd_rtt_usec */
+	/* # replies by round-trip time, bucket N counts usec < 2^N */
+	__u64		pnd_rtt_hist[LST_PING_RTT_BUCKETS];
 } lst_ping_data_t;
 
 static lst_ping_data_t  lst_ping_data;
 
+/* MD handles of idle MDs posted by a test unit, see srpc_post_idle_md() */
+typedef struct {
+	int		 pni_posted;	/* # posted MDs */
+	lnet_handle_md_t pni_mdh[0];	/* their handles */
+} lst_ping_idle_t;
+
+static void
+ping_client_unpost_idle(sfw_test_unit_t *tsu)
+{
+	lst_ping_idle_t	*idle = tsu->tsu_private;
+	int		 i;
+
+	if (idle == NULL)
+		return;
+
+	for (i = 0; i < idle->pni_posted; i++)
+		LNetMDUnlink(idle->pni_mdh[i]);
+
+	LIBCFS_FREE(idle, offsetof(lst_ping_idle_t,
+				   pni_mdh[tsu->tsu_instance->tsi_u.ping.png_posted]));
+	tsu->tsu_private = NULL;
+}
+
+/* keep @png_posted MDs for the destination of @tsu on the reply portal, so
+ * each reply has to be matched against a larger match-table */
+static int
+ping_client_post_idle(sfw_test_unit_t *tsu)
+{
+	int		 posted = tsu->tsu_instance->tsi_u.ping.png_posted;
+	lst_ping_idle_t	*idle;
+	int		 rc;
+
+	LIBCFS_ALLOC(idle, offsetof(lst_ping_idle_t, pni_mdh[posted]));
+	if (idle == NULL)
+		return -ENOMEM;
+
+	tsu->tsu_private = idle;
+	for (idle->pni_posted = 0; idle->pni_posted < posted;
+	     idle->pni_posted++) {
+		rc = srpc_post_idle_md(tsu->tsu_dest,
+				       &idle->pni_mdh[idle->pni_posted]);
+		if (rc != 0) {
+			CERROR("Can't post idle MD %d for %s: %d\n",
+			       idle->pni_posted,
+			       libcfs_id2str(tsu->tsu_dest), rc);
+			ping_client_unpost_idle(tsu);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
 static int
 ping_client_init(sfw_test_instance_t *tsi)
 {
-	sfw_session_t *sn = tsi->tsi_batch->bat_session;
+	sfw_session_t	*sn = tsi->tsi_batch->bat_session;
+	sfw_test_unit_t	*tsu;
+	int		 rc;
 
 	LASSERT(tsi->tsi_is_client);
 	LASSERT(sn != NULL && (sn->sn_features & ~LST_FEATS_MASK) == 0);
 
 	spin_lock_init(&lst_ping_data.pnd_lock);
 	lst_ping_data.pnd_counter = 0;
+	lst_ping_data.pnd_rtt_usec = 0;
+	lst_ping_data.pnd_nrtt = 0;
+	memset(lst_ping_data.pnd_rtt_hist, 0,
+	       sizeof(lst_ping_data.pnd_rtt_hist));
+
+	if (tsi->tsi_u.ping.png_posted == 0)
+		return 0;
+
+	if (tsi->tsi_u.ping.png_posted > LST_PING_POSTED_MAX) {
+		CERROR("Too many idle MDs per test unit: %u\n",
+		       tsi->tsi_u.ping.png_posted);
+		return -EINVAL;
+	}
+
+	list_for_each_entry(tsu, &tsi->tsi_units, tsu_list) {
+		rc = ping_client_post_idle(tsu);
+		if (rc != 0) {
+			list_for_each_entry(tsu, &tsi->tsi_units, tsu_list)
+				ping_client_unpost_idle(tsu);
+			return rc;
+		}
+	}
 
 	return 0;
 }
 
+/* upper bound in usec of the round-trip time of @pct percent of replies,
+ * called with pnd_lock held */
+static unsigned int
+ping_client_rtt_percentile(int pct)
+{
+	__u64	want = lst_ping_data.pnd_nrtt * pct;
+	__u64	sum = 0;
+	int	i;
+
+	for (i = 0; i < LST_PING_RTT_BUCKETS - 1; i++) {
+		sum += lst_ping_data.pnd_rtt_hist[i];
+		if (sum * 100 >= want)
+			break;
+	}
+
+	return 1U << i;
+}
+
 static void
 ping_client_fini (sfw_test_instance_t *tsi)
 {
         sfw_session_t *sn = tsi->tsi_batch->bat_session;
+	sfw_test_unit_t *tsu;
         int            errors;
+	__u64	       rtt = 0;
+	unsigned int   p50 = 0;
+	unsigned int   p90 = 0;
+	unsigned int   p99 = 0;
 
         LASSERT (sn != NULL);
         LASSERT (tsi->tsi_is_client);
 
+	list_for_each_entry(tsu, &tsi->tsi_units, tsu_list)
+		ping_client_unpost_idle(tsu);
+
+	spin_lock(&lst_ping_data.pnd_lock);
+	if (lst_ping_data.pnd_nrtt != 0) {
+		rtt = lst_ping_data.pnd_rtt_usec;
+		do_div(rtt, lst_ping_data.pnd_nrtt);
+		p50 = ping_client_rtt_percentile(50);
+		p90 = ping_client_rtt_percentile(90);
+		p99 = ping_client_rtt_percentile(99);
+	}
+	spin_unlock(&lst_ping_data.pnd_lock);
+
 	errors = atomic_read(&sn->sn_ping_errors);
         if (errors)
                 CWARN ("%d pings have failed.\n", errors);
         else
-                CDEBUG (D_NET, "Ping test finished OK.\n");
+		CDEBUG(D_CONSOLE, "Ping test finished OK, average round-trip "
+		       LPU64" usec (p50 < %u, p90 < %u, p99 < %u usec) "
+		       "with %u idle MDs per peer.\n",
+		       rtt, p50, p90, p99, tsi->tsi_u.ping.png_posted);
 }
 
 static int
@@ -124,6 +245,7 @@ ping_client_done_rpc (sfw_test_unit_t *tsu, srpc_client_rpc_t *rpc)
         srpc_ping_reqst_t   *reqst = &rpc->crpc_reqstmsg.msg_body.ping_reqst;
         srpc_ping_reply_t   *reply = &rpc->crpc_replymsg.msg_body.ping_reply;
         struct timeval       tv;
+	unsigned	     usec;
 
         LASSERT (sn != NULL);
 
@@ -161,9 +283,16 @@ ping_client_done_rpc (sfw_test_unit_t *tsu, srpc_client_rpc_t *rpc)
         }
 
         cfs_fs_timeval(&tv);
-        CDEBUG (D_NET, "%d reply in %u usec\n", reply->pnr_seq,
-                (unsigned)((tv.tv_sec - (unsigned)reqst->pnr_time_sec) * 1000000
-                           + (tv.tv_usec - reqst->pnr_time_usec)));
+	usec = (unsigned)((tv.tv_sec - (unsigned)reqst->pnr_time_sec) * 1000000
+			  + (tv.tv_usec - reqst->pnr_time_usec));
+	CDEBUG(D_NET, "%d reply in %u usec\n", reply->pnr_seq, usec);
+
+	spin_lock(&lst_ping_data.pnd_lock);
+	lst_ping_data.pnd_rtt_usec += usec;
+	lst_ping_data.pnd_nrtt++;
+	lst_ping_data.pnd_rtt_hist[min(fls(usec),
+				       LST_PING_RTT_BUCKETS - 1)]++;
+	spin_unlock(&lst_ping_data.pnd_lock);
         return;
 }
 
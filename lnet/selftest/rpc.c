@@ -390,6 +390,37 @@ srpc_post_passive_rdma(int portal, int local, __u64 matchbits, void *buf,
         return 0;
 }
 
+/**
+ * Post an MD which never matches any message on the reply/bulk portal, as
+ * it uses a matchbits value never sent to \a peer.  It only makes LNet
+ * match-tables larger, the ping test uses it to measure match overhead as
+ * the number of posted MDs grows.  No event is delivered for it, the
+ * caller must LNetMDUnlink() \a mdh when done.
+ */
+int
+srpc_post_idle_md(lnet_process_id_t peer, lnet_handle_md_t *mdh)
+{
+	lnet_handle_me_t meh;
+	lnet_md_t	 md;
+	int		 rc;
+
+	rc = LNetMEAttach(SRPC_RDMA_PORTAL, peer, srpc_next_id(), 0,
+			  LNET_UNLINK, LNET_INS_AFTER, &meh);
+	if (rc != 0)
+		return rc;
+
+	memset(&md, 0, sizeof(md));
+	md.threshold = LNET_MD_THRESH_INF;
+	md.options   = LNET_MD_OP_PUT;
+	LNetInvalidateHandle(&md.eq_handle);
+
+	rc = LNetMDAttach(meh, md, LNET_UNLINK, mdh);
+	if (rc != 0)
+		LNetMEUnlink(meh);
+
+	return rc;
+}
+
 static int
 srpc_post_active_rdma(int portal, __u64 matchbits, void *buf, int len,
                       int options, lnet_process_id_t peer, lnet_nid_t self,
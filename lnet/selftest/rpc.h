@@ -188,6 +188,7 @@ typedef struct {
 typedef struct {
 	__u32			png_size;       /* size of ping message */
 	__u32			png_flags;      /* reserved flags */
+	__u32			png_posted;	/* # idle MDs per test unit */
 } WIRE_ATTR test_ping_req_t;
 
 typedef struct {
@@ -2995,10 +2995,46 @@ lst_get_bulk_param(int argc, char **argv, lst_test_bulk_param_t *bulk)
         return rc;
 }
 
+int
+lst_get_ping_param(int argc, char **argv, lst_test_ping_param_t *ping)
+{
+	char	*tok = NULL;
+	char	*end = NULL;
+	int	 i;
+
+	for (i = 0; i < argc; i++) {
+		if (strcasestr(argv[i], "posted=") == argv[i] ||
+		    strcasestr(argv[i], "p=") == argv[i]) {
+			tok = strchr(argv[i], '=') + 1;
+
+			ping->png_posted = strtol(tok, &end, 0);
+			if (ping->png_posted < 0 || end == tok) {
+				fprintf(stderr, "Invalid posted MDs %s\n", tok);
+				return -1;
+			}
+
+			if (*end == 'k' || *end == 'K')
+				ping->png_posted *= 1024;
+
+			if (ping->png_posted > LST_PING_POSTED_MAX) {
+				fprintf(stderr, "Posted MDs exceed limitation:"
+					" %d\n", LST_PING_POSTED_MAX);
+				return -1;
+			}
+		} else {
+			fprintf(stderr, "Unknow parameter: %s\n", argv[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int
 lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 {
         lst_test_bulk_param_t *bulk = NULL;
+	lst_test_ping_param_t *ping = NULL;
         int                    type;
 
         type = lst_test_name2type(test);
@@ -3009,7 +3045,23 @@ lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 
         switch (type) {
         case LST_TEST_PING:
-                break;
+		ping = malloc(sizeof(*ping));
+		if (ping == NULL) {
+			fprintf(stderr, "Out of memory\n");
+			return -1;
+		}
+
+		memset(ping, 0, sizeof(*ping));
+
+		if (lst_get_ping_param(argc, argv, ping) != 0) {
+			free(ping);
+			return -1;
+		}
+
+		*param = ping;
+		*plen  = sizeof(*ping);
+
+		break;
 
         case LST_TEST_BULK:
                 bulk = malloc(sizeof(*bulk));
@@ -24,7 +24,9 @@
 #include <lnet/lnetctl.h>
 #include <lnet/socklnd.h>
 #include <lnet/lnet.h>
+#include <ctype.h>
 #include <getopt.h>
+#include <limits.h>
 #include <netdb.h>
 
 unsigned int libcfs_debug;
@@ -1285,12 +1287,74 @@ fault_attr_ptl_parse(char *ptl_str, __u64 *mask_p)
 	return 0;
 }
 
+/* parse a time in seconds, or in ms/us with those suffixes */
+static int
+fault_attr_time_parse(char *str, __u64 *usec_p)
+{
+	char		   *end;
+	unsigned long long  val = strtoull(str, &end, 0);
+
+	if (end == str)
+		goto failed;
+
+	if (*end == '\0' || !strcmp(end, "s"))
+		val *= 1000000;
+	else if (!strcmp(end, "ms"))
+		val *= 1000;
+	else if (strcmp(end, "us"))
+		goto failed;
+
+	*usec_p = val;
+	return 0;
+failed:
+	fprintf(stderr, "invalid time: %s\n", str);
+	return -1;
+}
+
+/* parse a size in bytes, or in KiB/MiB/GiB with K/M/G suffixes, to KiB */
+static int
+fault_attr_size_parse(char *str, __u32 *kib_p)
+{
+	char		   *end;
+	unsigned long long  val = strtoull(str, &end, 0);
+
+	if (end == str)
+		goto failed;
+
+	switch (toupper(*end)) {
+	case '\0':
+		val = (val + 1023) >> 10;
+		break;
+	case 'G':
+		val <<= 10;
+		/* fallthrough */
+	case 'M':
+		val <<= 10;
+		/* fallthrough */
+	case 'K':
+		break;
+	default:
+		goto failed;
+	}
+	if (*end != '\0' && end[1] != '\0' && strcasecmp(end + 1, "B"))
+		goto failed;
+	if (val > UINT_MAX)
+		goto failed;
+
+	*kib_p = val;
+	return 0;
+failed:
+	fprintf(stderr, "invalid size: %s\n", str);
+	return -1;
+}
+
 static int
 fault_simul_rule_add(__u32 opc, char *name, int argc, char **argv)
 {
 	struct libcfs_ioctl_data  data = {{0}};
 	struct lnet_fault_attr    attr;
 	char			 *optstr;
+	__u64			  usec;
 	int			  rc;
 
 	static struct option opts[] = {
@@ -1299,6 +1363,11 @@ fault_simul_rule_add(__u32 opc, char *name, int argc, char **argv)
 		{"rate",	required_argument,	0,	'r'},
 		{"interval",	required_argument,	0,	'i'},
 		{"latency",	required_argument,	0,	'l'},
+		{"jitter",	required_argument,	0,	'j'},
+		{"distribution", required_argument,	0,	'D'},
+		{"bandwidth",	required_argument,	0,	'b'},
+		{"burst",	required_argument,	0,	'B'},
+		{"reorder",	no_argument,		0,	'o'},
 		{"portal",	required_argument,	0,	'p'},
 		{"message",	required_argument,	0,	'm'},
 		{0, 0, 0, 0}
@@ -1310,7 +1379,8 @@ fault_simul_rule_add(__u32 opc, char *name, int argc, char **argv)
 		return -1;
 	}
 
-	optstr = opc == LNET_CTL_DROP_ADD ? "s:d:r:i:p:m:" : "s:d:r:l:p:m:";
+	optstr = opc == LNET_CTL_DROP_ADD ? "s:d:r:i:p:m:" :
+					    "s:d:r:i:l:j:D:b:B:op:m:";
 	memset(&attr, 0, sizeof(attr));
 	while (1) {
 		char c = getopt_long(argc, argv, optstr, opts, NULL);
@@ -1347,8 +1417,54 @@ fault_simul_rule_add(__u32 opc, char *name, int argc, char **argv)
 								   NULL, 0);
 			break;
 
-		case 'l': /* seconds to wait before activating rule */
-			attr.u.delay.la_latency = strtoul(optarg, NULL, 0);
+		case 'l': /* time to delay messages for */
+			rc = fault_attr_time_parse(optarg, &usec);
+			if (rc != 0)
+				goto getopt_failed;
+			attr.u.delay.la_latency = usec / 1000000;
+			attr.u.delay.la_latency_us = usec % 1000000;
+			break;
+
+		case 'j': /* variation of the latency */
+			rc = fault_attr_time_parse(optarg, &usec);
+			if (rc != 0)
+				goto getopt_failed;
+			if (usec >= (1U << 30)) {
+				fprintf(stderr, "jitter is too large: %s\n",
+					optarg);
+				goto getopt_failed;
+			}
+			attr.u.delay.la_jitter_us = usec;
+			break;
+
+		case 'D': /* distribution of the jitter */
+			if (!strcasecmp(optarg, "uniform")) {
+				attr.u.delay.la_dist = LNET_DELAY_DIST_UNIFORM;
+			} else if (!strcasecmp(optarg, "normal")) {
+				attr.u.delay.la_dist = LNET_DELAY_DIST_NORMAL;
+			} else {
+				fprintf(stderr, "unknown distribution %s\n",
+					optarg);
+				goto getopt_failed;
+			}
+			break;
+
+		case 'b': /* bandwidth per second */
+			rc = fault_attr_size_parse(optarg,
+						   &attr.u.delay.la_bandwidth);
+			if (rc != 0)
+				goto getopt_failed;
+			break;
+
+		case 'B': /* size received at once above the bandwidth */
+			rc = fault_attr_size_parse(optarg,
+						   &attr.u.delay.la_burst);
+			if (rc != 0)
+				goto getopt_failed;
+			break;
+
+		case 'o': /* jitter can reorder messages */
+			attr.u.delay.la_flags |= LNET_DELAY_F_REORDER;
 			break;
 
 		case 'p': /* portal to filter */
@@ -1381,16 +1497,29 @@ fault_simul_rule_add(__u32 opc, char *name, int argc, char **argv)
 			return -1;
 		}
 	} else if (opc == LNET_CTL_DELAY_ADD) {
-		if (!((attr.u.delay.la_rate == 0) ^
-		      (attr.u.delay.la_interval == 0))) {
+		/* NB: delay all messages by default */
+		if (attr.u.delay.la_rate == 0 && attr.u.delay.la_interval == 0)
+			attr.u.delay.la_rate = 1;
+
+		if (attr.u.delay.la_rate != 0 &&
+		    attr.u.delay.la_interval != 0) {
 			fprintf(stderr,
 				"please provide either delay rate or interval "
 				"but not both at the same time.\n");
 			return -1;
 		}
 
-		if (attr.u.delay.la_latency == 0) {
-			fprintf(stderr, "latency cannot be zero\n");
+		if (attr.u.delay.la_latency == 0 &&
+		    attr.u.delay.la_latency_us == 0 &&
+		    attr.u.delay.la_bandwidth == 0) {
+			fprintf(stderr,
+				"please provide latency or bandwidth\n");
+			return -1;
+		}
+
+		if (attr.u.delay.la_bandwidth == 0 &&
+		    attr.u.delay.la_burst != 0) {
+			fprintf(stderr, "burst needs a bandwidth\n");
 			return -1;
 		}
 	}
@@ -1605,15 +1734,27 @@ fault_simul_rule_list(__u32 opc, char *name, int argc, char **argv)
 			       stat.fs_get, stat.fs_reply);
 
 		} else if (opc == LNET_CTL_DELAY_LIST) {
-			printf("%s->%s (1/%d | %d, latency %d) ptl "LPX64
-			       ", msg %x, "LPU64"/"LPU64", PUT "LPU64
-			       ", ACK "LPU64", GET "LPU64", REP "LPU64"\n",
+			printf("%s->%s (1/%d | %d, latency %u.%06us, jitter "
+			       "%uus %s, bandwidth %uKiB/s burst %uKiB%s) ptl "
+			       LPX64", msg %x, "LPU64"/"LPU64", bytes "LPU64
+			       ", reordered "LPU64", PUT "LPU64", ACK "LPU64
+			       ", GET "LPU64", REP "LPU64"\n",
 			       libcfs_nid2str(attr.fa_src),
 			       libcfs_nid2str(attr.fa_dst),
 			       attr.u.delay.la_rate, attr.u.delay.la_interval,
 			       attr.u.delay.la_latency,
+			       attr.u.delay.la_latency_us,
+			       attr.u.delay.la_jitter_us,
+			       attr.u.delay.la_dist == LNET_DELAY_DIST_NORMAL ?
+			       "normal" : "uniform",
+			       attr.u.delay.la_bandwidth,
+			       attr.u.delay.la_burst,
+			       attr.u.delay.la_flags & LNET_DELAY_F_REORDER ?
+			       ", reorder" : "",
 			       attr.fa_ptl_mask, attr.fa_msg_mask,
 			       stat.u.delay.ls_delayed, stat.fs_count,
+			       stat.u.delay.ls_bytes,
+			       stat.u.delay.ls_reordered,
 			       stat.fs_put, stat.fs_ack, stat.fs_get,
 			       stat.fs_reply);
 		}
@@ -681,6 +681,23 @@ inode_ops_truncate, [
 ])
 ]) # LC_IOP_TRUNCATE
 
+#
+# LC_FILE_FALLOCATE
+#
+# 2.6.38 moved fallocate from inode_operations to file_operations
+#
+AC_DEFUN([LC_FILE_FALLOCATE], [
+LB_CHECK_COMPILE([if 'file_operations.fallocate' exist],
+file_ops_fallocate, [
+	#include <linux/fs.h>
+],[
+	((struct file_operations *)0)->fallocate(NULL, 0, 0, 0);
+],[
+	AC_DEFINE(HAVE_FILE_FALLOCATE, 1,
+		[file_operations.fallocate exist])
+])
+]) # LC_FILE_FALLOCATE
+
 #
 # LC_REQUEST_QUEUE_UNPLUG_FN
 #
@@ -1585,6 +1602,7 @@ AC_DEFUN([LC_PROG_LINUX], [
 	LC_INODE_I_RCU
 	LC_D_COMPARE_7ARGS
 	LC_D_DELETE_CONST
+	LC_FILE_FALLOCATE
 
 	# 2.6.39
 	LC_REQUEST_QUEUE_UNPLUG_FN
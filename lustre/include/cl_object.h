@@ -1389,7 +1389,7 @@ enum cl_io_type {
         CIT_READ,
         /** write system call */
         CIT_WRITE,
-        /** truncate, utime system calls */
+        /** truncate, utime, fallocate system calls */
         CIT_SETATTR,
         /**
          * page fault handling
@@ -1791,6 +1791,12 @@ struct cl_io {
 			int		 sa_stripe_index;
 			struct lu_fid    *sa_parent_fid;
 			struct obd_capa  *sa_capa;
+			/** fallocate(2) mode, FALLOC_FL_* flags */
+			int		 sa_falloc_mode;
+			/** fallocate(2) range [offset, end), end is 0
+			 * unless this is a fallocate io */
+			loff_t		 sa_falloc_offset;
+			loff_t		 sa_falloc_end;
 		} ci_setattr;
                 struct cl_fault_io {
                         /** page index within file. */
@@ -2477,6 +2483,15 @@ static inline int cl_io_is_trunc(const struct cl_io *io)
                 (io->u.ci_setattr.sa_valid & ATTR_SIZE);
 }
 
+/**
+ * True, iff \a io is a fallocate(2).
+ */
+static inline int cl_io_is_fallocate(const struct cl_io *io)
+{
+	return io->ci_type == CIT_SETATTR &&
+		io->u.ci_setattr.sa_falloc_end != 0;
+}
+
 struct cl_io *cl_io_top(struct cl_io *io);
 
 void cl_io_print(const struct lu_env *env, void *cookie,
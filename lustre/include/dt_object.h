@@ -1312,6 +1312,66 @@ struct dt_body_operations {
 			   __u64 start,
 			   __u64 end,
 			   struct thandle *th);
+
+	/**
+	 * Declare intention to preallocate space for an object.
+	 *
+	 * Notify the underlying filesystem that space may be allocated in
+	 * this transaction, so that it can reserve the journal credits and
+	 * quota needed to map the region [start, end). This method should be
+	 * called between creating the transaction and starting it. The whole
+	 * region is allocated in this transaction, so callers split large
+	 * regions over several transactions.
+	 *
+	 * \param[in] env	execution environment for this thread
+	 * \param[in] dt	object
+	 * \param[in] start	the start of the region to allocate
+	 * \param[in] end	the end of the region to allocate
+	 * \param[in] mode	fallocate mode (FALLOC_FL_* flags)
+	 * \param[in] th	transaction handle
+	 *
+	 * \retval 0		on success
+	 * \retval negative	negated errno on error
+	 */
+	int   (*dbo_declare_fallocate)(const struct lu_env *env,
+				       struct dt_object *dt,
+				       __u64 start,
+				       __u64 end,
+				       int mode,
+				       struct thandle *th);
+
+	/**
+	 * Preallocate space for, or punch a hole in, the specified region of
+	 * an object.
+	 *
+	 * Allocate blocks for the region [start, end) without writing data,
+	 * so that later writes into the region do not need to allocate. The
+	 * allocated blocks read back as zeroes. Unless FALLOC_FL_KEEP_SIZE is
+	 * set in \a mode, the object size is extended to \a end if needed.
+	 * With FALLOC_FL_PUNCH_HOLE the blocks of the region are freed
+	 * instead and the size is left alone; the layer may free them only
+	 * once the transaction is stopped.
+	 * If the layer implementing this method is responsible for quota,
+	 * then the method should maintain space accounting for the given
+	 * credentials.
+	 *
+	 * \param[in] env	execution environment for this thread
+	 * \param[in] dt	object
+	 * \param[in] start	the start of the region to allocate
+	 * \param[in] end	the end of the region to allocate
+	 * \param[in] mode	fallocate mode (FALLOC_FL_* flags)
+	 * \param[in] th	transaction handle
+	 *
+	 * \retval 0		on success
+	 * \retval -EOPNOTSUPP	if preallocation is not supported
+	 * \retval negative	negated errno on error
+	 */
+	int   (*dbo_fallocate)(const struct lu_env *env,
+			       struct dt_object *dt,
+			       __u64 start,
+			       __u64 end,
+			       int mode,
+			       struct thandle *th);
 };
 
 /**
@@ -2370,6 +2430,31 @@ static inline int dt_punch(const struct lu_env *env, struct dt_object *dt,
 	return dt->do_body_ops->dbo_punch(env, dt, start, end, th);
 }
 
+static inline int dt_declare_fallocate(const struct lu_env *env,
+				       struct dt_object *dt, __u64 start,
+				       __u64 end, int mode, struct thandle *th)
+{
+	LASSERT(dt);
+	if (dt->do_body_ops == NULL)
+		return -EPROTO;
+	if (dt->do_body_ops->dbo_declare_fallocate == NULL)
+		return -EOPNOTSUPP;
+	return dt->do_body_ops->dbo_declare_fallocate(env, dt, start, end,
+						      mode, th);
+}
+
+static inline int dt_fallocate(const struct lu_env *env, struct dt_object *dt,
+			       __u64 start, __u64 end, int mode,
+			       struct thandle *th)
+{
+	LASSERT(dt);
+	if (dt->do_body_ops == NULL)
+		return -EPROTO;
+	if (dt->do_body_ops->dbo_fallocate == NULL)
+		return -EOPNOTSUPP;
+	return dt->do_body_ops->dbo_fallocate(env, dt, start, end, mode, th);
+}
+
 static inline int dt_fiemap_get(const struct lu_env *env, struct dt_object *d,
                                 struct ll_user_fiemap *fm)
 {
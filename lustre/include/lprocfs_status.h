@@ -333,6 +333,8 @@ enum {
         PTLRPC_REQACTIVE_CNTR,
         PTLRPC_TIMEOUT,
         PTLRPC_REQBUF_AVAIL_CNTR,
+	PTLRPC_THREAD_START_CNTR,
+	PTLRPC_THREAD_EXIT_CNTR,
         PTLRPC_LAST_CNTR
 };
 
@@ -495,6 +495,11 @@ enum lu_object_header_flags {
 	 * Mark this object has already been taken out of cache.
 	 */
 	LU_OBJECT_UNHASHED = 1,
+	/**
+	 * Object was released again while still on the LRU list, so it is
+	 * given another pass by lu_site_purge() instead of being freed.
+	 */
+	LU_OBJECT_REFERENCED = 2,
 };
 
 enum lu_object_header_attr {
@@ -529,7 +534,9 @@ struct lu_object_header {
 	 */
 	unsigned long		loh_flags;
 	/**
-	 * Object reference count. Protected by lu_site::ls_guard.
+	 * Object reference count. Taken under the bucket lock of
+	 * lu_site::ls_obj_hash in shared mode, dropping the last reference
+	 * needs the bucket lock in exclusive mode.
 	 */
 	atomic_t		loh_ref;
 	/**
@@ -538,11 +545,13 @@ struct lu_object_header {
 	 */
 	__u32			loh_attr;
 	/**
-	 * Linkage into per-site hash table. Protected by lu_site::ls_guard.
+	 * Linkage into per-site hash table. Protected by the bucket lock of
+	 * lu_site::ls_obj_hash.
 	 */
 	struct hlist_node	loh_hash;
 	/**
-	 * Linkage into per-site LRU list. Protected by lu_site::ls_guard.
+	 * Linkage into per-bucket LRU list. Protected by the bucket lock of
+	 * lu_site::ls_obj_hash.
 	 */
 	struct list_head	loh_lru;
 	/**
@@ -564,12 +573,14 @@ struct lu_site_bkt_data {
 	 */
 	long			lsb_lru_len;
 	/**
-	 * LRU list, updated on each access to object. Protected by
-	 * bucket lock of lu_site::ls_obj_hash.
+	 * LRU list, protected by the bucket lock of lu_site::ls_obj_hash
+	 * held in exclusive mode.
 	 *
-	 * "Cold" end of LRU is lu_site::ls_lru.next. Accessed object are
-	 * moved to the lu_site::ls_lru.prev (this is due to the non-existence
-	 * of list_for_each_entry_safe_reverse()).
+	 * An object is added to the "hot" end (lsb_lru.prev) when its last
+	 * reference is released. Lookups do not remove it, so that they can
+	 * run with the bucket lock shared: busy objects and objects released
+	 * again (LU_OBJECT_REFERENCED) are aged in batches by lu_site_purge()
+	 * as it scans from the "cold" end (lsb_lru.next).
 	 */
 	struct list_head	lsb_lru;
 	/**
@@ -369,6 +369,16 @@ extern void lustre_som_swab(struct som_attrs *attrs);
 
 #define SOM_INCOMPAT_SUPP 0x0
 
+/**
+ * Flags for som_attrs::som_compat, telling which of the lazy size-on-MDT
+ * attributes hold a value.  They are updated when a writer closes the file
+ * and on truncate, so they may lag behind the OST objects.
+ */
+enum som_compat {
+	SOMC_LAZY_SIZE		= 0x00000001,
+	SOMC_LAZY_BLOCKS	= 0x00000002,
+};
+
 /* copytool uses a 32b bitmask field to encode archive-Ids during register
  * with MDT thru kuc.
  * archive num = 0 => all
@@ -1358,6 +1368,11 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 #define OBD_CONNECT_MULTIMODRPCS 0x200000000000000ULL /* support multiple modify
 							 RPCs in parallel */
 #define OBD_CONNECT_DIR_STRIPE	 0x400000000000000ULL /* striped DNE dir */
+#define OBD_CONNECT_FALLOCATE	 0x800000000000000ULL /* OST_FALLOCATE RPC */
+#define OBD_CONNECT_PEER_PING	0x1000000000000000ULL /* any request from the
+							 client node keeps
+							 all its exports
+							 alive */
 
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
@@ -1404,7 +1419,7 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_FLOCK_DEAD | \
 				OBD_CONNECT_DISP_STRIPE | OBD_CONNECT_LFSCK | \
 				OBD_CONNECT_OPEN_BY_FID | \
-				OBD_CONNECT_DIR_STRIPE)
+				OBD_CONNECT_DIR_STRIPE | OBD_CONNECT_PEER_PING)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
                                 OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -1422,7 +1437,8 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_JOBSTATS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_LVB_TYPE|\
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
-				OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK | \
+				OBD_CONNECT_FALLOCATE | OBD_CONNECT_PEER_PING)
 #define ECHO_CONNECT_SUPPORTED (0)
 #define MGS_CONNECT_SUPPORTED  (OBD_CONNECT_VERSION | OBD_CONNECT_AT | \
 				OBD_CONNECT_FULL20 | OBD_CONNECT_IMP_RECOV | \
@@ -1523,6 +1539,7 @@ typedef enum {
         OST_QUOTACHECK = 18,
         OST_QUOTACTL   = 19,
 	OST_QUOTA_ADJUST_QUNIT = 20, /* not used since 2.4 */
+	OST_FALLOCATE  = 21,
         OST_LAST_OPC
 } ost_cmd_t;
 #define OST_FIRST_OPC  OST_REPLY
@@ -1827,6 +1844,8 @@ lov_mds_md_max_stripe_count(size_t buf_size, __u32 lmm_magic)
 #define OBD_MD_FLRELEASED    (0x0020000000000000ULL) /* file released */
 
 #define OBD_MD_DEFAULT_MEA   (0x0040000000000000ULL) /* default MEA */
+#define OBD_MD_FLLAZYSIZE    (0x0080000000000000ULL) /* lazy size on MDT */
+#define OBD_MD_FLLAZYBLOCKS  (0x0100000000000000ULL) /* lazy blocks on MDT */
 
 #define OBD_MD_FLGETATTR (OBD_MD_FLID    | OBD_MD_FLATIME | OBD_MD_FLMTIME | \
                           OBD_MD_FLCTIME | OBD_MD_FLSIZE  | OBD_MD_FLBLKSZ | \
@@ -2518,6 +2537,7 @@ enum mds_op_bias {
 	MDS_OWNEROVERRIDE	= 1 << 11,
 	MDS_HSM_RELEASE		= 1 << 12,
 	MDS_RENAME_MIGRATE	= 1 << 13,
+	MDS_CLOSE_SIZE_KNOWN	= 1 << 14, /* close: the size is exact */
 };
 
 /* instance of mdt_reint_rec */
@@ -3541,7 +3561,8 @@ struct obdo {
 						 * each stripe.
 						 * brw: grant space consumed on
 						 * the client for the write */
-	__u64			o_padding_4;
+	__u32			o_falloc_mode;	/* fallocate: FALLOC_FL_* */
+	__u32			o_padding_3;
 	__u64			o_padding_5;
 	__u64			o_padding_6;
 };
@@ -281,6 +281,7 @@ struct ost_id {
 #define LL_IOC_MIGRATE			_IOR('f', 247, int)
 #define LL_IOC_FID2MDTIDX		_IOWR('f', 248, struct lu_fid)
 #define LL_IOC_GETPARENT		_IOWR('f', 249, struct getparent)
+#define LL_IOC_PCC_STATE		_IOR('f', 250, struct lu_pcc_state)
 
 /* Lease types for use as arg and return of LL_IOC_{GET,SET}_LEASE ioctl. */
 enum ll_lease_type {
@@ -298,6 +299,14 @@ enum ll_lease_type {
 #define IOC_MDC_GETFILESTRIPE   _IOWR(IOC_MDC_TYPE, 21, struct lov_user_md *)
 #define IOC_MDC_GETFILEINFO     _IOWR(IOC_MDC_TYPE, 22, struct lov_user_mds_data *)
 #define LL_IOC_MDC_GETINFO      _IOWR(IOC_MDC_TYPE, 23, struct lov_user_mds_data *)
+/* Like IOC_MDC_GETFILEINFO and LL_IOC_MDC_GETINFO, but lmd_st may hold the
+ * lazy size-on-MDT of a regular file instead of a glimpsed one.  The ioctl
+ * returns a mask of LMD_FL_* telling which fields of lmd_st are lazy. */
+#define IOC_MDC_GETFILEINFO_V2  _IOWR(IOC_MDC_TYPE, 24, struct lov_user_mds_data *)
+#define LL_IOC_MDC_GETINFO_V2   _IOWR(IOC_MDC_TYPE, 25, struct lov_user_mds_data *)
+
+#define LMD_FL_LAZY_SIZE	0x0001	/* st_size is the lazy size */
+#define LMD_FL_LAZY_BLOCKS	0x0002	/* st_blocks are the lazy blocks */
 
 #define MAX_OBD_NAME 128 /* If this changes, a NEW ioctl must be added */
 
@@ -587,6 +596,8 @@ struct if_quotacheck {
 };
 
 #define IDENTITY_DOWNCALL_MAGIC 0x6d6dd629
+/* same layout, installed in the cache even if no upcall asked for it */
+#define IDENTITY_PRELOAD_MAGIC  0x6d6dd62a
 
 /* permission */
 #define N_PERMS_MAX      64
@@ -846,6 +857,11 @@ enum changelog_send_flag {
 	CHANGELOG_FLAG_BLOCK    = 0x02,
 	/* Pack jobid into the changelog records if available. */
 	CHANGELOG_FLAG_JOBID    = 0x04,
+	/* Pack several records per KUC message (CL_RECORDS), already
+	 * remapped to the format the reader asked for. */
+	CHANGELOG_FLAG_BATCH    = 0x08,
+	/* Only send the record types set in ioc_changelog::icc_mask. */
+	CHANGELOG_FLAG_MASK     = 0x10,
 };
 
 #define CR_MAXSIZE cfs_size_round(2 * NAME_MAX + 2 + \
@@ -1008,16 +1024,33 @@ static inline void changelog_remap_rec(struct changelog_rec *rec,
 	rec->cr_flags = (rec->cr_flags & CLF_FLAGMASK) | crf_wanted;
 }
 
+#ifndef HAVE_CFS_SIZE_ROUND
+static inline int cfs_size_round (int val)
+{
+        return (val + 7) & (~0x7);
+}
+#define HAVE_CFS_SIZE_ROUND
+#endif
+
+/* Space taken by a record in a CL_RECORDS message. Records in a batch
+ * start on 8-byte boundaries and their name is followed by a NUL byte. */
+static inline size_t changelog_rec_batch_size(const struct changelog_rec *rec)
+{
+	return cfs_size_round(changelog_rec_size(rec) + rec->cr_namelen + 1);
+}
+
 struct ioc_changelog {
-        __u64 icc_recno;
-        __u32 icc_mdtindex;
-        __u32 icc_id;
-        __u32 icc_flags;
+	__u64 icc_recno;
+	__u32 icc_mdtindex;
+	__u32 icc_id;
+	__u32 icc_flags;
+	__u32 icc_mask; /* 1 << CL_* types to send, CHANGELOG_FLAG_MASK */
 };
 
 enum changelog_message_type {
-        CL_RECORD = 10, /* message is a changelog_rec */
-        CL_EOF    = 11, /* at end of current changelog */
+	CL_RECORD  = 10, /* message is a changelog_rec */
+	CL_EOF     = 11, /* at end of current changelog */
+	CL_RECORDS = 12, /* message is a batch of changelog_recs */
 };
 
 /********* Misc **********/
@@ -1291,14 +1324,6 @@ struct hsm_action_list {
 	   boundaries. See hai_zero */
 } __attribute__((packed));
 
-#ifndef HAVE_CFS_SIZE_ROUND
-static inline int cfs_size_round (int val)
-{
-        return (val + 7) & (~0x7);
-}
-#define HAVE_CFS_SIZE_ROUND
-#endif
-
 /* Return pointer to first hai in action list */
 static inline struct hsm_action_item *hai_first(struct hsm_action_list *hal)
 {
@@ -1365,6 +1390,88 @@ struct hsm_copy {
 	struct hsm_action_item	hc_hai;
 };
 
+/* Persistent client cache
+ * A released file whose HSM archive is on the local storage of a client
+ * is read and written there by that client, see llite/pcc.c */
+enum lu_pcc_state_flags {
+	PCC_STATE_ATTACHED	= 0x0001, /* IO is served from the local copy */
+};
+
+struct lu_pcc_state {
+	__u32	pccs_flags;		/* enum lu_pcc_state_flags */
+	__u32	pccs_archive_id;	/* archive holding the local copy */
+	char	pccs_path[PATH_MAX];	/* local copy, if attached */
+};
+
+/* RPC lifecycle tracing
+ * With the ptlrpc rpc_stage_trace module parameter set, the time at which
+ * each RPC reaches the stages below is recorded.  Completed RPCs can be read
+ * as struct rpc_trace_rec from /proc/fs/lustre/rpc_trace on clients and
+ * servers, and merged with ll_rpc_trace(8). */
+enum rpc_stage {
+	RPC_STAGE_QUEUED	= 0,	/* client: queued for sending */
+	RPC_STAGE_SENT		= 1,	/* client: request handed to LNet */
+	RPC_STAGE_REPLIED	= 2,	/* client: reply received */
+	RPC_STAGE_ARRIVED	= 3,	/* server: request received */
+	RPC_STAGE_DEQUEUED	= 4,	/* server: taken by a service thread */
+	RPC_STAGE_REPLY_SENT	= 5,	/* server: reply handed to LNet */
+	RPC_STAGE_HANDLED	= 6,	/* server: request handler returned */
+	RPC_STAGE_BULK_START	= 7,	/* bulk transfer started */
+	RPC_STAGE_BULK_END	= 8,	/* bulk transfer completed */
+	RPC_STAGE_NR		= 9,
+};
+
+#define RPC_TRACE_MAGIC		0x52505431	/* "RPT1" */
+
+enum rpc_trace_flags {
+	RPC_TRACE_SERVER	= 0x0001,	/* recorded by the server */
+};
+
+struct rpc_trace_rec {
+	__u32	rtr_magic;		/* RPC_TRACE_MAGIC */
+	__u32	rtr_opc;
+	__u64	rtr_xid;
+	__u64	rtr_self_nid;		/* node that recorded this */
+	__u64	rtr_peer_nid;
+	__u32	rtr_peer_pid;
+	__u32	rtr_flags;		/* enum rpc_trace_flags */
+	__s32	rtr_status;
+	__u32	rtr_padding;
+	__u64	rtr_stage[RPC_STAGE_NR]; /* usec since the Epoch, 0 if the
+					  * stage was not reached */
+};
+
+/*
+ * Requests handled by the ptlrpc services with "req_capture" set are read
+ * by ll_rpc_replay(8) from /proc/fs/lustre/rpc_capture, each record being
+ * a struct rpc_capture_rec followed by the first rcr_msglen bytes of the
+ * request message as received, before its body buffers are swabbed.
+ */
+#define RPC_CAPTURE_MAGIC	0x52504331	/* "RPC1" */
+#define RPC_CAPTURE_SVC_LEN	16
+
+enum rpc_capture_flags {
+	RPC_CAPTURE_SWABBED	= 0x0001,	/* sent by a peer of the other
+						 * byte order */
+};
+
+struct rpc_capture_rec {
+	__u32	rcr_magic;		/* RPC_CAPTURE_MAGIC */
+	__u32	rcr_reclen;		/* header and message, 8-byte aligned */
+	__u64	rcr_arrival;		/* usec since the Epoch */
+	__u64	rcr_xid;
+	__u64	rcr_self_nid;
+	__u64	rcr_peer_nid;
+	__u32	rcr_peer_pid;
+	__u32	rcr_opc;
+	__u32	rcr_flags;		/* enum rpc_capture_flags */
+	__u32	rcr_reqlen;		/* size of the request message */
+	__u32	rcr_msglen;		/* bytes of it captured */
+	__u32	rcr_padding;
+	char	rcr_service[RPC_CAPTURE_SVC_LEN];
+	char	rcr_msg[0];
+};
+
 /* JSON objects */
 enum llapi_json_types {
 	LLAPI_JSON_INTEGER = 1,
@@ -192,7 +192,8 @@ struct find_param {
 				 fp_check_layout:1,
 				 fp_exclude_layout:1,
 				 fp_get_default_lmv:1, /* Get default LMV */
-				 fp_migrate:1;
+				 fp_migrate:1,
+				 fp_lazy:1;	/* trust lazy size-on-MDT */
 
 	int			 fp_verbose;
 	int			 fp_quiet;
@@ -230,12 +231,15 @@ struct find_param {
 	unsigned long		 fp_got_uuids:1,
 				 fp_obds_printed:1;
 	unsigned int		 fp_depth;
+	int			 fp_lmd_flags;	/* LMD_FL_* of fp_lmd */
 };
 
 extern int llapi_ostlist(char *path, struct find_param *param);
 extern int llapi_uuid_match(char *real_uuid, char *search_uuid);
 extern int llapi_getstripe(char *path, struct find_param *param);
 extern int llapi_find(char *path, struct find_param *param);
+extern int llapi_find_parallel(char *path, struct find_param *param,
+			       int threads);
 
 extern int llapi_file_fget_mdtidx(int fd, int *mdtidx);
 extern int llapi_dir_set_default_lmv_stripe(const char *name, int stripe_offset,
@@ -338,8 +342,15 @@ extern int llapi_swap_layouts(const char *path1, const char *path2,
 
 extern int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 				 const char *mdtname, long long startrec);
+extern int llapi_changelog_start_mask(void **priv,
+				      enum changelog_send_flag flags,
+				      const char *mdtname, long long startrec,
+				      __u32 mask);
 extern int llapi_changelog_fini(void **priv);
 extern int llapi_changelog_recv(void *priv, struct changelog_rec **rech);
+/* Records are only valid until the next call, and must not be freed. */
+extern int llapi_changelog_recv_batch(void *priv, struct changelog_rec **recs,
+				      int count);
 extern int llapi_changelog_free(struct changelog_rec **rech);
 /* Allow records up to endrec to be destroyed; requires registered id. */
 extern int llapi_changelog_clear(const char *mdtname, const char *idstr,
@@ -385,6 +396,11 @@ extern int llapi_hsm_request(const char *path,
 extern int llapi_hsm_current_action(const char *path,
 				    struct hsm_current_action *hca);
 
+/* Persistent client cache, on top of HSM */
+extern int llapi_pcc_attach(const char *path, __u32 archive_id);
+extern int llapi_pcc_detach(const char *path);
+extern int llapi_pcc_state_get(const char *path, struct lu_pcc_state *state);
+
 /* JSON handling */
 extern int llapi_json_init_list(struct llapi_json_item_list **item_list);
 extern int llapi_json_destroy_list(struct llapi_json_item_list **item_list);
@@ -383,4 +383,12 @@ static inline void truncate_inode_pages_final(struct address_space *map)
 #define SIZE_MAX	(~(size_t)0)
 #endif
 
+#include <linux/falloc.h>
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE	0x01 /* default is extend size */
+#endif
+#ifndef FALLOC_FL_PUNCH_HOLE
+#define FALLOC_FL_PUNCH_HOLE	0x02 /* de-allocates range */
+#endif
+
 #endif /* _LUSTRE_COMPAT_H */
@@ -305,6 +305,24 @@ typedef enum {
 	LDLM_NAMESPACE_MODEST = 1 << 1
 } ldlm_appetite_t;
 
+/**
+ * Policy choosing which unused locks a client namespace cancels first.
+ */
+enum ldlm_lru_policy {
+	/** Cancel the least recently used locks first. */
+	LDLM_LRU_POLICY_LRU	= 0,
+	/**
+	 * Scan-resistant 2Q-like policy: locks that were used again while
+	 * cached, or whose resource had its locks cancelled from the LRU
+	 * shortly before, get a second pass through the LRU before being
+	 * cancelled, so locks used only once are cancelled first.
+	 */
+	LDLM_LRU_POLICY_2Q	= 1,
+};
+
+/** Number of recently cancelled resources remembered by a client namespace */
+#define LDLM_LRU_GHOST_SIZE	512
+
 /**
  * Default values for the "max_nolock_size", "contention_time" and
  * "contended_locks" namespace tunables.
@@ -424,6 +442,19 @@ struct ldlm_namespace {
 	unsigned int		ns_max_unused;
 	/** Maximum allowed age (last used time) for locks in the LRU */
 	unsigned int		ns_max_age;
+	/** Policy choosing the unused locks to cancel first */
+	enum ldlm_lru_policy	ns_lru_policy;
+	/**
+	 * "Ghost" entries of the LRU: keys of the resources whose locks were
+	 * recently cancelled from the LRU, direct-mapped by key so that an
+	 * entry is forgotten when another resource takes its slot.
+	 * LDLM_LRU_GHOST_SIZE entries, client only, protected by ns_lock.
+	 */
+	__u64			*ns_lru_ghost;
+	/** Number of locks cached again on a resource found in the ghosts */
+	unsigned int		ns_lru_ghost_hits;
+	/** Number of used-again locks given a second pass by 2Q policy */
+	unsigned int		ns_lru_demoted;
 	/**
 	 * Server only: number of times we evicted clients due to lack of reply
 	 * to ASTs.
@@ -654,6 +685,63 @@ enum lvb_type {
  */
 #define LDLM_GID_ANY  ((__u64)-1)
 
+/**
+ * Server-side-only part of an LDLM lock.
+ *
+ * Clients cache many more locks than they have in use, so the members
+ * that only servers need live in this separate structure, allocated only
+ * for locks of server namespaces, to keep cached client locks small.
+ */
+struct ldlm_lock_srv {
+	/** The lock this belongs to. */
+	struct ldlm_lock	*ls_lock;
+	/**
+	 * Per export hash of locks.
+	 * Protected by per-bucket exp->exp_lock_hash locks.
+	 */
+	struct hlist_node	ls_exp_hash;
+	/**
+	 * Per export hash of flock locks.
+	 * Protected by per-bucket exp->exp_flock_hash locks.
+	 */
+	struct hlist_node	ls_exp_flock_hash;
+	/**
+	 * export blocking dlm lock list, protected by
+	 * l_export->exp_bl_list_lock.
+	 * Lock order of waiting_lists_spinlock, exp_bl_list_lock and res lock
+	 * is: res lock -> exp_bl_list_lock -> wanting_lists_spinlock.
+	 */
+	struct list_head	ls_exp_list;
+	/** For ldlm_add_ast_work_item() for "revoke" AST used in COS. */
+	struct list_head	ls_rk_ast;
+	/**
+	 * Pointer to a conflicting lock that caused blocking AST to be sent
+	 * for this lock
+	 */
+	struct ldlm_lock	*ls_blocking_lock;
+	/**
+	 * Connection cookie for the client originating the operation.
+	 * Used by Commit on Share (COS) code. Currently only used for
+	 * inodebits locks on MDS.
+	 */
+	__u64			ls_client_cookie;
+	/**
+	 * Set when lock is sent a blocking AST. Time in seconds when timeout
+	 * is reached and client holding this lock could be evicted.
+	 * This timeout could be further extended by e.g. certain IO activity
+	 * under this lock.
+	 * \see ost_rw_prolong_locks
+	 */
+	cfs_time_t		ls_callback_timeout;
+	/**
+	 * Number of times blocking AST was sent for this lock.
+	 * This is for debugging. Valid values are 0 and 1, if there is an
+	 * attempt to send blocking AST more than once, an assertion would be
+	 * hit. \see ldlm_work_bl_ast_lock
+	 */
+	int			ls_bl_ast_run;
+};
+
 /**
  * LDLM lock structure
  *
@@ -697,6 +785,25 @@ struct ldlm_lock {
 	 * Protected by ns_lock in struct ldlm_namespace.
 	 */
 	struct list_head	l_lru;
+	/**
+	 * Time last used by e.g. being matched by lock match.
+	 * Jiffies. Should be converted to time if needed.
+	 * Kept next to l_lru, the LRU scan only looks at these.
+	 */
+	cfs_time_t		l_last_used;
+	/**
+	 * Set when the lock is put in the LRU again after being used, or
+	 * when its resource was in the LRU ghosts, see ldlm_lru_policy.
+	 * Protected by ns_lock.
+	 */
+	bool			l_lru_hot;
+	/**
+	 * Lock state flags. Protected by lr_lock.
+	 * Also checked by the LRU scan, so it shares a cache line with
+	 * l_lru.
+	 * \see lustre_dlm_flags.h where the bits are defined.
+	 */
+	__u64			l_flags;
 	/**
 	 * Linkage to resource's lock queues according to current lock state.
 	 * (could be granted, waiting or converting)
@@ -707,16 +814,6 @@ struct ldlm_lock {
 	 * Tree node for ldlm_extent.
 	 */
 	struct ldlm_interval	*l_tree_node;
-	/**
-	 * Per export hash of locks.
-	 * Protected by per-bucket exp->exp_lock_hash locks.
-	 */
-	struct hlist_node	l_exp_hash;
-	/**
-	 * Per export hash of flock locks.
-	 * Protected by per-bucket exp->exp_flock_hash locks.
-	 */
-	struct hlist_node	l_exp_flock_hash;
 	/**
 	 * Requested mode.
 	 * Protected by lr_lock.
@@ -771,12 +868,6 @@ struct ldlm_lock {
 	 */
 	ldlm_policy_data_t	l_policy_data;
 
-	/**
-	 * Lock state flags. Protected by lr_lock.
-	 * \see lustre_dlm_flags.h where the bits are defined.
-	 */
-	__u64			l_flags;
-
 	/**
 	 * Lock r/w usage counters.
 	 * Protected by lr_lock.
@@ -796,12 +887,6 @@ struct ldlm_lock {
 	 */
 	cfs_time_t		l_last_activity;
 
-	/**
-	 * Time last used by e.g. being matched by lock match.
-	 * Jiffies. Should be converted to time if needed.
-	 */
-	cfs_time_t		l_last_used;
-
 	/** Originally requested extent for the extent lock. */
 	struct ldlm_extent	l_req_extent;
 
@@ -825,11 +910,10 @@ struct ldlm_lock {
 	 */
 
 	/**
-	 * Connection cookie for the client originating the operation.
-	 * Used by Commit on Share (COS) code. Currently only used for
-	 * inodebits locks on MDS.
+	 * Members only needed by locks of server namespaces, allocated
+	 * with the lock there and NULL on clients.
 	 */
-	__u64			l_client_cookie;
+	struct ldlm_lock_srv	*l_srv;
 
 	/**
 	 * List item for locks waiting for cancellation from clients.
@@ -841,38 +925,13 @@ struct ldlm_lock {
 	 */
 	struct list_head	l_pending_chain;
 
-	/**
-	 * Set when lock is sent a blocking AST. Time in seconds when timeout
-	 * is reached and client holding this lock could be evicted.
-	 * This timeout could be further extended by e.g. certain IO activity
-	 * under this lock.
-	 * \see ost_rw_prolong_locks
-	 */
-	cfs_time_t		l_callback_timeout;
-
 	/** Local PID of process which created this lock. */
 	__u32			l_pid;
 
-	/**
-	 * Number of times blocking AST was sent for this lock.
-	 * This is for debugging. Valid values are 0 and 1, if there is an
-	 * attempt to send blocking AST more than once, an assertion would be
-	 * hit. \see ldlm_work_bl_ast_lock
-	 */
-	int			l_bl_ast_run;
 	/** List item ldlm_add_ast_work_item() for case of blocking ASTs. */
 	struct list_head	l_bl_ast;
 	/** List item ldlm_add_ast_work_item() for case of completion ASTs. */
 	struct list_head	l_cp_ast;
-	/** For ldlm_add_ast_work_item() for "revoke" AST used in COS. */
-	struct list_head	l_rk_ast;
-
-	/**
-	 * Pointer to a conflicting lock that caused blocking AST to be sent
-	 * for this lock
-	 */
-	struct ldlm_lock	*l_blocking_lock;
-
 	/**
 	 * Protected by lr_lock, linkages to "skip lists".
 	 * For more explanations of skip lists see ldlm/ldlm_inodebits.c
@@ -891,13 +950,6 @@ struct ldlm_lock {
 	/** referenced export object */
 	struct obd_export	*l_exp_refs_target;
 #endif
-	/**
-	 * export blocking dlm lock list, protected by
-	 * l_export->exp_bl_list_lock.
-	 * Lock order of waiting_lists_spinlock, exp_bl_list_lock and res lock
-	 * is: res lock -> exp_bl_list_lock -> wanting_lists_spinlock.
-	 */
-	struct list_head	l_exp_list;
 };
 
 /**
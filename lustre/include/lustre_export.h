@@ -205,7 +205,7 @@ struct obd_export {
         cfs_hash_t               *exp_lock_hash;
 	/**
 	 * Hash list for Posix lock deadlock detection, added with
-	 * ldlm_lock::l_exp_flock_hash.
+	 * ldlm_lock_srv::ls_exp_flock_hash.
 	 */
 	cfs_hash_t	       *exp_flock_hash;
 	struct list_head	exp_outstanding_replies;
@@ -221,6 +221,10 @@ struct obd_import {
 	atomic_t                  imp_inval_count;
 	/** Numbner of request timeouts */
 	atomic_t                  imp_timeouts;
+	/** Number of pings skipped because the server node was heard */
+	atomic_t		  imp_pings_avoided;
+	/** Pings skipped in a row, see ptlrpc_pinger_skip_ping() */
+	int			  imp_ping_skips;
 	/** Current import state */
         enum lustre_imp_state     imp_state;
 	/** Last replay state */
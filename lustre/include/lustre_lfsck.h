@@ -152,6 +152,8 @@ int lfsck_get_speed(struct seq_file *m, struct dt_device *key);
 int lfsck_set_speed(struct dt_device *key, int val);
 int lfsck_get_windows(struct seq_file *m, struct dt_device *key);
 int lfsck_set_windows(struct dt_device *key, int val);
+int lfsck_get_threads(struct seq_file *m, struct dt_device *key);
+int lfsck_set_threads(struct dt_device *key, int val);
 
 int lfsck_dump(struct seq_file *m, struct dt_device *key, enum lfsck_type type);
 
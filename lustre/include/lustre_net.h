@@ -519,6 +519,26 @@ struct ptlrpc_connection {
 	struct obd_uuid         c_remote_uuid;
 	/** reference counter for this connection */
 	atomic_t            c_refcount;
+	/**
+	 * Client side: time (in jiffies) of the last successful reply to a
+	 * request other than OBD_PING on any import using this connection.
+	 */
+	cfs_time_t		c_last_reply;
+	/**
+	 * Client side: time (in jiffies) of the last successful reply of any
+	 * kind, pings included, on any import using this connection.
+	 */
+	cfs_time_t		c_last_alive;
+	/**
+	 * Client side: pinger pass (in jiffies) that already sent a ping to
+	 * the peer on behalf of all imports using this connection.
+	 */
+	cfs_time_t		c_last_ping;
+	/**
+	 * Server side: time (in seconds) the last request was received from
+	 * the peer on any export using this connection.
+	 */
+	time_t			c_last_request_time;
 };
 
 /** Client definition for PortalRPC */
@@ -621,6 +641,7 @@ struct ptlrpc_set_cbdata {
 struct ptlrpc_bulk_desc;
 struct ptlrpc_service_part;
 struct ptlrpc_service;
+struct ptlrpc_stage_stats;
 
 /**
  * ptlrpc callback & work item stuff
@@ -2109,6 +2130,11 @@ struct ptlrpc_request {
 	time_t				 rq_sent;
 	/** when request must finish. */
 	time_t				 rq_deadline;
+	/**
+	 * when the request reached each enum rpc_stage (usec), only recorded
+	 * with rpc_stage_trace set
+	 */
+	__u64				 rq_stage[RPC_STAGE_NR];
 	/** request format description */
 	struct req_capsule		 rq_pill;
 };
@@ -2571,6 +2597,20 @@ struct ptlrpc_service {
 	int				srv_nthrs_cpt_init;
 	/** limit of threads number for each partition */
 	int				srv_nthrs_cpt_limit;
+	/** per-opcode stage latency histograms, see rpc_trace.c */
+	struct ptlrpc_stage_stats	*srv_stage_stats;
+	/** copy requests to the capture ring before handling them */
+	int				srv_req_capture;
+	/**
+	 * seconds a thread above srv_nthrs_cpt_init may stay idle before
+	 * it exits, 0 to never retire threads
+	 */
+	int				srv_thrs_idle_timeout;
+	/**
+	 * usec the oldest queued request must have waited before another
+	 * thread is started, 0 to start one as soon as all are busy
+	 */
+	int				srv_thrs_start_delay;
         /** Root of /proc dir tree for this service */
 	struct proc_dir_entry           *srv_procroot;
         /** Pointer to statistic data for this service */
@@ -2638,7 +2678,7 @@ struct ptlrpc_service_part {
 	struct ptlrpc_service		*scp_service __cfs_cacheline_aligned;
 	/* CPT id, reserved */
 	int				scp_cpt;
-	/** always increasing number */
+	/** one past the highest thread id handed out */
 	int				scp_thr_nextid;
 	/** # of starting threads */
 	int				scp_nthrs_starting;
@@ -2646,7 +2686,7 @@ struct ptlrpc_service_part {
 	int				scp_nthrs_stopping;
 	/** # running threads */
 	int				scp_nthrs_running;
-	/** service threads list */
+	/** service threads list, sorted by t_id */
 	struct list_head		scp_threads;
 
 	/**
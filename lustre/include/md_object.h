@@ -136,7 +136,7 @@ struct md_attr {
         struct lov_mds_md      *ma_lmm;
 	union lmv_mds_md       *ma_lmv;
         void                   *ma_acl;
-        struct md_som_data     *ma_som;
+        struct md_som_data      ma_som;
         int                     ma_lmm_size;
         int                     ma_lmv_size;
         int                     ma_acl_size;
@@ -594,6 +594,7 @@ enum mdd_object_role {
 struct dt_device;
 
 int lustre_buf2som(void *buf, int rc, struct md_som_data *msd);
+void lustre_som2buf(void *buf, const struct md_som_data *msd);
 int lustre_buf2hsm(void *buf, int rc, struct md_hsm *mh);
 void lustre_hsm2buf(void *buf, const struct md_hsm *mh);
 
@@ -716,6 +716,8 @@ struct obd_device {
 	struct proc_dir_entry	*obd_proc_exports_entry;
 	struct proc_dir_entry	*obd_svc_procroot;
 	struct lprocfs_stats	*obd_svc_stats;
+	/* per-opcode RPC stage latency histograms */
+	struct ptlrpc_stage_stats *obd_stage_stats;
 	struct lprocfs_vars	*obd_vars;
 	atomic_t		obd_evict_inprogress;
 	wait_queue_head_t	obd_evict_inprogress_waitq;
@@ -85,9 +85,15 @@ struct md_identity {
 
 struct upcall_cache_entry {
 	struct list_head	ue_hash;
+	/* chain on uc_upcall_pending while waiting for an upcall slot */
+	struct list_head	ue_upcall_list;
 	uint64_t		ue_key;
 	atomic_t		ue_refcount;
 	int			ue_flags;
+	/* upcall failure for this entry */
+	int			ue_upcall_rc;
+	/* refresh-ahead upcall issued for this valid entry */
+	int			ue_refresh;
 	wait_queue_head_t	ue_waitq;
 	cfs_time_t		ue_acquire_expire;
 	cfs_time_t		ue_expire;
@@ -99,6 +105,8 @@ struct upcall_cache_entry {
 #define UC_CACHE_HASH_SIZE        (128)
 #define UC_CACHE_HASH_INDEX(id)   ((id) & (UC_CACHE_HASH_SIZE - 1))
 #define UC_CACHE_UPCALL_MAXPATH   (1024UL)
+/* max keys resolved by one upcall invocation */
+#define UC_CACHE_BATCH_MAX        (64)
 
 struct upcall_cache;
 
@@ -113,11 +121,22 @@ struct upcall_cache_ops {
 					    struct upcall_cache_entry *,
 					    __u64 key, void *args);
 	int             (*do_upcall)(struct upcall_cache *,
-				     struct upcall_cache_entry *);
+				     __u64 *keys, int nkeys);
 	int             (*parse_downcall)(struct upcall_cache *,
 					  struct upcall_cache_entry *, void *);
 };
 
+struct upcall_cache_stats {
+	__u64			ucs_hits;	/* found valid entry */
+	__u64			ucs_misses;	/* had to wait for upcall */
+	__u64			ucs_upcalls;	/* upcall invocations */
+	__u64			ucs_upcall_keys; /* keys in those upcalls */
+	__u64			ucs_refresh_ahead; /* refresh-ahead upcalls */
+	__u64			ucs_preloads;	/* entries preloaded */
+	__u64			ucs_wait_usec;	/* total miss latency */
+	__u64			ucs_wait_max_usec; /* max miss latency */
+};
+
 struct upcall_cache {
 	struct list_head	uc_hashtable[UC_CACHE_HASH_SIZE];
 	spinlock_t		uc_lock;
@@ -127,7 +146,21 @@ struct upcall_cache {
 	char			uc_upcall[UC_CACHE_UPCALL_MAXPATH];
 	int			uc_acquire_expire;	/* seconds */
 	int			uc_entry_expire;	/* seconds */
+	/* refresh entries used this many seconds before they expire */
+	int			uc_refresh_ahead;
+	/* max keys per upcall invocation */
+	int			uc_upcall_batch;
 	struct upcall_cache_ops	*uc_ops;
+
+	/* entries waiting for an upcall, protected by uc_lock */
+	struct list_head	uc_upcall_pending;
+	/* a thread is running upcalls for uc_upcall_pending */
+	int			uc_upcall_active;
+	/* keys of the batch being upcalled, owned by the active thread */
+	__u64			uc_upcall_keys[UC_CACHE_BATCH_MAX];
+	/* runs upcalls for refresh-ahead and leftover pending entries */
+	cfs_workitem_t		uc_upcall_wi;
+	struct upcall_cache_stats uc_stats;
 };
 
 struct upcall_cache_entry *upcall_cache_get_entry(struct upcall_cache *cache,
@@ -136,6 +169,7 @@ void upcall_cache_put_entry(struct upcall_cache *cache,
 			    struct upcall_cache_entry *entry);
 int upcall_cache_downcall(struct upcall_cache *cache, __u32 err, __u64 key,
 			  void *args);
+int upcall_cache_preload(struct upcall_cache *cache, __u64 key, void *args);
 void upcall_cache_flush(struct upcall_cache *cache, int force);
 
 static inline void upcall_cache_flush_idle(struct upcall_cache *cache)
@@ -152,6 +186,10 @@ void upcall_cache_flush_one(struct upcall_cache *cache, __u64 key, void *args);
 struct upcall_cache *upcall_cache_init(const char *name, const char *upcall,
 				       struct upcall_cache_ops *ops);
 void upcall_cache_cleanup(struct upcall_cache *cache);
+void upcall_cache_get_stats(struct upcall_cache *cache,
+			    struct upcall_cache_stats *stats);
+int upcall_cache_global_init(void);
+void upcall_cache_global_fini(void);
 
 /** @} ucache */
 
@@ -647,10 +647,10 @@ static void discard_bl_list(struct list_head *bl_list)
 		list_del_init(&lock->l_bl_ast);
 		LASSERT(ldlm_is_ast_sent(lock));
 		ldlm_clear_ast_sent(lock);
-                LASSERT(lock->l_bl_ast_run == 0);
-                LASSERT(lock->l_blocking_lock);
-                LDLM_LOCK_RELEASE(lock->l_blocking_lock);
-                lock->l_blocking_lock = NULL;
+                LASSERT(lock->l_srv->ls_bl_ast_run == 0);
+                LASSERT(lock->l_srv->ls_blocking_lock);
+                LDLM_LOCK_RELEASE(lock->l_srv->ls_blocking_lock);
+                lock->l_srv->ls_blocking_lock = NULL;
                 LDLM_LOCK_RELEASE(lock);
         }
         EXIT;
@@ -102,7 +102,7 @@ static inline void ldlm_flock_blocking_link(struct ldlm_lock *req,
         if (req->l_export == NULL)
 		return;
 
-	LASSERT(hlist_unhashed(&req->l_exp_flock_hash));
+	LASSERT(hlist_unhashed(&req->l_srv->ls_exp_flock_hash));
 
         req->l_policy_data.l_flock.blocking_owner =
                 lock->l_policy_data.l_flock.owner;
@@ -112,7 +112,7 @@ static inline void ldlm_flock_blocking_link(struct ldlm_lock *req,
 
 	cfs_hash_add(req->l_export->exp_flock_hash,
 		     &req->l_policy_data.l_flock.owner,
-		     &req->l_exp_flock_hash);
+		     &req->l_srv->ls_exp_flock_hash);
 }
 
 static inline void ldlm_flock_blocking_unlink(struct ldlm_lock *req)
@@ -123,10 +123,10 @@ static inline void ldlm_flock_blocking_unlink(struct ldlm_lock *req)
 
 	check_res_locked(req->l_resource);
 	if (req->l_export->exp_flock_hash != NULL &&
-	    !hlist_unhashed(&req->l_exp_flock_hash))
+	    !hlist_unhashed(&req->l_srv->ls_exp_flock_hash))
 		cfs_hash_del(req->l_export->exp_flock_hash,
 			     &req->l_policy_data.l_flock.owner,
-			     &req->l_exp_flock_hash);
+			     &req->l_srv->ls_exp_flock_hash);
 }
 
 static inline void
@@ -138,7 +138,8 @@ ldlm_flock_destroy(struct ldlm_lock *lock, ldlm_mode_t mode, __u64 flags)
 		   mode, flags);
 
 	/* Safe to not lock here, since it should be empty anyway */
-	LASSERT(hlist_unhashed(&lock->l_exp_flock_hash));
+	LASSERT(lock->l_srv == NULL ||
+		hlist_unhashed(&lock->l_srv->ls_exp_flock_hash));
 
 	list_del_init(&lock->l_res_link);
 	if (flags == LDLM_FL_WAIT_NOREPROC) {
@@ -229,7 +230,8 @@ ldlm_flock_deadlock(struct ldlm_lock *req, struct ldlm_lock *bl_lock)
                 bl_exp_new = class_export_get(flock->blocking_export);
                 class_export_put(bl_exp);
 
-		cfs_hash_put(bl_exp->exp_flock_hash, &lock->l_exp_flock_hash);
+		cfs_hash_put(bl_exp->exp_flock_hash,
+			     &lock->l_srv->ls_exp_flock_hash);
                 bl_exp = bl_exp_new;
 
 		if (bl_exp->exp_failed)
@@ -543,10 +545,10 @@ reprocess:
                 if (lock->l_export != NULL) {
                         new2->l_export = class_export_lock_get(lock->l_export, new2);
                         if (new2->l_export->exp_lock_hash &&
-			    hlist_unhashed(&new2->l_exp_hash))
+			    hlist_unhashed(&new2->l_srv->ls_exp_hash))
                                 cfs_hash_add(new2->l_export->exp_lock_hash,
                                              &new2->l_remote_handle,
-                                             &new2->l_exp_hash);
+                                             &new2->l_srv->ls_exp_hash);
                 }
                 if (*flags == LDLM_FL_WAIT_NOREPROC)
                         ldlm_lock_addref_internal_nolock(new2,
@@ -888,7 +890,8 @@ ldlm_export_flock_key(struct hlist_node *hnode)
 {
 	struct ldlm_lock *lock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_flock_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv,
+			   ls_exp_flock_hash)->ls_lock;
 	return &lock->l_policy_data.l_flock.owner;
 }
 
@@ -901,7 +904,8 @@ ldlm_export_flock_keycmp(const void *key, struct hlist_node *hnode)
 static void *
 ldlm_export_flock_object(struct hlist_node *hnode)
 {
-	return hlist_entry(hnode, struct ldlm_lock, l_exp_flock_hash);
+	return hlist_entry(hnode, struct ldlm_lock_srv,
+			   ls_exp_flock_hash)->ls_lock;
 }
 
 static void
@@ -910,7 +914,8 @@ ldlm_export_flock_get(cfs_hash_t *hs, struct hlist_node *hnode)
 	struct ldlm_lock *lock;
 	struct ldlm_flock *flock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_flock_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv,
+			   ls_exp_flock_hash)->ls_lock;
 	LDLM_LOCK_GET(lock);
 
 	flock = &lock->l_policy_data.l_flock;
@@ -925,7 +930,8 @@ ldlm_export_flock_put(cfs_hash_t *hs, struct hlist_node *hnode)
 	struct ldlm_lock *lock;
 	struct ldlm_flock *flock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_flock_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv,
+			   ls_exp_flock_hash)->ls_lock;
 	LDLM_LOCK_RELEASE(lock);
 
 	flock = &lock->l_policy_data.l_flock;
@@ -128,7 +128,8 @@ ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 				 * requirement: it is only compatible with
 				 * locks from the same client. */
 				if (lock->l_req_mode == LCK_COS &&
-				    lock->l_client_cookie == req->l_client_cookie)
+				    lock->l_srv->ls_client_cookie ==
+				    req->l_srv->ls_client_cookie)
 					goto not_conflicting;
 				/* Found a conflicting policy group. */
 				if (!work_list)
@@ -228,6 +228,10 @@ void ldlm_lock_put(struct ldlm_lock *lock)
                         OBD_FREE_LARGE(lock->l_lvb_data, lock->l_lvb_len);
 
                 ldlm_interval_free(ldlm_interval_detach(lock));
+		if (lock->l_srv != NULL) {
+			OBD_SLAB_FREE_PTR(lock->l_srv, ldlm_lock_srv_slab);
+			lock->l_srv = NULL;
+		}
                 lu_ref_fini(&lock->l_reference);
 		OBD_FREE_RCU(lock, sizeof(*lock), &lock->l_handle);
         }
@@ -275,6 +279,65 @@ int ldlm_lock_remove_from_lru(struct ldlm_lock *lock)
 	return rc;
 }
 
+/**
+ * Key of the resource of \a lock in the LRU ghosts, never 0.
+ */
+static __u64 ldlm_lru_ghost_key(struct ldlm_lock *lock)
+{
+	struct ldlm_res_id *id = &lock->l_resource->lr_name;
+	__u64 key = 0;
+	int i;
+
+	for (i = 0; i < RES_NAME_SIZE; i++)
+		key = (key ^ id->name[i]) * CFS_GOLDEN_RATIO_PRIME_64;
+
+	return key | 1;
+}
+
+static __u64 *ldlm_lru_ghost_slot(struct ldlm_namespace *ns, __u64 key)
+{
+	return &ns->ns_lru_ghost[(key >> 32) & (LDLM_LRU_GHOST_SIZE - 1)];
+}
+
+/**
+ * Remember that the locks on the resource of \a lock were cancelled from
+ * the LRU.  Assumes LRU is already locked.
+ */
+void ldlm_lru_ghost_add_nolock(struct ldlm_lock *lock)
+{
+	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	__u64 key;
+
+	if (ns->ns_lru_ghost == NULL)
+		return;
+
+	key = ldlm_lru_ghost_key(lock);
+	*ldlm_lru_ghost_slot(ns, key) = key;
+}
+
+/**
+ * Check whether locks on the resource of \a lock were recently cancelled
+ * from the LRU, and forget about it.  Assumes LRU is already locked.
+ */
+static bool ldlm_lru_ghost_del_nolock(struct ldlm_lock *lock)
+{
+	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+	__u64 key;
+	__u64 *slot;
+
+	if (ns->ns_lru_ghost == NULL)
+		return false;
+
+	key = ldlm_lru_ghost_key(lock);
+	slot = ldlm_lru_ghost_slot(ns, key);
+	if (*slot != key)
+		return false;
+
+	*slot = 0;
+	ns->ns_lru_ghost_hits++;
+	return true;
+}
+
 /**
  * Adds LDLM lock \a lock to namespace LRU. Assumes LRU is already locked.
  */
@@ -282,6 +345,11 @@ void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock)
 {
 	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
 
+	/* A lock put in the LRU for the first time is hot only if it was
+	 * re-enqueued shortly after its resource was cancelled from the
+	 * LRU, otherwise it was used again since it was last cached. */
+	if (lock->l_last_used != 0 || ldlm_lru_ghost_del_nolock(lock))
+		lock->l_lru_hot = true;
 	lock->l_last_used = cfs_time_current();
 	LASSERT(list_empty(&lock->l_lru));
 	LASSERT(lock->l_resource->lr_type != LDLM_FLOCK);
@@ -377,7 +445,7 @@ static int ldlm_lock_destroy_internal(struct ldlm_lock *lock)
 		 * ldlm_export_lock_keycmp() */
 		/* coverity[overrun-buffer-val] */
 		cfs_hash_del(lock->l_export->exp_lock_hash,
-			     &lock->l_remote_handle, &lock->l_exp_hash);
+			     &lock->l_remote_handle, &lock->l_srv->ls_exp_hash);
 	}
 
         ldlm_lock_remove_from_lru(lock);
@@ -460,14 +528,33 @@ static struct portals_handle_ops lock_handle_ops = {
 static struct ldlm_lock *ldlm_lock_new(struct ldlm_resource *resource)
 {
 	struct ldlm_lock *lock;
+	struct ldlm_lock_srv *lsv = NULL;
 	ENTRY;
 
 	if (resource == NULL)
 		LBUG();
 
+	if (ns_is_server(ldlm_res_to_ns(resource))) {
+		OBD_SLAB_ALLOC_PTR_GFP(lsv, ldlm_lock_srv_slab, GFP_NOFS);
+		if (lsv == NULL)
+			RETURN(NULL);
+	}
+
 	OBD_SLAB_ALLOC_PTR_GFP(lock, ldlm_lock_slab, GFP_NOFS);
-	if (lock == NULL)
+	if (lock == NULL) {
+		if (lsv != NULL)
+			OBD_SLAB_FREE_PTR(lsv, ldlm_lock_srv_slab);
 		RETURN(NULL);
+	}
+
+	if (lsv != NULL) {
+		lsv->ls_lock = lock;
+		INIT_HLIST_NODE(&lsv->ls_exp_hash);
+		INIT_HLIST_NODE(&lsv->ls_exp_flock_hash);
+		INIT_LIST_HEAD(&lsv->ls_exp_list);
+		INIT_LIST_HEAD(&lsv->ls_rk_ast);
+		lock->l_srv = lsv;
+	}
 
 	spin_lock_init(&lock->l_lock);
 	lock->l_resource = resource;
@@ -479,13 +566,9 @@ static struct ldlm_lock *ldlm_lock_new(struct ldlm_resource *resource)
 	INIT_LIST_HEAD(&lock->l_pending_chain);
 	INIT_LIST_HEAD(&lock->l_bl_ast);
 	INIT_LIST_HEAD(&lock->l_cp_ast);
-	INIT_LIST_HEAD(&lock->l_rk_ast);
 	init_waitqueue_head(&lock->l_waitq);
-	lock->l_blocking_lock = NULL;
 	INIT_LIST_HEAD(&lock->l_sl_mode);
 	INIT_LIST_HEAD(&lock->l_sl_policy);
-	INIT_HLIST_NODE(&lock->l_exp_hash);
-	INIT_HLIST_NODE(&lock->l_exp_flock_hash);
 
         lprocfs_counter_incr(ldlm_res_to_ns(resource)->ns_stats,
                              LDLM_NSS_LOCKS);
@@ -494,14 +577,12 @@ static struct ldlm_lock *ldlm_lock_new(struct ldlm_resource *resource)
 
         lu_ref_init(&lock->l_reference);
         lu_ref_add(&lock->l_reference, "hash", lock);
-        lock->l_callback_timeout = 0;
 
 #if LUSTRE_TRACKS_LOCK_EXP_REFS
 	INIT_LIST_HEAD(&lock->l_exp_refs_link);
         lock->l_exp_refs_nr = 0;
         lock->l_exp_refs_target = NULL;
 #endif
-	INIT_LIST_HEAD(&lock->l_exp_list);
 
         RETURN(lock);
 }
@@ -671,8 +752,8 @@ static void ldlm_add_bl_work_item(struct ldlm_lock *lock, struct ldlm_lock *new,
 		LASSERT(list_empty(&lock->l_bl_ast));
 		list_add(&lock->l_bl_ast, work_list);
                 LDLM_LOCK_GET(lock);
-                LASSERT(lock->l_blocking_lock == NULL);
-                lock->l_blocking_lock = LDLM_LOCK_GET(new);
+                LASSERT(lock->l_srv->ls_blocking_lock == NULL);
+                lock->l_srv->ls_blocking_lock = LDLM_LOCK_GET(new);
         }
 }
 
@@ -1810,16 +1891,16 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	list_del_init(&lock->l_bl_ast);
 
 	LASSERT(ldlm_is_ast_sent(lock));
-	LASSERT(lock->l_bl_ast_run == 0);
-	LASSERT(lock->l_blocking_lock);
-	lock->l_bl_ast_run++;
+	LASSERT(lock->l_srv->ls_bl_ast_run == 0);
+	LASSERT(lock->l_srv->ls_blocking_lock);
+	lock->l_srv->ls_bl_ast_run++;
 	unlock_res_and_lock(lock);
 
-	ldlm_lock2desc(lock->l_blocking_lock, &d);
+	ldlm_lock2desc(lock->l_srv->ls_blocking_lock, &d);
 
 	rc = lock->l_blocking_ast(lock, &d, (void *)arg, LDLM_CB_BLOCKING);
-	LDLM_LOCK_RELEASE(lock->l_blocking_lock);
-	lock->l_blocking_lock = NULL;
+	LDLM_LOCK_RELEASE(lock->l_srv->ls_blocking_lock);
+	lock->l_srv->ls_blocking_lock = NULL;
 	LDLM_LOCK_RELEASE(lock);
 
 	RETURN(rc);
@@ -1885,8 +1966,9 @@ ldlm_work_revoke_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	if (list_empty(arg->list))
 		RETURN(-ENOENT);
 
-	lock = list_entry(arg->list->next, struct ldlm_lock, l_rk_ast);
-	list_del_init(&lock->l_rk_ast);
+	lock = list_entry(arg->list->next, struct ldlm_lock_srv,
+			  ls_rk_ast)->ls_lock;
+	list_del_init(&lock->l_srv->ls_rk_ast);
 
 	/* the desc just pretend to exclusive */
 	ldlm_lock2desc(lock, &desc);
@@ -2428,9 +2510,13 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
         struct obd_export *exp = lock->l_export;
         struct ldlm_resource *resource = lock->l_resource;
         char *nid = "local";
+	cfs_time_t timeout = 0;
 
         va_start(args, fmt);
 
+	if (lock->l_srv != NULL)
+		timeout = lock->l_srv->ls_callback_timeout;
+
         if (exp && exp->exp_connection) {
                 nid = libcfs_nid2str(exp->exp_connection->c_peer.nid);
         } else if (exp && exp->exp_obd != NULL) {
@@ -2451,7 +2537,7 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
                        ldlm_lockname[lock->l_req_mode],
                        lock->l_flags, nid, lock->l_remote_handle.cookie,
 		       exp ? atomic_read(&exp->exp_refcount) : -99,
-                       lock->l_pid, lock->l_callback_timeout, lock->l_lvb_type);
+                       lock->l_pid, timeout, lock->l_lvb_type);
                 va_end(args);
                 return;
         }
@@ -2476,7 +2562,7 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
 			lock->l_req_extent.start, lock->l_req_extent.end,
 			lock->l_flags, nid, lock->l_remote_handle.cookie,
 			exp ? atomic_read(&exp->exp_refcount) : -99,
-			lock->l_pid, lock->l_callback_timeout,
+			lock->l_pid, timeout,
 			lock->l_lvb_type);
 		break;
 
@@ -2499,7 +2585,7 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
 			lock->l_policy_data.l_flock.end,
 			lock->l_flags, nid, lock->l_remote_handle.cookie,
 			exp ? atomic_read(&exp->exp_refcount) : -99,
-			lock->l_pid, lock->l_callback_timeout);
+			lock->l_pid, timeout);
 		break;
 
 	case LDLM_IBITS:
@@ -2520,7 +2606,7 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
 			ldlm_typename[resource->lr_type],
 			lock->l_flags, nid, lock->l_remote_handle.cookie,
 			exp ? atomic_read(&exp->exp_refcount) : -99,
-			lock->l_pid, lock->l_callback_timeout,
+			lock->l_pid, timeout,
 			lock->l_lvb_type);
 		break;
 
@@ -2541,7 +2627,7 @@ void _ldlm_lock_debug(struct ldlm_lock *lock,
 			ldlm_typename[resource->lr_type],
 			lock->l_flags, nid, lock->l_remote_handle.cookie,
 			exp ? atomic_read(&exp->exp_refcount) : -99,
-			lock->l_pid, lock->l_callback_timeout,
+			lock->l_pid, timeout,
 			lock->l_lvb_type);
 		break;
 	}
@@ -236,7 +236,7 @@ static int expired_lock_main(void *arg)
 			spin_unlock_bh(&waiting_locks_spinlock);
 
 			spin_lock_bh(&export->exp_bl_list_lock);
-			list_del_init(&lock->l_exp_list);
+			list_del_init(&lock->l_srv->ls_exp_list);
 			spin_unlock_bh(&export->exp_bl_list_lock);
 
 			do_dump++;
@@ -304,7 +304,7 @@ static void waiting_locks_callback(unsigned long unused)
 	while (!list_empty(&waiting_locks_list)) {
 		lock = list_entry(waiting_locks_list.next, struct ldlm_lock,
                                       l_pending_chain);
-                if (cfs_time_after(lock->l_callback_timeout,
+                if (cfs_time_after(lock->l_srv->ls_callback_timeout,
                                    cfs_time_current()) ||
                     (lock->l_req_mode == LCK_GROUP))
                         break;
@@ -364,7 +364,8 @@ static void waiting_locks_callback(unsigned long unused)
                 cfs_time_t timeout_rounded;
 		lock = list_entry(waiting_locks_list.next, struct ldlm_lock,
                                       l_pending_chain);
-                timeout_rounded = (cfs_time_t)round_timeout(lock->l_callback_timeout);
+		timeout_rounded = (cfs_time_t)round_timeout(
+					lock->l_srv->ls_callback_timeout);
                 cfs_timer_arm(&waiting_locks_timer, timeout_rounded);
         }
 	spin_unlock_bh(&waiting_locks_spinlock);
@@ -395,10 +396,10 @@ static int __ldlm_add_waiting_lock(struct ldlm_lock *lock, int seconds)
                 seconds = 1;
 
         timeout = cfs_time_shift(seconds);
-        if (likely(cfs_time_after(timeout, lock->l_callback_timeout)))
-                lock->l_callback_timeout = timeout;
+        if (likely(cfs_time_after(timeout, lock->l_srv->ls_callback_timeout)))
+                lock->l_srv->ls_callback_timeout = timeout;
 
-        timeout_rounded = round_timeout(lock->l_callback_timeout);
+        timeout_rounded = round_timeout(lock->l_srv->ls_callback_timeout);
 
         if (cfs_time_before(timeout_rounded,
                             cfs_timer_deadline(&waiting_locks_timer)) ||
@@ -451,8 +452,8 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 
 	if (ret) {
 		spin_lock_bh(&lock->l_export->exp_bl_list_lock);
-		if (list_empty(&lock->l_exp_list))
-			list_add(&lock->l_exp_list,
+		if (list_empty(&lock->l_srv->ls_exp_list))
+			list_add(&lock->l_srv->ls_exp_list,
 				     &lock->l_export->exp_bl_list);
 		spin_unlock_bh(&lock->l_export->exp_bl_list_lock);
 	}
@@ -489,8 +490,8 @@ static int __ldlm_del_waiting_lock(struct ldlm_lock *lock)
                         struct ldlm_lock *next;
 			next = list_entry(list_next, struct ldlm_lock,
                                               l_pending_chain);
-                        cfs_timer_arm(&waiting_locks_timer,
-                                      round_timeout(next->l_callback_timeout));
+			cfs_timer_arm(&waiting_locks_timer, round_timeout(
+					next->l_srv->ls_callback_timeout));
                 }
         }
 	list_del_init(&lock->l_pending_chain);
@@ -515,7 +516,7 @@ int ldlm_del_waiting_lock(struct ldlm_lock *lock)
 
 	/* remove the lock out of export blocking list */
 	spin_lock_bh(&lock->l_export->exp_bl_list_lock);
-	list_del_init(&lock->l_exp_list);
+	list_del_init(&lock->l_srv->ls_exp_list);
 	spin_unlock_bh(&lock->l_export->exp_bl_list_lock);
 
         if (ret) {
@@ -1309,7 +1310,7 @@ int ldlm_handle_enqueue0(struct ldlm_namespace *ns,
         if (lock->l_export->exp_lock_hash)
                 cfs_hash_add(lock->l_export->exp_lock_hash,
                              &lock->l_remote_handle,
-                             &lock->l_exp_hash);
+                             &lock->l_srv->ls_exp_hash);
 
 	/* Inherit the enqueue flags before the operation, because we do not
 	 * keep the res lock on return and next operations (BL AST) may proceed
@@ -2500,7 +2501,7 @@ static int ldlm_revoke_lock_cb(cfs_hash_t *hs, cfs_hash_bd_t *bd,
         }
 
         LASSERT(lock->l_blocking_ast);
-        LASSERT(!lock->l_blocking_lock);
+        LASSERT(!lock->l_srv->ls_blocking_lock);
 
 	ldlm_set_ast_sent(lock);
         if (lock->l_export && lock->l_export->exp_lock_hash) {
@@ -2510,10 +2511,10 @@ static int ldlm_revoke_lock_cb(cfs_hash_t *hs, cfs_hash_bd_t *bd,
 		 * ldlm_export_lock_keycmp() */
 		/* coverity[overrun-buffer-val] */
 		cfs_hash_del(lock->l_export->exp_lock_hash,
-			     &lock->l_remote_handle, &lock->l_exp_hash);
+			     &lock->l_remote_handle, &lock->l_srv->ls_exp_hash);
 	}
 
-	list_add_tail(&lock->l_rk_ast, rpc_list);
+	list_add_tail(&lock->l_srv->ls_rk_ast, rpc_list);
         LDLM_LOCK_GET(lock);
 
         unlock_res_and_lock(lock);
@@ -2728,7 +2729,7 @@ ldlm_export_lock_key(struct hlist_node *hnode)
 {
         struct ldlm_lock *lock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv, ls_exp_hash)->ls_lock;
         return &lock->l_remote_handle;
 }
 
@@ -2737,7 +2738,7 @@ ldlm_export_lock_keycpy(struct hlist_node *hnode, void *key)
 {
         struct ldlm_lock     *lock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv, ls_exp_hash)->ls_lock;
         lock->l_remote_handle = *(struct lustre_handle *)key;
 }
 
@@ -2750,7 +2751,7 @@ ldlm_export_lock_keycmp(const void *key, struct hlist_node *hnode)
 static void *
 ldlm_export_lock_object(struct hlist_node *hnode)
 {
-	return hlist_entry(hnode, struct ldlm_lock, l_exp_hash);
+	return hlist_entry(hnode, struct ldlm_lock_srv, ls_exp_hash)->ls_lock;
 }
 
 static void
@@ -2758,7 +2759,7 @@ ldlm_export_lock_get(cfs_hash_t *hs, struct hlist_node *hnode)
 {
         struct ldlm_lock *lock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv, ls_exp_hash)->ls_lock;
         LDLM_LOCK_GET(lock);
 }
 
@@ -2767,7 +2768,7 @@ ldlm_export_lock_put(cfs_hash_t *hs, struct hlist_node *hnode)
 {
         struct ldlm_lock *lock;
 
-	lock = hlist_entry(hnode, struct ldlm_lock, l_exp_hash);
+	lock = hlist_entry(hnode, struct ldlm_lock_srv, ls_exp_hash)->ls_lock;
         LDLM_LOCK_RELEASE(lock);
 }
 
@@ -3077,6 +3078,16 @@ int ldlm_init(void)
 		kmem_cache_destroy(ldlm_lock_slab);
                 return -ENOMEM;
         }
+
+	ldlm_lock_srv_slab = kmem_cache_create("ldlm_locks_srv",
+					       sizeof(struct ldlm_lock_srv), 0,
+					       SLAB_HWCACHE_ALIGN, NULL);
+	if (ldlm_lock_srv_slab == NULL) {
+		kmem_cache_destroy(ldlm_resource_slab);
+		kmem_cache_destroy(ldlm_lock_slab);
+		kmem_cache_destroy(ldlm_interval_slab);
+		return -ENOMEM;
+	}
 #if LUSTRE_TRACKS_LOCK_EXP_REFS
         class_export_dump_hook = ldlm_dump_export_locks;
 #endif
@@ -3094,4 +3105,5 @@ void ldlm_exit(void)
 	synchronize_rcu();
 	kmem_cache_destroy(ldlm_lock_slab);
 	kmem_cache_destroy(ldlm_interval_slab);
+	kmem_cache_destroy(ldlm_lock_srv_slab);
 }
@@ -176,6 +176,7 @@ enum {
         LDLM_POOL_SHRINK_FREED_STAT,
         LDLM_POOL_RECALC_STAT,
         LDLM_POOL_TIMING_STAT,
+	LDLM_POOL_LRU_SCAN_STAT,
         LDLM_POOL_LAST_STAT
 };
 
@@ -828,6 +829,9 @@ static int ldlm_pool_proc_init(struct ldlm_pool *pl)
         lprocfs_counter_init(pl->pl_stats, LDLM_POOL_TIMING_STAT,
                              LPROCFS_CNTR_AVGMINMAX | LPROCFS_CNTR_STDDEV,
                              "recalc_timing", "sec");
+	lprocfs_counter_init(pl->pl_stats, LDLM_POOL_LRU_SCAN_STAT,
+			     LPROCFS_CNTR_AVGMINMAX | LPROCFS_CNTR_STDDEV,
+			     "lru_scan_time", "usec");
 	rc = lprocfs_register_stats(pl->pl_proc_dir, "stats", pl->pl_stats);
 
         EXIT;
@@ -928,6 +932,16 @@ void ldlm_pool_add(struct ldlm_pool *pl, struct ldlm_lock *lock)
 		ldlm_pool_recalc(pl);
 }
 
+/**
+ * Account \a usecs spent scanning the namespace LRU for locks to cancel.
+ */
+void ldlm_pool_lru_scan_time(struct ldlm_pool *pl, long usecs)
+{
+	if (pl->pl_stats != NULL)
+		lprocfs_counter_add(pl->pl_stats, LDLM_POOL_LRU_SCAN_STAT,
+				    usecs);
+}
+
 /**
  * Remove ldlm lock \a lock from pool \a pl accounting.
  */
@@ -465,7 +465,7 @@ int ldlm_cli_enqueue_local(struct ldlm_namespace *ns,
         if (policy != NULL)
                 lock->l_policy_data = *policy;
         if (client_cookie != NULL)
-                lock->l_client_cookie = *client_cookie;
+                lock->l_srv->ls_client_cookie = *client_cookie;
 	if (type == LDLM_EXTENT) {
 		/* extent lock without policy is a bug */
 		if (policy == NULL)
@@ -608,14 +608,14 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 
         lock_res_and_lock(lock);
         /* Key change rehash lock in per-export hash with new key */
-        if (exp->exp_lock_hash) {
+	if (exp->exp_lock_hash && lock->l_srv != NULL) {
 		/* In the function below, .hs_keycmp resolves to
 		 * ldlm_export_lock_keycmp() */
 		/* coverity[overrun-buffer-val] */
                 cfs_hash_rehash_key(exp->exp_lock_hash,
                                     &lock->l_remote_handle,
                                     &reply->lock_handle,
-                                    &lock->l_exp_hash);
+                                    &lock->l_srv->ls_exp_hash);
         } else {
                 lock->l_remote_handle = reply->lock_handle;
         }
@@ -1585,6 +1585,62 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, int flags)
         return ldlm_cancel_default_policy;
 }
 
+/**
+ * Find the lock at the cold end of the LRU of \a ns to pass to the LRU
+ * cancel policy, dropping the locks somebody is already canceling.
+ *
+ * With LDLM_LRU_POLICY_2Q, hot locks found on the way are demoted and
+ * moved to the other end of the LRU instead, so that they are cancelled
+ * only after the locks that were used once, e.g. by a tree walk.
+ * Assumes LRU is already locked.
+ *
+ * \retval lock to check, still in the LRU
+ * \retval NULL if there is no lock left to check
+ */
+static struct ldlm_lock *ldlm_lru_first(struct ldlm_namespace *ns, int flags)
+{
+	struct ldlm_lock *lock, *next;
+	bool twoq = ns->ns_lru_policy == LDLM_LRU_POLICY_2Q &&
+		    !(flags & LDLM_CANCEL_NO_WAIT);
+	bool demoted = false;
+
+again:
+	list_for_each_entry_safe(lock, next, &ns->ns_unused_list, l_lru) {
+		/* No locks which got blocking requests. */
+		LASSERT(!ldlm_is_bl_ast(lock));
+
+		if (flags & LDLM_CANCEL_NO_WAIT && ldlm_is_skipped(lock))
+			/* already processed */
+			continue;
+
+		/* Somebody is already doing CANCEL. No need for this
+		 * lock in LRU, do not traverse it again. */
+		if (ldlm_is_canceling(lock)) {
+			ldlm_lock_remove_from_lru_nolock(lock);
+			continue;
+		}
+
+		if (twoq && lock->l_lru_hot) {
+			lock->l_lru_hot = false;
+			list_move_tail(&lock->l_lru, &ns->ns_unused_list);
+			ns->ns_lru_demoted++;
+			demoted = true;
+			continue;
+		}
+
+		return lock;
+	}
+
+	/* Demoted locks are cold now, and at the end of the list which may
+	 * have been reached before them. */
+	if (demoted) {
+		demoted = false;
+		goto again;
+	}
+
+	return NULL;
+}
+
 /**
  * - Free space in LRU for \a count new locks,
  *   redundant unused locks are canceled locally;
@@ -1617,16 +1673,22 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, int flags)
  *                               (typically before replaying locks) w/o
  *                               sending any RPCs or waiting for any
  *                               outstanding RPC to complete.
+ *
+ * The namespace LRU policy decides which locks are passed to the above
+ * policies first, see ldlm_lru_first().
  */
 static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 				 struct list_head *cancels, int count, int max,
 				 int flags)
 {
 	ldlm_cancel_lru_policy_t pf;
-	struct ldlm_lock *lock, *next;
+	struct ldlm_lock *lock;
+	struct timeval scan_start;
+	struct timeval scan_end;
 	int added = 0, unused, remained;
 	ENTRY;
 
+	do_gettimeofday(&scan_start);
 	spin_lock(&ns->ns_lock);
         unused = ns->ns_nr_unused;
         remained = unused;
@@ -1648,24 +1710,8 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
                 if (max && added >= max)
                         break;
 
-		list_for_each_entry_safe(lock, next, &ns->ns_unused_list,
-					     l_lru) {
-                        /* No locks which got blocking requests. */
-			LASSERT(!ldlm_is_bl_ast(lock));
-
-			if (flags & LDLM_CANCEL_NO_WAIT &&
-			    ldlm_is_skipped(lock))
-				/* already processed */
-				continue;
-
-			/* Somebody is already doing CANCEL. No need for this
-			 * lock in LRU, do not traverse it again. */
-			if (!ldlm_is_canceling(lock))
-                                break;
-
-			ldlm_lock_remove_from_lru_nolock(lock);
-		}
-		if (&lock->l_lru == &ns->ns_unused_list)
+		lock = ldlm_lru_first(ns, flags);
+		if (lock == NULL)
 			break;
 
 		LDLM_LOCK_GET(lock);
@@ -1743,10 +1789,16 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 		unlock_res_and_lock(lock);
 		lu_ref_del(&lock->l_reference, __FUNCTION__, current);
 		spin_lock(&ns->ns_lock);
+		if (!(flags & LDLM_CANCEL_NO_WAIT))
+			ldlm_lru_ghost_add_nolock(lock);
 		added++;
 		unused--;
 	}
 	spin_unlock(&ns->ns_lock);
+
+	do_gettimeofday(&scan_end);
+	ldlm_pool_lru_scan_time(&ns->ns_pool,
+				cfs_timeval_sub(&scan_end, &scan_start, NULL));
 	RETURN(added);
 }
 
@@ -2140,14 +2192,14 @@ static int replay_lock_interpret(const struct lu_env *env,
 
         /* Key change rehash lock in per-export hash with new key */
         exp = req->rq_export;
-        if (exp && exp->exp_lock_hash) {
+	if (exp && exp->exp_lock_hash && lock->l_srv != NULL) {
 		/* In the function below, .hs_keycmp resolves to
 		 * ldlm_export_lock_keycmp() */
 		/* coverity[overrun-buffer-val] */
                 cfs_hash_rehash_key(exp->exp_lock_hash,
                                     &lock->l_remote_handle,
                                     &reply->lock_handle,
-                                    &lock->l_exp_hash);
+                                    &lock->l_srv->ls_exp_hash);
         } else {
                 lock->l_remote_handle = reply->lock_handle;
         }
@@ -46,6 +46,7 @@
 #include "ldlm_internal.h"
 
 struct kmem_cache *ldlm_resource_slab, *ldlm_lock_slab;
+struct kmem_cache *ldlm_lock_srv_slab;
 
 int ldlm_srv_namespace_nr = 0;
 int ldlm_cli_namespace_nr = 0;
@@ -310,6 +311,48 @@ static ssize_t lprocfs_elc_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(lprocfs_elc);
 
+static const char *ldlm_lru_policy_names[] = {
+	[LDLM_LRU_POLICY_LRU]	= "lru",
+	[LDLM_LRU_POLICY_2Q]	= "2q",
+};
+
+static int lprocfs_lru_policy_seq_show(struct seq_file *m, void *v)
+{
+	struct ldlm_namespace *ns = m->private;
+
+	return seq_printf(m, "%s\n", ldlm_lru_policy_names[ns->ns_lru_policy]);
+}
+
+static ssize_t lprocfs_lru_policy_seq_write(struct file *file,
+					    const char __user *buffer,
+					    size_t count, loff_t *off)
+{
+	struct ldlm_namespace *ns = ((struct seq_file *)file->private_data)->private;
+	char kernbuf[8];
+	int i;
+
+	if (count > sizeof(kernbuf) - 1)
+		return -EINVAL;
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	if (count > 0 && kernbuf[count - 1] == '\n')
+		kernbuf[count - 1] = '\0';
+	else
+		kernbuf[count] = '\0';
+
+	for (i = 0; i < ARRAY_SIZE(ldlm_lru_policy_names); i++) {
+		if (strcmp(kernbuf, ldlm_lru_policy_names[i]) == 0) {
+			CDEBUG(D_DLMTRACE, "%s: LRU policy %s\n",
+			       ldlm_ns_name(ns), kernbuf);
+			ns->ns_lru_policy = i;
+			return count;
+		}
+	}
+
+	return -EINVAL;
+}
+LPROC_SEQ_FOPS(lprocfs_lru_policy);
+
 static void ldlm_namespace_proc_unregister(struct ldlm_namespace *ns)
 {
 	if (ns->ns_proc_dir_entry == NULL)
@@ -366,6 +409,12 @@ static int ldlm_namespace_proc_register(struct ldlm_namespace *ns)
 			     &ns->ns_max_age, &ldlm_rw_uint_fops);
 		ldlm_add_var(&lock_vars[0], ns_pde, "early_lock_cancel",
 			     ns, &lprocfs_elc_fops);
+		ldlm_add_var(&lock_vars[0], ns_pde, "lru_policy",
+			     ns, &lprocfs_lru_policy_fops);
+		ldlm_add_var(&lock_vars[0], ns_pde, "lru_ghost_hits",
+			     &ns->ns_lru_ghost_hits, &ldlm_uint_fops);
+		ldlm_add_var(&lock_vars[0], ns_pde, "lru_demoted",
+			     &ns->ns_lru_demoted, &ldlm_uint_fops);
 	} else {
 		ldlm_add_var(&lock_vars[0], ns_pde, "ctime_age_limit",
 			     &ns->ns_ctime_age_limit, &ldlm_rw_uint_fops);
@@ -635,6 +684,14 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
         ns->ns_orig_connect_flags = 0;
         ns->ns_connect_flags      = 0;
         ns->ns_stopping           = 0;
+	ns->ns_lru_policy	  = LDLM_LRU_POLICY_LRU;
+	if (client == LDLM_NAMESPACE_CLIENT) {
+		OBD_ALLOC_LARGE(ns->ns_lru_ghost,
+				LDLM_LRU_GHOST_SIZE * sizeof(__u64));
+		if (ns->ns_lru_ghost == NULL)
+			GOTO(out_hash, rc = -ENOMEM);
+	}
+
         rc = ldlm_namespace_proc_register(ns);
         if (rc != 0) {
                 CERROR("Can't initialize ns proc, rc %d\n", rc);
@@ -654,6 +711,9 @@ out_proc:
         ldlm_namespace_proc_unregister(ns);
         ldlm_namespace_cleanup(ns, 0);
 out_hash:
+	if (ns->ns_lru_ghost != NULL)
+		OBD_FREE_LARGE(ns->ns_lru_ghost,
+			       LDLM_LRU_GHOST_SIZE * sizeof(__u64));
         cfs_hash_putref(ns->ns_rs_hash);
 out_ns:
         OBD_FREE_PTR(ns);
@@ -921,6 +981,9 @@ void ldlm_namespace_free_post(struct ldlm_namespace *ns)
 	 * this will cause issues related to using freed \a ns in poold
 	 * thread. */
 	LASSERT(list_empty(&ns->ns_list_chain));
+	if (ns->ns_lru_ghost != NULL)
+		OBD_FREE_LARGE(ns->ns_lru_ghost,
+			       LDLM_LRU_GHOST_SIZE * sizeof(__u64));
 	OBD_FREE_PTR(ns);
 	ldlm_put_ref();
 	EXIT;
@@ -47,6 +47,7 @@ static void lfsck_bookmark_le_to_cpu(struct lfsck_bookmark *des,
 	des->lb_param = le16_to_cpu(src->lb_param);
 	des->lb_speed_limit = le32_to_cpu(src->lb_speed_limit);
 	des->lb_async_windows = le16_to_cpu(src->lb_async_windows);
+	des->lb_assistant_threads = le16_to_cpu(src->lb_assistant_threads);
 	fid_le_to_cpu(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_le_to_cpu(&des->lb_last_fid, &src->lb_last_fid);
 }
@@ -59,6 +60,7 @@ void lfsck_bookmark_cpu_to_le(struct lfsck_bookmark *des,
 	des->lb_param = cpu_to_le16(src->lb_param);
 	des->lb_speed_limit = cpu_to_le32(src->lb_speed_limit);
 	des->lb_async_windows = cpu_to_le16(src->lb_async_windows);
+	des->lb_assistant_threads = cpu_to_le16(src->lb_assistant_threads);
 	fid_cpu_to_le(&des->lb_lpf_fid, &src->lb_lpf_fid);
 	fid_cpu_to_le(&des->lb_last_fid, &src->lb_last_fid);
 }
@@ -149,6 +151,7 @@ static int lfsck_bookmark_init(const struct lu_env *env,
 	mb->lb_magic = LFSCK_BOOKMARK_MAGIC;
 	mb->lb_version = LFSCK_VERSION_V2;
 	mb->lb_async_windows = LFSCK_ASYNC_WIN_DEFAULT;
+	mb->lb_assistant_threads = LFSCK_ASSISTANT_THREADS_DEFAULT;
 	mutex_lock(&lfsck->li_mutex);
 	rc = lfsck_bookmark_store(env, lfsck);
 	mutex_unlock(&lfsck->li_mutex);
@@ -185,10 +188,23 @@ int lfsck_bookmark_setup(const struct lu_env *env,
 	if (rc == 0) {
 		struct lfsck_bookmark *mb = &lfsck->li_bookmark_ram;
 
+		bool dirty = false;
+
 		/* It is upgraded from old release, set it as
 		 * LFSCK_ASYNC_WIN_DEFAULT to avoid memory pressure. */
 		if (unlikely(mb->lb_async_windows == 0)) {
 			mb->lb_async_windows = LFSCK_ASYNC_WIN_DEFAULT;
+			dirty = true;
+		}
+
+		/* The old release used the field as padding. */
+		if (unlikely(mb->lb_assistant_threads == 0)) {
+			mb->lb_assistant_threads =
+				LFSCK_ASSISTANT_THREADS_DEFAULT;
+			dirty = true;
+		}
+
+		if (dirty) {
 			mutex_lock(&lfsck->li_mutex);
 			rc = lfsck_bookmark_store(env, lfsck);
 			mutex_unlock(&lfsck->li_mutex);
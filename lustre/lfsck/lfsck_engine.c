@@ -1138,16 +1138,221 @@ fini_args:
 	return rc;
 }
 
-static inline bool lfsck_assistant_req_empty(struct lfsck_assistant_data *lad)
+/* Whether the assistant thread has something to do: some request can be
+ * claimed, or all the requests have been handled (maybe by the helper
+ * threads) and the main engine has asked for the next step. */
+static inline bool lfsck_assistant_req_ready(struct lfsck_assistant_data *lad)
 {
-	bool empty = false;
+	bool ready = false;
 
 	spin_lock(&lad->lad_lock);
-	if (list_empty(&lad->lad_req_list))
-		empty = true;
+	if (lfsck_assistant_req_claimable(lad) ||
+	    (list_empty(&lad->lad_req_list) &&
+	     (lad->lad_to_post || lad->lad_to_double_scan)))
+		ready = true;
 	spin_unlock(&lad->lad_lock);
 
-	return empty;
+	return ready;
+}
+
+static inline bool lfsck_assistant_req_ready_helper(
+					struct lfsck_assistant_data *lad)
+{
+	bool ready;
+
+	spin_lock(&lad->lad_lock);
+	ready = lfsck_assistant_req_claimable(lad);
+	spin_unlock(&lad->lad_lock);
+
+	return ready;
+}
+
+/**
+ * Claim the oldest pending request for the caller assistant thread.
+ *
+ * The request stays on the lad_req_list until it has been handled, so
+ * that la_fill_pos() that uses the list head as the checkpoint will not
+ * skip the requests that are still being handled by other threads.
+ * An exclusive request is only claimed when no other request is being
+ * handled, and nothing else is claimed until it has been handled.
+ *
+ * \param[in] lad	pointer to the assistant data
+ *
+ * \retval		the claimed request
+ * \retval		NULL if there is no request that can be claimed now
+ */
+static struct lfsck_assistant_req *
+lfsck_assistant_req_claim(struct lfsck_assistant_data *lad)
+{
+	struct lfsck_assistant_req *lar = NULL;
+
+	spin_lock(&lad->lad_lock);
+	if (lfsck_assistant_req_claimable(lad)) {
+		lar = list_entry(lad->lad_req_cursor->next,
+				 struct lfsck_assistant_req, lar_list);
+		lad->lad_req_cursor = &lar->lar_list;
+	}
+	spin_unlock(&lad->lad_lock);
+
+	return lar;
+}
+
+/**
+ * Handle the claimed request and remove it from the lad_req_list.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] com	pointer to the lfsck component
+ * \param[in] lar	the request claimed by lfsck_assistant_req_claim()
+ * \param[in] index	the slot of the caller thread in lad_handled
+ *
+ * \retval		the result of la_handler_p1()
+ */
+static int lfsck_assistant_req_handle(const struct lu_env *env,
+				      struct lfsck_component *com,
+				      struct lfsck_assistant_req *lar,
+				      int index)
+{
+	struct lfsck_assistant_data	*lad	= com->lc_data;
+	struct lfsck_bookmark		*bk	= &com->lc_lfsck->li_bookmark_ram;
+	bool				 wakeup = false;
+	bool				 empty;
+	bool				 claimable;
+	int				 rc;
+
+	rc = lad->lad_ops->la_handler_p1(env, com, lar);
+
+	spin_lock(&lad->lad_lock);
+	if (lad->lad_req_cursor == &lar->lar_list)
+		lad->lad_req_cursor = lar->lar_list.prev;
+	list_del_init(&lar->lar_list);
+	lad->lad_prefetched--;
+	lad->lad_handled[index]++;
+	/* Wake up the main engine thread only when the list
+	 * is empty or half of the prefetched items have been
+	 * handled to avoid too frequent thread schedule. */
+	if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
+		wakeup = true;
+	empty = list_empty(&lad->lad_req_list);
+	/* Some requests may have been held back by an exclusive one, let
+	 * the idle threads claim them. */
+	claimable = lad->lad_threads > 1 &&
+		    lfsck_assistant_req_claimable(lad);
+	spin_unlock(&lad->lad_lock);
+	if (wakeup)
+		wake_up_all(&com->lc_lfsck->li_thread.t_ctl_waitq);
+	/* The assistant thread may wait for the helpers to finish the
+	 * last requests before going to the next step. */
+	if ((empty && index != 0) || claimable)
+		wake_up_all(&lad->lad_thread.t_ctl_waitq);
+
+	lad->lad_ops->la_req_fini(env, lar);
+
+	return rc;
+}
+
+/**
+ * The LFSCK assistant helper thread handles the first-stage requests in
+ * parallel with the LFSCK assistant thread. It is only started for the
+ * LFSCK component whose la_handler_p1() can run concurrently, and it is
+ * stopped by the assistant thread before the second-stage scanning.
+ */
+static int lfsck_assistant_helper(void *args)
+{
+	struct lfsck_thread_args	*lta	 = args;
+	struct lu_env			*env	 = &lta->lta_env;
+	struct lfsck_component		*com	 = lta->lta_com;
+	struct lfsck_instance		*lfsck	 = lta->lta_lfsck;
+	struct lfsck_bookmark		*bk	 = &lfsck->li_bookmark_ram;
+	struct lfsck_assistant_data	*lad	 = com->lc_data;
+	struct ptlrpc_thread		*mthread = &lfsck->li_thread;
+	struct ptlrpc_thread		*athread = &lad->lad_thread;
+	struct lfsck_assistant_req	*lar;
+	struct l_wait_info		 lwi	 = { 0 };
+	int				 rc;
+
+	CDEBUG(D_LFSCK, "%s: %s LFSCK assistant helper %d start\n",
+	       lfsck_lfsck2name(lfsck), lad->lad_name, lta->lta_index);
+
+	while (1) {
+		l_wait_event(athread->t_ctl_waitq,
+			     lfsck_assistant_req_ready_helper(lad) ||
+			     lad->lad_helpers_stop ||
+			     lad->lad_exit ||
+			     !thread_is_running(mthread),
+			     &lwi);
+
+		if (lad->lad_helpers_stop || lad->lad_exit ||
+		    !thread_is_running(mthread))
+			break;
+
+		lar = lfsck_assistant_req_claim(lad);
+		if (lar == NULL)
+			continue;
+
+		rc = lfsck_assistant_req_handle(env, com, lar, lta->lta_index);
+		if (rc < 0 && bk->lb_param & LPF_FAILOUT) {
+			spin_lock(&lad->lad_lock);
+			if (lad->lad_assistant_status == 0)
+				lad->lad_assistant_status = rc;
+			spin_unlock(&lad->lad_lock);
+			break;
+		}
+	}
+
+	CDEBUG(D_LFSCK, "%s: %s LFSCK assistant helper %d exit\n",
+	       lfsck_lfsck2name(lfsck), lad->lad_name, lta->lta_index);
+
+	atomic_dec(&lad->lad_helpers);
+	wake_up_all(&athread->t_ctl_waitq);
+	lfsck_thread_args_fini(lta);
+
+	return 0;
+}
+
+static void lfsck_assistant_helpers_start(struct lfsck_component *com)
+{
+	struct lfsck_instance		*lfsck = com->lc_lfsck;
+	struct lfsck_assistant_data	*lad   = com->lc_data;
+	struct lfsck_thread_args	*lta;
+	struct task_struct		*task;
+	int				 i;
+
+	for (i = 1; i < lad->lad_threads; i++) {
+		lta = lfsck_thread_args_init(lfsck, com, NULL);
+		if (IS_ERR(lta))
+			break;
+
+		lta->lta_index = i;
+		atomic_inc(&lad->lad_helpers);
+		task = kthread_run(lfsck_assistant_helper, lta, "%s_%d",
+				   lad->lad_name, i);
+		if (IS_ERR(task)) {
+			atomic_dec(&lad->lad_helpers);
+			lfsck_thread_args_fini(lta);
+			break;
+		}
+	}
+
+	/* Run with less threads if some helper cannot be started. */
+	if (i < lad->lad_threads) {
+		CDEBUG(D_LFSCK, "%s: %s LFSCK assistant only starts %d of %d "
+		       "threads\n", lfsck_lfsck2name(lfsck), lad->lad_name,
+		       i, lad->lad_threads);
+		lad->lad_threads = i;
+	}
+}
+
+static void lfsck_assistant_helpers_stop(struct lfsck_component *com)
+{
+	struct lfsck_assistant_data	*lad	 = com->lc_data;
+	struct ptlrpc_thread		*athread = &lad->lad_thread;
+	struct l_wait_info		 lwi	 = { 0 };
+
+	lad->lad_helpers_stop = true;
+	wake_up_all(&athread->t_ctl_waitq);
+	l_wait_event(athread->t_ctl_waitq,
+		     atomic_read(&lad->lad_helpers) == 0,
+		     &lwi);
 }
 
 /**
@@ -1574,6 +1779,11 @@ again:
  * LFSCK assistant thread. So under such 1:N multiple asynchronous
  * pipelines mode, the whole LFSCK performance will be much better
  * than check/repair everything by the LFSCK main engine itself.
+ *
+ * If the component allows, the assistant thread starts some helper
+ * threads (see lfsck_bookmark::lb_assistant_threads) that claim and
+ * handle the requests from the same pipeline concurrently, which helps
+ * when the check/repair is blocked on remote targets or disk I/O.
  */
 int lfsck_assistant_engine(void *args)
 {
@@ -1616,53 +1826,48 @@ int lfsck_assistant_engine(void *args)
 	spin_unlock(&lad->lad_lock);
 	wake_up_all(&mthread->t_ctl_waitq);
 
-	while (1) {
-		while (!list_empty(&lad->lad_req_list)) {
-			bool wakeup = false;
+	if (lad->lad_threads > 1)
+		lfsck_assistant_helpers_start(com);
 
+	while (1) {
+		while (1) {
 			if (unlikely(lad->lad_exit ||
 				     !thread_is_running(mthread)))
 				GOTO(cleanup1, rc = lad->lad_post_result);
 
-			lar = list_entry(lad->lad_req_list.next,
-					 struct lfsck_assistant_req,
-					 lar_list);
-			/* Only the lfsck_assistant_engine thread itself can
-			 * remove the "lar" from the head of the list, LFSCK
-			 * engine thread only inserts other new "lar" at the
-			 * end of the list. So it is safe to handle current
-			 * "lar" without the spin_lock. */
-			rc = lao->la_handler_p1(env, com, lar);
-			spin_lock(&lad->lad_lock);
-			list_del_init(&lar->lar_list);
-			lad->lad_prefetched--;
-			/* Wake up the main engine thread only when the list
-			 * is empty or half of the prefetched items have been
-			 * handled to avoid too frequent thread schedule. */
-			if (lad->lad_prefetched <= (bk->lb_async_windows / 2))
-				wakeup = true;
-			spin_unlock(&lad->lad_lock);
-			if (wakeup)
-				wake_up_all(&mthread->t_ctl_waitq);
+			if (unlikely(lad->lad_assistant_status < 0))
+				GOTO(cleanup1, rc = lad->lad_assistant_status);
+
+			/* The LFSCK engine thread only inserts new "lar" at
+			 * the end of the list, and the claimed "lar" is only
+			 * removed by the thread that claimed it. So it is safe
+			 * to handle the claimed "lar" without the spin_lock. */
+			lar = lfsck_assistant_req_claim(lad);
+			if (lar == NULL)
+				break;
 
-			lao->la_req_fini(env, lar);
+			rc = lfsck_assistant_req_handle(env, com, lar, 0);
 			if (rc < 0 && bk->lb_param & LPF_FAILOUT)
 				GOTO(cleanup1, rc);
 		}
 
 		l_wait_event(athread->t_ctl_waitq,
-			     !lfsck_assistant_req_empty(lad) ||
+			     lfsck_assistant_req_ready(lad) ||
 			     lad->lad_exit ||
-			     lad->lad_to_post ||
-			     lad->lad_to_double_scan,
+			     lad->lad_assistant_status < 0,
 			     &lwi);
 
 		if (unlikely(lad->lad_exit))
 			GOTO(cleanup1, rc = lad->lad_post_result);
 
-		if (!list_empty(&lad->lad_req_list))
+		if (!list_empty(&lad->lad_req_list) ||
+		    lad->lad_assistant_status < 0)
 			continue;
 
+		/* All the first-stage requests have been handled. */
+		if (lad->lad_to_post || lad->lad_to_double_scan)
+			lfsck_assistant_helpers_stop(com);
+
 		if (lad->lad_to_post) {
 			CDEBUG(D_LFSCK, "%s: %s LFSCK assistant thread post\n",
 			       lfsck_lfsck2name(lfsck), lad->lad_name);
@@ -1756,6 +1961,9 @@ p2_next:
 	}
 
 cleanup1:
+	/* The helpers may be still handling some requests. */
+	lfsck_assistant_helpers_stop(com);
+
 	/* Cleanup the unfinished requests. */
 	spin_lock(&lad->lad_lock);
 	if (rc < 0)
@@ -1774,6 +1982,7 @@ cleanup1:
 		lao->la_req_fini(env, lar);
 		spin_lock(&lad->lad_lock);
 	}
+	lad->lad_req_cursor = &lad->lad_req_list;
 	spin_unlock(&lad->lad_lock);
 
 	LASSERTF(lad->lad_prefetched == 0, "unmatched prefeteched objs %d\n",
@@ -95,8 +95,8 @@ struct lfsck_bookmark {
 	/* The windows size for async requests pipeline. */
 	__u16	lb_async_windows;
 
-	/* For 64-bits aligned. */
-	__u16	lb_padding;
+	/* How many threads handle the async requests pipeline. */
+	__u16	lb_assistant_threads;
 
 	/* The FID for .lustre/lost+found/MDTxxxx */
 	struct lu_fid	lb_lpf_fid;
@@ -715,11 +715,16 @@ struct lfsck_thread_args {
 	struct lfsck_instance		*lta_lfsck;
 	struct lfsck_component		*lta_com;
 	struct lfsck_start_param	*lta_lsp;
+	/* The slot in lfsck_assistant_data::lad_handled for the thread. */
+	int				 lta_index;
 };
 
 struct lfsck_assistant_req {
 	struct list_head	lar_list;
 	struct lu_fid		lar_fid;
+	/* The request is handled when no other request is being handled,
+	 * and no other request is claimed until it has been handled. */
+	bool			lar_exclusive;
 };
 
 struct lfsck_namespace_req {
@@ -757,12 +762,25 @@ struct lfsck_assistant_operations {
 	void (*la_sync_failures)(const struct lu_env *env,
 				 struct lfsck_component *com,
 				 struct lfsck_request *lr);
+
+	/* Whether la_handler_p1() can handle different requests in
+	 * parallel, then there may be more than one assistant thread. */
+	bool la_parallel_p1;
 };
 
+#define LFSCK_ASSISTANT_THREADS_DEFAULT	1
+#define LFSCK_ASSISTANT_THREADS_MAX	16
+
 struct lfsck_assistant_data {
 	spinlock_t				 lad_lock;
 	struct list_head			 lad_req_list;
 
+	/* The last request claimed by an assistant thread. The requests
+	 * before it are being handled, the ones after it are pending. A
+	 * request is only removed from lad_req_list after being handled,
+	 * so the list head is always the oldest unfinished request. */
+	struct list_head			*lad_req_cursor;
+
 	/* list for the ost targets involve LFSCK. */
 	struct list_head			 lad_ost_list;
 
@@ -792,6 +810,17 @@ struct lfsck_assistant_data {
 	int					 lad_prefetched;
 	int					 lad_assistant_status;
 	int					 lad_post_result;
+
+	/* How many assistant threads are handling the first-stage
+	 * requests, including the assistant thread itself. */
+	int					 lad_threads;
+	/* How many helper threads are still running. */
+	atomic_t				 lad_helpers;
+	bool					 lad_helpers_stop;
+	/* When the first-stage handling started. */
+	cfs_time_t				 lad_time_start;
+	/* How many requests each assistant thread has handled. */
+	__u64		 lad_handled[LFSCK_ASSISTANT_THREADS_MAX];
 	unsigned int				 lad_to_post:1,
 						 lad_to_double_scan:1,
 						 lad_in_double_scan:1,
@@ -914,6 +943,7 @@ int lfsck_double_scan_generic(const struct lu_env *env,
 			      struct lfsck_component *com, int status);
 void lfsck_quit_generic(const struct lu_env *env,
 			struct lfsck_component *com);
+int lfsck_assistant_dump(struct seq_file *m, struct lfsck_component *com);
 
 /* lfsck_engine.c */
 int lfsck_unpack_ent(struct lu_dirent *ent, __u64 *cookie, __u16 *type);
@@ -1352,6 +1382,41 @@ static inline bool lfsck_phase2_next_ready(struct lfsck_assistant_data *lad)
 		list_empty(&lad->lad_ost_phase1_list));
 }
 
+/* Whether some request has not been claimed by any assistant thread yet,
+ * the caller should hold the lfsck_assistant_data::lad_lock. */
+static inline bool lfsck_assistant_req_pending(struct lfsck_assistant_data *lad)
+{
+	return lad->lad_req_cursor->next != &lad->lad_req_list;
+}
+
+/* Whether the next pending request can be claimed now, taking the
+ * exclusive requests into account, the caller should hold the
+ * lfsck_assistant_data::lad_lock. */
+static inline bool
+lfsck_assistant_req_claimable(struct lfsck_assistant_data *lad)
+{
+	struct lfsck_assistant_req *lar;
+
+	if (!lfsck_assistant_req_pending(lad))
+		return false;
+
+	/* Nothing is being handled. */
+	if (lad->lad_req_cursor == &lad->lad_req_list)
+		return true;
+
+	/* The last claimed request is exclusive, wait for it. */
+	lar = list_entry(lad->lad_req_cursor, struct lfsck_assistant_req,
+			 lar_list);
+	if (lar->lar_exclusive)
+		return false;
+
+	/* The next one is exclusive, wait for the others. */
+	lar = list_entry(lad->lad_req_cursor->next,
+			 struct lfsck_assistant_req, lar_list);
+
+	return !lar->lar_exclusive;
+}
+
 static inline void lfsck_lad_set_bitmap(const struct lu_env *env,
 					struct lfsck_component *com,
 					__u32 index)
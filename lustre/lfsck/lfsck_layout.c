@@ -4334,10 +4334,11 @@ static int lfsck_layout_scan_stripes(const struct lu_env *env,
 			RETURN(lad->lad_assistant_status);
 		}
 
-		list_add_tail(&llr->llr_lar.lar_list, &lad->lad_req_list);
-		if (lad->lad_prefetched == 0)
+		if (!lfsck_assistant_req_pending(lad))
 			wakeup = true;
 
+		list_add_tail(&llr->llr_lar.lar_list, &lad->lad_req_list);
+
 		lad->lad_prefetched++;
 		spin_unlock(&lad->lad_lock);
 		if (wakeup)
@@ -4856,6 +4857,8 @@ static int lfsck_layout_dump(const struct lu_env *env,
 			      speed,
 			      new_checked);
 
+		lfsck_assistant_dump(m, com);
+
 		LASSERT(lfsck->li_di_oit != NULL);
 
 		iops = &lfsck->li_obj_oit->do_index_ops->dio_it;
@@ -5504,6 +5507,7 @@ struct lfsck_assistant_operations lfsck_layout_assistant_ops = {
 	.la_double_scan_result	= lfsck_layout_double_scan_result,
 	.la_req_fini		= lfsck_layout_assistant_req_fini,
 	.la_sync_failures	= lfsck_layout_assistant_sync_failures,
+	.la_parallel_p1		= true,
 };
 
 int lfsck_layout_setup(const struct lu_env *env, struct lfsck_instance *lfsck)
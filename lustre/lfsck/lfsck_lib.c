@@ -1928,6 +1928,7 @@ lfsck_assistant_data_init(struct lfsck_assistant_operations *lao,
 		}
 
 		INIT_LIST_HEAD(&lad->lad_req_list);
+		lad->lad_req_cursor = &lad->lad_req_list;
 		spin_lock_init(&lad->lad_lock);
 		INIT_LIST_HEAD(&lad->lad_ost_list);
 		INIT_LIST_HEAD(&lad->lad_ost_phase1_list);
@@ -2349,6 +2350,16 @@ int lfsck_start_assistant(const struct lu_env *env, struct lfsck_component *com,
 	lad->lad_to_double_scan = 0;
 	lad->lad_in_double_scan = 0;
 	lad->lad_exit = 0;
+	lad->lad_req_cursor = &lad->lad_req_list;
+	lad->lad_threads = 1;
+	if (lad->lad_ops->la_parallel_p1 &&
+	    lfsck->li_bookmark_ram.lb_assistant_threads > 1)
+		lad->lad_threads = min_t(int, LFSCK_ASSISTANT_THREADS_MAX,
+				lfsck->li_bookmark_ram.lb_assistant_threads);
+	atomic_set(&lad->lad_helpers, 0);
+	lad->lad_helpers_stop = false;
+	lad->lad_time_start = cfs_time_current();
+	memset(lad->lad_handled, 0, sizeof(lad->lad_handled));
 	thread_set_flags(athread, 0);
 
 	lta = lfsck_thread_args_init(lfsck, com, lsp);
@@ -2461,6 +2472,39 @@ void lfsck_quit_generic(const struct lu_env *env,
 		     &lwi);
 }
 
+/**
+ * Dump how fast every assistant thread handles the first-stage requests,
+ * so that the effect of the lfsck_assistant_threads tunable is visible.
+ *
+ * \param[in] m	output buffer
+ * \param[in] com	pointer to the lfsck component
+ *
+ * \retval		0 for success
+ */
+int lfsck_assistant_dump(struct seq_file *m, struct lfsck_component *com)
+{
+	struct lfsck_assistant_data	*lad = com->lc_data;
+	__u32				 rtime;
+	__u64				 speed;
+	int				 i;
+
+	if (lad == NULL || lad->lad_threads == 0)
+		return 0;
+
+	rtime = cfs_duration_sec(cfs_time_current() - lad->lad_time_start +
+				 HALF_SEC);
+	seq_printf(m, "assistant_threads: %d\n", lad->lad_threads);
+	for (i = 0; i < lad->lad_threads; i++) {
+		speed = lad->lad_handled[i];
+		if (rtime != 0)
+			do_div(speed, rtime);
+		seq_printf(m, "assistant_speed_phase1_%d: "LPU64" items/sec\n",
+			   i, speed);
+	}
+
+	return 0;
+}
+
 /* external interfaces */
 
 int lfsck_get_speed(struct seq_file *m, struct dt_device *key)
@@ -2577,6 +2621,72 @@ int lfsck_set_windows(struct dt_device *key, int val)
 }
 EXPORT_SYMBOL(lfsck_set_windows);
 
+int lfsck_get_threads(struct seq_file *m, struct dt_device *key)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		seq_printf(m, "%u\n",
+			   lfsck->li_bookmark_ram.lb_assistant_threads);
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_get_threads);
+
+/**
+ * Set how many threads handle the first-stage requests for the LFSCK
+ * components that support it. It takes effect from the next start.
+ */
+int lfsck_set_threads(struct dt_device *key, int val)
+{
+	struct lu_env		env;
+	struct lfsck_instance  *lfsck;
+	int			rc;
+	ENTRY;
+
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		RETURN(rc);
+
+	lfsck = lfsck_instance_find(key, true, false);
+	if (likely(lfsck != NULL)) {
+		if (val < 1 || val > LFSCK_ASSISTANT_THREADS_MAX) {
+			CWARN("%s: invalid assistant threads count. The valid "
+			      "range is [1 - %u].\n",
+			      lfsck_lfsck2name(lfsck),
+			      LFSCK_ASSISTANT_THREADS_MAX);
+			rc = -EINVAL;
+		} else if (lfsck->li_bookmark_ram.lb_assistant_threads != val) {
+			mutex_lock(&lfsck->li_mutex);
+			lfsck->li_bookmark_ram.lb_assistant_threads = val;
+			rc = lfsck_bookmark_store(&env, lfsck);
+			mutex_unlock(&lfsck->li_mutex);
+		}
+		lfsck_instance_put(&env, lfsck);
+	} else {
+		rc = -ENXIO;
+	}
+
+	lu_env_fini(&env);
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(lfsck_set_threads);
+
 int lfsck_dump(struct seq_file *m, struct dt_device *key, enum lfsck_type type)
 {
 	struct lu_env		env;
@@ -72,6 +72,9 @@ lfsck_namespace_assistant_req_init(struct lfsck_instance *lfsck,
 	INIT_LIST_HEAD(&lnr->lnr_lar.lar_list);
 	lnr->lnr_lar.lar_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
 	lnr->lnr_lmv = lfsck_lmv_get(lfsck->li_lmv);
+	/* The name entries in the same striped directory share the
+	 * lfsck_lmv, handle them one by one. */
+	lnr->lnr_lar.lar_exclusive = lnr->lnr_lmv != NULL;
 	lnr->lnr_fid = ent->lde_fid;
 	lnr->lnr_oit_cookie = lfsck->li_pos_current.lp_oit_cookie;
 	lnr->lnr_dir_cookie = ent->lde_hash;
@@ -234,6 +237,18 @@ static void lfsck_namespace_cpu_to_le(struct lfsck_namespace *dst,
 	dst->ln_bitmap_size = cpu_to_le32(src->ln_bitmap_size);
 }
 
+/* Set @flags in the namespace LFSCK trace file, which may be updated by
+ * more than one assistant thread at the same time. */
+static void lfsck_namespace_set_flags(struct lfsck_component *com,
+				      __u32 flags)
+{
+	struct lfsck_namespace *ns = com->lc_file_ram;
+
+	down_write(&com->lc_sem);
+	ns->ln_flags |= flags;
+	up_write(&com->lc_sem);
+}
+
 static void lfsck_namespace_record_failure(const struct lu_env *env,
 					   struct lfsck_instance *lfsck,
 					   struct lfsck_namespace *ns)
@@ -2150,11 +2165,8 @@ log:
 	       name, type, update ? lfsck_object_type(child) : 0,
 	       update ? "updating" : "removing", name2, rc);
 
-	if (rc != 0) {
-		struct lfsck_namespace *ns = com->lc_file_ram;
-
-		ns->ln_flags |= LF_INCONSISTENT;
-	}
+	if (rc != 0)
+		lfsck_namespace_set_flags(com, LF_INCONSISTENT);
 
 	return rc;
 }
@@ -3831,6 +3843,7 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 	 * in this striped directory has been scanned for the first time. */
 	INIT_LIST_HEAD(&lnr->lnr_lar.lar_list);
 	lnr->lnr_lar.lar_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
+	lnr->lnr_lar.lar_exclusive = true;
 	lnr->lnr_lmv = lfsck_lmv_get(llmv);
 	lnr->lnr_fid = *lfsck_dto2fid(lfsck->li_obj_dir);
 	lnr->lnr_oit_cookie = lfsck->li_pos_current.lp_oit_cookie;
@@ -3846,10 +3859,11 @@ static void lfsck_namespace_close_dir(const struct lu_env *env,
 		RETURN_EXIT;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
+	if (!lfsck_assistant_req_pending(lad))
 		wakeup = true;
 
+	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
+
 	lad->lad_prefetched++;
 	spin_unlock(&lad->lad_lock);
 	if (wakeup)
@@ -4156,10 +4170,11 @@ static int lfsck_namespace_exec_dir(const struct lu_env *env,
 		return lad->lad_assistant_status;
 	}
 
-	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
-	if (lad->lad_prefetched == 0)
+	if (!lfsck_assistant_req_pending(lad))
 		wakeup = true;
 
+	list_add_tail(&lnr->lnr_lar.lar_list, &lad->lad_req_list);
+
 	lad->lad_prefetched++;
 	spin_unlock(&lad->lad_lock);
 	if (wakeup)
@@ -4312,6 +4327,8 @@ lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 			      speed,
 			      new_checked);
 
+		lfsck_assistant_dump(m, com);
+
 		LASSERT(lfsck->li_di_oit != NULL);
 
 		iops = &lfsck->li_obj_oit->do_index_ops->dio_it;
@@ -4974,11 +4991,8 @@ log:
 	       create ? "Create the lost OST-object as required" :
 			"Keep the MDT-object there by default", rc);
 
-	if (rc <= 0) {
-		struct lfsck_namespace *ns = com->lc_file_ram;
-
-		ns->ln_flags |= LF_INCONSISTENT;
-	}
+	if (rc <= 0)
+		lfsck_namespace_set_flags(com, LF_INCONSISTENT);
 
 	return rc;
 }
@@ -5011,6 +5025,10 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 	int			    idx      = 0;
 	int			    count    = 0;
 	int			    rc	     = 0;
+	/* Flags and counters to be merged into @ns under lc_sem, there
+	 * may be other assistant threads, see la_parallel_p1. */
+	__u32			    flags    = 0;
+	__u32			    linkea_repaired = 0;
 	enum lfsck_namespace_inconsistency_type type = LNIT_NONE;
 	ENTRY;
 
@@ -5026,13 +5044,14 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 
 	pfid = lfsck_dto2fid(dir);
 	la->la_nlink = 0;
-	if (lnr->lnr_attr & LUDA_UPGRADE) {
-		ns->ln_flags |= LF_UPGRADE;
-		ns->ln_dirent_repaired++;
-		repaired = true;
-	} else if (lnr->lnr_attr & LUDA_REPAIR) {
-		ns->ln_flags |= LF_INCONSISTENT;
+	if (lnr->lnr_attr & (LUDA_UPGRADE | LUDA_REPAIR)) {
+		down_write(&com->lc_sem);
+		if (lnr->lnr_attr & LUDA_UPGRADE)
+			ns->ln_flags |= LF_UPGRADE;
+		else
+			ns->ln_flags |= LF_INCONSISTENT;
 		ns->ln_dirent_repaired++;
+		up_write(&com->lc_sem);
 		repaired = true;
 	}
 
@@ -5106,7 +5125,9 @@ static int lfsck_namespace_assistant_handler_p1(const struct lu_env *env,
 			CDEBUG(D_LFSCK, "%s: cannot talk with MDT %x which "
 			       "did not join the namespace LFSCK\n",
 			       lfsck_lfsck2name(lfsck), idx);
+			down_write(&com->lc_sem);
 			lfsck_lad_set_bitmap(env, com, idx);
+			up_write(&com->lc_sem);
 
 			GOTO(out, rc = -ENODEV);
 		}
@@ -5192,14 +5213,14 @@ again:
 		    (count == 1 || !S_ISDIR(lfsck_object_type(obj)))) {
 			if ((lfsck_object_type(obj) & S_IFMT) !=
 			    lnr->lnr_type) {
-				ns->ln_flags |= LF_INCONSISTENT;
+				flags |= LF_INCONSISTENT;
 				type = LNIT_BAD_TYPE;
 			}
 
 			goto stop;
 		}
 
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 
 		/* If the name entry hash does not match the slave striped
 		 * directory, and the name entry does not match also, then
@@ -5238,7 +5259,7 @@ again:
 			type = LNIT_BAD_TYPE;
 
 		count = 1;
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		/* The magic crashed, we are not sure whether there are more
 		 * corrupt data in the linkea, so remove all linkea entries. */
 		remove = true;
@@ -5249,13 +5270,13 @@ again:
 			type = LNIT_BAD_TYPE;
 
 		count = 1;
-		ns->ln_flags |= LF_UPGRADE;
+		flags |= LF_UPGRADE;
 		remove = false;
 		newdata = true;
 
 nodata:
 		if (bk->lb_param & LPF_DRYRUN) {
-			ns->ln_linkea_repaired++;
+			linkea_repaired++;
 			repaired = true;
 			log = true;
 			goto stop;
@@ -5306,7 +5327,7 @@ nodata:
 				 * as LF_INCOMPLETE, then the LFSCK will
 				 * skip nlink attribute verification for
 				 * all objects. */
-				ns->ln_flags |= LF_INCOMPLETE;
+				flags |= LF_INCOMPLETE;
 
 			GOTO(out, rc = 0);
 		}
@@ -5317,7 +5338,7 @@ nodata:
 		count = ldata.ld_leh->leh_reccount;
 		if (!S_ISDIR(lfsck_object_type(obj)) ||
 		    !dt_object_remote(obj)) {
-			ns->ln_linkea_repaired++;
+			linkea_repaired++;
 			repaired = true;
 			log = true;
 		}
@@ -5339,7 +5360,7 @@ out:
 	    !lfsck_is_valid_slave_name_entry(env, lnr->lnr_lmv,
 					     lnr->lnr_name, lnr->lnr_namelen) &&
 	    type != LNIT_BAD_DIRENT) {
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 
 		log = false;
 		rc = lfsck_namespace_repair_bad_name_hash(env, com, dir,
@@ -5379,6 +5400,8 @@ out:
 	}
 
 	down_write(&com->lc_sem);
+	ns->ln_flags |= flags;
+	ns->ln_linkea_repaired += linkea_repaired;
 	if (rc < 0) {
 		CDEBUG(D_LFSCK, "%s: namespace LFSCK assistant fail to handle "
 		       "the entry: "DFID", parent "DFID", name %.*s: rc = %d\n",
@@ -6219,6 +6242,7 @@ struct lfsck_assistant_operations lfsck_namespace_assistant_ops = {
 	.la_double_scan_result	= lfsck_namespace_double_scan_result,
 	.la_req_fini		= lfsck_namespace_assistant_req_fini,
 	.la_sync_failures	= lfsck_namespace_assistant_sync_failures,
+	.la_parallel_p1		= true,
 };
 
 /**
@@ -1315,7 +1315,9 @@ out_rmdir:
 		RETURN(ll_obd_statfs(inode, (void __user *)arg));
         case LL_IOC_LOV_GETSTRIPE:
         case LL_IOC_MDC_GETINFO:
+	case LL_IOC_MDC_GETINFO_V2:
         case IOC_MDC_GETFILEINFO:
+	case IOC_MDC_GETFILEINFO_V2:
         case IOC_MDC_GETFILESTRIPE: {
                 struct ptlrpc_request *request = NULL;
 		struct lov_user_md __user *lump;
@@ -1323,8 +1325,13 @@ out_rmdir:
                 struct mdt_body *body;
                 char *filename = NULL;
                 int lmmsize;
+		bool v1 = cmd == IOC_MDC_GETFILEINFO ||
+			  cmd == LL_IOC_MDC_GETINFO;
+		bool v2 = cmd == IOC_MDC_GETFILEINFO_V2 ||
+			  cmd == LL_IOC_MDC_GETINFO_V2;
 
                 if (cmd == IOC_MDC_GETFILEINFO ||
+		    cmd == IOC_MDC_GETFILEINFO_V2 ||
                     cmd == IOC_MDC_GETFILESTRIPE) {
 			filename = ll_getname((const char __user *)arg);
                         if (IS_ERR(filename))
@@ -1346,8 +1353,7 @@ out_rmdir:
                 }
 
                 if (rc < 0) {
-                        if (rc == -ENODATA && (cmd == IOC_MDC_GETFILEINFO ||
-                                               cmd == LL_IOC_MDC_GETINFO))
+			if (rc == -ENODATA && (v1 || v2))
                                 GOTO(skip_lmm, rc = 0);
                         else
                                 GOTO(out_req, rc);
@@ -1367,9 +1373,10 @@ out_rmdir:
                         rc = -EOVERFLOW;
                 }
         skip_lmm:
-                if (cmd == IOC_MDC_GETFILEINFO || cmd == LL_IOC_MDC_GETINFO) {
+		if (v1 || v2) {
 			struct lov_user_mds_data __user *lmdp;
                         lstat_t st = { 0 };
+			int flags = 0;
 
 			st.st_dev	= inode->i_sb->s_dev;
 			st.st_mode	= body->mbo_mode;
@@ -1385,9 +1392,23 @@ out_rmdir:
 			st.st_ctime	= body->mbo_ctime;
 			st.st_ino	= inode->i_ino;
 
+			/* only V2 callers know the size may be lazy */
+			if (v2 && S_ISREG(body->mbo_mode)) {
+				if (body->mbo_valid & OBD_MD_FLLAZYSIZE)
+					flags |= LMD_FL_LAZY_SIZE;
+				if (body->mbo_valid & OBD_MD_FLLAZYBLOCKS)
+					flags |= LMD_FL_LAZY_BLOCKS;
+			}
+
 			lmdp = (struct lov_user_mds_data __user *)arg;
 			if (copy_to_user(&lmdp->lmd_st, &st, sizeof(st)))
                                 GOTO(out_req, rc = -EFAULT);
+
+			if (flags & LMD_FL_LAZY_SIZE)
+				ll_stats_ops_tally(sbi, LPROC_LL_GLIMPSE_AVOIDED,
+						   1);
+			if (v2 && rc == 0)
+				rc = flags;
                 }
 
                 EXIT;
@@ -132,6 +132,7 @@ static int ll_close_inode_openhandle(struct obd_export *md_exp,
         struct md_op_data *op_data;
         struct ptlrpc_request *req = NULL;
         struct obd_device *obd = class_exp2obd(exp);
+	bool size_known = false;
         int rc;
         ENTRY;
 
@@ -149,7 +150,19 @@ static int ll_close_inode_openhandle(struct obd_export *md_exp,
         if (op_data == NULL)
                 GOTO(out, rc = -ENOMEM); // XXX We leak openhandle and request here.
 
+	/* i_size is only the size of the file once glimpsed, so that the MDT
+	 * can keep it as the exact lazy size when this is the last writer.
+	 * The glimpse costs a round trip to every OST of the file, only pay
+	 * it when this client uses lazy sizes */
+	if (data_version == NULL && och->och_flags & FMODE_WRITE &&
+	    ll_i2sbi(inode)->ll_flags & LL_SBI_LAZY_SIZE &&
+	    ll_i2info(inode)->lli_flags & LLIF_DATA_MODIFIED &&
+	    ll_glimpse_size(inode) == 0)
+		size_known = true;
+
 	ll_prepare_close(inode, op_data, och);
+	if (size_known)
+		op_data->op_bias |= MDS_CLOSE_SIZE_KNOWN;
 	if (data_version != NULL) {
 		/* Pass in data_version implies release. */
 		op_data->op_bias |= MDS_HSM_RELEASE;
@@ -175,6 +188,22 @@ static int ll_close_inode_openhandle(struct obd_export *md_exp,
 		spin_unlock(&lli->lli_lock);
 	}
 
+	/* the MDT keeps an exact size sent on close as the lazy size, any
+	 * other size is merged with what it has and has to be fetched again */
+	if (rc == 0 && !(op_data->op_bias & MDS_HSM_RELEASE) &&
+	    op_data->op_attr.ia_valid & ATTR_SIZE) {
+		if (size_known) {
+			ll_lazy_size_set(inode, op_data->op_attr.ia_size,
+					 op_data->op_attr_blocks, true);
+		} else {
+			struct ll_inode_info *lli = ll_i2info(inode);
+
+			spin_lock(&lli->lli_lock);
+			lli->lli_flags &= ~(LLIF_LAZY_SIZE | LLIF_LAZY_BLOCKS);
+			spin_unlock(&lli->lli_lock);
+		}
+	}
+
 	if (rc == 0 && op_data->op_bias & MDS_HSM_RELEASE) {
 		struct mdt_body *body;
 		body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
@@ -1005,6 +1034,11 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		file->f_dentry->d_name.name, iot, *ppos, count);
 
 restart:
+	/* a released file may be served from the persistent client cache */
+	if (args->via_io_subtype == IO_NORMAL &&
+	    ll_pcc_file_io(file, args, iot, ppos, &result))
+		GOTO(out_stats, result);
+
         io = ccc_env_thread_io(env);
         ll_io_init(io, file, iot == CIT_WRITE);
 
@@ -1094,6 +1128,7 @@ out:
 		goto restart;
 	}
 
+out_stats:
         if (iot == CIT_READ) {
                 if (result >= 0)
                         ll_stats_ops_tally(ll_i2sbi(file->f_dentry->d_inode),
@@ -1360,7 +1395,8 @@ int ll_lov_getstripe_ea_info(struct inode *inode, const char *filename,
         if (IS_ERR(op_data))
                 RETURN(PTR_ERR(op_data));
 
-        op_data->op_valid = OBD_MD_FLEASIZE | OBD_MD_FLDIREA;
+	op_data->op_valid = OBD_MD_FLEASIZE | OBD_MD_FLDIREA |
+			    OBD_MD_FLLAZYSIZE;
         rc = md_getattr_name(sbi->ll_md_exp, op_data, &req);
         ll_finish_md_op_data(op_data);
         if (rc < 0) {
@@ -2429,6 +2465,21 @@ ll_file_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 		OBD_FREE_PTR(hui);
 		RETURN(rc);
 	}
+	case LL_IOC_PCC_STATE: {
+		struct lu_pcc_state *state;
+
+		OBD_ALLOC_PTR(state);
+		if (state == NULL)
+			RETURN(-ENOMEM);
+
+		rc = ll_pcc_state_get(inode, state);
+		if (rc == 0 &&
+		    copy_to_user((void __user *)arg, state, sizeof(*state)))
+			rc = -EFAULT;
+
+		OBD_FREE_PTR(state);
+		RETURN(rc);
+	}
 
 	default: {
 		int err;
@@ -2682,6 +2733,9 @@ int ll_fsync(struct file *file, struct dentry *dentry, int datasync)
 		struct ll_file_data *fd = LUSTRE_FPRIVATE(file);
 
 		err = cl_sync_file_range(inode, start, end, CL_FSYNC_ALL, 0);
+		if (rc == 0 && err < 0)
+			rc = err;
+		err = ll_pcc_fsync(inode, datasync);
 		if (rc == 0 && err < 0)
 			rc = err;
 		if (rc < 0)
@@ -2696,6 +2750,104 @@ int ll_fsync(struct file *file, struct dentry *dentry, int datasync)
 	RETURN(rc);
 }
 
+/**
+ * Preallocate space for, or punch a hole in, the byte range
+ * [offset, offset + len) of a regular file.
+ *
+ * The request is passed down as a CIT_SETATTR io, which takes a PW extent
+ * lock on the range and sends an OST_FALLOCATE RPC to each stripe object
+ * covering it, so the OSTs allocate (unwritten) blocks up front instead of
+ * growing objects one extending write at a time.
+ */
+static long ll_do_fallocate(struct inode *inode, int mode, loff_t offset,
+			    loff_t len)
+{
+	struct lu_env	*env;
+	struct cl_io	*io;
+	struct obd_capa	*capa;
+	loff_t		 end = offset + len;
+	int		 refcheck;
+	long		 rc;
+	ENTRY;
+
+	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p), mode %#x, offset %lld, "
+	       "len %lld\n", PFID(ll_inode2fid(inode)), inode, mode,
+	       offset, len);
+
+	if (!S_ISREG(inode->i_mode))
+		RETURN(-ENODEV);
+
+	/* only allocation and hole punching are supported, and a hole
+	 * can only be punched without changing the file size */
+	if (mode & ~(FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE))
+		RETURN(-EOPNOTSUPP);
+	if ((mode & FALLOC_FL_PUNCH_HOLE) && !(mode & FALLOC_FL_KEEP_SIZE))
+		RETURN(-EOPNOTSUPP);
+
+	if (offset < 0 || len <= 0)
+		RETURN(-EINVAL);
+	if (end > ll_file_maxbytes(inode) || end < offset)
+		RETURN(-EFBIG);
+
+	ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_FALLOCATE, 1);
+
+	if (mode & FALLOC_FL_PUNCH_HOLE) {
+		/* write out dirty pages in the range, they are dropped from
+		 * the page cache once the hole is punched */
+		rc = cl_sync_file_range(inode, offset, end - 1,
+					CL_FSYNC_LOCAL, 0);
+		if (rc < 0)
+			RETURN(rc);
+	}
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		RETURN(PTR_ERR(env));
+
+	capa = ll_osscapa_get(inode, CAPA_OPC_OSS_WRITE);
+
+	io = ccc_env_thread_io(env);
+	io->ci_obj = ll_i2info(inode)->lli_clob;
+
+again:
+	io->u.ci_setattr.sa_attr.lvb_mtime = LTIME_S(CURRENT_TIME);
+	io->u.ci_setattr.sa_attr.lvb_ctime = LTIME_S(CURRENT_TIME);
+	io->u.ci_setattr.sa_valid = ATTR_MTIME | ATTR_MTIME_SET |
+				    ATTR_CTIME | ATTR_CTIME_SET;
+	io->u.ci_setattr.sa_parent_fid = ll_inode2fid(inode);
+	io->u.ci_setattr.sa_capa = capa;
+	io->u.ci_setattr.sa_falloc_mode = mode;
+	io->u.ci_setattr.sa_falloc_offset = offset;
+	io->u.ci_setattr.sa_falloc_end = end;
+
+	if (cl_io_init(env, io, CIT_SETATTR, io->ci_obj) == 0)
+		rc = cl_io_loop(env, io);
+	else
+		rc = io->ci_result;
+	cl_io_fini(env, io);
+	if (unlikely(io->ci_need_restart))
+		goto again;
+
+	cl_env_put(env, &refcheck);
+	capa_put(capa);
+
+	RETURN(rc);
+}
+
+#ifdef HAVE_FILE_FALLOCATE
+static long ll_fallocate(struct file *file, int mode, loff_t offset,
+			 loff_t len)
+{
+	return ll_do_fallocate(file->f_dentry->d_inode, mode, offset, len);
+}
+#else
+static long ll_fallocate(struct inode *inode, int mode, loff_t offset,
+			 loff_t len)
+{
+	return ll_do_fallocate(inode, mode, offset, len);
+}
+#endif
+
 static int
 ll_file_flock(struct file *file, int cmd, struct file_lock *file_lock)
 {
@@ -3104,7 +3256,8 @@ static int __ll_inode_revalidate(struct dentry *dentry, __u64 ibits)
 			rc = ll_get_default_mdsize(sbi, &ealen);
 			if (rc)
 				RETURN(rc);
-			valid |= OBD_MD_FLEASIZE | OBD_MD_FLMODEASIZE;
+			valid |= OBD_MD_FLEASIZE | OBD_MD_FLMODEASIZE |
+				 OBD_MD_FLLAZYSIZE;
 		}
 
                 op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL,
@@ -3153,8 +3306,75 @@ static int ll_merge_md_attr(struct inode *inode)
 	RETURN(0);
 }
 
+/**
+ * Remember the lazy size-on-MDT of \a inode.
+ *
+ * \param[in] inode		regular file
+ * \param[in] size		lazy size
+ * \param[in] blocks		lazy blocks, valid if \a has_blocks
+ * \param[in] has_blocks	whether the MDT knows the blocks of the file
+ */
+void ll_lazy_size_set(struct inode *inode, __u64 size, __u64 blocks,
+		      bool has_blocks)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+
+	spin_lock(&lli->lli_lock);
+	lli->lli_lazysize = size;
+	lli->lli_flags |= LLIF_LAZY_SIZE;
+	if (has_blocks) {
+		lli->lli_lazyblocks = blocks;
+		lli->lli_flags |= LLIF_LAZY_BLOCKS;
+	} else {
+		lli->lli_flags &= ~LLIF_LAZY_BLOCKS;
+	}
+	spin_unlock(&lli->lli_lock);
+}
+
+/**
+ * Get the lazy size-on-MDT of \a inode if stat(2) may use it instead of
+ * glimpsing the OSTs.
+ *
+ * That is the case with the lazy_size tunable set, when the MDT returned a
+ * lazy size, and when this client has no pending writes to the file which
+ * the MDT could not know of yet.  The blocks fall back to i_blocks if the
+ * MDT has no lazy blocks.
+ *
+ * \retval true	\a size and \a blocks are set
+ * \retval false	the file has to be glimpsed
+ */
+static bool ll_lazy_size_get(struct inode *inode, __u64 *size,
+			     blkcnt_t *blocks)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	bool			 lazy = false;
+
+	if (!(ll_i2sbi(inode)->ll_flags & LL_SBI_LAZY_SIZE))
+		return false;
+
+	spin_lock(&lli->lli_lock);
+	if ((lli->lli_flags & (LLIF_LAZY_SIZE | LLIF_DATA_MODIFIED)) ==
+	    LLIF_LAZY_SIZE && lli->lli_open_fd_write_count == 0) {
+		*size = lli->lli_lazysize;
+		*blocks = lli->lli_flags & LLIF_LAZY_BLOCKS ?
+			  lli->lli_lazyblocks : inode->i_blocks;
+		lazy = true;
+	}
+	spin_unlock(&lli->lli_lock);
+
+	return lazy;
+}
+
+/**
+ * Revalidate the attributes of \a dentry.
+ *
+ * For a regular file the size is glimpsed from the OSTs, unless \a lazy is
+ * given and the lazy size-on-MDT may be used, which is then returned in
+ * \a lazy_size and \a lazy_blocks with *\a lazy set.
+ */
 static int
-ll_inode_revalidate(struct dentry *dentry, __u64 ibits)
+ll_inode_revalidate(struct dentry *dentry, __u64 ibits, bool *lazy,
+		    __u64 *lazy_size, blkcnt_t *lazy_blocks)
 {
 	struct inode	*inode = dentry->d_inode;
 	int		 rc;
@@ -3184,8 +3404,15 @@ ll_inode_revalidate(struct dentry *dentry, __u64 ibits)
 		 * restore the MDT holds the layout lock so the glimpse will
 		 * block up to the end of restore (getattr will block)
 		 */
-		if (!(ll_i2info(inode)->lli_flags & LLIF_FILE_RESTORING))
+		if (lazy != NULL &&
+		    ll_lazy_size_get(inode, lazy_size, lazy_blocks)) {
+			*lazy = true;
+			ll_stats_ops_tally(ll_i2sbi(inode),
+					   LPROC_LL_GLIMPSE_AVOIDED, 1);
+		} else if (!(ll_i2info(inode)->lli_flags &
+			     LLIF_FILE_RESTORING)) {
 			rc = ll_glimpse_size(inode);
+		}
 	}
 	RETURN(rc);
 }
@@ -3195,10 +3422,14 @@ int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat)
         struct inode *inode = de->d_inode;
         struct ll_sb_info *sbi = ll_i2sbi(inode);
         struct ll_inode_info *lli = ll_i2info(inode);
+	bool lazy = false;
+	__u64 lazy_size = 0;
+	blkcnt_t lazy_blocks = 0;
         int res = 0;
 
 	res = ll_inode_revalidate(de, MDS_INODELOCK_UPDATE |
-				      MDS_INODELOCK_LOOKUP);
+				      MDS_INODELOCK_LOOKUP,
+				  &lazy, &lazy_size, &lazy_blocks);
         ll_stats_ops_tally(sbi, LPROC_LL_GETATTR, 1);
 
         if (res)
@@ -3219,8 +3450,9 @@ int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat)
 	stat->blksize = 1 << inode->i_blkbits;
 
 	stat->nlink = inode->i_nlink;
-	stat->size = i_size_read(inode);
-	stat->blocks = inode->i_blocks;
+	stat->size = lazy ? lazy_size : i_size_read(inode);
+	stat->blocks = lazy ? lazy_blocks : inode->i_blocks;
+	ll_pcc_getattr(inode, stat);
 
         return 0;
 }
@@ -3404,6 +3636,9 @@ struct file_operations ll_file_operations = {
         .llseek         = ll_file_seek,
         .splice_read    = ll_file_splice_read,
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush
 };
 
@@ -3419,6 +3654,9 @@ struct file_operations ll_file_operations_flock = {
         .llseek         = ll_file_seek,
         .splice_read    = ll_file_splice_read,
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush,
         .flock          = ll_file_flock,
         .lock           = ll_file_flock
@@ -3437,6 +3675,9 @@ struct file_operations ll_file_operations_noflock = {
         .llseek         = ll_file_seek,
         .splice_read    = ll_file_splice_read,
         .fsync          = ll_fsync,
+#ifdef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
         .flush          = ll_flush,
         .flock          = ll_file_noflock,
         .lock           = ll_file_noflock
@@ -3451,6 +3692,9 @@ struct inode_operations ll_file_inode_operations = {
 	.listxattr	= ll_listxattr,
 	.removexattr	= ll_removexattr,
 	.fiemap		= ll_fiemap,
+#ifndef HAVE_FILE_FALLOCATE
+	.fallocate	= ll_fallocate,
+#endif
 #ifdef HAVE_IOP_GET_ACL
 	.get_acl	= ll_get_acl,
 #endif
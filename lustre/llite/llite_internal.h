@@ -120,6 +120,10 @@ enum lli_flags {
 	LLIF_FILE_RESTORING	= 1 << 1,
 	/* Xattr cache is attached to the file */
 	LLIF_XATTR_CACHE	= 1 << 2,
+	/* lli_lazysize holds the lazy size-on-MDT */
+	LLIF_LAZY_SIZE		= 1 << 3,
+	/* lli_lazyblocks holds the lazy blocks-on-MDT */
+	LLIF_LAZY_BLOCKS	= 1 << 4,
 };
 
 struct ll_inode_info {
@@ -233,6 +237,16 @@ struct ll_inode_info {
 			 * accurate if the file is shared by different jobs.
 			 */
 			char                    lli_jobid[LUSTRE_JOBID_SIZE];
+
+			/* local copy of a released file in the persistent
+			 * client cache, protected by lli_pcc_sem */
+			struct file		       *lli_pcc_file;
+			struct rw_semaphore		lli_pcc_sem;
+
+			/* lazy size-on-MDT from the last getattr reply,
+			 * protected by lli_lock */
+			__u64				lli_lazysize;
+			__u64				lli_lazyblocks;
 		};
 	};
 
@@ -410,6 +424,7 @@ enum stats_track_type {
 #define LL_SBI_USER_FID2PATH  0x40000 /* allow fid2path by unprivileged users */
 #define LL_SBI_XATTR_CACHE    0x80000 /* support for xattr cache */
 #define LL_SBI_NOROOTSQUASH  0x100000 /* do not apply root squash */
+#define LL_SBI_LAZY_SIZE     0x200000 /* stat uses lazy size-on-MDT */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -433,6 +448,7 @@ enum stats_track_type {
 	"user_fid2path",\
 	"xattr_cache",	\
 	"norootsquash",	\
+	"lazy_size",	\
 }
 
 #define RCE_HASHES      32
@@ -477,6 +493,14 @@ struct lustre_client_ocd {
 	struct obd_export	*lco_dt_exp;
 };
 
+/* persistent client cache of a mount, see pcc.c */
+struct ll_pcc_config {
+	struct rw_semaphore	 lpc_sem;	/* protects the fields below */
+	__u32			 lpc_archive_id; /* 0 if the cache is off */
+	char			*lpc_root;	/* hsm_root of the copytool */
+	const struct cred	*lpc_cred;	/* to open files in lpc_root */
+};
+
 struct ll_sb_info {
 	struct list_head		  ll_list;
 	/* this protects pglist and ra_info.  It isn't safe to
@@ -551,6 +575,9 @@ struct ll_sb_info {
 
 	/* root squash */
 	struct root_squash_info	  ll_squash;
+
+	/* persistent client cache */
+	struct ll_pcc_config	  ll_pcc;
 };
 
 #define LL_DEFAULT_MAX_RW_CHUNK      (32 * 1024 * 1024)
@@ -712,6 +739,7 @@ enum {
 	LPROC_LL_MAP,
 	LPROC_LL_LLSEEK,
 	LPROC_LL_FSYNC,
+	LPROC_LL_FALLOCATE,
 	LPROC_LL_READDIR,
 	LPROC_LL_SETATTR,
 	LPROC_LL_TRUNC,
@@ -733,6 +761,13 @@ enum {
 	LPROC_LL_LISTXATTR,
 	LPROC_LL_REMOVEXATTR,
 	LPROC_LL_INODE_PERM,
+	LPROC_LL_PCC_ATTACH,
+	LPROC_LL_PCC_DETACH,
+	LPROC_LL_PCC_READ_BYTES,
+	LPROC_LL_PCC_WRITE_BYTES,
+	LPROC_LL_PCC_HIT,
+	LPROC_LL_PCC_MISS,
+	LPROC_LL_GLIMPSE_AVOIDED,
 	LPROC_LL_FILE_OPCODES
 };
 
@@ -812,6 +847,8 @@ extern void ll_rw_stats_tally(struct ll_sb_info *sbi, pid_t pid,
                               struct ll_file_data *file, loff_t pos,
                               size_t count, int rw);
 int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat);
+void ll_lazy_size_set(struct inode *inode, __u64 size, __u64 blocks,
+		      bool has_blocks);
 struct posix_acl *ll_get_acl(struct inode *inode, int type);
 int ll_migrate(struct inode *parent, struct file *file, int mdtidx,
 	       const char *name, int namelen);
@@ -930,6 +967,21 @@ static inline ssize_t ll_lov_user_md_size(const struct lov_user_md *lum)
 	return -EINVAL;
 }
 
+/* llite/pcc.c */
+struct vvp_io_args;
+
+void ll_pcc_init(struct ll_pcc_config *pcc);
+void ll_pcc_fini(struct ll_pcc_config *pcc);
+int ll_pcc_config_set(struct ll_pcc_config *pcc, char *buf);
+int ll_pcc_config_show(struct ll_pcc_config *pcc, struct seq_file *m);
+int ll_pcc_attach(struct inode *inode);
+void ll_pcc_detach(struct inode *inode);
+bool ll_pcc_file_io(struct file *file, struct vvp_io_args *args,
+		    enum cl_io_type iot, loff_t *ppos, ssize_t *result);
+void ll_pcc_getattr(struct inode *inode, struct kstat *stat);
+int ll_pcc_fsync(struct inode *inode, int datasync);
+int ll_pcc_state_get(struct inode *inode, struct lu_pcc_state *state);
+
 /* llite/llite_nfs.c */
 extern struct export_operations lustre_export_operations;
 __u32 get_uuid2int(const char *name, int len);
@@ -143,6 +143,8 @@ static struct ll_sb_info *ll_init_sbi(void)
 	INIT_LIST_HEAD(&sbi->ll_squash.rsi_nosquash_nids);
 	init_rwsem(&sbi->ll_squash.rsi_sem);
 
+	ll_pcc_init(&sbi->ll_pcc);
+
 	RETURN(sbi);
 }
 
@@ -157,6 +159,7 @@ static void ll_free_sbi(struct super_block *sb)
 		spin_unlock(&ll_sb_lock);
 		if (!list_empty(&sbi->ll_squash.rsi_nosquash_nids))
 			cfs_free_nidlist(&sbi->ll_squash.rsi_nosquash_nids);
+		ll_pcc_fini(&sbi->ll_pcc);
 		if (sbi->ll_cache != NULL) {
 			cl_cache_decref(sbi->ll_cache);
 			sbi->ll_cache = NULL;
@@ -215,7 +218,7 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 				  OBD_CONNECT_FLOCK_DEAD |
 				  OBD_CONNECT_DISP_STRIPE | OBD_CONNECT_LFSCK |
 				  OBD_CONNECT_OPEN_BY_FID |
-				  OBD_CONNECT_DIR_STRIPE;
+				  OBD_CONNECT_DIR_STRIPE | OBD_CONNECT_PEER_PING;
 
 #ifdef HAVE_LRU_RESIZE_SUPPORT
         if (sbi->ll_flags & LL_SBI_LRU_RESIZE)
@@ -413,7 +416,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
 				  OBD_CONNECT_LAYOUTLOCK |
-				  OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK;
+				  OBD_CONNECT_PINGLESS | OBD_CONNECT_LFSCK |
+				  OBD_CONNECT_FALLOCATE | OBD_CONNECT_PEER_PING;
 
         if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_CKSUM)) {
                 /* OBD_CONNECT_CKSUM should always be set, even if checksums are
@@ -912,6 +916,16 @@ static int ll_options(char *options, int *flags)
                         *flags &= ~tmp;
                         goto next;
                 }
+		tmp = ll_set_opt("lazysize", s1, LL_SBI_LAZY_SIZE);
+		if (tmp) {
+			*flags |= tmp;
+			goto next;
+		}
+		tmp = ll_set_opt("nolazysize", s1, LL_SBI_LAZY_SIZE);
+		if (tmp) {
+			*flags &= ~tmp;
+			goto next;
+		}
                 tmp = ll_set_opt("32bitapi", s1, LL_SBI_32BIT_API);
                 if (tmp) {
                         *flags |= tmp;
@@ -991,6 +1005,8 @@ void ll_lli_init(struct ll_inode_info *lli)
 		INIT_LIST_HEAD(&lli->lli_agl_list);
 		lli->lli_agl_index = 0;
 		lli->lli_async_rc = 0;
+		lli->lli_pcc_file = NULL;
+		init_rwsem(&lli->lli_pcc_sem);
 	}
 	mutex_init(&lli->lli_layout_mutex);
 }
@@ -1448,6 +1464,7 @@ void ll_clear_inode(struct inode *inode)
         }
 
 	ll_xattr_cache_destroy(inode);
+	ll_pcc_detach(inode);
 
 	if (sbi->ll_flags & LL_SBI_RMT_CLIENT) {
 		LASSERT(lli->lli_posix_acl == NULL);
@@ -1998,6 +2015,12 @@ int ll_update_inode(struct inode *inode, struct lustre_md *md)
 			lli->lli_flags |= LLIF_FILE_RESTORING;
 	}
 
+	if (S_ISREG(inode->i_mode) && body->mbo_valid & OBD_MD_FLLAZYSIZE)
+		ll_lazy_size_set(inode, body->mbo_size,
+				 body->mbo_valid & OBD_MD_FLLAZYBLOCKS ?
+				 body->mbo_blocks : 0,
+				 body->mbo_valid & OBD_MD_FLLAZYBLOCKS);
+
 	return 0;
 }
 
@@ -2588,6 +2611,9 @@ int ll_show_options(struct seq_file *seq, struct vfsmount *vfs)
         if (sbi->ll_flags & LL_SBI_LAZYSTATFS)
                 seq_puts(seq, ",lazystatfs");
 
+	if (sbi->ll_flags & LL_SBI_LAZY_SIZE)
+		seq_puts(seq, ",lazysize");
+
 	if (sbi->ll_flags & LL_SBI_USER_FID2PATH)
 		seq_puts(seq, ",user_fid2path");
 
@@ -768,6 +768,36 @@ static ssize_t ll_lazystatfs_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_lazystatfs);
 
+static int ll_lazy_size_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return seq_printf(m, "%u\n",
+			  (sbi->ll_flags & LL_SBI_LAZY_SIZE) ? 1 : 0);
+}
+
+static ssize_t ll_lazy_size_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ll_sb_info *sbi = ll_s2sbi((struct super_block *)m->private);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_LAZY_SIZE;
+	else
+		sbi->ll_flags &= ~LL_SBI_LAZY_SIZE;
+
+	return count;
+}
+LPROC_SEQ_FOPS(ll_lazy_size);
+
 static int ll_max_easize_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
@@ -1018,6 +1048,41 @@ static ssize_t ll_nosquash_nids_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ll_nosquash_nids);
 
+static int ll_pcc_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+
+	return ll_pcc_config_show(&ll_s2sbi(sb)->ll_pcc, m);
+}
+
+static ssize_t ll_pcc_seq_write(struct file *file, const char __user *buffer,
+				size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct super_block *sb = m->private;
+	char *kernbuf;
+	int rc;
+
+	if (count >= PATH_MAX + 16)
+		return -EINVAL;
+
+	OBD_ALLOC(kernbuf, count + 1);
+	if (kernbuf == NULL)
+		return -ENOMEM;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		GOTO(out, rc = -EFAULT);
+
+	rc = ll_pcc_config_set(&ll_s2sbi(sb)->ll_pcc, kernbuf);
+	if (rc < 0)
+		CERROR("%s: cannot set pcc to '%s': rc = %d\n",
+		       ll_get_fsname(sb, NULL, 0), kernbuf, rc);
+out:
+	OBD_FREE(kernbuf, count + 1);
+	return rc < 0 ? rc : count;
+}
+LPROC_SEQ_FOPS(ll_pcc);
+
 struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	{ .name	=	"uuid",
 	  .fops	=	&ll_sb_uuid_fops			},
@@ -1065,6 +1130,8 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_statahead_stats_fops		},
 	{ .name	=	"lazystatfs",
 	  .fops	=	&ll_lazystatfs_fops			},
+	{ .name	=	"lazy_size",
+	  .fops	=	&ll_lazy_size_fops			},
 	{ .name	=	"max_easize",
 	  .fops	=	&ll_max_easize_fops			},
 	{ .name	=	"default_easize",
@@ -1083,6 +1150,8 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_root_squash_fops			},
 	{ .name	=	"nosquash_nids",
 	  .fops	=	&ll_nosquash_nids_fops			},
+	{ .name	=	"pcc",
+	  .fops	=	&ll_pcc_fops				},
 	{ NULL }
 };
 
@@ -1114,6 +1183,7 @@ static const struct llite_file_opcode {
         { LPROC_LL_MAP,            LPROCFS_TYPE_REGS, "mmap" },
         { LPROC_LL_LLSEEK,         LPROCFS_TYPE_REGS, "seek" },
         { LPROC_LL_FSYNC,          LPROCFS_TYPE_REGS, "fsync" },
+	{ LPROC_LL_FALLOCATE,	   LPROCFS_TYPE_REGS, "fallocate" },
         { LPROC_LL_READDIR,        LPROCFS_TYPE_REGS, "readdir" },
         /* inode operation */
         { LPROC_LL_SETATTR,        LPROCFS_TYPE_REGS, "setattr" },
@@ -1138,6 +1208,15 @@ static const struct llite_file_opcode {
         { LPROC_LL_LISTXATTR,      LPROCFS_TYPE_REGS, "listxattr" },
         { LPROC_LL_REMOVEXATTR,    LPROCFS_TYPE_REGS, "removexattr" },
         { LPROC_LL_INODE_PERM,     LPROCFS_TYPE_REGS, "inode_permission" },
+	{ LPROC_LL_PCC_ATTACH,	   LPROCFS_TYPE_REGS, "pcc_attach" },
+	{ LPROC_LL_PCC_DETACH,	   LPROCFS_TYPE_REGS, "pcc_detach" },
+	{ LPROC_LL_PCC_READ_BYTES, LPROCFS_CNTR_AVGMINMAX|LPROCFS_TYPE_BYTES,
+				   "pcc_read_bytes" },
+	{ LPROC_LL_PCC_WRITE_BYTES, LPROCFS_CNTR_AVGMINMAX|LPROCFS_TYPE_BYTES,
+				   "pcc_write_bytes" },
+	{ LPROC_LL_PCC_HIT,	   LPROCFS_TYPE_REGS, "pcc_hit" },
+	{ LPROC_LL_PCC_MISS,	   LPROCFS_TYPE_REGS, "pcc_miss" },
+	{ LPROC_LL_GLIMPSE_AVOIDED, LPROCFS_TYPE_REGS, "glimpse_avoided" },
 };
 
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, int count)
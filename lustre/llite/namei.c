@@ -262,6 +262,9 @@ int ll_md_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 				CDEBUG(D_INODE, "cannot invalidate layout of "
 				       DFID": rc = %d\n",
 				       PFID(ll_inode2fid(inode)), rc);
+
+			/* the local copy may be restored to the OSTs now */
+			ll_pcc_detach(inode);
 		}
 
 		if ((bits & MDS_INODELOCK_UPDATE) && S_ISDIR(inode->i_mode)) {
@@ -0,0 +1,498 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * Persistent client cache.
+ *
+ * A file is cached on the local storage of a client by archiving it with
+ * an HSM copytool that runs on that client and keeps its archive on a
+ * local filesystem (tmpfs, NVMe, ...), then releasing it.  While the
+ * client holds the layout lock of the released file, reads and writes of
+ * it are served from the archived copy instead of restoring the file, and
+ * the copy survives eviction and remount because it is the HSM archive.
+ *
+ * Consistency comes from the HSM machinery: any client that needs the
+ * data on the OSTs triggers a restore, the coordinator revokes the layout
+ * lock before the copytool copies the local file (with the changes made
+ * through the cache) back to Lustre, and losing the layout lock detaches
+ * the local copy here.
+ *
+ * The cache of a mount is set with "lctl set_param llite.*.pcc=ID ROOT",
+ * where ID is the archive number the copytool serves and ROOT its
+ * --hsm-root.  Local copies are found where lhsmtool_posix stores them.
+ */
+
+#define DEBUG_SUBSYSTEM S_LLITE
+
+#include <linux/fs.h>
+#include <linux/file.h>
+#include <linux/cred.h>
+#include <linux/namei.h>
+#include <obd_support.h>
+#include <lustre/lustre_user.h>
+#include "llite_internal.h"
+
+void ll_pcc_init(struct ll_pcc_config *pcc)
+{
+	init_rwsem(&pcc->lpc_sem);
+	pcc->lpc_archive_id = 0;
+	pcc->lpc_root = NULL;
+	pcc->lpc_cred = NULL;
+}
+
+/* lpc_sem must be held for write */
+static void ll_pcc_config_clear(struct ll_pcc_config *pcc)
+{
+	if (pcc->lpc_root != NULL) {
+		OBD_FREE(pcc->lpc_root, strlen(pcc->lpc_root) + 1);
+		pcc->lpc_root = NULL;
+	}
+	if (pcc->lpc_cred != NULL) {
+		put_cred(pcc->lpc_cred);
+		pcc->lpc_cred = NULL;
+	}
+	pcc->lpc_archive_id = 0;
+}
+
+void ll_pcc_fini(struct ll_pcc_config *pcc)
+{
+	down_write(&pcc->lpc_sem);
+	ll_pcc_config_clear(pcc);
+	up_write(&pcc->lpc_sem);
+}
+
+/**
+ * Set the persistent client cache of a mount.
+ *
+ * Files are opened in the cache with the credentials of the caller, who
+ * must be able to access every file the copytool writes there.
+ *
+ * \param[in] pcc	cache of the mount
+ * \param[in] buf	"ARCHIVE_ID ROOT", or "0" to turn the cache off
+ *
+ * \retval 0		success
+ * \retval -EINVAL	malformed \a buf
+ * \retval -ENOMEM	out of memory
+ */
+int ll_pcc_config_set(struct ll_pcc_config *pcc, char *buf)
+{
+	const struct cred	*cred;
+	unsigned long		 archive_id;
+	char			*start;
+	char			*end;
+	char			*root;
+	size_t			 len;
+
+	archive_id = simple_strtoul(buf, &end, 0);
+	if (end == buf || archive_id > LL_HSM_MAX_ARCHIVE)
+		return -EINVAL;
+
+	start = skip_spaces(end);
+	len = strlen(start);
+	while (len > 0 && isspace(start[len - 1]))
+		start[--len] = '\0';
+
+	if (archive_id == 0) {
+		if (len != 0)
+			return -EINVAL;
+		ll_pcc_fini(pcc);
+		return 0;
+	}
+
+	/* the local copies are opened by path, from any process context */
+	if (start == end || start[0] != '/' || len >= PATH_MAX)
+		return -EINVAL;
+
+	OBD_ALLOC(root, len + 1);
+	if (root == NULL)
+		return -ENOMEM;
+	memcpy(root, start, len);
+
+	cred = prepare_creds();
+	if (cred == NULL) {
+		OBD_FREE(root, len + 1);
+		return -ENOMEM;
+	}
+
+	down_write(&pcc->lpc_sem);
+	ll_pcc_config_clear(pcc);
+	pcc->lpc_archive_id = archive_id;
+	pcc->lpc_root = root;
+	pcc->lpc_cred = cred;
+	up_write(&pcc->lpc_sem);
+
+	return 0;
+}
+
+int ll_pcc_config_show(struct ll_pcc_config *pcc, struct seq_file *m)
+{
+	int rc;
+
+	down_read(&pcc->lpc_sem);
+	if (pcc->lpc_archive_id == 0)
+		rc = seq_printf(m, "0\n");
+	else
+		rc = seq_printf(m, "%u %s\n", pcc->lpc_archive_id,
+				pcc->lpc_root);
+	up_read(&pcc->lpc_sem);
+
+	return rc;
+}
+
+/* path of the archived copy of \a fid, as lhsmtool_posix names it */
+static void ll_pcc_path(char *buf, int size, const char *root,
+			const struct lu_fid *fid)
+{
+	snprintf(buf, size, "%s/%04x/%04x/%04x/%04x/%04x/%04x/"DFID_NOBRACE,
+		 root, fid->f_oid & 0xFFFF, fid->f_oid >> 16 & 0xFFFF,
+		 (unsigned int)(fid->f_seq & 0xFFFF),
+		 (unsigned int)(fid->f_seq >> 16 & 0xFFFF),
+		 (unsigned int)(fid->f_seq >> 32 & 0xFFFF),
+		 (unsigned int)(fid->f_seq >> 48 & 0xFFFF), PFID(fid));
+}
+
+/* the copy in the cache is the data of the file only while the file is
+ * released and archived there, and not modified since */
+static int ll_pcc_check_hsm(struct inode *inode, __u32 archive_id)
+{
+	struct hsm_user_state	*hus;
+	struct md_op_data	*op_data;
+	int			 rc;
+	ENTRY;
+
+	OBD_ALLOC_PTR(hus);
+	if (hus == NULL)
+		RETURN(-ENOMEM);
+
+	op_data = ll_prep_md_op_data(NULL, inode, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, hus);
+	if (IS_ERR(op_data))
+		GOTO(out, rc = PTR_ERR(op_data));
+
+	rc = obd_iocontrol(LL_IOC_HSM_STATE_GET, ll_i2mdexp(inode),
+			   sizeof(*op_data), op_data, NULL);
+	ll_finish_md_op_data(op_data);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	if ((hus->hus_states & (HS_EXISTS | HS_ARCHIVED | HS_RELEASED)) !=
+	    (HS_EXISTS | HS_ARCHIVED | HS_RELEASED) ||
+	    (hus->hus_states & (HS_DIRTY | HS_LOST)) ||
+	    hus->hus_archive_id != archive_id)
+		rc = -ENODATA;
+
+	EXIT;
+out:
+	OBD_FREE_PTR(hus);
+	return rc;
+}
+
+/**
+ * Attach the local copy of a released file, if there is one.
+ *
+ * The copy stays attached until the layout lock of the file is lost.
+ *
+ * \param[in] inode	released file
+ *
+ * \retval 0		IO on the file is served from the local copy
+ * \retval -ENODATA	there is no usable local copy, the file must be
+ *			restored
+ * \retval negative	other errors
+ */
+int ll_pcc_attach(struct inode *inode)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_sb_info	*sbi = ll_i2sbi(inode);
+	struct ll_pcc_config	*pcc = &sbi->ll_pcc;
+	const struct cred	*cred = NULL;
+	const struct cred	*old_cred;
+	struct file		*file;
+	char			*path;
+	__u32			 archive_id;
+	__u32			 gen;
+	int			 rc;
+	ENTRY;
+
+	if (!S_ISREG(inode->i_mode) || !(sbi->ll_flags & LL_SBI_LAYOUT_LOCK))
+		RETURN(-ENODATA);
+
+	if (lli->lli_pcc_file != NULL)
+		RETURN(0);
+
+	OBD_ALLOC(path, PATH_MAX);
+	if (path == NULL)
+		RETURN(-ENOMEM);
+
+	down_read(&pcc->lpc_sem);
+	archive_id = pcc->lpc_archive_id;
+	if (archive_id != 0) {
+		ll_pcc_path(path, PATH_MAX, pcc->lpc_root, &lli->lli_fid);
+		cred = get_cred(pcc->lpc_cred);
+	}
+	up_read(&pcc->lpc_sem);
+
+	if (archive_id == 0)
+		GOTO(out, rc = -ENODATA);
+
+	/* The layout lock must be held from the HSM state check until the
+	 * copy is attached, a changed layout generation tells it was lost
+	 * in between. */
+	rc = ll_layout_refresh(inode, &gen);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	rc = ll_pcc_check_hsm(inode, archive_id);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	old_cred = override_creds(cred);
+	file = filp_open(path, O_RDWR | O_LARGEFILE, 0);
+	revert_creds(old_cred);
+	if (IS_ERR(file)) {
+		rc = PTR_ERR(file);
+		CDEBUG(D_INODE, "%s: cannot open cached copy '%s' of "DFID
+		       ": rc = %d\n", ll_get_fsname(inode->i_sb, NULL, 0),
+		       path, PFID(&lli->lli_fid), rc);
+		GOTO(out, rc = rc == -ENOENT ? -ENODATA : rc);
+	}
+
+	down_write(&lli->lli_pcc_sem);
+	if (lli->lli_pcc_file != NULL) {
+		/* attached by a concurrent IO */
+	} else if (ll_layout_version_get(lli) != gen) {
+		rc = -ENODATA;
+	} else {
+		lli->lli_pcc_file = file;
+		file = NULL;
+	}
+	up_write(&lli->lli_pcc_sem);
+
+	if (file != NULL) {
+		fput(file);
+	} else {
+		CDEBUG(D_INODE, "%s: attached "DFID" to '%s'\n",
+		       ll_get_fsname(inode->i_sb, NULL, 0),
+		       PFID(&lli->lli_fid), path);
+		ll_stats_ops_tally(sbi, LPROC_LL_PCC_ATTACH, 1);
+	}
+
+	EXIT;
+out:
+	if (cred != NULL)
+		put_cred(cred);
+	OBD_FREE(path, PATH_MAX);
+	return rc;
+}
+
+/**
+ * Stop serving IO on \a inode from its local copy.
+ *
+ * Called when the layout lock is lost, the next IO on the file either
+ * attaches the copy again or restores the file.
+ */
+void ll_pcc_detach(struct inode *inode)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct file		*file;
+
+	if (!S_ISREG(inode->i_mode))
+		return;
+
+	down_write(&lli->lli_pcc_sem);
+	file = lli->lli_pcc_file;
+	lli->lli_pcc_file = NULL;
+	up_write(&lli->lli_pcc_sem);
+
+	if (file == NULL)
+		return;
+
+	CDEBUG(D_INODE, "%s: detached "DFID"\n",
+	       ll_get_fsname(inode->i_sb, NULL, 0), PFID(&lli->lli_fid));
+	fput(file);
+	ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_PCC_DETACH, 1);
+}
+
+/**
+ * Read or write \a file in its local copy, if one is attached.
+ *
+ * \param[in] file	Lustre file
+ * \param[in] args	IO_NORMAL arguments
+ * \param[in] iot	CIT_READ or CIT_WRITE
+ * \param[in,out] ppos	file position
+ * \param[out] result	bytes transferred or negative errno
+ *
+ * \retval true		the IO was done in the local copy
+ * \retval false	no copy is attached, the IO must go to Lustre
+ */
+bool ll_pcc_file_io(struct file *file, struct vvp_io_args *args,
+		    enum cl_io_type iot, loff_t *ppos, ssize_t *result)
+{
+	struct inode		*inode = file->f_dentry->d_inode;
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct file		*pcc_file;
+	bool			 append;
+	ssize_t			 done = 0;
+	unsigned long		 seg;
+
+	LASSERT(args->via_io_subtype == IO_NORMAL);
+
+	if (lli->lli_pcc_file == NULL)
+		return false;
+
+	down_read(&lli->lli_pcc_sem);
+	pcc_file = lli->lli_pcc_file;
+	if (pcc_file == NULL) {
+		up_read(&lli->lli_pcc_sem);
+		return false;
+	}
+
+	/* the local copy is shared by all openers, serialize appends */
+	append = iot == CIT_WRITE && (file->f_flags & O_APPEND);
+	if (append) {
+		mutex_lock(&inode->i_mutex);
+		*ppos = i_size_read(pcc_file->f_dentry->d_inode);
+	}
+
+	for (seg = 0; seg < args->u.normal.via_nrsegs; seg++) {
+		struct iovec	*iov = &args->u.normal.via_iov[seg];
+		ssize_t		 rc;
+
+		if (iov->iov_len == 0)
+			continue;
+
+		if (iot == CIT_READ)
+			rc = vfs_read(pcc_file, iov->iov_base, iov->iov_len,
+				      ppos);
+		else
+			rc = vfs_write(pcc_file, iov->iov_base, iov->iov_len,
+				       ppos);
+		if (rc < 0) {
+			if (done == 0)
+				done = rc;
+			break;
+		}
+
+		done += rc;
+		if (rc < iov->iov_len)
+			break;
+	}
+
+	if (append)
+		mutex_unlock(&inode->i_mutex);
+	up_read(&lli->lli_pcc_sem);
+
+	if (done >= 0)
+		ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_PCC_HIT, 1);
+	if (done > 0)
+		ll_stats_ops_tally(ll_i2sbi(inode), iot == CIT_READ ?
+				   LPROC_LL_PCC_READ_BYTES :
+				   LPROC_LL_PCC_WRITE_BYTES, done);
+	*result = done;
+
+	return true;
+}
+
+/* a released file has no size on the OSTs, report the local copy's */
+void ll_pcc_getattr(struct inode *inode, struct kstat *stat)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+
+	if (!S_ISREG(inode->i_mode) || lli->lli_pcc_file == NULL)
+		return;
+
+	down_read(&lli->lli_pcc_sem);
+	if (lli->lli_pcc_file != NULL) {
+		struct inode *pcc_inode = lli->lli_pcc_file->f_dentry->d_inode;
+
+		stat->size = i_size_read(pcc_inode);
+		stat->blocks = pcc_inode->i_blocks;
+		stat->mtime = pcc_inode->i_mtime;
+	}
+	up_read(&lli->lli_pcc_sem);
+}
+
+int ll_pcc_fsync(struct inode *inode, int datasync)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	int			 rc = 0;
+
+	if (!S_ISREG(inode->i_mode) || lli->lli_pcc_file == NULL)
+		return 0;
+
+	down_read(&lli->lli_pcc_sem);
+	if (lli->lli_pcc_file != NULL)
+#if defined(HAVE_FILE_FSYNC_4ARGS) || defined(HAVE_FILE_FSYNC_2ARGS)
+		rc = vfs_fsync(lli->lli_pcc_file, datasync);
+#else
+		rc = vfs_fsync(lli->lli_pcc_file,
+			       lli->lli_pcc_file->f_dentry, datasync);
+#endif
+	up_read(&lli->lli_pcc_sem);
+
+	return rc;
+}
+
+/**
+ * Report whether \a inode is served from the cache on this client.
+ *
+ * A released file archived in the cache is attached first, so that the
+ * state reflects what the next IO would do.
+ */
+int ll_pcc_state_get(struct inode *inode, struct lu_pcc_state *state)
+{
+	struct ll_inode_info	*lli = ll_i2info(inode);
+	struct ll_pcc_config	*pcc = &ll_i2sbi(inode)->ll_pcc;
+	char			*buf;
+	char			*path;
+	int			 rc;
+	ENTRY;
+
+	if (!S_ISREG(inode->i_mode))
+		RETURN(-EINVAL);
+
+	memset(state, 0, sizeof(*state));
+	down_read(&pcc->lpc_sem);
+	state->pccs_archive_id = pcc->lpc_archive_id;
+	up_read(&pcc->lpc_sem);
+
+	rc = ll_pcc_attach(inode);
+	if (rc == -ENODATA)
+		RETURN(0);
+	if (rc != 0)
+		RETURN(rc);
+
+	OBD_ALLOC(buf, PATH_MAX);
+	if (buf == NULL)
+		RETURN(-ENOMEM);
+
+	down_read(&lli->lli_pcc_sem);
+	if (lli->lli_pcc_file != NULL) {
+		state->pccs_flags |= PCC_STATE_ATTACHED;
+		path = d_path(&lli->lli_pcc_file->f_path, buf, PATH_MAX);
+		if (!IS_ERR(path))
+			strlcpy(state->pccs_path, path,
+				sizeof(state->pccs_path));
+	}
+	up_read(&lli->lli_pcc_sem);
+
+	OBD_FREE(buf, PATH_MAX);
+	RETURN(0);
+}
@@ -309,6 +309,23 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 	       io->ci_ignore_layout, io->ci_verify_layout,
 	       vio->vui_layout_gen, io->ci_restore_needed);
 
+	/* a released file archived in the persistent client cache is read
+	 * and written there, restart the io to go through the local copy */
+	if (io->ci_restore_needed == 1 &&
+	    (io->ci_type == CIT_READ || io->ci_type == CIT_WRITE) &&
+	    vio->vui_io_subtype == IO_NORMAL) {
+		if (ll_pcc_attach(inode) == 0) {
+			io->ci_restore_needed = 0;
+			io->ci_need_restart = 1;
+			io->ci_verify_layout = 0;
+		} else if (ll_i2sbi(inode)->ll_pcc.lpc_archive_id != 0) {
+			/* the cache is on but has no usable copy, the file
+			 * is restored; an unlocked read is enough for stats */
+			ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_PCC_MISS,
+					   1);
+		}
+	}
+
 	if (io->ci_restore_needed == 1) {
 		int	rc;
 
@@ -624,6 +641,13 @@ static int vvp_io_setattr_lock(const struct lu_env *env,
 	__u64 new_size;
 	__u32 enqflags = 0;
 
+	if (cl_io_is_fallocate(io)) {
+		vio->u.setattr.vui_local_lock = SETATTR_EXTENT_LOCK;
+		return vvp_io_one_lock(env, io, 0, CLM_WRITE,
+				       io->u.ci_setattr.sa_falloc_offset,
+				       io->u.ci_setattr.sa_falloc_end - 1);
+	}
+
         if (cl_io_is_trunc(io)) {
                 new_size = io->u.ci_setattr.sa_attr.lvb_size;
                 if (new_size == 0)
@@ -712,6 +736,29 @@ static int vvp_io_setattr_start(const struct lu_env *env,
 	return result;
 }
 
+/**
+ * Reflect a completed fallocate(2) in the VFS inode: extend i_size unless
+ * the caller asked to keep it, and drop cached pages of a punched range so
+ * they are read back as zeroes.
+ */
+static void vvp_io_setattr_falloc_end(struct cl_io *io, struct inode *inode)
+{
+	int   mode = io->u.ci_setattr.sa_falloc_mode;
+	loff_t end = io->u.ci_setattr.sa_falloc_end;
+
+	if (mode & FALLOC_FL_PUNCH_HOLE) {
+		/* dirty pages were flushed by ll_do_fallocate() */
+		invalidate_inode_pages2_range(inode->i_mapping,
+			io->u.ci_setattr.sa_falloc_offset >> PAGE_CACHE_SHIFT,
+			(end - 1) >> PAGE_CACHE_SHIFT);
+	} else if (!(mode & FALLOC_FL_KEEP_SIZE)) {
+		ll_inode_size_lock(inode);
+		if (end > i_size_read(inode))
+			i_size_write(inode, end);
+		ll_inode_size_unlock(inode);
+	}
+}
+
 static void vvp_io_setattr_end(const struct lu_env *env,
                                const struct cl_io_slice *ios)
 {
@@ -723,6 +770,8 @@ static void vvp_io_setattr_end(const struct lu_env *env,
 		 * because osc has already notified to destroy osc_extents. */
 		vvp_do_vmtruncate(inode, io->u.ci_setattr.sa_attr.lvb_size);
 		inode_dio_write_done(inode);
+	} else if (cl_io_is_fallocate(io) && io->ci_result == 0) {
+		vvp_io_setattr_falloc_end(io, inode);
 	}
 	mutex_unlock(&inode->i_mutex);
 }
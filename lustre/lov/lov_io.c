@@ -96,12 +96,18 @@ static void lov_io_sub_inherit(struct cl_io *io, struct lov_io *lio,
 		io->u.ci_setattr.sa_parent_fid =
 					parent->u.ci_setattr.sa_parent_fid;
 		io->u.ci_setattr.sa_capa = parent->u.ci_setattr.sa_capa;
+		io->u.ci_setattr.sa_falloc_mode =
+					parent->u.ci_setattr.sa_falloc_mode;
                 if (cl_io_is_trunc(io)) {
                         loff_t new_size = parent->u.ci_setattr.sa_attr.lvb_size;
 
                         new_size = lov_size_to_stripe(lsm, new_size, stripe);
                         io->u.ci_setattr.sa_attr.lvb_size = new_size;
-                }
+		} else if (cl_io_is_fallocate(parent)) {
+			/* [start, end) is the stripe-local range */
+			io->u.ci_setattr.sa_falloc_offset = start;
+			io->u.ci_setattr.sa_falloc_end = end;
+		}
                 break;
         }
         case CIT_FAULT: {
@@ -340,6 +346,11 @@ static int lov_io_slice_init(struct lov_io *lio,
                 break;
 
         case CIT_SETATTR:
+		if (cl_io_is_fallocate(io)) {
+			lio->lis_pos = io->u.ci_setattr.sa_falloc_offset;
+			lio->lis_endpos = io->u.ci_setattr.sa_falloc_end;
+			break;
+		}
                 if (cl_io_is_trunc(io))
                         lio->lis_pos = io->u.ci_setattr.sa_attr.lvb_size;
                 else
@@ -1044,8 +1055,9 @@ int lov_io_init_released(const struct lu_env *env, struct cl_object *obj,
 		 * - in open, for open O_TRUNC
 		 * - in setattr, for truncate
 		 */
-		/* the truncate is for size > 0 so triggers a restore */
-		if (cl_io_is_trunc(io))
+		/* the truncate is for size > 0 so triggers a restore,
+		 * as does preallocating space in the file */
+		if (cl_io_is_trunc(io) || cl_io_is_fallocate(io))
 			io->ci_restore_needed = 1;
 		result = -ENODATA;
 		break;
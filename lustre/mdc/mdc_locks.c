@@ -451,6 +451,7 @@ static struct ptlrpc_request *mdc_intent_getattr_pack(struct obd_export *exp,
 	u64			 valid = OBD_MD_FLGETATTR | OBD_MD_FLEASIZE |
 					 OBD_MD_FLMODEASIZE | OBD_MD_FLDIREA |
 					 OBD_MD_FLMDSCAPA | OBD_MD_MEA |
+					 OBD_MD_FLLAZYSIZE |
 					 (client_is_remote(exp) ?
 					  OBD_MD_FLRMTPERM : OBD_MD_FLACL);
 	struct ldlm_intent	*lit;
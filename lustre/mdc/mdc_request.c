@@ -1875,8 +1875,11 @@ static struct kuc_hdr *changelog_kuc_hdr(char *buf, size_t len, __u32 flags)
 struct changelog_show {
 	__u64				 cs_startrec;
 	enum changelog_send_flag	 cs_flags;
+	__u32				 cs_mask;
 	struct file			*cs_fp;
 	char				*cs_buf;
+	/* bytes used in cs_buf by a CL_RECORDS message being built */
+	size_t				 cs_batch_len;
 	struct obd_device		*cs_obd;
 };
 
@@ -1885,6 +1888,61 @@ static inline char *cs_obd_name(struct changelog_show *cs)
 	return cs->cs_obd->obd_name;
 }
 
+/* Send the records packed so far into the CL_RECORDS message */
+static int changelog_kkuc_flush(struct changelog_show *cs)
+{
+	struct kuc_hdr	*lh;
+	size_t		 len = cs->cs_batch_len;
+	int		 rc;
+
+	if (len <= sizeof(*lh))
+		return 0;
+
+	lh = changelog_kuc_hdr(cs->cs_buf, sizeof(*lh), cs->cs_flags);
+	lh->kuc_msgtype = CL_RECORDS;
+	lh->kuc_msglen = len;
+	cs->cs_batch_len = sizeof(*lh);
+
+	rc = libcfs_kkuc_msg_put(cs->cs_fp, lh);
+	CDEBUG(D_HSM, "kucmsg fp %p batch len %zu rc %d\n", cs->cs_fp, len, rc);
+
+	return rc;
+}
+
+/* Append \a rec to the CL_RECORDS message, remapped to the reader format
+ * so that it can be used in place from the message by userspace */
+static int changelog_kkuc_batch(struct changelog_show *cs,
+				struct changelog_rec *rec)
+{
+	enum changelog_rec_flags crf = CLF_VERSION | CLF_RENAME;
+	struct changelog_rec	*slot;
+	size_t			 reclen;
+	size_t			 len;
+	int			 rc;
+
+	if (cs->cs_flags & CHANGELOG_FLAG_JOBID)
+		crf |= CLF_JOBID;
+
+	reclen = changelog_rec_size(rec) + rec->cr_namelen;
+	len = cfs_size_round(changelog_rec_offset(crf) + rec->cr_namelen + 1);
+	if (cs->cs_batch_len + max(reclen, len) > KUC_CHANGELOG_BATCH_MAXSIZE) {
+		rc = changelog_kkuc_flush(cs);
+		if (rc != 0)
+			return rc;
+	}
+
+	slot = (struct changelog_rec *)(cs->cs_buf + cs->cs_batch_len);
+	memcpy(slot, rec, reclen);
+	changelog_remap_rec(slot, crf);
+	/* NUL-terminate the name and clear the padding */
+	reclen = changelog_rec_size(slot) + slot->cr_namelen;
+	memset((char *)slot + reclen, 0, len - reclen);
+	LASSERT(changelog_rec_batch_size(slot) == len);
+	cs->cs_batch_len += len;
+
+	return 0;
+}
+
 static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 			     struct llog_rec_hdr *hdr, void *data)
 {
@@ -1910,6 +1968,10 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 		RETURN(0);
 	}
 
+	if (cs->cs_flags & CHANGELOG_FLAG_MASK &&
+	    !(cs->cs_mask & (1 << rec->cr.cr_type)))
+		RETURN(0);
+
 	CDEBUG(D_HSM, LPU64" %02d%-5s "LPU64" 0x%x t="DFID" p="DFID" %.*s\n",
 	       rec->cr.cr_index, rec->cr.cr_type,
 	       changelog_type2str(rec->cr.cr_type), rec->cr.cr_time,
@@ -1917,6 +1979,9 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 	       PFID(&rec->cr.cr_tfid), PFID(&rec->cr.cr_pfid),
 	       rec->cr.cr_namelen, changelog_rec_name(&rec->cr));
 
+	if (cs->cs_flags & CHANGELOG_FLAG_BATCH)
+		RETURN(changelog_kkuc_batch(cs, &rec->cr));
+
 	len = sizeof(*lh) + changelog_rec_size(&rec->cr) + rec->cr.cr_namelen;
 
         /* Set up the message */
@@ -1936,12 +2001,18 @@ static int mdc_changelog_send_thread(void *csdata)
 	struct llog_handle	*llh = NULL;
 	struct kuc_hdr		*kuch;
 	enum llog_flag		 flags = LLOG_F_IS_CAT;
+	size_t			 buflen = KUC_CHANGELOG_MSG_MAXSIZE;
 	int			 rc;
 
 	CDEBUG(D_HSM, "changelog to fp=%p start "LPU64"\n",
 	       cs->cs_fp, cs->cs_startrec);
 
-	OBD_ALLOC(cs->cs_buf, KUC_CHANGELOG_MSG_MAXSIZE);
+	if (cs->cs_flags & CHANGELOG_FLAG_BATCH) {
+		buflen = KUC_CHANGELOG_BATCH_MAXSIZE;
+		cs->cs_batch_len = sizeof(*kuch);
+	}
+
+	OBD_ALLOC_LARGE(cs->cs_buf, buflen);
 	if (cs->cs_buf == NULL)
 		GOTO(out, rc = -ENOMEM);
 
@@ -1967,6 +2038,8 @@ static int mdc_changelog_send_thread(void *csdata)
 	}
 
 	rc = llog_cat_process(NULL, llh, changelog_kkuc_cb, cs, 0, 0);
+	if (cs->cs_flags & CHANGELOG_FLAG_BATCH)
+		changelog_kkuc_flush(cs);
 
         /* Send EOF no matter what our result */
         if ((kuch = changelog_kuc_hdr(cs->cs_buf, sizeof(*kuch),
@@ -1982,7 +2055,7 @@ out:
         if (ctxt)
                 llog_ctxt_put(ctxt);
 	if (cs->cs_buf)
-		OBD_FREE(cs->cs_buf, KUC_CHANGELOG_MSG_MAXSIZE);
+		OBD_FREE_LARGE(cs->cs_buf, buflen);
 	OBD_FREE_PTR(cs);
 	return rc;
 }
@@ -2004,6 +2077,8 @@ static int mdc_ioc_changelog_send(struct obd_device *obd,
 	/* matching fput in mdc_changelog_send_thread */
 	cs->cs_fp = fget(icc->icc_id);
 	cs->cs_flags = icc->icc_flags;
+	if (cs->cs_flags & CHANGELOG_FLAG_MASK)
+		cs->cs_mask = icc->icc_mask;
 
 	/*
 	 * New thread because we should return to user app before
@@ -262,6 +262,58 @@ static int llog_changelog_cancel(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Append a changelog record to the current plain llog
+ *
+ * The record index is assigned here rather than by the caller, while the
+ * plain llog handle is locked for the append. This keeps cr_index in llog
+ * order, which changelog readers, llog_changelog_cancel_cb() and
+ * changelog_init_cb() all rely on, and keeps mc_lock out of the section
+ * that concurrent metadata operations contend on.
+ *
+ * \param[in] env	execution environment
+ * \param[in] loghandle	changelog llog handle
+ * \param[in] hdr	llog record to write
+ * \param[out] cookie	cookie of the written record if needed
+ * \param[in] idx	index of the record to modify, LLOG_NEXT_IDX to append
+ * \param[in] th	current transaction handle
+ *
+ * \retval		see llog_osd_ops::lop_write_rec()
+ */
+static int mdd_changelog_write_rec(const struct lu_env *env,
+				   struct llog_handle *loghandle,
+				   struct llog_rec_hdr *hdr,
+				   struct llog_cookie *cookie,
+				   int idx, struct thandle *th)
+{
+	struct llog_changelog_rec	*rec;
+	struct mdd_device		*mdd;
+	int				 rc;
+
+	if (idx != LLOG_NEXT_IDX || hdr->lrh_type != CHANGELOG_REC)
+		return llog_osd_ops.lop_write_rec(env, loghandle, hdr, cookie,
+						  idx, th);
+
+	mdd = lu2mdd_dev(loghandle->lgh_ctxt->loc_obd->obd_lu_dev);
+	rec = container_of(hdr, struct llog_changelog_rec, cr_hdr);
+
+	spin_lock(&mdd->mdd_cl.mc_lock);
+	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
+	spin_unlock(&mdd->mdd_cl.mc_lock);
+
+	rc = llog_osd_ops.lop_write_rec(env, loghandle, hdr, cookie, idx, th);
+	if (rc < 0) {
+		/* give the index back, the record may be retried in the next
+		 * plain llog on -ENOSPC */
+		spin_lock(&mdd->mdd_cl.mc_lock);
+		if (mdd->mdd_cl.mc_index == rec->cr.cr_index)
+			mdd->mdd_cl.mc_index--;
+		spin_unlock(&mdd->mdd_cl.mc_lock);
+	}
+
+	return rc;
+}
+
 static struct llog_operations changelog_orig_logops;
 
 static int
@@ -532,9 +584,7 @@ int mdd_changelog_write_header(const struct lu_env *env,
 					    rec->cr.cr_namelen);
 	rec->cr_hdr.lrh_type = CHANGELOG_REC;
 	rec->cr.cr_time = cl_time();
-	spin_lock(&mdd->mdd_cl.mc_lock);
-	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
-	spin_unlock(&mdd->mdd_cl.mc_lock);
+	rec->cr.cr_index = 0;
 
 	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
 	LASSERT(ctxt);
@@ -1579,6 +1629,7 @@ static int __init mdd_mod_init(void)
 	changelog_orig_logops.lop_cancel = llog_changelog_cancel;
 	changelog_orig_logops.lop_add = llog_cat_add_rec;
 	changelog_orig_logops.lop_declare_add = llog_cat_declare_add_rec;
+	changelog_orig_logops.lop_write_rec = mdd_changelog_write_rec;
 
 	hsm_actions_logops = llog_osd_ops;
 	hsm_actions_logops.lop_add = llog_cat_add_rec;
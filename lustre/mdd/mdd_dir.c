@@ -709,13 +709,9 @@ int mdd_changelog_store(const struct lu_env *env, struct mdd_device *mdd,
 	/* llog_lvfs_write_rec sets the llog tail len */
 	rec->cr_hdr.lrh_type = CHANGELOG_REC;
 	rec->cr.cr_time = cl_time();
-
-	spin_lock(&mdd->mdd_cl.mc_lock);
-	/* NB: I suppose it's possible llog_add adds out of order wrt cr_index,
-	 * but as long as the MDD transactions are ordered correctly for e.g.
-	 * rename conflicts, I don't think this should matter. */
-	rec->cr.cr_index = ++mdd->mdd_cl.mc_index;
-	spin_unlock(&mdd->mdd_cl.mc_lock);
+	/* cr_index is assigned by mdd_changelog_write_rec() under the llog
+	 * lock, so records are appended in index order */
+	rec->cr.cr_index = 0;
 
 	ctxt = llog_get_context(obd, LLOG_CHANGELOG_ORIG_CTXT);
 	if (ctxt == NULL)
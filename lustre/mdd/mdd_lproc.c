@@ -256,6 +256,32 @@ mdd_lfsck_async_windows_seq_write(struct file *file, const char *buffer,
 }
 LPROC_SEQ_FOPS(mdd_lfsck_async_windows);
 
+static int mdd_lfsck_assistant_threads_seq_show(struct seq_file *m, void *data)
+{
+	struct mdd_device *mdd = m->private;
+
+	LASSERT(mdd != NULL);
+	return lfsck_get_threads(m, mdd->mdd_bottom);
+}
+
+static ssize_t
+mdd_lfsck_assistant_threads_seq_write(struct file *file, const char *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file   *m = file->private_data;
+	struct mdd_device *mdd = m->private;
+	__u32		   val;
+	int		   rc;
+
+	LASSERT(mdd != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc == 0)
+		rc = lfsck_set_threads(mdd->mdd_bottom, val);
+
+	return rc != 0 ? rc : count;
+}
+LPROC_SEQ_FOPS(mdd_lfsck_assistant_threads);
+
 static int mdd_lfsck_namespace_seq_show(struct seq_file *m, void *data)
 {
 	struct mdd_device *mdd = m->private;
@@ -289,6 +315,8 @@ static struct lprocfs_vars lprocfs_mdd_obd_vars[] = {
 	  .fops =	&mdd_lfsck_speed_limit_fops	},
 	{ .name =	"lfsck_async_windows",
 	  .fops =	&mdd_lfsck_async_windows_fops	},
+	{ .name =	"lfsck_assistant_threads",
+	  .fops =	&mdd_lfsck_assistant_threads_fops	},
 	{ .name =	"lfsck_namespace",
 	  .fops =	&mdd_lfsck_namespace_fops	},
 	{ .name	=	"lfsck_layout",
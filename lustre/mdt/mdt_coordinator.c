@@ -146,6 +146,79 @@ struct hsm_scan_data {
 	__u64				*cookies;
 };
 
+/**
+ * check if a started request made no progress for too long and if so,
+ * cancel it the same way the copy tool acknowledges a cancel request
+ * \param mti [IN] context
+ * \param larr [IN] request record
+ * \retval 0 request still active
+ * \retval 1 request cleaned, its record has to be set canceled
+ * \retval -ENOENT request no longer exists, its record can be removed
+ */
+static int mdt_coordinator_expire_request(struct mdt_thread_info *mti,
+				const struct llog_agent_req_rec *larr)
+{
+	struct mdt_device		*mdt = mti->mti_mdt;
+	struct coordinator		*cdt = &mdt->mdt_coordinator;
+	struct cdt_agent_req		*car;
+	struct hsm_progress_kernel	 pgs;
+	cfs_time_t			 last;
+	int				 rc;
+	ENTRY;
+
+	/* we search for a running request
+	 * error may happen if coordinator crashes or stopped
+	 * with running request
+	 */
+	car = mdt_cdt_find_request(cdt, larr->arr_hai.hai_cookie, NULL);
+	if (car == NULL) {
+		last = larr->arr_req_create;
+	} else {
+		last = car->car_req_update;
+		mdt_cdt_put_request(car);
+	}
+
+	/* test if request too long, if yes cancel it
+	 * the same way the copy tool acknowledge a cancel request */
+	if ((last + cdt->cdt_active_req_timeout) >= cfs_time_current_sec())
+		RETURN(0);
+
+	dump_llog_agent_req_rec("mdt_coordinator_cb(): request timeouted, "
+				"start cleaning", larr);
+	/* a too old cancel request just needs to be removed
+	 * this can happen, if copy tool does not support cancel
+	 * for other requests, we have to remove the running
+	 * request and notify the copytool
+	 */
+	pgs.hpk_fid = larr->arr_hai.hai_fid;
+	pgs.hpk_cookie = larr->arr_hai.hai_cookie;
+	pgs.hpk_extent = larr->arr_hai.hai_extent;
+	pgs.hpk_flags = HP_FLAG_COMPLETED;
+	pgs.hpk_errval = ENOSYS;
+	pgs.hpk_data_version = 0;
+	/* update request state, but do not record in llog, to
+	 * avoid deadlock on cdt_llog_lock
+	 */
+	rc = mdt_hsm_update_request_state(mti, &pgs, 0);
+	if (rc)
+		CERROR("%s: Cannot cleanup timeouted request: "
+		       DFID" for cookie "LPX64" action=%s\n",
+		       mdt_obd_name(mdt),
+		       PFID(&pgs.hpk_fid), pgs.hpk_cookie,
+		       hsm_copytool_action2name(larr->arr_hai.hai_action));
+
+	if (rc == -ENOENT) {
+		/* The request no longer exists, forget
+		 * about it, and do not send a cancel request
+		 * to the client, for which an error will be
+		 * sent back, leading to an endless cycle of
+		 * cancellation. */
+		RETURN(-ENOENT);
+	}
+
+	RETURN(1);
+}
+
 /**
  *  llog_cat_process() callback, used to:
  *  - find waiting request and start action
@@ -289,63 +362,11 @@ static int mdt_coordinator_cb(const struct lu_env *env,
 		hsd->request[found].hal->hal_count++;
 		break;
 	}
-	case ARS_STARTED: {
-		struct cdt_agent_req *car;
-		cfs_time_t last;
-
-		/* we search for a running request
-		 * error may happen if coordinator crashes or stopped
-		 * with running request
-		 */
-		car = mdt_cdt_find_request(cdt, larr->arr_hai.hai_cookie, NULL);
-		if (car == NULL) {
-			last = larr->arr_req_create;
-		} else {
-			last = car->car_req_update;
-			mdt_cdt_put_request(car);
-		}
-
-		/* test if request too long, if yes cancel it
-		 * the same way the copy tool acknowledge a cancel request */
-		if ((last + cdt->cdt_active_req_timeout)
-		     < cfs_time_current_sec()) {
-			struct hsm_progress_kernel pgs;
-
-			dump_llog_agent_req_rec("mdt_coordinator_cb(): "
-						"request timeouted, start "
-						"cleaning", larr);
-			/* a too old cancel request just needs to be removed
-			 * this can happen, if copy tool does not support cancel
-			 * for other requests, we have to remove the running
-			 * request and notify the copytool
-			 */
-			pgs.hpk_fid = larr->arr_hai.hai_fid;
-			pgs.hpk_cookie = larr->arr_hai.hai_cookie;
-			pgs.hpk_extent = larr->arr_hai.hai_extent;
-			pgs.hpk_flags = HP_FLAG_COMPLETED;
-			pgs.hpk_errval = ENOSYS;
-			pgs.hpk_data_version = 0;
-			/* update request state, but do not record in llog, to
-			 * avoid deadlock on cdt_llog_lock
-			 */
-			rc = mdt_hsm_update_request_state(hsd->mti, &pgs, 0);
-			if (rc)
-				CERROR("%s: Cannot cleanup timeouted request: "
-				       DFID" for cookie "LPX64" action=%s\n",
-				       mdt_obd_name(mdt),
-				       PFID(&pgs.hpk_fid), pgs.hpk_cookie,
-				       hsm_copytool_action2name(
-						     larr->arr_hai.hai_action));
-
-			if (rc == -ENOENT) {
-				/* The request no longer exists, forget
-				 * about it, and do not send a cancel request
-				 * to the client, for which an error will be
-				 * sent back, leading to an endless cycle of
-				 * cancellation. */
-				RETURN(LLOG_DEL_RECORD);
-			}
-
+	case ARS_STARTED:
+		rc = mdt_coordinator_expire_request(hsd->mti, larr);
+		if (rc == -ENOENT)
+			RETURN(LLOG_DEL_RECORD);
+		if (rc == 1) {
 			/* add the cookie to the list of record to be
 			 * canceled by caller */
 			if (hsd->max_cookie == (hsd->cookie_cnt - 1)) {
@@ -376,7 +397,6 @@ static int mdt_coordinator_cb(const struct lu_env *env,
 			hsd->cookie_cnt++;
 		}
 		break;
-	}
 	case ARS_FAILED:
 	case ARS_CANCELED:
 	case ARS_SUCCEED:
@@ -438,6 +458,118 @@ struct lprocfs_vars *hsm_cdt_get_proc_vars(void)
 	return lprocfs_mdt_hsm_vars;
 }
 
+#define CDT_EXPIRE_BATCH	32
+
+/**
+ * cancel started requests which made no progress for too long, using
+ * the action queue instead of a llog scan
+ * \param mti [IN] context
+ */
+static void mdt_coordinator_expire_started(struct mdt_thread_info *mti)
+{
+	struct mdt_device	*mdt = mti->mti_mdt;
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct cdt_queue_entry	*cqe;
+	__u64			 cookies[CDT_EXPIRE_BATCH];
+	int			 cnt = 0, rc;
+	ENTRY;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	list_for_each_entry(cqe, &cdt->cdt_queue.cq_started, cqe_list) {
+		/* an already gone request is canceled too, so the
+		 * record is purged after the grace delay */
+		if (mdt_coordinator_expire_request(mti, &cqe->cqe_larr) == 0)
+			continue;
+
+		cookies[cnt++] = cqe->cqe_larr.arr_hai.hai_cookie;
+		if (cnt == CDT_EXPIRE_BATCH)
+			break;
+	}
+	mutex_unlock(&cdt->cdt_llog_lock);
+
+	if (cnt == 0)
+		RETURN_EXIT;
+
+	rc = mdt_agent_record_update(mti->mti_env, mdt, cookies, cnt,
+				     ARS_CANCELED);
+	if (rc)
+		CERROR("%s: mdt_agent_record_update() failed, rc=%d, cannot "
+		       "update status to %s for %d cookies\n",
+		       mdt_obd_name(mdt), rc,
+		       agent_req_status2name(ARS_CANCELED), cnt);
+	EXIT;
+}
+
+/**
+ * send waiting requests from the action queue to the agents, as long as
+ * agents have free slots
+ * \param mti [IN] context
+ * \param fs_name [IN] file system name
+ */
+static void mdt_coordinator_dispatch(struct mdt_thread_info *mti,
+				     const char *fs_name)
+{
+	struct mdt_device	*mdt = mti->mti_mdt;
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	ENTRY;
+
+	while (1) {
+		struct hsm_action_list	*hal;
+		struct hsm_action_item	*hai;
+		__u64			*cookies;
+		enum agent_req_status	 status;
+		int			 slots, hal_len, sz, i, rc;
+
+		/* still room for work ? */
+		slots = cdt->cdt_max_requests -
+			atomic_read(&cdt->cdt_request_count);
+		if (slots <= 0)
+			break;
+
+		rc = cdt_queue_next_hal(mdt, fs_name, slots, &hal, &hal_len);
+		if (rc != 0 || hal == NULL)
+			break;
+
+		rc = mdt_hsm_agent_send(mti, hal, 0);
+		/* if failure, we suppose it is temporary
+		 * if the copy tool failed to do the request
+		 * it has to use hsm_progress
+		 */
+		status = (rc ? ARS_WAITING : ARS_STARTED);
+
+		sz = hal->hal_count * sizeof(__u64);
+		OBD_ALLOC(cookies, sz);
+		if (cookies == NULL) {
+			CERROR("%s: Cannot allocate memory (%d o) "
+			       "for cookies vector "LPX64"\n",
+			       mdt_obd_name(mdt), sz, hal->hal_compound_id);
+			kuc_free(hal, hal_len);
+			break;
+		}
+		hai = hai_first(hal);
+		for (i = 0; i < hal->hal_count; i++, hai = hai_next(hai))
+			cookies[i] = hai->hai_cookie;
+
+		rc = mdt_agent_record_update(mti->mti_env, mdt, cookies,
+					     hal->hal_count, status);
+		if (rc)
+			CERROR("%s: mdt_agent_record_update() failed, "
+			       "rc=%d, cannot update status to %s "
+			       "for %d cookies\n",
+			       mdt_obd_name(mdt), rc,
+			       agent_req_status2name(status),
+			       hal->hal_count);
+
+		OBD_FREE(cookies, sz);
+		kuc_free(hal, hal_len);
+
+		/* requeued at the tail, retried at next wake up */
+		if (status == ARS_WAITING)
+			break;
+	}
+	EXIT;
+}
+
 /**
  * coordinator thread
  * \param data [IN] obd device
@@ -506,6 +638,15 @@ static int mdt_coordinator(void *data)
 			continue;
 		}
 
+		/* no llog scan when the action queue is in use */
+		if (cdt->cdt_queue.cq_loaded) {
+			mdt_coordinator_expire_started(mti);
+			cdt_queue_purge(mti->mti_env, mdt);
+			if (!list_empty(&cdt->cdt_agents))
+				mdt_coordinator_dispatch(mti, hsd.fs_name);
+			continue;
+		}
+
 		CDEBUG(D_HSM, "coordinator starts reading llog\n");
 
 		if (hsd.max_requests != cdt->cdt_max_requests) {
@@ -807,8 +948,8 @@ static int mdt_hsm_pending_restore(struct mdt_thread_info *mti)
 
 	hrd.hrd_mti = mti;
 
-	rc = cdt_llog_process(mti->mti_env, mti->mti_mdt,
-			      hsm_restore_cb, &hrd);
+	/* the same llog scan loads the action queue */
+	rc = cdt_queue_load(mti->mti_env, mti->mti_mdt, hsm_restore_cb, &hrd);
 
 	RETURN(rc);
 }
@@ -881,6 +1022,7 @@ int mdt_hsm_cdt_init(struct mdt_device *mdt)
 	INIT_LIST_HEAD(&cdt->cdt_requests);
 	INIT_LIST_HEAD(&cdt->cdt_agents);
 	INIT_LIST_HEAD(&cdt->cdt_restore_hdl);
+	cdt_queue_init(cdt);
 
 	rc = lu_env_init(&cdt->cdt_env, LCT_MD_THREAD);
 	if (rc < 0)
@@ -1034,6 +1176,8 @@ int mdt_hsm_cdt_stop(struct mdt_device *mdt)
 	cdt->cdt_state = CDT_STOPPED;
 
 	/* start cleaning */
+	cdt_queue_fini(mdt);
+
 	down_write(&cdt->cdt_request_lock);
 	list_for_each_entry_safe(car, tmp1, &cdt->cdt_requests,
 				 car_request_list) {
@@ -1699,6 +1843,10 @@ static int hsm_cancel_all_actions(struct mdt_device *mdt)
 		OBD_FREE(hal, hal_sz);
 
 	/* cancel all on-disk records */
+	rc = cdt_queue_cancel_all(mti->mti_env, mdt);
+	if (rc != -EAGAIN)
+		GOTO(out, rc);
+
 	hcad.mdt = mdt;
 
 	rc = cdt_llog_process(mti->mti_env, mti->mti_mdt,
@@ -1958,6 +2106,39 @@ GENERATE_PROC_METHOD(cdt_active_req_timeout)
 GENERATE_PROC_METHOD(cdt_max_requests)
 GENERATE_PROC_METHOD(cdt_default_archive_id)
 
+static int mdt_hsm_action_queue_seq_show(struct seq_file *m, void *data)
+{
+	struct mdt_device	*mdt = m->private;
+	struct cdt_queue	*cq = &mdt->mdt_coordinator.cdt_queue;
+	__u64			 avg = 0;
+	ENTRY;
+
+	if (cq->cq_dispatched != 0) {
+		avg = cq->cq_latency_sum;
+		do_div(avg, cq->cq_dispatched);
+	}
+
+	seq_printf(m, "loaded: %s\n"
+		   "waiting_restore: "LPU64"\n"
+		   "waiting_cancel: "LPU64"\n"
+		   "waiting_remove: "LPU64"\n"
+		   "waiting_archive: "LPU64"\n"
+		   "started: "LPU64"\n"
+		   "done: "LPU64"\n"
+		   "dispatched: "LPU64"\n"
+		   "dispatch_latency_avg_ms: "LPU64"\n"
+		   "dispatch_latency_max_ms: "LPU64"\n",
+		   cq->cq_loaded ? "yes" : "no",
+		   cq->cq_waiting_count[CQC_RESTORE],
+		   cq->cq_waiting_count[CQC_CANCEL],
+		   cq->cq_waiting_count[CQC_REMOVE],
+		   cq->cq_waiting_count[CQC_ARCHIVE],
+		   cq->cq_started_count, cq->cq_done_count,
+		   cq->cq_dispatched, avg, cq->cq_latency_max);
+	RETURN(0);
+}
+LPROC_SEQ_FOPS_RO(mdt_hsm_action_queue);
+
 /*
  * procfs write method for MDT/hsm_control
  * proc entry is in mdt directory so data is mdt obd_device pointer
@@ -2219,6 +2400,9 @@ static struct lprocfs_vars lprocfs_mdt_hsm_vars[] = {
 	{ .name	=	"actions",
 	  .fops	=	&mdt_hsm_actions_fops,
 	  .proc_mode =	0444					},
+	{ .name	=	"action_queue",
+	  .fops	=	&mdt_hsm_action_queue_fops,
+	  .proc_mode =	0444					},
 	{ .name	=	"default_archive_id",
 	  .fops	=	&mdt_hsm_cdt_default_archive_id_fops	},
 	{ .name	=	"grace_delay",
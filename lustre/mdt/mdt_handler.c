@@ -782,6 +782,14 @@ int mdt_attr_get_complex(struct mdt_thread_info *info,
 			GOTO(out, rc = rc2);
 	}
 
+	if (need & MA_SOM && S_ISREG(mode)) {
+		rc2 = mdt_lsom_get(info, o, &ma->ma_som);
+		if (rc2 == 0)
+			ma->ma_valid |= MA_SOM;
+		else if (rc2 < 0 && rc2 != -ENODATA)
+			GOTO(out, rc = rc2);
+	}
+
 #ifdef CONFIG_FS_POSIX_ACL
 	if (need & MA_ACL_DEF && S_ISDIR(mode)) {
 		buf->lb_buf = ma->ma_acl;
@@ -874,6 +882,8 @@ static int mdt_getattr_internal(struct mdt_thread_info *info,
 		ma->ma_need = MA_INODE | MA_HSM;
 		if (ma->ma_lmm_size > 0)
 			ma->ma_need |= MA_LOV;
+		if (reqbody->mbo_valid & OBD_MD_FLLAZYSIZE)
+			ma->ma_need |= MA_SOM;
 	}
 
         if (S_ISDIR(lu_object_attr(&next->mo_lu)) &&
@@ -930,6 +940,9 @@ static int mdt_getattr_internal(struct mdt_thread_info *info,
         else
                 RETURN(-EFAULT);
 
+	if (reqbody->mbo_valid & OBD_MD_FLLAZYSIZE)
+		mdt_pack_lsom2body(info, repbody, ma);
+
         if (mdt_body_has_lov(la, reqbody)) {
                 if (ma->ma_valid & MA_LOV) {
                         LASSERT(ma->ma_lmm_size);
@@ -2215,6 +2228,7 @@ int mdt_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 {
         struct obd_device *obd = ldlm_lock_to_ns(lock)->ns_obd;
         struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct ldlm_lock_srv *lsv = lock->l_srv;
         int rc;
         ENTRY;
 
@@ -2227,16 +2241,17 @@ int mdt_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
         }
         if (mdt_cos_is_enabled(mdt) &&
             lock->l_req_mode & (LCK_PW | LCK_EX) &&
-            lock->l_blocking_lock != NULL &&
-            lock->l_client_cookie != lock->l_blocking_lock->l_client_cookie) {
+	    lsv->ls_blocking_lock != NULL &&
+	    lsv->ls_client_cookie !=
+	    lsv->ls_blocking_lock->l_srv->ls_client_cookie) {
                 mdt_set_lock_sync(lock);
         }
         rc = ldlm_blocking_ast_nocheck(lock);
 
-        /* There is no lock conflict if l_blocking_lock == NULL,
+	/* There is no lock conflict if ls_blocking_lock == NULL,
          * it indicates a blocking ast sent from ldlm_lock_decref_internal
          * when the last reference to a local lock was released */
-        if (lock->l_req_mode == LCK_COS && lock->l_blocking_lock != NULL) {
+	if (lock->l_req_mode == LCK_COS && lsv->ls_blocking_lock != NULL) {
                 struct lu_env env;
 
 		rc = lu_env_init(&env, LCT_LOCAL);
@@ -3008,7 +3023,7 @@ mdt_intent_lock_replace(struct mdt_thread_info *info,
 
         cfs_hash_add(new_lock->l_export->exp_lock_hash,
                      &new_lock->l_remote_handle,
-                     &new_lock->l_exp_hash);
+                     &new_lock->l_srv->ls_exp_hash);
 
         LDLM_LOCK_RELEASE(new_lock);
         lh->mlh_reg_lh.cookie = 0;
@@ -4631,6 +4646,7 @@ static struct lu_object *mdt_object_alloc(const struct lu_env *env,
 		spin_lock_init(&mo->mot_write_lock);
 		mutex_init(&mo->mot_lov_mutex);
 		init_rwsem(&mo->mot_open_sem);
+		mutex_init(&mo->mot_som_mutex);
 		RETURN(o);
 	}
 	RETURN(NULL);
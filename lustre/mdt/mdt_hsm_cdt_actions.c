@@ -130,6 +130,7 @@ int mdt_agent_record_add(const struct lu_env *env,
 	struct coordinator		*cdt = &mdt->mdt_coordinator;
 	struct llog_ctxt		*lctxt = NULL;
 	struct llog_agent_req_rec	*larr;
+	struct llog_cookie		 cookie;
 	int				 rc;
 	int				 sz;
 	ENTRY;
@@ -162,10 +163,18 @@ int mdt_agent_record_add(const struct lu_env *env,
 		hai->hai_cookie = cdt->cdt_last_cookie;
 	}
 	larr->arr_hai.hai_cookie = hai->hai_cookie;
-	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, NULL);
+	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, &cookie);
 	if (rc > 0)
 		rc = 0;
 
+	if (rc == 0) {
+		/* llog and action queue have to stay in sync */
+		rc = cdt_queue_add(cdt, larr, &cookie);
+		if (rc < 0)
+			llog_cat_cancel_records(env, lctxt->loc_handle, 1,
+						&cookie);
+	}
+
 	mutex_unlock(&cdt->cdt_llog_lock);
 	llog_ctxt_put(lctxt);
 
@@ -269,6 +278,9 @@ int mdt_agent_record_update(const struct lu_env *env, struct mdt_device *mdt,
 			    __u64 *cookies, int cookies_count,
 			    enum agent_req_status status)
 {
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct llog_ctxt	*lctxt;
 	struct data_update_cb	 ducb;
 	int			 rc;
 	ENTRY;
@@ -280,13 +292,31 @@ int mdt_agent_record_update(const struct lu_env *env, struct mdt_device *mdt,
 	ducb.status = status;
 	ducb.change_time = cfs_time_current_sec();
 
-	rc = cdt_llog_process(env, mdt, mdt_agent_record_update_cb, &ducb);
-	if (rc < 0)
-		CERROR("%s: cdt_llog_process() failed, rc=%d, cannot update "
-		       "status to %s for %d cookies, done %d\n",
-		       mdt_obd_name(mdt), rc,
-		       agent_req_status2name(status),
-		       cookies_count, ducb.cookies_done);
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL)
+		RETURN(-ENOENT);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+
+	/* the action queue knows where the records are, if it is not
+	 * loaded the llog has to be scanned */
+	rc = cdt_queue_update(env, mdt, lctxt->loc_handle, cookies,
+			      cookies_count, status, ducb.change_time);
+	if (rc == -EAGAIN) {
+		rc = llog_cat_process(env, lctxt->loc_handle,
+				      mdt_agent_record_update_cb, &ducb, 0, 0);
+		if (rc < 0)
+			CERROR("%s: llog_cat_process() failed, rc=%d, cannot "
+			       "update status to %s for %d cookies, done %d\n",
+			       mdt_obd_name(mdt), rc,
+			       agent_req_status2name(status),
+			       cookies_count, ducb.cookies_done);
+		else
+			rc = 0;
+	}
+
+	mutex_unlock(&cdt->cdt_llog_lock);
+	llog_ctxt_put(lctxt);
 	RETURN(rc);
 }
 
@@ -155,6 +155,30 @@ static int hsm_find_compatible(const struct lu_env *env, struct mdt_device *mdt,
 	hcdcb.cdt = &mdt->mdt_coordinator;
 	hcdcb.hal = hal;
 
+	/* the action queue indexes waiting and started requests by FID */
+	mutex_lock(&hcdcb.cdt->cdt_llog_lock);
+	if (hcdcb.cdt->cdt_queue.cq_loaded) {
+		struct llog_agent_req_rec	*larr;
+		struct hsm_action_item		*next;
+
+		/* the callback may overwrite hai */
+		hai = hai_first(hal);
+		for (i = 0; i < hal->hal_count; i++, hai = next) {
+			next = hai_next(hai);
+			if (hai->hai_action == HSMA_CANCEL &&
+			    hai->hai_cookie != 0)
+				continue;
+
+			larr = cdt_queue_find_fid(hcdcb.cdt, &hai->hai_fid);
+			if (larr != NULL)
+				hsm_find_compatible_cb(env, NULL,
+						       &larr->arr_hdr, &hcdcb);
+		}
+		mutex_unlock(&hcdcb.cdt->cdt_llog_lock);
+		RETURN(0);
+	}
+	mutex_unlock(&hcdcb.cdt->cdt_llog_lock);
+
 	rc = cdt_llog_process(env, mdt, hsm_find_compatible_cb, &hcdcb);
 
 	RETURN(rc);
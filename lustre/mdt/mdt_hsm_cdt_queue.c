@@ -0,0 +1,826 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * Copyright (c) 2015, Intel Corporation.
+ */
+/*
+ * lustre/mdt/mdt_hsm_cdt_queue.c
+ *
+ * Lustre HSM coordinator action queue
+ *
+ * In-memory index of the HSM action llog. Records are kept on a waiting
+ * list per class and archive id, on a started list or on a done list, and
+ * are hashed by cookie and by FID, so the coordinator finds work and
+ * updates records without scanning the whole llog. The queue is loaded
+ * from the llog when the coordinator starts and then follows every llog
+ * update. If it cannot be loaded, the llog is scanned as before.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include <obd_support.h>
+#include <lustre/lustre_user.h>
+#include <lustre_log.h>
+#include <lprocfs_status.h>
+#include "mdt_internal.h"
+
+#define CDT_QUEUE_HASH_SIZE	(1 << CDT_QUEUE_HASH_BITS)
+
+static inline int cdt_queue_entry_size(int rec_len)
+{
+	return offsetof(struct cdt_queue_entry, cqe_larr) + rec_len;
+}
+
+static inline struct hlist_head *cdt_queue_cookie_head(struct cdt_queue *cq,
+						       __u64 cookie)
+{
+	return &cq->cq_cookie_hash[hash_long((unsigned long)cookie,
+					     CDT_QUEUE_HASH_BITS)];
+}
+
+static inline struct hlist_head *cdt_queue_fid_head(struct cdt_queue *cq,
+						    const struct lu_fid *fid)
+{
+	return &cq->cq_fid_hash[fid_hash(fid, CDT_QUEUE_HASH_BITS)];
+}
+
+static enum cdt_queue_class cdt_queue_class(const struct hsm_action_item *hai)
+{
+	switch (hai->hai_action) {
+	case HSMA_RESTORE:
+		return CQC_RESTORE;
+	case HSMA_CANCEL:
+		return CQC_CANCEL;
+	case HSMA_REMOVE:
+		return CQC_REMOVE;
+	default:
+		return CQC_ARCHIVE;
+	}
+}
+
+/**
+ * put an entry on the list matching its record status
+ * \param cq [IN] queue
+ * \param cqe [IN] entry
+ */
+static void cdt_queue_link(struct cdt_queue *cq, struct cdt_queue_entry *cqe)
+{
+	struct llog_agent_req_rec	*larr = &cqe->cqe_larr;
+	enum cdt_queue_class		 class;
+
+	switch (larr->arr_status) {
+	case ARS_WAITING:
+		class = cdt_queue_class(&larr->arr_hai);
+		list_add_tail(&cqe->cqe_list,
+			      &cq->cq_waiting[class][larr->arr_archive_id %
+						     CDT_QUEUE_ARCHIVES]);
+		cq->cq_waiting_count[class]++;
+		break;
+	case ARS_STARTED:
+		list_add_tail(&cqe->cqe_list, &cq->cq_started);
+		cq->cq_started_count++;
+		break;
+	default:
+		/* final records are only kept until they are purged */
+		list_add_tail(&cqe->cqe_list, &cq->cq_done);
+		cq->cq_done_count++;
+		if (!hlist_unhashed(&cqe->cqe_fid_hash))
+			hlist_del_init(&cqe->cqe_fid_hash);
+		break;
+	}
+}
+
+/**
+ * remove an entry from its status list
+ * \param cq [IN] queue
+ * \param cqe [IN] entry
+ */
+static void cdt_queue_unlink(struct cdt_queue *cq, struct cdt_queue_entry *cqe)
+{
+	struct llog_agent_req_rec *larr = &cqe->cqe_larr;
+
+	switch (larr->arr_status) {
+	case ARS_WAITING:
+		cq->cq_waiting_count[cdt_queue_class(&larr->arr_hai)]--;
+		break;
+	case ARS_STARTED:
+		cq->cq_started_count--;
+		break;
+	default:
+		cq->cq_done_count--;
+		break;
+	}
+	list_del_init(&cqe->cqe_list);
+}
+
+/**
+ * allocate an entry for a llog record and index it
+ * \param cq [IN] queue
+ * \param larr [IN] record
+ * \param cookie [IN] location of the record in the llog
+ * \retval 0 success
+ * \retval -ve failure
+ */
+static int cdt_queue_insert(struct cdt_queue *cq,
+			    const struct llog_agent_req_rec *larr,
+			    const struct llog_cookie *cookie)
+{
+	struct cdt_queue_entry *cqe;
+
+	if (larr->arr_hdr.lrh_len < sizeof(*larr))
+		return -EINVAL;
+
+	OBD_ALLOC(cqe, cdt_queue_entry_size(larr->arr_hdr.lrh_len));
+	if (cqe == NULL)
+		return -ENOMEM;
+
+	memcpy(&cqe->cqe_larr, larr, larr->arr_hdr.lrh_len);
+	cqe->cqe_llog_cookie = *cookie;
+	cqe->cqe_seq = ++cq->cq_seq;
+	cqe->cqe_queued = cfs_time_current();
+	INIT_LIST_HEAD(&cqe->cqe_list);
+	hlist_add_head(&cqe->cqe_cookie_hash,
+		       cdt_queue_cookie_head(cq, larr->arr_hai.hai_cookie));
+	hlist_add_head(&cqe->cqe_fid_hash,
+		       cdt_queue_fid_head(cq, &larr->arr_hai.hai_fid));
+	cdt_queue_link(cq, cqe);
+
+	return 0;
+}
+
+/**
+ * unindex and free an entry
+ * \param cq [IN] queue
+ * \param cqe [IN] entry
+ */
+static void cdt_queue_free(struct cdt_queue *cq, struct cdt_queue_entry *cqe)
+{
+	cdt_queue_unlink(cq, cqe);
+	hlist_del(&cqe->cqe_cookie_hash);
+	if (!hlist_unhashed(&cqe->cqe_fid_hash))
+		hlist_del(&cqe->cqe_fid_hash);
+	OBD_FREE(cqe, cdt_queue_entry_size(cqe->cqe_larr.arr_hdr.lrh_len));
+}
+
+/**
+ * write a record with its new status at the end of the llog and cancel
+ * the old one, the same way mdt_agent_llog_update_rec() callers do
+ * \param env [IN] environment
+ * \param cq [IN] queue
+ * \param cathandle [IN] action llog catalog
+ * \param cqe [IN] entry to update
+ * \param status [IN] new status
+ * \param change_time [IN] status change time
+ * \retval 0 success
+ * \retval -ve failure, record and entry are unchanged
+ */
+static int cdt_queue_rewrite(const struct lu_env *env, struct cdt_queue *cq,
+			     struct llog_handle *cathandle,
+			     struct cdt_queue_entry *cqe,
+			     enum agent_req_status status, __u64 change_time)
+{
+	struct llog_agent_req_rec	*larr = &cqe->cqe_larr;
+	struct llog_rec_hdr		 saved_hdr = larr->arr_hdr;
+	enum agent_req_status		 old_status = larr->arr_status;
+	__u64				 old_change = larr->arr_req_change;
+	struct llog_cookie		 cookie;
+	int				 rc;
+
+	cdt_queue_unlink(cq, cqe);
+
+	larr->arr_status = status;
+	larr->arr_req_change = change_time;
+	larr->arr_hdr.lrh_id = 0;
+	larr->arr_hdr.lrh_index = 0;
+	rc = llog_cat_add(env, cathandle, &larr->arr_hdr, &cookie);
+	larr->arr_hdr = saved_hdr;
+	if (rc < 0) {
+		larr->arr_status = old_status;
+		larr->arr_req_change = old_change;
+		cdt_queue_link(cq, cqe);
+		return rc;
+	}
+
+	/* a failure only leaves the old record behind, as a failed
+	 * LLOG_DEL_RECORD would */
+	llog_cat_cancel_records(env, cathandle, 1, &cqe->cqe_llog_cookie);
+
+	if (old_status == ARS_WAITING && status == ARS_STARTED) {
+		__u64 latency;
+
+		latency = jiffies_to_msecs(cfs_time_sub(cfs_time_current(),
+							cqe->cqe_queued));
+		cq->cq_dispatched++;
+		cq->cq_latency_sum += latency;
+		if (latency > cq->cq_latency_max)
+			cq->cq_latency_max = latency;
+	} else if (old_status != ARS_WAITING && status == ARS_WAITING) {
+		cqe->cqe_queued = cfs_time_current();
+	}
+
+	cqe->cqe_llog_cookie = cookie;
+	cqe->cqe_seq = ++cq->cq_seq;
+	cdt_queue_link(cq, cqe);
+
+	return 0;
+}
+
+/**
+ * find the oldest record with a cookie which can take a new status,
+ * following the rules of mdt_agent_record_update_cb()
+ * \param cq [IN] queue
+ * \param cookie [IN] request cookie
+ * \param status [IN] new status
+ * \retval entry found or NULL
+ */
+static struct cdt_queue_entry *cdt_queue_find(struct cdt_queue *cq,
+					      __u64 cookie,
+					      enum agent_req_status status)
+{
+	struct cdt_queue_entry		*cqe;
+	struct cdt_queue_entry		*found = NULL;
+	struct hlist_node __maybe_unused *pos;
+
+	cfs_hlist_for_each_entry(cqe, pos, cdt_queue_cookie_head(cq, cookie),
+				 cqe_cookie_hash) {
+		struct llog_agent_req_rec *larr = &cqe->cqe_larr;
+
+		if (larr->arr_hai.hai_cookie != cookie)
+			continue;
+		if (agent_req_in_final_state(larr->arr_status) ||
+		    (larr->arr_hai.hai_action == HSMA_CANCEL &&
+		     status == ARS_CANCELED))
+			continue;
+		if (found == NULL || cqe->cqe_seq < found->cqe_seq)
+			found = cqe;
+	}
+
+	return found;
+}
+
+/**
+ * find the last logged waiting or started request on a FID, cancel
+ * requests excluded
+ * cdt_llog_lock must be held
+ * \param cdt [IN] coordinator
+ * \param fid [IN] FID
+ * \retval record or NULL if none
+ */
+struct llog_agent_req_rec *cdt_queue_find_fid(struct coordinator *cdt,
+					      const struct lu_fid *fid)
+{
+	struct cdt_queue		*cq = &cdt->cdt_queue;
+	struct cdt_queue_entry		*cqe;
+	struct cdt_queue_entry		*found = NULL;
+	struct hlist_node __maybe_unused *pos;
+
+	cfs_hlist_for_each_entry(cqe, pos, cdt_queue_fid_head(cq, fid),
+				 cqe_fid_hash) {
+		if (!lu_fid_eq(&cqe->cqe_larr.arr_hai.hai_fid, fid) ||
+		    cqe->cqe_larr.arr_hai.hai_action == HSMA_CANCEL)
+			continue;
+		if (found == NULL || cqe->cqe_seq > found->cqe_seq)
+			found = cqe;
+	}
+
+	return found != NULL ? &found->cqe_larr : NULL;
+}
+
+/**
+ * free all entries and the hash tables
+ * cdt_llog_lock must be held
+ * \param cq [IN] queue
+ */
+static void cdt_queue_free_all(struct cdt_queue *cq)
+{
+	struct cdt_queue_entry	*cqe, *tmp;
+	int			 i, j;
+
+	for (i = 0; i < CQC_NR; i++)
+		for (j = 0; j < CDT_QUEUE_ARCHIVES; j++)
+			list_for_each_entry_safe(cqe, tmp, &cq->cq_waiting[i][j],
+						 cqe_list)
+				cdt_queue_free(cq, cqe);
+	list_for_each_entry_safe(cqe, tmp, &cq->cq_started, cqe_list)
+		cdt_queue_free(cq, cqe);
+	list_for_each_entry_safe(cqe, tmp, &cq->cq_done, cqe_list)
+		cdt_queue_free(cq, cqe);
+
+	if (cq->cq_cookie_hash != NULL)
+		OBD_FREE_LARGE(cq->cq_cookie_hash,
+			       CDT_QUEUE_HASH_SIZE * sizeof(struct hlist_head));
+	if (cq->cq_fid_hash != NULL)
+		OBD_FREE_LARGE(cq->cq_fid_hash,
+			       CDT_QUEUE_HASH_SIZE * sizeof(struct hlist_head));
+	cq->cq_cookie_hash = NULL;
+	cq->cq_fid_hash = NULL;
+	cq->cq_loaded = false;
+}
+
+/**
+ * initialize an empty, not loaded, queue
+ * \param cdt [IN] coordinator
+ */
+void cdt_queue_init(struct coordinator *cdt)
+{
+	struct cdt_queue	*cq = &cdt->cdt_queue;
+	int			 i, j;
+
+	memset(cq, 0, sizeof(*cq));
+	for (i = 0; i < CQC_NR; i++)
+		for (j = 0; j < CDT_QUEUE_ARCHIVES; j++)
+			INIT_LIST_HEAD(&cq->cq_waiting[i][j]);
+	INIT_LIST_HEAD(&cq->cq_started);
+	INIT_LIST_HEAD(&cq->cq_done);
+}
+
+/**
+ * free the queue content, the llog is used again
+ * \param mdt [IN] MDT device
+ */
+void cdt_queue_fini(struct mdt_device *mdt)
+{
+	struct coordinator *cdt = &mdt->mdt_coordinator;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	cdt_queue_free_all(&cdt->cdt_queue);
+	mutex_unlock(&cdt->cdt_llog_lock);
+}
+
+/**
+ * data passed to llog_cat_process() callback
+ * to load the queue
+ */
+struct cdt_queue_load_data {
+	struct coordinator	*cqld_cdt;
+	llog_cb_t		 cqld_cb;
+	void			*cqld_data;
+	int			 cqld_rc;
+};
+
+/**
+ *  llog_cat_process() callback, used to:
+ *  - call the caller callback
+ *  - index the record
+ * \param env [IN] environment
+ * \param llh [IN] llog handle
+ * \param hdr [IN] llog record
+ * \param data [IN/OUT] cb data = struct cdt_queue_load_data
+ * \retval 0 success
+ * \retval -ve failure
+ */
+static int cdt_queue_load_cb(const struct lu_env *env,
+			     struct llog_handle *llh,
+			     struct llog_rec_hdr *hdr, void *data)
+{
+	struct cdt_queue_load_data	*cqld = data;
+	struct llog_cookie		 cookie;
+	int				 rc;
+	ENTRY;
+
+	if (cqld->cqld_cb != NULL) {
+		rc = cqld->cqld_cb(env, llh, hdr, cqld->cqld_data);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
+	/* keep on calling the caller callback even if the queue cannot
+	 * be used */
+	if (cqld->cqld_rc != 0 || hdr->lrh_type != HSM_AGENT_REC)
+		RETURN(0);
+
+	memset(&cookie, 0, sizeof(cookie));
+	cookie.lgc_lgl = llh->lgh_id;
+	cookie.lgc_index = hdr->lrh_index;
+	cqld->cqld_rc = cdt_queue_insert(&cqld->cqld_cdt->cdt_queue,
+					 (struct llog_agent_req_rec *)hdr,
+					 &cookie);
+	RETURN(0);
+}
+
+/**
+ * process the actions llog and load the queue from it
+ * records added or updated meanwhile are serialized by cdt_llog_lock, so
+ * the queue is in sync with the llog once loaded
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param cb [IN] llog callback called for each record, can be NULL
+ * \param data [IN] llog callback data
+ * \retval 0 success, queue may still be unloaded if out of memory
+ * \retval -ve failure
+ */
+int cdt_queue_load(const struct lu_env *env, struct mdt_device *mdt,
+		   llog_cb_t cb, void *data)
+{
+	struct obd_device		*obd = mdt2obd_dev(mdt);
+	struct coordinator		*cdt = &mdt->mdt_coordinator;
+	struct cdt_queue		*cq = &cdt->cdt_queue;
+	struct cdt_queue_load_data	 cqld;
+	struct llog_ctxt		*lctxt;
+	int				 rc;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL) {
+		llog_ctxt_put(lctxt);
+		RETURN(-ENOENT);
+	}
+
+	cqld.cqld_cdt = cdt;
+	cqld.cqld_cb = cb;
+	cqld.cqld_data = data;
+	cqld.cqld_rc = 0;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+
+	cdt_queue_free_all(cq);
+	cdt_queue_init(cdt);
+	OBD_ALLOC_LARGE(cq->cq_cookie_hash,
+			CDT_QUEUE_HASH_SIZE * sizeof(struct hlist_head));
+	OBD_ALLOC_LARGE(cq->cq_fid_hash,
+			CDT_QUEUE_HASH_SIZE * sizeof(struct hlist_head));
+	if (cq->cq_cookie_hash == NULL || cq->cq_fid_hash == NULL)
+		cqld.cqld_rc = -ENOMEM;
+
+	rc = llog_cat_process(env, lctxt->loc_handle, cdt_queue_load_cb,
+			      &cqld, 0, 0);
+	if (rc < 0) {
+		CERROR("%s: failed to process HSM_ACTIONS llog (rc=%d)\n",
+		       mdt_obd_name(mdt), rc);
+	} else {
+		rc = 0;
+		if (cqld.cqld_rc != 0)
+			CWARN("%s: cannot load HSM action queue, the llog will "
+			      "be scanned instead: rc = %d\n",
+			      mdt_obd_name(mdt), cqld.cqld_rc);
+	}
+
+	if (rc == 0 && cqld.cqld_rc == 0) {
+		cq->cq_loaded = true;
+		CDEBUG(D_HSM, "%s: HSM action queue loaded, "LPU64" records\n",
+		       mdt_obd_name(mdt), cq->cq_seq);
+	} else {
+		cdt_queue_free_all(cq);
+	}
+
+	mutex_unlock(&cdt->cdt_llog_lock);
+	llog_ctxt_put(lctxt);
+	RETURN(rc);
+}
+
+/**
+ * index a record just added to the llog
+ * cdt_llog_lock must be held
+ * \param cdt [IN] coordinator
+ * \param larr [IN] record
+ * \param cookie [IN] location of the record in the llog
+ * \retval 0 success, or queue not loaded
+ * \retval -ve failure, caller has to cancel the record
+ */
+int cdt_queue_add(struct coordinator *cdt,
+		  const struct llog_agent_req_rec *larr,
+		  const struct llog_cookie *cookie)
+{
+	if (!cdt->cdt_queue.cq_loaded)
+		return 0;
+
+	return cdt_queue_insert(&cdt->cdt_queue, larr, cookie);
+}
+
+/**
+ * update the status of records found by cookie
+ * cdt_llog_lock must be held
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param cathandle [IN] action llog catalog
+ * \param cookies [IN] request cookies
+ * \param cookies_count [IN] number of cookies
+ * \param status [IN] new status
+ * \param change_time [IN] status change time
+ * \retval 0 success
+ * \retval -EAGAIN queue not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+int cdt_queue_update(const struct lu_env *env, struct mdt_device *mdt,
+		     struct llog_handle *cathandle, __u64 *cookies,
+		     int cookies_count, enum agent_req_status status,
+		     __u64 change_time)
+{
+	struct cdt_queue	*cq = &mdt->mdt_coordinator.cdt_queue;
+	int			 i, rc = 0, rc1;
+	ENTRY;
+
+	if (!cq->cq_loaded)
+		RETURN(-EAGAIN);
+
+	for (i = 0; i < cookies_count; i++) {
+		struct cdt_queue_entry *cqe;
+
+		/* records in a final state are not changed */
+		cqe = cdt_queue_find(cq, cookies[i], status);
+		if (cqe == NULL)
+			continue;
+
+		rc1 = cdt_queue_rewrite(env, cq, cathandle, cqe, status,
+					change_time);
+		if (rc1 < 0) {
+			CERROR("%s: cannot update status to %s for cookie "
+			       LPX64": rc = %d\n", mdt_obd_name(mdt),
+			       agent_req_status2name(status), cookies[i], rc1);
+			if (rc == 0)
+				rc = rc1;
+		}
+	}
+	RETURN(rc);
+}
+
+/**
+ * set all waiting and started records canceled
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -EAGAIN queue not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+int cdt_queue_cancel_all(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct cdt_queue	*cq = &cdt->cdt_queue;
+	struct cdt_queue_entry	*cqe, *tmp;
+	struct llog_ctxt	*lctxt;
+	__u64			 now = cfs_time_current_sec();
+	int			 i, j, rc = 0, rc1;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL) {
+		llog_ctxt_put(lctxt);
+		RETURN(-ENOENT);
+	}
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cq->cq_loaded)
+		GOTO(out, rc = -EAGAIN);
+
+	for (i = 0; i < CQC_NR; i++) {
+		for (j = 0; j < CDT_QUEUE_ARCHIVES; j++) {
+			list_for_each_entry_safe(cqe, tmp,
+						 &cq->cq_waiting[i][j],
+						 cqe_list) {
+				rc1 = cdt_queue_rewrite(env, cq,
+							lctxt->loc_handle,
+							cqe, ARS_CANCELED, now);
+				if (rc1 < 0 && rc == 0)
+					rc = rc1;
+			}
+		}
+	}
+	list_for_each_entry_safe(cqe, tmp, &cq->cq_started, cqe_list) {
+		rc1 = cdt_queue_rewrite(env, cq, lctxt->loc_handle, cqe,
+					ARS_CANCELED, now);
+		if (rc1 < 0 && rc == 0)
+			rc = rc1;
+	}
+	EXIT;
+out:
+	mutex_unlock(&cdt->cdt_llog_lock);
+	llog_ctxt_put(lctxt);
+	return rc;
+}
+
+#define CDT_QUEUE_PURGE_BATCH	64
+
+/**
+ * cancel the llog records which are in a final state for more than
+ * cdt_grace_delay
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -EAGAIN queue not loaded, the llog has to be scanned
+ * \retval -ve failure, requests whose records are still in the llog stay
+ *		queued
+ */
+int cdt_queue_purge(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct cdt_queue	*cq = &cdt->cdt_queue;
+	struct cdt_queue_entry	*cqe, *tmp;
+	struct llog_cookie	*cookies;
+	struct llog_ctxt	*lctxt;
+	__u64			 now = cfs_time_current_sec();
+	int			 count, kept = 0;
+	int			 rc = 0, rc2;
+	ENTRY;
+
+	if (list_empty(&cq->cq_done))
+		RETURN(0);
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL) {
+		llog_ctxt_put(lctxt);
+		RETURN(-ENOENT);
+	}
+
+	OBD_ALLOC(cookies, CDT_QUEUE_PURGE_BATCH * sizeof(*cookies));
+	if (cookies == NULL)
+		GOTO(out_ctxt, rc = -ENOMEM);
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cq->cq_loaded)
+		GOTO(out, rc = -EAGAIN);
+
+	do {
+		/* done list is ordered by change time */
+		count = 0;
+		list_for_each_entry(cqe, &cq->cq_done, cqe_list) {
+			if (cqe->cqe_larr.arr_req_change +
+			    cdt->cdt_grace_delay >= now ||
+			    count == CDT_QUEUE_PURGE_BATCH)
+				break;
+			cookies[count++] = cqe->cqe_llog_cookie;
+		}
+		if (count == 0)
+			break;
+
+		rc = llog_cat_cancel_records(env, lctxt->loc_handle, count,
+					     cookies);
+		list_for_each_entry_safe(cqe, tmp, &cq->cq_done, cqe_list) {
+			if (count-- == 0)
+				break;
+			/* the batch failed part way, find out which records
+			 * are still in the llog and keep them in memory too,
+			 * so the llog and the queue stay in sync and the
+			 * next purge retries them */
+			if (rc != 0 && rc != -ENOENT) {
+				rc2 = llog_cat_cancel_records(env,
+							lctxt->loc_handle, 1,
+							&cqe->cqe_llog_cookie);
+				if (rc2 != 0 && rc2 != -ENOENT) {
+					kept++;
+					continue;
+				}
+			}
+			cdt_queue_free(cq, cqe);
+		}
+		/* all records of the failed batch are gone after all */
+		if (rc != 0 && rc != -ENOENT && kept == 0)
+			rc = 0;
+	} while (rc == 0 || rc == -ENOENT);
+
+	if (kept > 0)
+		CERROR("%s: cannot cancel %d done requests, kept: rc = %d\n",
+		       mdt_obd_name(mdt), kept, rc);
+	EXIT;
+out:
+	mutex_unlock(&cdt->cdt_llog_lock);
+	OBD_FREE(cookies, CDT_QUEUE_PURGE_BATCH * sizeof(*cookies));
+out_ctxt:
+	llog_ctxt_put(lctxt);
+	return rc == -ENOENT ? 0 : rc;
+}
+
+/**
+ * check if a waiting record can be sent in the same action list as
+ * another one
+ */
+static bool cdt_queue_same_hal(const struct llog_agent_req_rec *first,
+			       const struct llog_agent_req_rec *larr)
+{
+	return larr->arr_compound_id == first->arr_compound_id &&
+	       larr->arr_archive_id == first->arr_archive_id &&
+	       larr->arr_flags == first->arr_flags;
+}
+
+/**
+ * build the next action list to send to an agent
+ * restores are served first, then cancels, removes and archives. Within a
+ * class, archive ids are served round robin, skipping the ones no agent
+ * serves, and records in llog order. An action list holds consecutive
+ * records of the same compound, archive id and flags.
+ * \param mdt [IN] MDT device
+ * \param fs_name [IN] file system name
+ * \param max_count [IN] max number of actions in the list
+ * \param hal [OUT] kuc allocated action list, NULL if nothing to send
+ * \param hal_len [OUT] size of the action list
+ * \retval 0 success
+ * \retval -EAGAIN queue not loaded, the llog has to be scanned
+ * \retval -ve failure
+ */
+int cdt_queue_next_hal(struct mdt_device *mdt, const char *fs_name,
+		       int max_count, struct hsm_action_list **hal,
+		       int *hal_len)
+{
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	struct cdt_queue	*cq = &cdt->cdt_queue;
+	struct cdt_queue_entry	*first = NULL, *cqe;
+	struct list_head	*head = NULL;
+	struct hsm_action_item	*hai;
+	struct obd_uuid		 uuid;
+	int			 class, i, count, len, rc = 0;
+	ENTRY;
+
+	*hal = NULL;
+	*hal_len = 0;
+
+	mutex_lock(&cdt->cdt_llog_lock);
+	if (!cq->cq_loaded)
+		GOTO(out, rc = -EAGAIN);
+
+	for (class = 0; class < CQC_NR && first == NULL; class++) {
+		if (cq->cq_waiting_count[class] == 0)
+			continue;
+
+		for (i = 0; i < CDT_QUEUE_ARCHIVES; i++) {
+			int archive;
+
+			archive = (cq->cq_next_archive[class] + i) %
+				  CDT_QUEUE_ARCHIVES;
+			head = &cq->cq_waiting[class][archive];
+			if (list_empty(head))
+				continue;
+
+			cqe = list_entry(head->next, struct cdt_queue_entry,
+					 cqe_list);
+			/* do not hold other archives back */
+			if (mdt_hsm_find_best_agent(cdt,
+					cqe->cqe_larr.arr_archive_id,
+					&uuid) != 0)
+				continue;
+
+			cq->cq_next_archive[class] = archive + 1;
+			first = cqe;
+			break;
+		}
+	}
+	if (first == NULL)
+		GOTO(out, rc = 0);
+
+	/* a cancel is sent to the agent running the request it cancels,
+	 * so cancels are not grouped */
+	if (first->cqe_larr.arr_hai.hai_action == HSMA_CANCEL)
+		max_count = 1;
+
+	count = 0;
+	len = sizeof(**hal) + cfs_size_round(strlen(fs_name) + 1);
+	cqe = first;
+	list_for_each_entry_from(cqe, head, cqe_list) {
+		if (count == max_count ||
+		    !cdt_queue_same_hal(&first->cqe_larr, &cqe->cqe_larr))
+			break;
+		len += cfs_size_round(cqe->cqe_larr.arr_hai.hai_len);
+		count++;
+	}
+
+	*hal = kuc_alloc(len, KUC_TRANSPORT_HSM, HMT_ACTION_LIST);
+	if (IS_ERR(*hal)) {
+		rc = PTR_ERR(*hal);
+		*hal = NULL;
+		CERROR("%s: Cannot allocate memory (%d o) for compound "LPX64
+		       "\n", mdt_obd_name(mdt), len,
+		       first->cqe_larr.arr_compound_id);
+		GOTO(out, rc);
+	}
+
+	(*hal)->hal_version = HAL_VERSION;
+	strlcpy((*hal)->hal_fsname, fs_name, MTI_NAME_MAXLEN + 1);
+	(*hal)->hal_compound_id = first->cqe_larr.arr_compound_id;
+	(*hal)->hal_archive_id = first->cqe_larr.arr_archive_id;
+	(*hal)->hal_flags = first->cqe_larr.arr_flags;
+	(*hal)->hal_count = count;
+	*hal_len = len;
+
+	hai = hai_first(*hal);
+	cqe = first;
+	list_for_each_entry_from(cqe, head, cqe_list) {
+		if (count-- == 0)
+			break;
+		memcpy(hai, &cqe->cqe_larr.arr_hai,
+		       cqe->cqe_larr.arr_hai.hai_len);
+		hai = hai_next(hai);
+	}
+	EXIT;
+out:
+	mutex_unlock(&cdt->cdt_llog_lock);
+	return rc;
+}
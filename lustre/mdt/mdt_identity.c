@@ -91,58 +91,73 @@ static void mdt_identity_entry_free(struct upcall_cache *cache,
 	}
 }
 
+/* invoke the upcall as "upcall mdtname uid [uid ...]" for @nkeys uids */
 static int mdt_identity_do_upcall(struct upcall_cache *cache,
-                                  struct upcall_cache_entry *entry)
+				  __u64 *keys, int nkeys)
 {
-        char keystr[16];
-        char *argv[] = {
-                  [0] = cache->uc_upcall,
-                  [1] = cache->uc_name,
-                  [2] = keystr,
-                  [3] = NULL
-        };
-        char *envp[] = {
-                  [0] = "HOME=/",
-                  [1] = "PATH=/sbin:/usr/sbin",
-                  [2] = NULL
-        };
-        struct timeval start, end;
-        int rc;
-        ENTRY;
+	char (*keystr)[16];
+	char **argv;
+	char *envp[] = {
+		  [0] = "HOME=/",
+		  [1] = "PATH=/sbin:/usr/sbin",
+		  [2] = NULL
+	};
+	struct timeval start, end;
+	int i, rc;
+	ENTRY;
+
+	LASSERT(nkeys > 0 && nkeys <= UC_CACHE_BATCH_MAX);
+
+	OBD_ALLOC(keystr, nkeys * sizeof(*keystr));
+	if (keystr == NULL)
+		RETURN(-ENOMEM);
+
+	OBD_ALLOC(argv, (nkeys + 3) * sizeof(*argv));
+	if (argv == NULL) {
+		OBD_FREE(keystr, nkeys * sizeof(*keystr));
+		RETURN(-ENOMEM);
+	}
 
-        /* There is race condition:
-         * "uc_upcall" was changed just after "is_identity_get_disabled" check.
-         */
+	/* There is race condition:
+	 * "uc_upcall" was changed just after "is_identity_get_disabled" check.
+	 */
 	read_lock(&cache->uc_upcall_rwlock);
-        CDEBUG(D_INFO, "The upcall is: '%s'\n", cache->uc_upcall);
+	CDEBUG(D_INFO, "The upcall is: '%s'\n", cache->uc_upcall);
 
-        if (unlikely(!strcmp(cache->uc_upcall, "NONE"))) {
-                CERROR("no upcall set\n");
-                GOTO(out, rc = -EREMCHG);
-        }
+	if (unlikely(!strcmp(cache->uc_upcall, "NONE"))) {
+		CERROR("no upcall set\n");
+		GOTO(out, rc = -EREMCHG);
+	}
 
-        argv[0] = cache->uc_upcall;
-        snprintf(keystr, sizeof(keystr), LPU64, entry->ue_key);
+	argv[0] = cache->uc_upcall;
+	argv[1] = cache->uc_name;
+	for (i = 0; i < nkeys; i++) {
+		snprintf(keystr[i], sizeof(keystr[i]), LPU64, keys[i]);
+		argv[i + 2] = keystr[i];
+	}
+	argv[nkeys + 2] = NULL;
 
 	do_gettimeofday(&start);
 	rc = call_usermodehelper(argv[0], argv, envp, UMH_WAIT_EXEC);
 	do_gettimeofday(&end);
 	if (rc < 0) {
-                CERROR("%s: error invoking upcall %s %s %s: rc %d; "
-                       "check /proc/fs/lustre/mdt/%s/identity_upcall, "
-                       "time %ldus\n",
-                       cache->uc_name, argv[0], argv[1], argv[2], rc,
-                       cache->uc_name, cfs_timeval_sub(&end, &start, NULL));
-        } else {
-                CDEBUG(D_HA, "%s: invoked upcall %s %s %s, time %ldus\n",
-                       cache->uc_name, argv[0], argv[1], argv[2],
-                       cfs_timeval_sub(&end, &start, NULL));
-                rc = 0;
-        }
-        EXIT;
+		CERROR("%s: error invoking upcall %s %s %s (%d uids): rc %d; "
+		       "check /proc/fs/lustre/mdt/%s/identity_upcall, "
+		       "time %ldus\n",
+		       cache->uc_name, argv[0], argv[1], argv[2], nkeys, rc,
+		       cache->uc_name, cfs_timeval_sub(&end, &start, NULL));
+	} else {
+		CDEBUG(D_HA, "%s: invoked upcall %s %s %s (%d uids), "
+		       "time %ldus\n", cache->uc_name, argv[0], argv[1],
+		       argv[2], nkeys, cfs_timeval_sub(&end, &start, NULL));
+		rc = 0;
+	}
+	EXIT;
 out:
 	read_unlock(&cache->uc_upcall_rwlock);
-        return rc;
+	OBD_FREE(argv, (nkeys + 3) * sizeof(*argv));
+	OBD_FREE(keystr, nkeys * sizeof(*keystr));
+	return rc;
 }
 
 static int mdt_identity_parse_downcall(struct upcall_cache *cache,
@@ -109,6 +109,59 @@ enum cdt_states { CDT_STOPPED = 0,
 		  CDT_DISABLE,
 		  CDT_STOPPING };
 
+/* waiting actions are dispatched by class, in this order */
+enum cdt_queue_class {
+	CQC_RESTORE = 0,	/**< users are blocked on them */
+	CQC_CANCEL,		/**< free agent slots */
+	CQC_REMOVE,
+	CQC_ARCHIVE,		/**< and anything else */
+	CQC_NR
+};
+
+#define CDT_QUEUE_ARCHIVES	(LL_HSM_MAX_ARCHIVE + 1)
+#define CDT_QUEUE_HASH_BITS	16
+
+/**
+ * in-memory copy of an action llog record
+ * all fields are protected by cdt_llog_lock
+ */
+struct cdt_queue_entry {
+	struct list_head	 cqe_list;	   /**< on a waiting, started
+						    * or done list */
+	struct hlist_node	 cqe_cookie_hash;  /**< by request cookie */
+	struct hlist_node	 cqe_fid_hash;	   /**< by FID, unhashed once
+						    * in a final state */
+	struct llog_cookie	 cqe_llog_cookie;  /**< on-disk location */
+	__u64			 cqe_seq;	   /**< llog write order */
+	cfs_time_t		 cqe_queued;	   /**< jiffies when waiting
+						    * started */
+	struct llog_agent_req_rec cqe_larr;	   /**< record, must be
+						    * last */
+};
+
+/**
+ * index of the action llog records, so the coordinator does not have
+ * to scan the llog to find work
+ */
+struct cdt_queue {
+	bool			 cq_loaded;	/**< in sync with llog */
+	__u64			 cq_seq;	/**< last cqe_seq */
+	struct hlist_head	*cq_cookie_hash;
+	struct hlist_head	*cq_fid_hash;
+	struct list_head	 cq_waiting[CQC_NR][CDT_QUEUE_ARCHIVES];
+	int			 cq_next_archive[CQC_NR]; /**< round robin
+							   * between archives */
+	struct list_head	 cq_started;
+	struct list_head	 cq_done;	/**< oldest change first */
+	/* statistics */
+	__u64			 cq_waiting_count[CQC_NR];
+	__u64			 cq_started_count;
+	__u64			 cq_done_count;
+	__u64			 cq_dispatched;
+	__u64			 cq_latency_sum;  /**< dispatch latency in ms */
+	__u64			 cq_latency_max;
+};
+
 /* when multiple lock are needed, the lock order is
  * cdt_llog_lock
  * cdt_agent_lock
@@ -152,6 +205,9 @@ struct coordinator {
 						       * agents */
 	struct list_head	 cdt_restore_hdl;     /**< list of restore lock
 						       * handles */
+	struct cdt_queue	 cdt_queue;	      /**< action llog index,
+						       * protected by
+						       * cdt_llog_lock */
 	/* Bitmasks indexed by the HSMA_XXX constants. */
 	__u64			 cdt_user_request_mask;
 	__u64			 cdt_group_request_mask;
@@ -243,6 +299,8 @@ struct mdt_object {
 	/* Lock to protect lease open.
 	 * Lease open acquires write lock; normal open acquires read lock */
 	struct rw_semaphore	mot_open_sem;
+	/* Lock to serialize lazy SOM updates */
+	struct mutex		mot_som_mutex;
 	atomic_t		mot_lease_count;
 	atomic_t		mot_open_count;
 };
@@ -721,6 +779,14 @@ struct mdt_thread_info *tsi2mdt_info(struct tgt_session_info *tsi);
 int mdt_hsm_attr_set(struct mdt_thread_info *info, struct mdt_object *obj,
 		     const struct md_hsm *mh);
 
+/* mdt_som.c */
+int mdt_lsom_get(struct mdt_thread_info *info, struct mdt_object *o,
+		 struct md_som_data *msd);
+int mdt_lsom_update(struct mdt_thread_info *info, struct mdt_object *o,
+		    __u64 size, __u64 blocks, __u32 valid, bool exact);
+void mdt_pack_lsom2body(struct mdt_thread_info *info, struct mdt_body *b,
+			const struct md_attr *ma);
+
 int mdt_remote_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 			    void *data, int flag);
 int mdt_links_read(struct mdt_thread_info *info,
@@ -802,6 +868,26 @@ int mdt_agent_llog_update_rec(const struct lu_env *env, struct mdt_device *mdt,
 			      struct llog_handle *llh,
 			      struct llog_agent_req_rec *larr);
 
+/* mdt/mdt_hsm_cdt_queue.c */
+void cdt_queue_init(struct coordinator *cdt);
+void cdt_queue_fini(struct mdt_device *mdt);
+int cdt_queue_load(const struct lu_env *env, struct mdt_device *mdt,
+		   llog_cb_t cb, void *data);
+int cdt_queue_add(struct coordinator *cdt,
+		  const struct llog_agent_req_rec *larr,
+		  const struct llog_cookie *cookie);
+int cdt_queue_update(const struct lu_env *env, struct mdt_device *mdt,
+		     struct llog_handle *cathandle, __u64 *cookies,
+		     int cookies_count, enum agent_req_status status,
+		     __u64 change_time);
+int cdt_queue_cancel_all(const struct lu_env *env, struct mdt_device *mdt);
+int cdt_queue_purge(const struct lu_env *env, struct mdt_device *mdt);
+int cdt_queue_next_hal(struct mdt_device *mdt, const char *fs_name,
+		       int max_count, struct hsm_action_list **hal,
+		       int *hal_len);
+struct llog_agent_req_rec *cdt_queue_find_fid(struct coordinator *cdt,
+					      const struct lu_fid *fid);
+
 /* mdt/mdt_hsm_cdt_agent.c */
 extern const struct file_operations mdt_hsm_agent_fops;
 int mdt_hsm_agent_register(struct mdt_thread_info *info,
@@ -956,6 +956,11 @@ static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
 	else
 		ma->ma_attr_flags &= ~MDS_HSM_RELEASE;
 
+	if (rec->sa_bias & MDS_CLOSE_SIZE_KNOWN)
+		ma->ma_attr_flags |= MDS_CLOSE_SIZE_KNOWN;
+	else
+		ma->ma_attr_flags &= ~MDS_CLOSE_SIZE_KNOWN;
+
 	RETURN(0);
 }
 
@@ -265,6 +265,95 @@ mdt_identity_acquire_expire_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(mdt_identity_acquire_expire);
 
+static int mdt_identity_refresh_ahead_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return seq_printf(m, "%u\n", mdt->mdt_identity_cache->uc_refresh_ahead);
+}
+
+static ssize_t
+mdt_identity_refresh_ahead_seq_write(struct file *file,
+				     const char __user *buffer,
+				     size_t count, loff_t *off)
+{
+	struct seq_file	  *m = file->private_data;
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	int rc, val;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 0 disables refresh-ahead */
+	if (val < 0 || val >= mdt->mdt_identity_cache->uc_entry_expire)
+		return -EINVAL;
+
+	mdt->mdt_identity_cache->uc_refresh_ahead = val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdt_identity_refresh_ahead);
+
+static int mdt_identity_upcall_batch_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return seq_printf(m, "%u\n", mdt->mdt_identity_cache->uc_upcall_batch);
+}
+
+static ssize_t
+mdt_identity_upcall_batch_seq_write(struct file *file,
+				    const char __user *buffer,
+				    size_t count, loff_t *off)
+{
+	struct seq_file	  *m = file->private_data;
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	int rc, val;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	/* 1 restores one upcall per uid for upcalls taking a single uid */
+	if (val < 1 || val > UC_CACHE_BATCH_MAX)
+		return -EINVAL;
+
+	mdt->mdt_identity_cache->uc_upcall_batch = val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdt_identity_upcall_batch);
+
+static int mdt_identity_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device	  *obd = m->private;
+	struct mdt_device	  *mdt = mdt_dev(obd->obd_lu_dev);
+	struct upcall_cache_stats  stats;
+	__u64			   avg = 0;
+
+	upcall_cache_get_stats(mdt->mdt_identity_cache, &stats);
+	if (stats.ucs_misses != 0) {
+		avg = stats.ucs_wait_usec;
+		do_div(avg, stats.ucs_misses);
+	}
+
+	return seq_printf(m, "hits: "LPU64"\n"
+			  "misses: "LPU64"\n"
+			  "upcalls: "LPU64"\n"
+			  "upcall_uids: "LPU64"\n"
+			  "refresh_ahead: "LPU64"\n"
+			  "preloaded: "LPU64"\n"
+			  "miss_avg_usec: "LPU64"\n"
+			  "miss_max_usec: "LPU64"\n",
+			  stats.ucs_hits, stats.ucs_misses, stats.ucs_upcalls,
+			  stats.ucs_upcall_keys, stats.ucs_refresh_ahead,
+			  stats.ucs_preloads, avg, stats.ucs_wait_max_usec);
+}
+LPROC_SEQ_FOPS_RO(mdt_identity_stats);
+
 static int mdt_identity_upcall_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
@@ -369,7 +458,8 @@ again:
 
 	if (checked == 0) {
 		checked = 1;
-		if (param->idd_magic != IDENTITY_DOWNCALL_MAGIC) {
+		if (param->idd_magic != IDENTITY_DOWNCALL_MAGIC &&
+		    param->idd_magic != IDENTITY_PRELOAD_MAGIC) {
 			CERROR("%s: MDS identity downcall bad params\n",
 			       mdt_obd_name(mdt));
 			GOTO(out, rc = -EINVAL);
@@ -398,8 +488,14 @@ again:
 		}
 	}
 
-	rc = upcall_cache_downcall(mdt->mdt_identity_cache, param->idd_err,
-				   param->idd_uid, param);
+	if (param->idd_magic == IDENTITY_PRELOAD_MAGIC)
+		rc = param->idd_err ? -EINVAL :
+		     upcall_cache_preload(mdt->mdt_identity_cache,
+					  param->idd_uid, param);
+	else
+		rc = upcall_cache_downcall(mdt->mdt_identity_cache,
+					   param->idd_err, param->idd_uid,
+					   param);
 
 out:
 	if (param != NULL)
@@ -658,6 +754,12 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 	  .fops =	&mdt_identity_expire_fops		},
 	{ .name =	"identity_acquire_expire",
 	  .fops =	&mdt_identity_acquire_expire_fops	},
+	{ .name =	"identity_refresh_ahead",
+	  .fops =	&mdt_identity_refresh_ahead_fops	},
+	{ .name =	"identity_upcall_batch",
+	  .fops =	&mdt_identity_upcall_batch_fops		},
+	{ .name =	"identity_stats",
+	  .fops =	&mdt_identity_stats_fops		},
 	{ .name =	"identity_upcall",
 	  .fops =	&mdt_identity_upcall_fops		},
 	{ .name =	"identity_flush",
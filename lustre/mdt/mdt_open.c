@@ -1806,6 +1806,34 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
 	RETURN(rc);
 }
 
+/**
+ * A writer sends the size it knows of when it closes the file, keep it as
+ * the lazy size-on-MDT.  A release stores the exact size by itself.
+ *
+ * The size is only taken as the size of the file when the last writer
+ * closes it and the client glimpsed it (MDS_CLOSE_SIZE_KNOWN).  Otherwise
+ * it is the client's cached i_size, which may be stale or 0, and the lazy
+ * size only grows.
+ */
+static void mdt_close_lsom_update(struct mdt_thread_info *info,
+				  struct mdt_file_data *mfd)
+{
+	struct md_attr	*ma = &info->mti_attr;
+	struct lu_attr	*la = &ma->ma_attr;
+	__u32		 valid = SOMC_LAZY_SIZE;
+
+	if (!(mfd->mfd_mode & FMODE_WRITE) || !(ma->ma_valid & MA_INODE) ||
+	    !(la->la_valid & LA_SIZE) || ma->ma_attr_flags & MDS_HSM_RELEASE)
+		return;
+
+	if (la->la_valid & LA_BLOCKS)
+		valid |= SOMC_LAZY_BLOCKS;
+
+	mdt_lsom_update(info, mfd->mfd_object, la->la_size, la->la_blocks,
+			valid, ma->ma_attr_flags & MDS_CLOSE_SIZE_KNOWN &&
+			mdt_write_read(mfd->mfd_object) == 1);
+}
+
 int mdt_close(struct tgt_session_info *tsi)
 {
 	struct mdt_thread_info	*info = tsi2mdt_info(tsi);
@@ -1873,6 +1901,7 @@ int mdt_close(struct tgt_session_info *tsi)
                 /* Do not lose object before last unlink. */
                 o = mfd->mfd_object;
                 mdt_object_get(info->mti_env, o);
+		mdt_close_lsom_update(info, mfd);
                 ret = mdt_mfd_close(info, mfd);
                 if (repbody != NULL)
                         rc = mdt_handle_last_unlink(info, o, ma);
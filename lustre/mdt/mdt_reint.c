@@ -664,6 +664,11 @@ static int mdt_reint_setattr(struct mdt_thread_info *info,
 		rc = mdt_attr_set(info, mo, ma);
                 if (rc)
                         GOTO(out_put, rc);
+
+		/* a truncate sets the exact size */
+		if (ma->ma_attr.la_valid & LA_SIZE)
+			mdt_lsom_update(info, mo, ma->ma_attr.la_size, 0,
+					SOMC_LAZY_SIZE, true);
 	} else if ((ma->ma_valid & MA_LOV) && (ma->ma_valid & MA_INODE)) {
 		struct lu_buf *buf  = &info->mti_buf;
 
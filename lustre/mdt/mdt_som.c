@@ -0,0 +1,182 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/mdt/mdt_som.c
+ *
+ * Lazy Size-on-MDT.
+ *
+ * The size and blocks of a regular file live on its OST objects, so an
+ * exact stat(2) needs a glimpse of every stripe.  The MDT keeps a copy of
+ * them in the XATTR_NAME_SOM extended attribute, updated from the size a
+ * client reports when it closes a file it wrote to and from truncates.
+ * The copy is not kept in sync while the file is open for write, so it is
+ * only returned to clients that explicitly ask for it with
+ * OBD_MD_FLLAZYSIZE, and is flagged as lazy in the reply.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/**
+ * Read the lazy SOM attributes of \a o.
+ *
+ * \param[in] info	thread info
+ * \param[in] o		MDT object
+ * \param[out] msd	unpacked SOM attributes
+ *
+ * \retval 0		on success
+ * \retval -ENODATA	if \a o has no (usable) SOM attributes
+ * \retval -ve		other errors
+ */
+int mdt_lsom_get(struct mdt_thread_info *info, struct mdt_object *o,
+		 struct md_som_data *msd)
+{
+	struct lu_buf	*buf = &info->mti_buf;
+	int		 rc;
+
+	CLASSERT(sizeof(struct som_attrs) <= sizeof(info->mti_xattr_buf));
+	buf->lb_buf = info->mti_xattr_buf;
+	buf->lb_len = sizeof(info->mti_xattr_buf);
+	rc = mo_xattr_get(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_SOM);
+	if (rc > 0 && rc < sizeof(struct som_attrs))
+		rc = -ENODATA;
+
+	return lustre_buf2som(info->mti_xattr_buf, rc, msd);
+}
+
+static int mdt_lsom_attr_set(struct mdt_thread_info *info,
+			     struct mdt_object *o,
+			     const struct md_som_data *msd)
+{
+	struct lu_ucred	*uc = mdt_ucred(info);
+	struct lu_buf	*buf = &info->mti_buf;
+	cfs_cap_t	 cap;
+	int		 rc;
+
+	lustre_som2buf(info->mti_xattr_buf, msd);
+	buf->lb_buf = info->mti_xattr_buf;
+	buf->lb_len = sizeof(struct som_attrs);
+
+	/* any writer of the file may update its size, not only the owner */
+	cap = uc->uc_cap;
+	uc->uc_cap |= 1 << CFS_CAP_FOWNER;
+	rc = mo_xattr_set(info->mti_env, mdt_object_child(o), buf,
+			  XATTR_NAME_SOM, 0);
+	uc->uc_cap = cap;
+
+	return rc;
+}
+
+/**
+ * Update the lazy SOM attributes of \a o.
+ *
+ * With \a exact (truncate, or the last writer closing the file) \a size
+ * replaces the stored size.  Otherwise other writers may still extend the
+ * file behind this client's back, so the stored values only grow.
+ *
+ * \param[in] info	thread info
+ * \param[in] o		regular file object
+ * \param[in] size	file size
+ * \param[in] blocks	file blocks, if \a valid has SOMC_LAZY_BLOCKS
+ * \param[in] valid	SOMC_LAZY_SIZE, and SOMC_LAZY_BLOCKS if \a blocks is
+ *			known
+ * \param[in] exact	whether \a size is the current size of the file
+ *
+ * \retval 0		on success, or if there is nothing to update
+ * \retval -ve		on error
+ */
+int mdt_lsom_update(struct mdt_thread_info *info, struct mdt_object *o,
+		    __u64 size, __u64 blocks, __u32 valid, bool exact)
+{
+	struct md_som_data	 msd;
+	struct md_som_data	 old;
+	int			 rc;
+	ENTRY;
+
+	if (!(valid & SOMC_LAZY_SIZE) ||
+	    !S_ISREG(lu_object_attr(&o->mot_obj)))
+		RETURN(0);
+
+	mutex_lock(&o->mot_som_mutex);
+	rc = mdt_lsom_get(info, o, &msd);
+	if (rc == -ENODATA) {
+		memset(&msd, 0, sizeof(msd));
+		rc = 0;
+	}
+	if (rc < 0)
+		GOTO(out, rc);
+
+	old = msd;
+	if (exact || !(msd.msd_compat & SOMC_LAZY_SIZE) ||
+	    size > msd.msd_size)
+		msd.msd_size = size;
+	msd.msd_compat |= SOMC_LAZY_SIZE;
+
+	if (valid & SOMC_LAZY_BLOCKS) {
+		if (exact || !(msd.msd_compat & SOMC_LAZY_BLOCKS) ||
+		    blocks > msd.msd_blocks)
+			msd.msd_blocks = blocks;
+		msd.msd_compat |= SOMC_LAZY_BLOCKS;
+	} else if (exact) {
+		/* the old blocks do not match the new size */
+		msd.msd_compat &= ~SOMC_LAZY_BLOCKS;
+	}
+
+	if (memcmp(&old, &msd, sizeof(old)) == 0)
+		GOTO(out, rc = 0);
+
+	rc = mdt_lsom_attr_set(info, o, &msd);
+	CDEBUG(D_INODE, "%s: "DFID" lazy size "LPU64" blocks "LPU64
+	       " compat %#x%s: rc = %d\n", mdt_obd_name(info->mti_mdt),
+	       PFID(mdt_object_fid(o)), msd.msd_size, msd.msd_blocks,
+	       msd.msd_compat, exact ? " (exact)" : "", rc);
+	EXIT;
+out:
+	mutex_unlock(&o->mot_som_mutex);
+	return rc;
+}
+
+/**
+ * Return the lazy SOM attributes in \a ma to a client that asked for them.
+ *
+ * The authoritative size already packed for released files and files without
+ * OST objects (OBD_MD_FLSIZE) is never overridden.
+ */
+void mdt_pack_lsom2body(struct mdt_thread_info *info, struct mdt_body *b,
+			const struct md_attr *ma)
+{
+	const struct md_som_data *msd = &ma->ma_som;
+
+	if (!(ma->ma_valid & MA_SOM) || (b->mbo_valid & OBD_MD_FLSIZE))
+		return;
+
+	if (msd->msd_compat & SOMC_LAZY_SIZE) {
+		b->mbo_size = msd->msd_size;
+		b->mbo_valid |= OBD_MD_FLLAZYSIZE;
+	}
+	if (msd->msd_compat & SOMC_LAZY_BLOCKS) {
+		b->mbo_blocks = msd->msd_blocks;
+		b->mbo_valid |= OBD_MD_FLLAZYBLOCKS;
+	}
+}
@@ -48,6 +48,7 @@
 #ifdef HAVE_SERVER_SUPPORT
 # include <dt_object.h>
 # include <md_object.h>
+# include <upcall_cache.h>
 #endif /* HAVE_SERVER_SUPPORT */
 #include <lustre_ioctl.h>
 #include "llog_internal.h"
@@ -588,6 +589,10 @@ static int __init init_obdclass(void)
 	err = lu_ucred_global_init();
 	if (err != 0)
 		return err;
+
+	err = upcall_cache_global_init();
+	if (err != 0)
+		return err;
 #endif /* HAVE_SERVER_SUPPORT */
 
 	err = llog_info_init();
@@ -652,6 +657,7 @@ static void cleanup_obdclass(void)
 	misc_deregister(&obd_psdev);
 	llog_info_fini();
 #ifdef HAVE_SERVER_SUPPORT
+	upcall_cache_global_fini();
 	lu_ucred_global_fini();
 	dt_global_fini();
 #endif /* HAVE_SERVER_SUPPORT */
@@ -311,6 +311,55 @@ static int llog_osd_declare_write_rec(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Write the llog header parts changed by appending record \a index
+ *
+ * An append changes only the fixed header fields (llh_count), one word of
+ * the bitmap and the header tail, so write just those instead of the whole
+ * LLOG_CHUNK_SIZE header. The append is done under the llog handle lock,
+ * so this shortens the time every other writer of a busy llog (changelog,
+ * HSM actions) waits.
+ *
+ * \param[in] env	execution environment
+ * \param[in] o		llog object
+ * \param[in] llh	in-memory llog header
+ * \param[in] index	index of the record just set in the bitmap
+ * \param[in] th	current transaction handle
+ *
+ * \retval		0 on successful write
+ * \retval		negative error if write failed
+ */
+static int llog_osd_write_hdr_append(const struct lu_env *env,
+				     struct dt_object *o,
+				     struct llog_log_hdr *llh, int index,
+				     struct thandle *th)
+{
+	struct llog_thread_info	*lgi = llog_info(env);
+	int			 rc;
+
+	lgi->lgi_off = 0;
+	lgi->lgi_buf.lb_len = offsetof(struct llog_log_hdr, llh_bitmap);
+	lgi->lgi_buf.lb_buf = llh;
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		return rc;
+
+	/* ext2 bitops are little-endian, so bit @index always lives in
+	 * the same 32-bit word of the on-disk bitmap */
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_bitmap) +
+		       (index / 32) * sizeof(llh->llh_bitmap[0]);
+	lgi->lgi_buf.lb_len = sizeof(llh->llh_bitmap[0]);
+	lgi->lgi_buf.lb_buf = &llh->llh_bitmap[index / 32];
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		return rc;
+
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_tail);
+	lgi->lgi_buf.lb_len = sizeof(llh->llh_tail);
+	lgi->lgi_buf.lb_buf = &llh->llh_tail;
+	return dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+}
+
 /**
  * Implementation of the llog_operations::lop_write
  *
@@ -347,6 +396,7 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	struct llog_rec_tail	*lrt;
 	struct dt_object	*o;
 	size_t			 left;
+	__u64			 llog_size;
 	bool			 header_is_updated = false;
 
 	ENTRY;
@@ -475,6 +525,7 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	 * boundary, write in a fake (but referenced) entry to pad the chunk.
 	 */
 	LASSERT(lgi->lgi_attr.la_valid & LA_SIZE);
+	llog_size = lgi->lgi_attr.la_size;
 	lgi->lgi_off = lgi->lgi_attr.la_size;
 	left = LLOG_CHUNK_SIZE - (lgi->lgi_off & (LLOG_CHUNK_SIZE - 1));
 	/* NOTE: padding is a record, but no bit is set */
@@ -518,14 +569,26 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	llh->llh_count++;
 	spin_unlock(&loghandle->lgh_hdr_lock);
 
-	lgi->lgi_off = 0;
-	lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
-	lgi->lgi_buf.lb_buf = &llh->llh_hdr;
-	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	/* the whole header must be written once when the llog is still
+	 * empty, afterwards only the parts changed by this append.  Any of
+	 * these writes may fail after others reached the disk, so from now
+	 * on the error path must rewrite the whole header */
+	header_is_updated = true;
+	if (llog_size >= sizeof(*llh) &&
+	    llh->llh_hdr.lrh_len == sizeof(*llh) &&
+	    llh->llh_bitmap_offset == offsetof(struct llog_log_hdr,
+					       llh_bitmap)) {
+		rc = llog_osd_write_hdr_append(env, o, llh, index, th);
+	} else {
+		lgi->lgi_off = 0;
+		lgi->lgi_buf.lb_len = llh->llh_hdr.lrh_len;
+		lgi->lgi_buf.lb_buf = &llh->llh_hdr;
+		rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off,
+				     th);
+	}
 	if (rc)
 		GOTO(out, rc);
 
-	header_is_updated = true;
 	rc = dt_attr_get(env, o, &lgi->lgi_attr);
 	if (rc)
 		GOTO(out, rc);
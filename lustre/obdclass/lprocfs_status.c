@@ -652,7 +652,8 @@ static const char *obd_connect_names[] = {
 	"unlink_close",
 	"multi_mod_rpcs",
 	"dir_stripe",
-	"unknown",
+	"fallocate",
+	"peer_ping",
 	NULL
 };
 
@@ -818,11 +819,13 @@ int lprocfs_import_seq_show(struct seq_file *m, void *data)
 		      "       inflight: %u\n"
 		      "       unregistering: %u\n"
 		      "       timeouts: %u\n"
-		      "       avg_waittime: "LPU64" %s\n",
+		      "       avg_waittime: "LPU64" %s\n"
+		      "       pings_avoided: %u\n",
 		      atomic_read(&imp->imp_inflight),
 		      atomic_read(&imp->imp_unregistering),
 		      atomic_read(&imp->imp_timeouts),
-		      ret.lc_sum, header->lc_units);
+		      ret.lc_sum, header->lc_units,
+		      atomic_read(&imp->imp_pings_avoided));
 
 	k = 0;
 	for(j = 0; j < IMP_AT_MAX_PORTALS; j++) {
@@ -151,9 +151,18 @@ void lu_object_put(const struct lu_env *env, struct lu_object *o)
 
 	if (!lu_object_is_dying(top) &&
 	    (lu_object_exists(orig) || lu_object_is_cl(orig))) {
-		LASSERT(list_empty(&top->loh_lru));
-		list_add_tail(&top->loh_lru, &bkt->lsb_lru);
-		bkt->lsb_lru_len++;
+		/*
+		 * The object may still be on the LRU from the last time it
+		 * was released, as lookups leave it there. Don't move it to
+		 * the hot end now, just mark it and let lu_site_purge() do
+		 * it for a batch of objects at once.
+		 */
+		if (list_empty(&top->loh_lru)) {
+			list_add_tail(&top->loh_lru, &bkt->lsb_lru);
+			bkt->lsb_lru_len++;
+		} else {
+			set_bit(LU_OBJECT_REFERENCED, &top->loh_flags);
+		}
                 cfs_hash_bd_unlock(site->ls_obj_hash, &bd, 1);
                 return;
         }
@@ -162,13 +171,17 @@ void lu_object_put(const struct lu_env *env, struct lu_object *o)
          * If object is dying (will not be cached), removed it
          * from hash table and LRU.
          *
-         * This is done with hash table and LRU lists locked. As the only
+         * This is done with the bucket locked exclusively. As the only
          * way to acquire first reference to previously unreferenced
          * object is through hash-table lookup (lu_object_find()),
-         * or LRU scanning (lu_site_purge()), that are done under hash-table
-         * and LRU lock, no race with concurrent object lookup is possible
+         * or LRU scanning (lu_site_purge()), that are done under the
+         * bucket lock, no race with concurrent object lookup is possible
          * and we can safely destroy object below.
          */
+	if (!list_empty(&top->loh_lru)) {
+		list_del_init(&top->loh_lru);
+		bkt->lsb_lru_len--;
+	}
 	if (!test_and_set_bit(LU_OBJECT_UNHASHED, &top->loh_flags))
 		cfs_hash_bd_del_locked(site->ls_obj_hash, &bd, &top->loh_hash);
         cfs_hash_bd_unlock(site->ls_obj_hash, &bd, 1);
@@ -349,6 +362,7 @@ int lu_site_purge(const struct lu_env *env, struct lu_site *s, int nr)
         cfs_hash_bd_t            bd;
         cfs_hash_bd_t            bd2;
 	struct list_head	 dispose;
+	struct list_head	 again;
 	int                      did_sth;
 	unsigned int		 start;
         int                      count;
@@ -359,9 +373,13 @@ int lu_site_purge(const struct lu_env *env, struct lu_site *s, int nr)
 		RETURN(0);
 
 	INIT_LIST_HEAD(&dispose);
+	INIT_LIST_HEAD(&again);
         /*
          * Under LRU list lock, scan LRU list and move unreferenced objects to
-         * the dispose list, removing them from LRU and hash table.
+         * the dispose list, removing them from LRU and hash table. Objects
+         * that are busy again are dropped from the LRU, those that were
+         * used and released since they were queued are moved back to the
+         * hot end of the LRU, unless everything is being purged.
          */
         start = s->ls_purge_start;
 	bnr = (nr == ~0) ? -1 : nr / (int)CFS_HASH_NBKT(s->ls_obj_hash) + 1;
@@ -380,7 +398,18 @@ int lu_site_purge(const struct lu_env *env, struct lu_site *s, int nr)
                 bkt = cfs_hash_bd_extra_get(s->ls_obj_hash, &bd);
 
 		list_for_each_entry_safe(h, temp, &bkt->lsb_lru, loh_lru) {
-			LASSERT(atomic_read(&h->loh_ref) == 0);
+			if (atomic_read(&h->loh_ref) > 0) {
+				clear_bit(LU_OBJECT_REFERENCED, &h->loh_flags);
+				list_del_init(&h->loh_lru);
+				bkt->lsb_lru_len--;
+				continue;
+			}
+
+			if (test_and_clear_bit(LU_OBJECT_REFERENCED,
+					       &h->loh_flags) && nr != ~0) {
+				list_move_tail(&h->loh_lru, &again);
+				continue;
+			}
 
                         cfs_hash_bd_get(s->ls_obj_hash, &h->loh_fid, &bd2);
                         LASSERT(bd.bd_bucket == bd2.bd_bucket);
@@ -399,6 +428,7 @@ int lu_site_purge(const struct lu_env *env, struct lu_site *s, int nr)
                                 break;
 
 		}
+		list_splice_tail_init(&again, &bkt->lsb_lru);
 		cfs_hash_bd_unlock(s->ls_obj_hash, &bd, 1);
 		cond_resched();
 		/*
@@ -573,6 +603,13 @@ int lu_object_invariant(const struct lu_object *o)
         return 1;
 }
 
+/**
+ * Look up \a f in bucket \a bd, and take a reference on the object found.
+ *
+ * The bucket can be locked in shared mode: a found object isn't removed
+ * from the LRU, and its reference can only drop to zero, or be taken by
+ * lu_site_purge(), with the bucket locked exclusively.
+ */
 static struct lu_object *htable_lookup(struct lu_site *s,
 				       cfs_hash_bd_t *bd,
 				       const struct lu_fid *f,
@@ -599,12 +636,9 @@ static struct lu_object *htable_lookup(struct lu_site *s,
 
         h = container_of0(hnode, struct lu_object_header, loh_hash);
         if (likely(!lu_object_is_dying(h))) {
+		/* the object is left on the LRU, see lu_site_purge() */
 		cfs_hash_get(s->ls_obj_hash, hnode);
                 lprocfs_counter_incr(s->ls_stats, LU_SS_CACHE_HIT);
-		if (!list_empty(&h->loh_lru)) {
-			list_del_init(&h->loh_lru);
-			bkt->lsb_lru_len--;
-		}
                 return lu_object_top(h);
         }
 
@@ -703,9 +737,9 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
         /*
          * This uses standard index maintenance protocol:
          *
-         *     - search index under lock, and return object if found;
+         *     - search index under shared lock, and return object if found;
          *     - otherwise, unlock index, allocate new object;
-         *     - lock index and search again;
+         *     - lock index exclusively and search again;
          *     - if nothing is found (usual case), insert newly created
          *       object into index;
          *     - otherwise (race: other thread inserted object), free
@@ -725,9 +759,9 @@ static struct lu_object *lu_object_find_try(const struct lu_env *env,
 
         s  = dev->ld_site;
         hs = s->ls_obj_hash;
-        cfs_hash_bd_get_and_lock(hs, (void *)f, &bd, 1);
+        cfs_hash_bd_get_and_lock(hs, (void *)f, &bd, 0);
         o = htable_lookup(s, &bd, f, waiter, &version);
-        cfs_hash_bd_unlock(hs, &bd, 1);
+        cfs_hash_bd_unlock(hs, &bd, 0);
 	if (!IS_ERR(o) || PTR_ERR(o) != -ENOENT)
                 return o;
 
@@ -1059,7 +1093,7 @@ int lu_site_init(struct lu_site *s, struct lu_device *top)
 						 bits - LU_SITE_BKT_BITS,
 						 sizeof(*bkt), 0, 0,
 						 &lu_site_hash_ops,
-						 CFS_HASH_SPIN_BKTLOCK |
+						 CFS_HASH_RW_BKTLOCK |
 						 CFS_HASH_NO_ITEMREF |
 						 CFS_HASH_DEPTH |
 						 CFS_HASH_ASSERT_EMPTY |
@@ -1924,14 +1958,16 @@ static void lu_site_stats_get(cfs_hash_t *hs,
                 struct lu_site_bkt_data *bkt = cfs_hash_bd_extra_get(hs, &bd);
 		struct hlist_head	*hhead;
 
-                cfs_hash_bd_lock(hs, &bd, 1);
+                cfs_hash_bd_lock(hs, &bd, 0);
+		/* objects found again stay on the LRU until the next purge,
+		 * so this is a lower bound of the busy objects */
 		stats->lss_busy  +=
 			cfs_hash_bd_count_get(&bd) - bkt->lsb_lru_len;
                 stats->lss_total += cfs_hash_bd_count_get(&bd);
                 stats->lss_max_search = max((int)stats->lss_max_search,
                                             cfs_hash_bd_depmax_get(&bd));
                 if (!populated) {
-                        cfs_hash_bd_unlock(hs, &bd, 1);
+                        cfs_hash_bd_unlock(hs, &bd, 0);
                         continue;
                 }
 
@@ -1939,7 +1975,7 @@ static void lu_site_stats_get(cfs_hash_t *hs,
 			if (!hlist_empty(hhead))
                                 stats->lss_populated++;
                 }
-                cfs_hash_bd_unlock(hs, &bd, 1);
+                cfs_hash_bd_unlock(hs, &bd, 0);
         }
 }
 
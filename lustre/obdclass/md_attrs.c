@@ -128,6 +128,29 @@ int lustre_buf2som(void *buf, int rc, struct md_som_data *msd)
 }
 EXPORT_SYMBOL(lustre_buf2som);
 
+/*
+ * Pack SOM attributes.
+ *
+ * \param buf - is the output buffer where to pack the on-disk SOM xattr.
+ * \param msd - is the md_som_data structure to pack.
+ */
+void lustre_som2buf(void *buf, const struct md_som_data *msd)
+{
+	struct som_attrs *attrs = (struct som_attrs *)buf;
+
+	/* copy SOM attributes */
+	attrs->som_compat   = msd->msd_compat;
+	attrs->som_incompat = msd->msd_incompat;
+	attrs->som_ioepoch  = msd->msd_ioepoch;
+	attrs->som_size     = msd->msd_size;
+	attrs->som_blocks   = msd->msd_blocks;
+	attrs->som_mountid  = msd->msd_mountid;
+
+	/* pack xattr */
+	lustre_som_swab(attrs);
+}
+EXPORT_SYMBOL(lustre_som2buf);
+
 /**
  * Swab, if needed, HSM structure which is stored on-disk in little-endian
  * order.
@@ -43,6 +43,9 @@
 #include <lnet/types.h>
 #include <upcall_cache.h>
 
+/* runs upcalls queued by refresh-ahead or left over by service threads */
+static struct cfs_wi_sched *upcall_cache_sched;
+
 static struct upcall_cache_entry *alloc_entry(struct upcall_cache *cache,
 					      __u64 key, void *args)
 {
@@ -54,6 +57,7 @@ static struct upcall_cache_entry *alloc_entry(struct upcall_cache *cache,
 
 	UC_CACHE_SET_NEW(entry);
 	INIT_LIST_HEAD(&entry->ue_hash);
+	INIT_LIST_HEAD(&entry->ue_upcall_list);
 	entry->ue_key = key;
 	atomic_set(&entry->ue_refcount, 0);
 	init_waitqueue_head(&entry->ue_waitq);
@@ -70,6 +74,7 @@ static void free_entry(struct upcall_cache *cache,
 		cache->uc_ops->free_entry(cache, entry);
 
 	list_del(&entry->ue_hash);
+	list_del_init(&entry->ue_upcall_list);
 	CDEBUG(D_OTHER, "destroy cache entry %p for key "LPU64"\n",
 		entry, entry->ue_key);
 	LIBCFS_FREE(entry, sizeof(*entry));
@@ -140,11 +145,156 @@ static int check_unlink_entry(struct upcall_cache *cache,
 	return 1;
 }
 
-static inline int refresh_entry(struct upcall_cache *cache,
-			 struct upcall_cache_entry *entry)
+/* fail the entries still acquiring @keys, protected by cache lock */
+static void fail_upcall_keys(struct upcall_cache *cache, __u64 *keys,
+			     int nkeys, int rc)
+{
+	struct upcall_cache_entry *entry;
+	struct list_head *head;
+	int i;
+
+	for (i = 0; i < nkeys; i++) {
+		head = &cache->uc_hashtable[UC_CACHE_HASH_INDEX(keys[i])];
+		list_for_each_entry(entry, head, ue_hash) {
+			if (entry->ue_key != keys[i] ||
+			    !UC_CACHE_IS_ACQUIRING(entry))
+				continue;
+
+			UC_CACHE_CLEAR_ACQUIRING(entry);
+			UC_CACHE_SET_INVALID(entry);
+			entry->ue_upcall_rc = rc;
+			wake_up_all(&entry->ue_waitq);
+		}
+	}
+}
+
+/* clear the refresh-ahead mark of the valid entries for @keys after their
+ * upcall failed, so they can be refreshed again, protected by cache lock */
+static void fail_refresh_keys(struct upcall_cache *cache, __u64 *keys,
+			      int nkeys)
 {
+	struct upcall_cache_entry *entry;
+	struct list_head *head;
+	int i;
+
+	for (i = 0; i < nkeys; i++) {
+		head = &cache->uc_hashtable[UC_CACHE_HASH_INDEX(keys[i])];
+		list_for_each_entry(entry, head, ue_hash) {
+			if (entry->ue_key == keys[i] && entry->ue_refresh)
+				entry->ue_refresh = 0;
+		}
+	}
+}
+
+/*
+ * Invoke the upcall for the entries queued on uc_upcall_pending, with up
+ * to uc_upcall_batch keys per invocation.  Only one thread runs upcalls
+ * for a cache at a time and entries queued meanwhile go into its next
+ * batch, so a burst of misses costs a few upcalls instead of one per key.
+ *
+ * A service thread only runs \a nbatches batches and leaves the remaining
+ * entries to the upcall cache workitem, which passes 0 to drain the list.
+ * Called and returns with cache lock held.
+ */
+static void run_upcalls(struct upcall_cache *cache, int nbatches)
+{
+	struct upcall_cache_entry *entry, *next;
+	__u64 *keys = cache->uc_upcall_keys;
+	int batches = 0;
+	int nkeys;
+	int rc;
+
 	LASSERT(cache->uc_ops->do_upcall);
-	return cache->uc_ops->do_upcall(cache, entry);
+
+	if (cache->uc_upcall_active)
+		return;
+
+	cache->uc_upcall_active = 1;
+	while (!list_empty(&cache->uc_upcall_pending)) {
+		if (nbatches > 0 && batches++ >= nbatches)
+			break;
+		nkeys = 0;
+		list_for_each_entry_safe(entry, next, &cache->uc_upcall_pending,
+					 ue_upcall_list) {
+			if (nkeys >= cache->uc_upcall_batch)
+				break;
+			keys[nkeys++] = entry->ue_key;
+			list_del_init(&entry->ue_upcall_list);
+		}
+
+		spin_unlock(&cache->uc_lock);
+		rc = cache->uc_ops->do_upcall(cache, keys, nkeys);
+		spin_lock(&cache->uc_lock);
+
+		cache->uc_stats.ucs_upcalls++;
+		cache->uc_stats.ucs_upcall_keys += nkeys;
+		if (rc < 0) {
+			fail_upcall_keys(cache, keys, nkeys, rc);
+			fail_refresh_keys(cache, keys, nkeys);
+		}
+	}
+	cache->uc_upcall_active = 0;
+
+	if (!list_empty(&cache->uc_upcall_pending))
+		cfs_wi_schedule(upcall_cache_sched, &cache->uc_upcall_wi);
+}
+
+static int upcall_cache_wi_action(cfs_workitem_t *wi)
+{
+	struct upcall_cache *cache = wi->wi_data;
+
+	spin_lock(&cache->uc_lock);
+	run_upcalls(cache, 0);
+	spin_unlock(&cache->uc_lock);
+
+	return 0;
+}
+
+/*
+ * Create a valid entry for \a key from the downcall data \a args, which
+ * replaces any valid entry for the key.  Users of the old entry keep it
+ * until they put it, new lookups find the new one.
+ */
+static int install_entry(struct upcall_cache *cache, __u64 key, void *args)
+{
+	struct upcall_cache_entry *new, *entry, *next;
+	struct list_head *head;
+	int rc = 0;
+
+	new = alloc_entry(cache, key, args);
+	if (!new)
+		return -ENOMEM;
+
+	if (cache->uc_ops->parse_downcall)
+		rc = cache->uc_ops->parse_downcall(cache, new, args);
+
+	head = &cache->uc_hashtable[UC_CACHE_HASH_INDEX(key)];
+	spin_lock(&cache->uc_lock);
+	if (rc) {
+		free_entry(cache, new);
+		spin_unlock(&cache->uc_lock);
+		return rc;
+	}
+
+	list_for_each_entry_safe(entry, next, head, ue_hash) {
+		if (downcall_compare(cache, entry, key, args) != 0 ||
+		    UC_CACHE_IS_ACQUIRING(entry))
+			continue;
+
+		UC_CACHE_SET_EXPIRED(entry);
+		list_del_init(&entry->ue_hash);
+		if (!atomic_read(&entry->ue_refcount))
+			free_entry(cache, entry);
+	}
+
+	new->ue_expire = cfs_time_shift(cache->uc_entry_expire);
+	UC_CACHE_SET_VALID(new);
+	list_add(&new->ue_hash, head);
+	spin_unlock(&cache->uc_lock);
+
+	CDEBUG(D_OTHER, "%s: installed upcall cache entry %p for key "LPU64
+	       "\n", cache->uc_name, new, key);
+	return 0;
 }
 
 struct upcall_cache_entry *upcall_cache_get_entry(struct upcall_cache *cache,
@@ -153,7 +303,8 @@ struct upcall_cache_entry *upcall_cache_get_entry(struct upcall_cache *cache,
 	struct upcall_cache_entry *entry = NULL, *new = NULL, *next;
 	struct list_head *head;
 	wait_queue_t wait;
-	int rc, found;
+	ktime_t start = ktime_set(0, 0);
+	int rc, found, miss = 0;
 	ENTRY;
 
 	LASSERT(cache);
@@ -194,24 +345,25 @@ find_again:
 	}
 	get_entry(entry);
 
+	if (!miss) {
+		if (UC_CACHE_IS_VALID(entry)) {
+			cache->uc_stats.ucs_hits++;
+		} else {
+			cache->uc_stats.ucs_misses++;
+			start = ktime_get();
+			miss = 1;
+		}
+	}
+
 	/* acquire for new one */
 	if (UC_CACHE_IS_NEW(entry)) {
 		UC_CACHE_SET_ACQUIRING(entry);
 		UC_CACHE_CLEAR_NEW(entry);
-		spin_unlock(&cache->uc_lock);
-		rc = refresh_entry(cache, entry);
-		spin_lock(&cache->uc_lock);
 		entry->ue_acquire_expire =
 			cfs_time_shift(cache->uc_acquire_expire);
-		if (rc < 0) {
-			UC_CACHE_CLEAR_ACQUIRING(entry);
-			UC_CACHE_SET_INVALID(entry);
-			wake_up_all(&entry->ue_waitq);
-			if (unlikely(rc == -EREMCHG)) {
-				put_entry(cache, entry);
-				GOTO(out, entry = ERR_PTR(rc));
-			}
-		}
+		list_add_tail(&entry->ue_upcall_list,
+			      &cache->uc_upcall_pending);
+		run_upcalls(cache, 1);
 	}
 	/* someone (and only one) is doing upcall upon this item,
 	 * wait it to complete */
@@ -243,8 +395,9 @@ find_again:
 
 	/* invalid means error, don't need to try again */
 	if (UC_CACHE_IS_INVALID(entry)) {
+		rc = entry->ue_upcall_rc == -EREMCHG ? -EREMCHG : -EIDRM;
 		put_entry(cache, entry);
-		GOTO(out, entry = ERR_PTR(-EIDRM));
+		GOTO(out, entry = ERR_PTR(rc));
 	}
 
 	/* check expired
@@ -265,8 +418,27 @@ find_again:
 		}
 	}
 
-	/* Now we know it's good */
+	/* Now we know it's good.  If it is about to expire, have the
+	 * workitem resolve the key again, so users don't stall on the upcall
+	 * when it does and this thread doesn't wait for it either. */
+	if (cache->uc_refresh_ahead > 0 && UC_CACHE_IS_VALID(entry) &&
+	    !entry->ue_refresh && list_empty(&entry->ue_upcall_list) &&
+	    cfs_time_before(entry->ue_expire,
+			    cfs_time_shift(cache->uc_refresh_ahead))) {
+		entry->ue_refresh = 1;
+		cache->uc_stats.ucs_refresh_ahead++;
+		list_add_tail(&entry->ue_upcall_list,
+			      &cache->uc_upcall_pending);
+		cfs_wi_schedule(upcall_cache_sched, &cache->uc_upcall_wi);
+	}
 out:
+	if (miss) {
+		__u64 usec = ktime_us_delta(ktime_get(), start);
+
+		cache->uc_stats.ucs_wait_usec += usec;
+		if (usec > cache->uc_stats.ucs_wait_max_usec)
+			cache->uc_stats.ucs_wait_max_usec = usec;
+	}
 	spin_unlock(&cache->uc_lock);
 	RETURN(entry);
 }
@@ -319,6 +491,19 @@ int upcall_cache_downcall(struct upcall_cache *cache, __u32 err, __u64 key,
 		RETURN(-EINVAL);
 	}
 
+	/* reply to a refresh-ahead upcall, replace the valid entry */
+	if (entry->ue_refresh && UC_CACHE_IS_VALID(entry)) {
+		spin_unlock(&cache->uc_lock);
+		rc = err ? -EINVAL : install_entry(cache, key, args);
+		spin_lock(&cache->uc_lock);
+		/* keep using the old entry, and refresh it again later */
+		if (rc)
+			entry->ue_refresh = 0;
+		put_entry(cache, entry);
+		spin_unlock(&cache->uc_lock);
+		RETURN(rc);
+	}
+
 	if (err) {
 		CDEBUG(D_OTHER, "%s: upcall for key "LPU64" returned %d\n",
 		       cache->uc_name, entry->ue_key, err);
@@ -362,6 +547,49 @@ out:
 }
 EXPORT_SYMBOL(upcall_cache_downcall);
 
+/**
+ * Install an entry for \a key from downcall data \a args which no thread
+ * asked for, so the cache can be filled before users arrive.
+ *
+ * \retval 0 on success, negative errno on failure
+ */
+int upcall_cache_preload(struct upcall_cache *cache, __u64 key, void *args)
+{
+	struct upcall_cache_entry *entry;
+	struct list_head *head;
+	int acquiring = 0;
+	int rc;
+	ENTRY;
+
+	LASSERT(cache);
+
+	head = &cache->uc_hashtable[UC_CACHE_HASH_INDEX(key)];
+
+	spin_lock(&cache->uc_lock);
+	list_for_each_entry(entry, head, ue_hash) {
+		if (downcall_compare(cache, entry, key, args) == 0 &&
+		    UC_CACHE_IS_ACQUIRING(entry)) {
+			acquiring = 1;
+			break;
+		}
+	}
+	spin_unlock(&cache->uc_lock);
+
+	/* somebody is waiting for this key, complete its upcall instead */
+	if (acquiring)
+		RETURN(upcall_cache_downcall(cache, 0, key, args));
+
+	rc = install_entry(cache, key, args);
+	if (rc == 0) {
+		spin_lock(&cache->uc_lock);
+		cache->uc_stats.ucs_preloads++;
+		spin_unlock(&cache->uc_lock);
+	}
+
+	RETURN(rc);
+}
+EXPORT_SYMBOL(upcall_cache_preload);
+
 void upcall_cache_flush(struct upcall_cache *cache, int force)
 {
 	struct upcall_cache_entry *entry, *next;
@@ -437,7 +665,11 @@ struct upcall_cache *upcall_cache_init(const char *name, const char *upcall,
 	strlcpy(cache->uc_upcall, upcall, sizeof(cache->uc_upcall));
 	cache->uc_entry_expire = 20 * 60;
 	cache->uc_acquire_expire = 30;
+	cache->uc_refresh_ahead = 60;
+	cache->uc_upcall_batch = 1;
 	cache->uc_ops = ops;
+	INIT_LIST_HEAD(&cache->uc_upcall_pending);
+	cfs_wi_init(&cache->uc_upcall_wi, cache, upcall_cache_wi_action);
 
 	RETURN(cache);
 }
@@ -447,7 +679,35 @@ void upcall_cache_cleanup(struct upcall_cache *cache)
 {
 	if (!cache)
 		return;
+
+	/* wait for the workitem if it is running upcalls for this cache */
+	while (!cfs_wi_deschedule(upcall_cache_sched, &cache->uc_upcall_wi))
+		schedule_timeout_uninterruptible(cfs_time_seconds(1) / 10);
+
 	upcall_cache_flush_all(cache);
 	LIBCFS_FREE(cache, sizeof(*cache));
 }
 EXPORT_SYMBOL(upcall_cache_cleanup);
+
+void upcall_cache_get_stats(struct upcall_cache *cache,
+			    struct upcall_cache_stats *stats)
+{
+	spin_lock(&cache->uc_lock);
+	*stats = cache->uc_stats;
+	spin_unlock(&cache->uc_lock);
+}
+EXPORT_SYMBOL(upcall_cache_get_stats);
+
+int upcall_cache_global_init(void)
+{
+	return cfs_wi_sched_create("uc_upcall", cfs_cpt_table, CFS_CPT_ANY,
+				   1, &upcall_cache_sched);
+}
+
+void upcall_cache_global_fini(void)
+{
+	if (upcall_cache_sched != NULL) {
+		cfs_wi_sched_destroy(upcall_cache_sched);
+		upcall_cache_sched = NULL;
+	}
+}
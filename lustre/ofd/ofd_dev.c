@@ -2092,6 +2092,102 @@ out:
 	return rc;
 }
 
+/**
+ * OFD request handler for OST_FALLOCATE RPC.
+ *
+ * This is part of request processing. Validate request fields,
+ * preallocate, or punch a hole in, the given range of the OFD object and
+ * pack reply.
+ *
+ * \param[in] tsi	target session environment for this request
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+static int ofd_fallocate_hdl(struct tgt_session_info *tsi)
+{
+	const struct obdo	*oa = &tsi->tsi_ost_body->oa;
+	struct ost_body		*repbody;
+	struct ofd_thread_info	*info = tsi2ofd_info(tsi);
+	struct ldlm_namespace	*ns = tsi->tsi_tgt->lut_obd->obd_namespace;
+	struct ldlm_resource	*res;
+	struct ofd_object	*fo;
+	__u64			 flags = 0;
+	struct lustre_handle	 lh = { 0, };
+	int			 rc;
+	__u64			 start, end;
+	int			 mode;
+	bool			 srvlock;
+
+	ENTRY;
+
+	if ((oa->o_valid & (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS)) !=
+	    (OBD_MD_FLSIZE | OBD_MD_FLBLOCKS))
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-ENOMEM));
+
+	/* fallocate start,end are passed in o_size,o_blocks like punch */
+	start = oa->o_size;
+	end = oa->o_blocks;
+	mode = oa->o_falloc_mode;
+
+	if (start >= end)
+		RETURN(-EINVAL);
+
+	repbody->oa.o_oi = oa->o_oi;
+	repbody->oa.o_valid = OBD_MD_FLID;
+
+	srvlock = oa->o_valid & OBD_MD_FLFLAGS &&
+		  oa->o_flags & OBD_FL_SRVLOCK;
+
+	if (srvlock) {
+		rc = tgt_extent_lock(ns, &tsi->tsi_resid, start, end, &lh,
+				     LCK_PW, &flags);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
+	CDEBUG(D_INODE, "calling fallocate for object "DFID", valid = "LPX64
+	       ", start = "LPD64", end = "LPD64", mode = %#x\n",
+	       PFID(&tsi->tsi_fid), oa->o_valid, start, end, mode);
+
+	fo = ofd_object_find_exists(tsi->tsi_env, ofd_exp(tsi->tsi_exp),
+				    &tsi->tsi_fid);
+	if (IS_ERR(fo))
+		GOTO(out, rc = PTR_ERR(fo));
+
+	la_from_obdo(&info->fti_attr, oa,
+		     OBD_MD_FLMTIME | OBD_MD_FLATIME | OBD_MD_FLCTIME);
+
+	rc = ofd_object_fallocate(tsi->tsi_env, fo, start, end, mode,
+				  &info->fti_attr, (struct obdo *)oa);
+	if (rc)
+		GOTO(out_put, rc);
+
+	ofd_counter_incr(tsi->tsi_exp, LPROC_OFD_STATS_PREALLOC,
+			 tsi->tsi_jobid, 1);
+	EXIT;
+out_put:
+	ofd_object_put(tsi->tsi_env, fo);
+out:
+	if (srvlock)
+		tgt_extent_unlock(&lh, LCK_PW);
+	if (rc == 0) {
+		/* refresh the LVB after the object reference is dropped,
+		 * see ofd_punch_hdl() */
+		res = ldlm_resource_get(ns, NULL, &tsi->tsi_resid,
+					LDLM_EXTENT, 0);
+		if (!IS_ERR(res)) {
+			ldlm_res_lvbo_update(res, NULL, 0);
+			ldlm_resource_putref(res);
+		}
+	}
+	return rc;
+}
+
 /**
  * OFD request handler for OST_QUOTACTL RPC.
  *
@@ -2252,6 +2348,7 @@ static int ofd_prolong_extent_locks(struct tgt_session_info *tsi,
 		.end = end
 	};
 	struct ldlm_lock	*lock;
+	struct ldlm_lock_srv	*lsv;
 	int			 lock_count = 0;
 
 	ENTRY;
@@ -2278,7 +2375,8 @@ static int ofd_prolong_extent_locks(struct tgt_session_info *tsi,
 	}
 
 	spin_lock_bh(&exp->exp_bl_list_lock);
-	list_for_each_entry(lock, &exp->exp_bl_list, l_exp_list) {
+	list_for_each_entry(lsv, &exp->exp_bl_list, ls_exp_list) {
+		lock = lsv->ls_lock;
 		LASSERT(lock->l_flags & LDLM_FL_AST_SENT);
 		LASSERT(lock->l_resource->lr_type == LDLM_EXTENT);
 
@@ -2610,6 +2708,8 @@ TGT_OST_HDL_HP(HABEO_CORPUS| HABEO_REFERO | MUTABOR,
 					OST_PUNCH,	ofd_punch_hdl,
 							ofd_hp_punch),
 TGT_OST_HDL(HABEO_CORPUS| HABEO_REFERO,	OST_SYNC,	ofd_sync_hdl),
+TGT_OST_HDL(HABEO_CORPUS| HABEO_REFERO | MUTABOR,
+					OST_FALLOCATE,	ofd_fallocate_hdl),
 TGT_OST_HDL(0		| HABEO_REFERO,	OST_QUOTACTL,	ofd_quotactl),
 };
 
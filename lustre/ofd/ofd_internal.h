@@ -51,6 +51,9 @@
 #define OFD_PRECREATE_SMALL_FS		(1024ULL * 1024 * 1024)
 #define OFD_PRECREATE_BATCH_SMALL	8
 
+/* preallocate at most this much space in a single transaction */
+#define OFD_PREALLOC_CHUNK		(128ULL * 1024 * 1024)
+
 /* Limit the returned fields marked valid to those that we actually might set */
 #define OFD_VALID_FLAGS (LA_TYPE | LA_MODE | LA_SIZE | LA_BLOCKS | \
 			 LA_BLKSIZE | LA_ATIME | LA_MTIME | LA_CTIME)
@@ -83,6 +86,7 @@ enum {
 	LPROC_OFD_STATS_GET_INFO,
 	LPROC_OFD_STATS_SET_INFO,
 	LPROC_OFD_STATS_QUOTACTL,
+	LPROC_OFD_STATS_PREALLOC,
 	LPROC_OFD_STATS_LAST,
 };
 
@@ -381,8 +385,8 @@ struct thandle *ofd_trans_create(const struct lu_env *env,
 int ofd_trans_start(const struct lu_env *env,
 		    struct ofd_device *ofd, struct ofd_object *fo,
 		    struct thandle *th);
-void ofd_trans_stop(const struct lu_env *env, struct ofd_device *ofd,
-		    struct thandle *th, int rc);
+int ofd_trans_stop(const struct lu_env *env, struct ofd_device *ofd,
+		   struct thandle *th, int rc);
 int ofd_txn_stop_cb(const struct lu_env *env, struct thandle *txn,
 		    void *cookie);
 
@@ -408,6 +412,9 @@ int ofd_attr_set(const struct lu_env *env, struct ofd_object *fo,
 int ofd_object_punch(const struct lu_env *env, struct ofd_object *fo,
 		     __u64 start, __u64 end, struct lu_attr *la,
 		     struct filter_fid *ff, struct obdo *oa);
+int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
+			 __u64 start, __u64 end, int mode, struct lu_attr *la,
+			 struct obdo *oa);
 int ofd_object_destroy(const struct lu_env *, struct ofd_object *, int);
 int ofd_attr_get(const struct lu_env *env, struct ofd_object *fo,
 		 struct lu_attr *la);
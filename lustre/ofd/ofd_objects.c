@@ -583,8 +583,8 @@ unlock:
  *
  * This function frees all of the allocated object's space from the \a start
  * offset to the \a end offset. For truncate() operations the \a end offset
- * is OBD_OBJECT_EOF. The functionality to punch holes in an object via
- * fallocate(FALLOC_FL_PUNCH_HOLE) is not yet implemented (see LU-3606).
+ * is OBD_OBJECT_EOF. Holes are punched in the middle of an object by
+ * ofd_object_fallocate() with FALLOC_FL_PUNCH_HOLE.
  *
  * \param[in] env	execution environment
  * \param[in] fo	OFD object
@@ -705,6 +705,115 @@ unlock:
 	return rc;
 }
 
+/**
+ * Preallocate space for, or punch a hole in, an OFD object.
+ *
+ * This function allocates the object's space from the \a start offset to
+ * the \a end offset without writing any data, so that later writes into
+ * the region find their blocks already allocated and contiguous. Unless
+ * FALLOC_FL_KEEP_SIZE is set in \a mode, the object size is extended to
+ * \a end, as for a write. With FALLOC_FL_PUNCH_HOLE the space of the
+ * region is freed instead.
+ *
+ * A large region is allocated in OFD_PREALLOC_CHUNK pieces, one
+ * transaction each, as it would not fit a single transaction. Each piece
+ * is allocated, and the object size and times updated, in the same
+ * transaction, so a crash leaves the object consistent with the pieces
+ * allocated so far.
+ *
+ * \param[in] env	execution environment
+ * \param[in] fo	OFD object
+ * \param[in] start	start offset to allocate from
+ * \param[in] end	end of allocation
+ * \param[in] mode	fallocate mode (FALLOC_FL_* flags)
+ * \param[in] la	object attributes
+ * \param[in] oa	obdo struct from incoming request
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
+			 __u64 start, __u64 end, int mode, struct lu_attr *la,
+			 struct obdo *oa)
+{
+	struct ofd_thread_info	*info = ofd_info(env);
+	struct ofd_device	*ofd = ofd_obj2dev(fo);
+	struct ofd_mod_data	*fmd;
+	struct dt_object	*dob = ofd_object_child(fo);
+	struct thandle		*th;
+	__u64			 pos;
+	__u64			 chunk_end;
+	int			 rc;
+	int			 rc2;
+
+	ENTRY;
+
+	ofd_write_lock(env, fo);
+	fmd = ofd_fmd_get(info->fti_exp, &fo->ofo_header.loh_fid);
+	if (fmd && fmd->fmd_mactime_xid < info->fti_xid)
+		fmd->fmd_mactime_xid = info->fti_xid;
+	ofd_fmd_put(info->fti_exp, fmd);
+
+	if (!ofd_object_exists(fo))
+		GOTO(unlock, rc = -ENOENT);
+
+	if (ofd->ofd_lfsck_verify_pfid && oa->o_valid & OBD_MD_FLFID) {
+		rc = ofd_verify_ff(env, fo, oa);
+		if (rc != 0)
+			GOTO(unlock, rc);
+	}
+
+	/* VBR: version recovery check */
+	rc = ofd_version_get_check(info, fo);
+	if (rc)
+		GOTO(unlock, rc);
+
+	rc = ofd_attr_handle_ugid(env, fo, la, 0 /* !is_setattr */);
+	if (rc != 0)
+		GOTO(unlock, rc);
+
+	for (pos = start; pos < end && rc == 0; pos = chunk_end) {
+		/* the OSD punches the whole hole itself */
+		if (mode & FALLOC_FL_PUNCH_HOLE ||
+		    end - pos <= OFD_PREALLOC_CHUNK)
+			chunk_end = end;
+		else
+			chunk_end = pos + OFD_PREALLOC_CHUNK;
+
+		th = ofd_trans_create(env, ofd);
+		if (IS_ERR(th))
+			GOTO(unlock, rc = PTR_ERR(th));
+
+		rc = dt_declare_attr_set(env, dob, la, th);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = dt_declare_fallocate(env, dob, pos, chunk_end, mode, th);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = ofd_trans_start(env, ofd, fo, th);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = dt_fallocate(env, dob, pos, chunk_end, mode, th);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = dt_attr_set(env, dob, la, th);
+stop:
+		/* a hole is only punched once the transaction stops */
+		rc2 = ofd_trans_stop(env, ofd, th, rc);
+		if (rc == 0)
+			rc = rc2;
+	}
+	EXIT;
+unlock:
+	ofd_write_unlock(env, fo);
+
+	return rc;
+}
+
 /**
  * Destroy OFD object.
  *
@@ -64,6 +64,13 @@ struct osc_async_page {
         enum async_flags        oap_async_flags;
 
         struct brw_page         oap_brw_page;
+	/* checksum of the page in the last write RPC, reused on resend */
+	__u32			 oap_cksum;
+	/* cksum_type_t of oap_cksum, 0 if there is none */
+	cksum_type_t		 oap_cksum_type;
+	/* offset in the page and bytes covered by oap_cksum */
+	unsigned int		 oap_cksum_off;
+	unsigned int		 oap_cksum_count;
 
         struct ptlrpc_request   *oap_request;
         struct client_obd       *oap_cli;
@@ -124,6 +131,9 @@ int osc_setattr_async_base(struct obd_export *exp, struct obd_info *oinfo,
 int osc_punch_base(struct obd_export *exp, struct obd_info *oinfo,
                    obd_enqueue_update_f upcall, void *cookie,
                    struct ptlrpc_request_set *rqset);
+int osc_fallocate_base(struct obd_export *exp, struct obd_info *oinfo,
+		       obd_enqueue_update_f upcall, void *cookie,
+		       struct ptlrpc_request_set *rqset);
 int osc_sync_base(struct obd_export *exp, struct obd_info *oinfo,
 		  obd_enqueue_update_f upcall, void *cookie,
 		  struct ptlrpc_request_set *rqset);
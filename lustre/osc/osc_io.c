@@ -495,6 +495,11 @@ static int osc_io_setattr_start(const struct lu_env *env,
 	if (cl_io_is_trunc(io))
 		result = osc_cache_truncate_start(env, oio, cl2osc(obj), size);
 
+	if (cl_io_is_fallocate(io) &&
+	    !(exp_connect_flags(osc_export(cl2osc(obj))) &
+	      OBD_CONNECT_FALLOCATE))
+		result = -EOPNOTSUPP;
+
 	if (result == 0 && oio->oi_lockless == 0) {
 		cl_object_attr_lock(obj);
 		result = cl_object_attr_get(env, obj, attr);
@@ -505,6 +510,20 @@ static int osc_io_setattr_start(const struct lu_env *env,
 			if (ia_valid & ATTR_SIZE) {
 				attr->cat_size = attr->cat_kms = size;
 				cl_valid = (CAT_SIZE | CAT_KMS);
+			} else if (cl_io_is_fallocate(io) &&
+				   !(io->u.ci_setattr.sa_falloc_mode &
+				     (FALLOC_FL_KEEP_SIZE |
+				      FALLOC_FL_PUNCH_HOLE))) {
+				__u64 end = io->u.ci_setattr.sa_falloc_end;
+
+				if (end > attr->cat_size) {
+					attr->cat_size = end;
+					cl_valid |= CAT_SIZE;
+				}
+				if (end > attr->cat_kms) {
+					attr->cat_kms = end;
+					cl_valid |= CAT_KMS;
+				}
 			}
 			if (ia_valid & ATTR_MTIME_SET) {
 				attr->cat_mtime = lvb->lvb_mtime;
@@ -533,7 +552,14 @@ static int osc_io_setattr_start(const struct lu_env *env,
 		oa->o_ctime = attr->cat_ctime;
 		oa->o_valid |= OBD_MD_FLID | OBD_MD_FLGROUP | OBD_MD_FLATIME |
 			OBD_MD_FLCTIME | OBD_MD_FLMTIME;
-                if (ia_valid & ATTR_SIZE) {
+		if (cl_io_is_fallocate(io)) {
+			/* fallocate range is sent in o_size,o_blocks like
+			 * the punch range */
+			oa->o_size = io->u.ci_setattr.sa_falloc_offset;
+			oa->o_blocks = io->u.ci_setattr.sa_falloc_end;
+			oa->o_falloc_mode = io->u.ci_setattr.sa_falloc_mode;
+			oa->o_valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+		} else if (ia_valid & ATTR_SIZE) {
                         oa->o_size = size;
                         oa->o_blocks = OBD_OBJECT_EOF;
                         oa->o_valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
@@ -550,7 +576,11 @@ static int osc_io_setattr_start(const struct lu_env *env,
                 oinfo.oi_capa = io->u.ci_setattr.sa_capa;
 		init_completion(&cbargs->opc_sync);
 
-                if (ia_valid & ATTR_SIZE)
+		if (cl_io_is_fallocate(io))
+			result = osc_fallocate_base(osc_export(cl2osc(obj)),
+						    &oinfo, osc_async_upcall,
+						    cbargs, PTLRPCD_SET);
+		else if (ia_valid & ATTR_SIZE)
                         result = osc_punch_base(osc_export(cl2osc(obj)),
 						&oinfo, osc_async_upcall,
                                                 cbargs, PTLRPCD_SET);
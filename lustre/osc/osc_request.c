@@ -443,6 +443,52 @@ int osc_punch_base(struct obd_export *exp, struct obd_info *oinfo,
         RETURN(0);
 }
 
+int osc_fallocate_base(struct obd_export *exp, struct obd_info *oinfo,
+		       obd_enqueue_update_f upcall, void *cookie,
+		       struct ptlrpc_request_set *rqset)
+{
+	struct ptlrpc_request	*req;
+	struct osc_setattr_args	*sa;
+	struct ost_body		*body;
+	int			 rc;
+	ENTRY;
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_OST_FALLOCATE);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	osc_set_capa_size(req, &RMF_CAPA1, oinfo->oi_capa);
+	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, OST_FALLOCATE);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+	/* allocation may take a while, like punch (bug 7198) */
+	req->rq_request_portal = OST_IO_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body);
+	lustre_set_wire_obdo(&req->rq_import->imp_connect_data, &body->oa,
+			     oinfo->oi_oa);
+	osc_pack_capa(req, body, oinfo->oi_capa);
+
+	ptlrpc_request_set_replen(req);
+
+	req->rq_interpret_reply = (ptlrpc_interpterer_t)osc_setattr_interpret;
+	CLASSERT(sizeof(*sa) <= sizeof(req->rq_async_args));
+	sa = ptlrpc_req_async_args(req);
+	sa->sa_oa     = oinfo->oi_oa;
+	sa->sa_upcall = upcall;
+	sa->sa_cookie = cookie;
+	if (rqset == PTLRPCD_SET)
+		ptlrpcd_add_req(req, PDL_POLICY_ROUND, -1);
+	else
+		ptlrpc_set_add_req(rqset, req);
+
+	RETURN(0);
+}
+
 static int osc_sync_interpret(const struct lu_env *env,
                               struct ptlrpc_request *req,
                               void *arg, int rc)
@@ -1021,19 +1067,39 @@ static inline int can_merge_pages(struct brw_page *p1, struct brw_page *p2)
         return (p1->off + p1->count == p2->off);
 }
 
-static u32 osc_checksum_bulk(int nob, size_t pg_count,
+/**
+ * Checksum the pages of a bulk RPC.
+ *
+ * Writes checksum each page separately and combine the page checksums into
+ * the checksum of the RPC, which is the same as if the pages were hashed as
+ * a whole.  The page checksums are kept in the osc_async_pages, so a resent
+ * write only checksums the pages it has no checksum of yet, or whose
+ * checksum covers another part of the page.
+ *
+ * \param[in] resend	reuse the page checksums of the previous send
+ * \param[out] cksum	checksum of the RPC
+ *
+ * \retval 0		success
+ * \retval negative	errno if the checksum cannot be computed
+ */
+static int osc_checksum_bulk(int nob, size_t pg_count,
 			     struct brw_page **pga, int opc,
-			     cksum_type_t cksum_type)
+			     cksum_type_t cksum_type, int resend, u32 *cksum)
 {
-	u32				cksum;
 	int				i = 0;
 	struct cfs_crypto_hash_desc	*hdesc;
 	unsigned int			bufsize;
+	int				rc = 0;
 	int				err;
 	unsigned char			cfs_alg = cksum_obd2cfs(cksum_type);
+	bool				per_page;
 
 	LASSERT(pg_count > 0);
 
+	*cksum = 0;
+	/* only if the combined page digests were checked at load time */
+	per_page = opc == OST_WRITE && cfs_crypto_hash_page_speed(cfs_alg) > 0;
+
 	hdesc = cfs_crypto_hash_init(cfs_alg, NULL, 0);
 	if (IS_ERR(hdesc)) {
 		CERROR("Unable to initialize checksum hash %s\n",
@@ -1043,6 +1109,7 @@ static u32 osc_checksum_bulk(int nob, size_t pg_count,
 
 	while (nob > 0 && pg_count > 0) {
 		unsigned int count = pga[i]->count > nob ? nob : pga[i]->count;
+		unsigned int off = pga[i]->off & ~CFS_PAGE_MASK;
 
 		/* corrupt the data before we compute the checksum, to
 		 * simulate an OST->client data error */
@@ -1054,26 +1121,65 @@ static u32 osc_checksum_bulk(int nob, size_t pg_count,
 			memcpy(ptr + off, "bad1", min_t(typeof(nob), 4, nob));
 			kunmap(pga[i]->pg);
 		}
-		cfs_crypto_hash_update_page(hdesc, pga[i]->pg,
-					    pga[i]->off & ~CFS_PAGE_MASK,
-					    count);
-		LL_CDEBUG_PAGE(D_PAGE, pga[i]->pg, "off %d\n",
-			       (int)(pga[i]->off & ~CFS_PAGE_MASK));
+		if (per_page) {
+			struct osc_async_page *oap = brw_page2oap(pga[i]);
+
+			if (!resend || oap->oap_cksum_type != cksum_type ||
+			    oap->oap_cksum_off != off ||
+			    oap->oap_cksum_count != count) {
+				bufsize = sizeof(oap->oap_cksum);
+				rc = cfs_crypto_hash_digest_page(hdesc,
+					pga[i]->pg, off, count,
+					(unsigned char *)&oap->oap_cksum,
+					&bufsize);
+				if (rc != 0) {
+					oap->oap_cksum_type = 0;
+					break;
+				}
+				oap->oap_cksum_type = cksum_type;
+				oap->oap_cksum_off = off;
+				oap->oap_cksum_count = count;
+			}
+			if (i == 0)
+				*cksum = oap->oap_cksum;
+			else
+				cfs_crypto_hash_combine(cfs_alg, cksum,
+							oap->oap_cksum, count);
+		} else {
+			rc = cfs_crypto_hash_update_page(hdesc, pga[i]->pg,
+							 off, count);
+			if (rc != 0)
+				break;
+		}
+		LL_CDEBUG_PAGE(D_PAGE, pga[i]->pg, "off %u\n", off);
 
 		nob -= pga[i]->count;
 		pg_count--;
 		i++;
 	}
 
-	bufsize = sizeof(cksum);
-	err = cfs_crypto_hash_final(hdesc, (unsigned char *)&cksum, &bufsize);
+	if (per_page) {
+		/* the page checksums are already combined, only free hdesc */
+		err = cfs_crypto_hash_final(hdesc, NULL, NULL);
+	} else {
+		bufsize = sizeof(*cksum);
+		err = cfs_crypto_hash_final(hdesc, (unsigned char *)cksum,
+					    &bufsize);
+	}
+	if (rc == 0)
+		rc = err;
+	if (rc != 0) {
+		CERROR("Unable to compute checksum %s: rc = %d\n",
+		       cfs_crypto_hash_name(cfs_alg), rc);
+		return rc;
+	}
 
 	/* For sending we only compute the wrong checksum instead
 	 * of corrupting the data so it is still correct on a redo */
 	if (opc == OST_WRITE && OBD_FAIL_CHECK(OBD_FAIL_OSC_CHECKSUM_SEND))
-		cksum++;
+		(*cksum)++;
 
-	return cksum;
+	return 0;
 }
 
 static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
@@ -1229,10 +1335,11 @@ static int osc_brw_prep_request(int cmd, struct client_obd *cli,struct obdo *oa,
                         }
                         body->oa.o_flags |= cksum_type_pack(cksum_type);
                         body->oa.o_valid |= OBD_MD_FLCKSUM | OBD_MD_FLFLAGS;
-                        body->oa.o_cksum = osc_checksum_bulk(requested_nob,
-                                                             page_count, pga,
-                                                             OST_WRITE,
-                                                             cksum_type);
+			rc = osc_checksum_bulk(requested_nob, page_count, pga,
+					       OST_WRITE, cksum_type, resend,
+					       &body->oa.o_cksum);
+			if (rc < 0)
+				GOTO(out, rc);
                         CDEBUG(D_PAGE, "checksum at write origin: %x\n",
                                body->oa.o_cksum);
                         /* save this in 'oa', too, for later checking */
@@ -1291,6 +1398,7 @@ static int check_write_checksum(struct obdo *oa, const lnet_process_id_t *peer,
         __u32 new_cksum;
         char *msg;
         cksum_type_t cksum_type;
+	int rc;
 
         if (server_cksum == client_cksum) {
                 CDEBUG(D_PAGE, "checksum %x confirmed\n", client_cksum);
@@ -1299,10 +1407,14 @@ static int check_write_checksum(struct obdo *oa, const lnet_process_id_t *peer,
 
         cksum_type = cksum_type_unpack(oa->o_valid & OBD_MD_FLFLAGS ?
                                        oa->o_flags : 0);
-        new_cksum = osc_checksum_bulk(nob, page_count, pga, OST_WRITE,
-                                      cksum_type);
-
-        if (cksum_type != client_cksum_type)
+	/* checksum the pages again, the data may have changed since, and
+	 * the resend should not reuse the page checksums */
+	rc = osc_checksum_bulk(nob, page_count, pga, OST_WRITE, cksum_type, 0,
+			       &new_cksum);
+
+	if (rc < 0)
+		msg = "failed to calculate the client write checksum";
+	else if (cksum_type != client_cksum_type)
                 msg = "the server did not use the checksum type specified in "
                       "the original request - likely a protocol problem";
         else if (new_cksum == server_cksum)
@@ -1419,13 +1531,15 @@ static int osc_brw_fini_request(struct ptlrpc_request *req, int rc)
 		u32        server_cksum = body->oa.o_cksum;
 		char      *via = "";
 		char      *router = "";
+		int	   nob = rc;
                 cksum_type_t cksum_type;
 
                 cksum_type = cksum_type_unpack(body->oa.o_valid &OBD_MD_FLFLAGS?
                                                body->oa.o_flags : 0);
-                client_cksum = osc_checksum_bulk(rc, aa->aa_page_count,
-                                                 aa->aa_ppga, OST_READ,
-                                                 cksum_type);
+		rc = osc_checksum_bulk(nob, aa->aa_page_count, aa->aa_ppga,
+				       OST_READ, cksum_type, 0, &client_cksum);
+		if (rc < 0)
+			GOTO(out, rc);
 
 		if (peer->nid != req->rq_bulk->bd_sender) {
 			via = " via ";
@@ -130,6 +130,7 @@ int osd_trans_declare_op2rb[] = {
 	[OSD_OT_INSERT]		= OSD_OT_DELETE,
 	[OSD_OT_DELETE]		= OSD_OT_INSERT,
 	[OSD_OT_QUOTA]		= OSD_OT_MAX,
+	[OSD_OT_PREALLOC]	= OSD_OT_MAX,
 };
 
 static int osd_has_index(const struct osd_object *obj)
@@ -1059,6 +1060,9 @@ static int osd_trans_start(const struct lu_env *env, struct dt_device *d,
 		      oti->oti_declare_ops_cred[OSD_OT_REF_ADD],
 		      oti->oti_declare_ops[OSD_OT_REF_DEL],
 		      oti->oti_declare_ops_cred[OSD_OT_REF_DEL]);
+		CWARN("  prealloc: %u/%u\n",
+		      oti->oti_declare_ops[OSD_OT_PREALLOC],
+		      oti->oti_declare_ops_cred[OSD_OT_PREALLOC]);
 
 		if (last_credits != oh->ot_credits &&
 		    time_after(jiffies, last_printed +
@@ -1135,6 +1139,10 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	struct osd_device      *osd = osd_dt_dev(th->th_dev);
 	struct qsd_instance    *qsd = osd->od_quota_slave;
 	struct lquota_trans    *qtrans;
+	struct osd_object      *punch_obj;
+	__u64			punch_start;
+	__u64			punch_end;
+	int			punch_result;
 	ENTRY;
 
 	oh = container_of0(th, struct osd_thandle, ot_super);
@@ -1142,6 +1150,14 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	qtrans = oh->ot_quota_trans;
 	oh->ot_quota_trans = NULL;
 
+	/* the handle may be freed by its commit callback once stopped, and
+	 * nothing is punched for a failed transaction */
+	punch_obj = oh->ot_punch_obj;
+	punch_result = th->th_result;
+	punch_start = oh->ot_punch_start;
+	punch_end = oh->ot_punch_end;
+	oh->ot_punch_obj = NULL;
+
         if (oh->ot_handle != NULL) {
                 handle_t *hdl = oh->ot_handle;
 
@@ -1175,6 +1191,14 @@ static int osd_trans_stop(const struct lu_env *env, struct dt_device *dt,
 	/* inform the quota slave device that the transaction is stopping */
 	qsd_op_end(env, qsd, qtrans);
 
+	/* ldiskfs punches holes in handles of its own, see osd_fallocate() */
+	if (punch_obj != NULL) {
+		if (rc == 0 && punch_result == 0)
+			rc = osd_execute_punch(env, punch_obj, punch_start,
+					       punch_end);
+		lu_object_put(env, &punch_obj->oo_dt.do_lu);
+	}
+
 	/* as we want IO to journal and data IO be concurrent, we don't block
 	 * awaiting data IO completion in osd_do_bio(), instead we wait here
 	 * once transaction is submitted to the journal. all reqular requests
@@ -5917,6 +5941,7 @@ static int osd_device_init0(const struct lu_env *env,
 
 	o->od_full_scrub_ratio = OFSR_DEFAULT;
 	o->od_full_scrub_threshold_rate = FULL_SCRUB_THRESHOLD_RATE_DEFAULT;
+	o->od_scrub_threads = SCRUB_THREADS_DEFAULT;
 	rc = osd_mount(env, o, cfg);
 	if (rc != 0)
 		GOTO(out, rc);
@@ -282,6 +282,9 @@ struct osd_device {
 	 * exceeds the osd_device::od_full_scrub_threshold_rate,
 	 * then trigger OI scrub to scan the whole device. */
 	__u64			 od_full_scrub_threshold_rate;
+	/* How many threads scan the inode table for the full speed OI
+	 * scrub, more than one means the parallel OI scrub. */
+	int			 od_scrub_threads;
 };
 
 enum osd_full_scrub_ratio {
@@ -323,7 +326,8 @@ enum {
 	OSD_OT_INSERT		= 8,
 	OSD_OT_DELETE		= 9,
 	OSD_OT_QUOTA		= 10,
-	OSD_OT_MAX		= 11
+	OSD_OT_PREALLOC		= 11,
+	OSD_OT_MAX		= 12
 };
 
 struct osd_thandle {
@@ -338,6 +342,10 @@ struct osd_thandle {
         unsigned short          ot_id_type;
         uid_t                   ot_id_array[OSD_MAX_UGID_CNT];
 	struct lquota_trans    *ot_quota_trans;
+	/* hole punched once the handle is stopped, see osd_fallocate() */
+	struct osd_object      *ot_punch_obj;
+	__u64			ot_punch_start;
+	__u64			ot_punch_end;
 #if OSD_THANDLE_STATS
         /** time when this handle was allocated */
         cfs_time_t oth_alloced;
@@ -500,7 +508,7 @@ struct osd_thread_info {
 	struct dentry		oti_it_dentry;
 
 	union {
-		/* fake struct file for osd_object_sync */
+		/* fake struct file for osd_object_sync, osd_execute_punch */
 		struct file		oti_file;
 		/* osd_statfs() */
 		struct kstatfs		oti_ksfs;
@@ -908,6 +916,8 @@ static inline void osd_ipd_put(const struct lu_env *env,
 int osd_ldiskfs_read(struct inode *inode, void *buf, int size, loff_t *offs);
 int osd_ldiskfs_write_record(struct inode *inode, void *buf, int bufsize,
 			     int write_NUL, loff_t *offs, handle_t *handle);
+int osd_execute_punch(const struct lu_env *env, struct osd_object *obj,
+		      __u64 start, __u64 end);
 
 static inline
 struct dentry *osd_child_dentry_by_inode(const struct lu_env *env,
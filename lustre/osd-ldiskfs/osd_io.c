@@ -1816,6 +1816,257 @@ static int osd_punch(const struct lu_env *env, struct dt_object *dt,
         RETURN(rc == 0 ? rc2 : rc);
 }
 
+#ifdef HAVE_LDISKFS_MAP_BLOCKS
+# ifndef LDISKFS_GET_BLOCKS_CREATE_UNINIT_EXT
+#  define LDISKFS_GET_BLOCKS_CREATE_UNINIT_EXT \
+	LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT
+# endif
+#endif
+
+/* longest run of blocks a single unwritten extent can describe */
+#define OSD_PREALLOC_CHUNK_BLOCKS	32767
+
+/**
+ * Estimate the journal credits needed to map \a blocks new blocks of
+ * \a inode as a single unwritten extent: each level of the extent tree may
+ * be split (block, bitmap, group descriptor plus the old block), and the
+ * allocated range may cross a few block group boundaries, each of which
+ * dirties one more bitmap and group descriptor. The inode itself is
+ * dirtied as well for the i_blocks/i_size update.
+ */
+static int osd_prealloc_credits(struct inode *inode, unsigned long blocks)
+{
+	struct super_block *sb = inode->i_sb;
+	int depth = max(ext_depth(inode), 1) + 1;
+	int groups;
+
+	groups = blocks / LDISKFS_BLOCKS_PER_GROUP(sb) + 2;
+	if (groups > LDISKFS_SB(sb)->s_groups_count)
+		groups = LDISKFS_SB(sb)->s_groups_count;
+
+	return depth * 4 + groups * 2 + 1;
+}
+
+/**
+ * Implementation of dt_body_operations::dbo_declare_fallocate
+ *
+ * Credits are reserved for the whole region, one unwritten extent per
+ * OSD_PREALLOC_CHUNK_BLOCKS, so that osd_fallocate() never has to restart
+ * the handle and the size and attribute updates done in the same
+ * transaction stay atomic with the allocation. Callers split regions that
+ * would not fit a single transaction, see ofd_object_fallocate(). Quota
+ * is declared for the whole region, since every block in it may be
+ * allocated.
+ *
+ * A hole is punched by ldiskfs in transactions of its own once this one
+ * is stopped, so nothing is reserved for it here.
+ */
+static int osd_declare_fallocate(const struct lu_env *env,
+				 struct dt_object *dt, __u64 start, __u64 end,
+				 int mode, struct thandle *th)
+{
+	struct osd_thandle	*oh;
+	struct inode		*inode = osd_dt_obj(dt)->oo_inode;
+	struct osd_device	*osd = osd_obj2dev(osd_dt_obj(dt));
+	unsigned long		 blocks;
+	unsigned long		 chunks;
+	long long		 quota_space;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(th);
+	LASSERT(inode);
+	oh = container_of(th, struct osd_thandle, ot_super);
+
+	/* only extent-mapped objects can hold unwritten extents, and ldiskfs
+	 * only punches holes in them */
+	if (mode & ~(FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE) ||
+	    !osd_extents_enabled(osd_sb(osd), inode))
+		RETURN(-EOPNOTSUPP);
+
+	if (start >= end)
+		RETURN(-EINVAL);
+
+	if (mode & FALLOC_FL_PUNCH_HOLE) {
+		if (!(mode & FALLOC_FL_KEEP_SIZE))
+			RETURN(-EOPNOTSUPP);
+		osd_trans_declare_op(env, oh, OSD_OT_PREALLOC, 0);
+		rc = osd_declare_inode_qid(env, i_uid_read(inode),
+					   i_gid_read(inode), 0, oh,
+					   osd_dt_obj(dt), true, NULL, false);
+		RETURN(rc);
+	}
+
+	blocks = (end - start + LDISKFS_BLOCK_SIZE(osd_sb(osd)) - 1) >>
+		 osd_sb(osd)->s_blocksize_bits;
+	chunks = (blocks + OSD_PREALLOC_CHUNK_BLOCKS - 1) /
+		 OSD_PREALLOC_CHUNK_BLOCKS;
+
+	osd_trans_declare_op(env, oh, OSD_OT_PREALLOC, chunks *
+			     osd_prealloc_credits(inode,
+				min_t(unsigned long, blocks,
+				      OSD_PREALLOC_CHUNK_BLOCKS)));
+
+	quota_space = toqb(end - start);
+	rc = osd_declare_inode_qid(env, i_uid_read(inode), i_gid_read(inode),
+				   quota_space, oh, osd_dt_obj(dt), true,
+				   NULL, false);
+	RETURN(rc);
+}
+
+/**
+ * Punch the hole [start, end) in \a obj.
+ *
+ * Called by osd_trans_stop() once the handle of the transaction that
+ * asked for the hole is stopped: ldiskfs takes i_mutex and starts its own,
+ * possibly restarted, handles to free the blocks, which must not be done
+ * with another handle held. The blocks are released with the same
+ * fallocate(2) method userspace would use, through a fake struct file as
+ * in osd_object_sync().
+ *
+ * \param[in] env	execution environment
+ * \param[in] obj	object to punch
+ * \param[in] start	start of the hole
+ * \param[in] end	end of the hole
+ *
+ * \retval		0 if successful
+ * \retval		negative value on error
+ */
+int osd_execute_punch(const struct lu_env *env, struct osd_object *obj,
+		      __u64 start, __u64 end)
+{
+	struct inode		*inode = obj->oo_inode;
+	struct osd_thread_info	*info = osd_oti_get(env);
+	struct dentry		*dentry = &info->oti_obj_dentry;
+	struct file		*file = &info->oti_file;
+	int			 mode = FALLOC_FL_PUNCH_HOLE |
+					FALLOC_FL_KEEP_SIZE;
+	int			 rc;
+	ENTRY;
+
+	LASSERT(journal_current_handle() == NULL);
+
+	dentry->d_inode = inode;
+	dentry->d_sb = inode->i_sb;
+	file->f_dentry = dentry;
+	file->f_mapping = inode->i_mapping;
+	file->f_op = inode->i_fop;
+	set_file_inode(file, inode);
+
+#ifdef HAVE_FILE_FALLOCATE
+	if (file->f_op == NULL || file->f_op->fallocate == NULL)
+		RETURN(-EOPNOTSUPP);
+	rc = file->f_op->fallocate(file, mode, start, end - start);
+#else
+	if (inode->i_op->fallocate == NULL)
+		RETURN(-EOPNOTSUPP);
+	rc = inode->i_op->fallocate(inode, mode, start, end - start);
+#endif
+	if (rc != 0)
+		CERROR("%s: cannot punch "DFID" ["LPU64", "LPU64"): rc = %d\n",
+		       osd_name(osd_obj2dev(obj)),
+		       PFID(lu_object_fid(&obj->oo_dt.do_lu)), start, end, rc);
+
+	RETURN(rc);
+}
+
+/**
+ * Implementation of dt_body_operations::dbo_fallocate
+ *
+ * Map the region [start, end) of the object with unwritten extents, so
+ * that the blocks are reserved on disk but read back as zeroes until they
+ * are written. Unless FALLOC_FL_KEEP_SIZE is set, the object size is
+ * extended to cover the region. Everything is done in \a th, which was
+ * declared large enough by osd_declare_fallocate().
+ *
+ * For FALLOC_FL_PUNCH_HOLE the hole is only queued on \a th, and punched
+ * by osd_execute_punch() when the transaction is stopped.
+ */
+static int osd_fallocate(const struct lu_env *env, struct dt_object *dt,
+			 __u64 start, __u64 end, int mode, struct thandle *th)
+{
+	struct osd_thandle	*oh;
+	struct osd_object	*obj = osd_dt_obj(dt);
+	struct inode		*inode = obj->oo_inode;
+#ifdef HAVE_LDISKFS_MAP_BLOCKS
+	struct ldiskfs_map_blocks map = { 0 };
+	unsigned int		 blkbits = inode->i_blkbits;
+	loff_t			 new_size = 0;
+	int			 flags;
+	int			 rc = 0;
+#endif
+	ENTRY;
+
+	LASSERT(dt_object_exists(dt));
+	LASSERT(osd_invariant(obj));
+	LASSERT(th);
+	ll_vfs_dq_init(inode);
+
+	oh = container_of(th, struct osd_thandle, ot_super);
+	LASSERT(oh->ot_handle->h_transaction != NULL);
+
+	osd_trans_exec_op(env, th, OSD_OT_PREALLOC);
+
+	if (mode & FALLOC_FL_PUNCH_HOLE) {
+		/* only one hole can be queued per transaction */
+		if (oh->ot_punch_obj != NULL)
+			RETURN(-EBUSY);
+		lu_object_get(&dt->do_lu);
+		oh->ot_punch_obj = obj;
+		oh->ot_punch_start = start;
+		oh->ot_punch_end = end;
+		RETURN(0);
+	}
+
+#ifdef HAVE_LDISKFS_MAP_BLOCKS
+	flags = LDISKFS_GET_BLOCKS_CREATE_UNINIT_EXT;
+#ifdef LDISKFS_GET_BLOCKS_KEEP_SIZE
+	if (mode & FALLOC_FL_KEEP_SIZE)
+		flags |= LDISKFS_GET_BLOCKS_KEEP_SIZE;
+#endif
+
+	map.m_lblk = start >> blkbits;
+	map.m_len = ((end + (1 << blkbits) - 1) >> blkbits) - map.m_lblk;
+
+	while (map.m_len > 0) {
+		map.m_len = min_t(unsigned int, map.m_len,
+				  OSD_PREALLOC_CHUNK_BLOCKS);
+		rc = ldiskfs_map_blocks(oh->ot_handle, inode, &map, flags);
+		if (rc <= 0) {
+			CDEBUG(D_INODE, "%s: cannot preallocate "DFID" at %u: "
+			       "rc = %d\n", osd_name(osd_obj2dev(obj)),
+			       PFID(lu_object_fid(&dt->do_lu)), map.m_lblk,
+			       rc);
+			if (rc == 0)
+				rc = -ENOSPC;
+			break;
+		}
+
+		new_size = min_t(loff_t, (loff_t)(map.m_lblk + rc) << blkbits,
+				 end);
+		map.m_lblk += rc;
+		map.m_len = ((end + (1 << blkbits) - 1) >> blkbits) -
+			    map.m_lblk;
+		rc = 0;
+	}
+
+	if (!(mode & FALLOC_FL_KEEP_SIZE) && new_size > i_size_read(inode)) {
+		spin_lock(&inode->i_lock);
+		if (new_size > i_size_read(inode))
+			i_size_write(inode, new_size);
+		if (i_size_read(inode) > LDISKFS_I(inode)->i_disksize)
+			LDISKFS_I(inode)->i_disksize = i_size_read(inode);
+		spin_unlock(&inode->i_lock);
+	}
+	inode->i_ctime = inode->i_mtime = CURRENT_TIME;
+	ll_dirty_inode(inode, I_DIRTY_DATASYNC);
+
+	RETURN(rc);
+#else
+	RETURN(-EOPNOTSUPP);
+#endif
+}
+
 static int fiemap_check_ranges(struct inode *inode,
 			       u64 start, u64 len, u64 *new_len)
 {
@@ -1900,6 +2151,8 @@ const struct dt_body_operations osd_body_ops = {
         .dbo_read_prep            = osd_read_prep,
         .dbo_declare_punch         = osd_declare_punch,
         .dbo_punch                 = osd_punch,
+	.dbo_declare_fallocate	  = osd_declare_fallocate,
+	.dbo_fallocate		  = osd_fallocate,
         .dbo_fiemap_get           = osd_fiemap_get,
 };
 
@@ -478,6 +478,43 @@ ldiskfs_osd_full_scrub_threshold_rate_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ldiskfs_osd_full_scrub_threshold_rate);
 
+static int ldiskfs_osd_scrub_threads_seq_show(struct seq_file *m, void *data)
+{
+	struct osd_device *dev = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	return seq_printf(m, "%d\n", dev->od_scrub_threads);
+}
+
+static ssize_t
+ldiskfs_osd_scrub_threads_seq_write(struct file *file, const char *buffer,
+				    size_t count, loff_t *off)
+{
+	struct seq_file	  *m = file->private_data;
+	struct dt_device  *dt = m->private;
+	struct osd_device *dev = osd_dt_dev(dt);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	if (val < 1 || val > SCRUB_THREADS_MAX)
+		return -EINVAL;
+
+	/* It takes effect from the next full speed OI scrub scanning. */
+	dev->od_scrub_threads = val;
+	return count;
+}
+LPROC_SEQ_FOPS(ldiskfs_osd_scrub_threads);
+
 static int
 ldiskfs_osd_track_declares_assert_seq_show(struct seq_file *m, void *data)
 {
@@ -660,6 +697,8 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	  .fops	=	&ldiskfs_osd_full_scrub_ratio_fops	},
 	{ .name	=	"full_scrub_threshold_rate",
 	  .fops	=	&ldiskfs_osd_full_scrub_threshold_rate_fops	},
+	{ .name	=	"scrub_threads",
+	  .fops	=	&ldiskfs_osd_scrub_threads_fops		},
 	{ .name	=	"oi_scrub",
 	  .fops	=	&ldiskfs_osd_oi_scrub_fops	},
 	{ .name	=	"read_cache_enable",
@@ -455,7 +455,7 @@ stop:
 
 static int
 osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
-		       struct osd_idmap_cache *oic, int val)
+		       struct osd_idmap_cache *oic, int val, bool prior)
 {
 	struct osd_scrub	     *scrub  = &dev->od_scrub;
 	struct scrub_file	     *sf     = &scrub->os_file;
@@ -470,20 +470,27 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	bool			      converted = false;
 	ENTRY;
 
+	/* The os_rwsem only protects the scrub file and statistics, the OI
+	 * lookup and update are done without it, so that the parallel OI
+	 * scrub workers do not serialize on it. */
 	down_write(&scrub->os_rwsem);
 	scrub->os_new_checked++;
+	up_write(&scrub->os_rwsem);
 	if (val < 0)
 		GOTO(out, rc = val);
 
-	if (scrub->os_in_prior)
+	if (prior)
 		oii = list_entry(oic, struct osd_inconsistent_item,
 				 oii_cache);
 
 	if (lid->oii_ino < sf->sf_pos_latest_start && oii == NULL)
 		GOTO(out, rc = 0);
 
-	if (fid_is_igif(fid))
+	if (fid_is_igif(fid)) {
+		down_write(&scrub->os_rwsem);
 		sf->sf_items_igif++;
+		up_write(&scrub->os_rwsem);
+	}
 
 	if (val == SCRUB_NEXT_OSTOBJ_OLD) {
 		inode = osd_iget(info, dev, lid);
@@ -495,9 +502,11 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 			GOTO(out, rc);
 		}
 
+		down_write(&scrub->os_rwsem);
 		sf->sf_flags |= SF_UPGRADE;
 		sf->sf_internal_flags &= ~SIF_NO_HANDLE_OLD_FID;
 		dev->od_check_ff = 1;
+		up_write(&scrub->os_rwsem);
 		rc = osd_scrub_convert_ff(info, dev, inode, fid);
 		if (rc != 0)
 			GOTO(out, rc);
@@ -536,13 +545,17 @@ iget:
 			}
 		}
 
-		if (!scrub->os_partial_scan)
+		/* The parallel OI scrub only runs at full speed, so the
+		 * workers never set the bit here. */
+		if (!scrub->os_partial_scan && !scrub->os_full_speed)
 			scrub->os_full_speed = 1;
 
 		idx = osd_oi_fid2idx(dev, fid);
 		switch (val) {
 		case SCRUB_NEXT_NOLMA:
+			down_write(&scrub->os_rwsem);
 			sf->sf_flags |= SF_UPGRADE;
+			up_write(&scrub->os_rwsem);
 			if (!(sf->sf_param & SP_DRYRUN)) {
 				rc = osd_ea_fid_set(info, inode, fid, 0, 0);
 				if (rc != 0)
@@ -553,24 +566,32 @@ iget:
 				dev->od_igif_inoi = 0;
 			break;
 		case SCRUB_NEXT_OSTOBJ:
+			down_write(&scrub->os_rwsem);
 			sf->sf_flags |= SF_INCONSISTENT;
+			up_write(&scrub->os_rwsem);
 		case SCRUB_NEXT_OSTOBJ_OLD:
 			break;
 		default:
+			down_write(&scrub->os_rwsem);
 			sf->sf_flags |= SF_RECREATED;
 			if (unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
 				ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+			up_write(&scrub->os_rwsem);
 			break;
 		}
 	} else if (osd_id_eq(lid, lid2)) {
-		if (converted)
+		if (converted) {
+			down_write(&scrub->os_rwsem);
 			sf->sf_items_updated++;
+			up_write(&scrub->os_rwsem);
+		}
 
 		GOTO(out, rc = 0);
 	} else {
-		if (!scrub->os_partial_scan)
+		if (!scrub->os_partial_scan && !scrub->os_full_speed)
 			scrub->os_full_speed = 1;
 
+		down_write(&scrub->os_rwsem);
 		sf->sf_flags |= SF_INCONSISTENT;
 
 		/* XXX: If the device is restored from file-level backup, then
@@ -586,26 +607,31 @@ iget:
 		 *	then ask the client to retry after upgrading completed.
 		 *	No better choice. */
 		dev->od_igif_inoi = 1;
+		up_write(&scrub->os_rwsem);
 	}
 
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops, false,
 			(val == SCRUB_NEXT_OSTOBJ ||
 			 val == SCRUB_NEXT_OSTOBJ_OLD) ? OI_KNOWN_ON_OST : 0);
 	if (rc == 0) {
-		if (scrub->os_in_prior)
+		down_write(&scrub->os_rwsem);
+		if (prior)
 			sf->sf_items_updated_prior++;
 		else
 			sf->sf_items_updated++;
+		up_write(&scrub->os_rwsem);
 	}
 
 	GOTO(out, rc);
 
 out:
 	if (rc < 0) {
+		down_write(&scrub->os_rwsem);
 		sf->sf_items_failed++;
 		if (sf->sf_pos_first_inconsistent == 0 ||
 		    sf->sf_pos_first_inconsistent > lid->oii_ino)
 			sf->sf_pos_first_inconsistent = lid->oii_ino;
+		up_write(&scrub->os_rwsem);
 	} else {
 		rc = 0;
 	}
@@ -619,7 +645,6 @@ out:
 				(val == SCRUB_NEXT_OSTOBJ ||
 				 val == SCRUB_NEXT_OSTOBJ_OLD) ?
 				OI_KNOWN_ON_OST : 0);
-	up_write(&scrub->os_rwsem);
 
 	if (inode != NULL && !IS_ERR(inode))
 		iput(inode);
@@ -1099,7 +1124,7 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 		goto next;
 	}
 
-	rc = osd_scrub_check_update(info, dev, oic, rc);
+	rc = osd_scrub_check_update(info, dev, oic, rc, scrub->os_in_prior);
 	if (rc != 0)
 		return rc;
 
@@ -1232,6 +1257,446 @@ static void osd_scrub_join(struct osd_device *dev, __u32 flags,
 	EXIT;
 }
 
+/* The same as ldiskfs_inode_bitmap() and ldiskfs_inode_table(), which are
+ * not exported by ldiskfs. */
+static inline ldiskfs_fsblk_t
+osd_scrub_group_blk(struct super_block *sb, __le32 lo, __le32 hi)
+{
+	return le32_to_cpu(lo) |
+	       (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT ?
+		(ldiskfs_fsblk_t)le32_to_cpu(hi) << 32 : 0);
+}
+
+/**
+ * Read ahead the inode bitmap and the used part of the inode table of the
+ * given group, so that the scanning of the group will not wait for the
+ * inode table blocks one by one.
+ */
+static void osd_scrub_readahead(struct super_block *sb, ldiskfs_group_t bg)
+{
+	struct ldiskfs_group_desc *desc;
+	ldiskfs_fsblk_t		   blk;
+	__u32			   used;
+	__u32			   count;
+	__u32			   i;
+
+	if (bg >= LDISKFS_SB(sb)->s_groups_count)
+		return;
+
+	desc = ldiskfs_get_group_desc(sb, bg, NULL);
+	if (desc == NULL ||
+	    desc->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT))
+		return;
+
+	sb_breadahead(sb, osd_scrub_group_blk(sb, desc->bg_inode_bitmap_lo,
+					      desc->bg_inode_bitmap_hi));
+
+	used = LDISKFS_INODES_PER_GROUP(sb) -
+	       min_t(__u32, ldiskfs_itable_unused_count(sb, desc),
+		     LDISKFS_INODES_PER_GROUP(sb));
+	count = (used * LDISKFS_INODE_SIZE(sb) + sb->s_blocksize - 1) >>
+		sb->s_blocksize_bits;
+	blk = osd_scrub_group_blk(sb, desc->bg_inode_table_lo,
+				  desc->bg_inode_table_hi);
+	for (i = 0; i < count; i++)
+		sb_breadahead(sb, blk + i);
+}
+
+/* parallel OI scrub */
+
+/**
+ * Scan the group assigned to the OI scrub worker, from the inode
+ * osd_scrub_worker::osw_pos_start to the end of the group.
+ *
+ * \param[in] info	pointer to the worker thread info
+ * \param[in] dev	pointer to the osd device
+ * \param[in] osw	pointer to the worker
+ *
+ * \retval		0 for success
+ * \retval		negative error number on failure
+ */
+static int osd_scrub_group(struct osd_thread_info *info,
+			   struct osd_device *dev,
+			   struct osd_scrub_worker *osw)
+{
+	struct osd_scrub	  *scrub = &dev->od_scrub;
+	struct scrub_file	  *sf	 = &scrub->os_file;
+	struct osd_idmap_cache	  *oic	 = &osw->osw_oic;
+	struct osd_iit_param	   param = { NULL };
+	struct ldiskfs_group_desc *desc;
+	__u32			   ipg;
+	int			   rc	 = 0;
+
+	param.sb = osd_sb(dev);
+	ipg = LDISKFS_INODES_PER_GROUP(param.sb);
+	param.bg = (osw->osw_pos_start - 1) / ipg;
+	param.gbase = 1 + param.bg * ipg;
+	param.offset = (osw->osw_pos_start - 1) % ipg;
+	desc = ldiskfs_get_group_desc(param.sb, param.bg, NULL);
+	if (desc == NULL)
+		return -EIO;
+
+	param.bitmap = ldiskfs_read_inode_bitmap(param.sb, param.bg);
+	if (param.bitmap == NULL) {
+		CDEBUG(D_LFSCK, "%.16s: fail to read bitmap for %u, "
+		       "scrub will stop, urgent mode\n",
+		       osd_scrub2name(scrub), (__u32)param.bg);
+		return -EIO;
+	}
+
+	while (param.offset < ipg) {
+		if (param.offset + ldiskfs_itable_unused_count(param.sb, desc) >
+		    ipg)
+			break;
+
+		if (unlikely(!thread_is_running(&scrub->os_thread) ||
+			     !thread_is_running(&osw->osw_thread)))
+			break;
+
+		if (osd_iit_next(&param, &osw->osw_pos_current) != 0)
+			break;
+
+		rc = osd_iit_iget(info, dev, &oic->oic_fid, &oic->oic_lid,
+				  osw->osw_pos_current, param.sb, true);
+		switch (rc) {
+		case SCRUB_NEXT_CONTINUE:
+			rc = 0;
+			break;
+		case SCRUB_NEXT_NOSCRUB:
+			down_write(&scrub->os_rwsem);
+			scrub->os_new_checked++;
+			sf->sf_items_noscrub++;
+			up_write(&scrub->os_rwsem);
+			rc = 0;
+			break;
+		default:
+			rc = osd_scrub_check_update(info, dev, oic, rc, false);
+			break;
+		}
+		if (rc != 0)
+			break;
+
+		osw->osw_checked++;
+		param.offset++;
+	}
+
+	brelse(param.bitmap);
+	return rc;
+}
+
+static int osd_scrub_worker_main(void *args)
+{
+	struct lu_env		 env;
+	struct osd_scrub_worker *osw	= args;
+	struct osd_scrub	*scrub	= &osw->osw_dev->od_scrub;
+	struct ptlrpc_thread	*thread = &osw->osw_thread;
+	struct l_wait_info	 lwi	= { 0 };
+	int			 rc;
+
+	rc = lu_env_init(&env, LCT_LOCAL);
+	if (rc != 0) {
+		CDEBUG(D_LFSCK, "%.16s: OI scrub worker %d fail to init env: "
+		       "rc = %d\n", osd_scrub2name(scrub), osw->osw_index, rc);
+		GOTO(noenv, rc);
+	}
+
+	spin_lock(&scrub->os_lock);
+	thread_set_flags(thread, SVC_RUNNING);
+	spin_unlock(&scrub->os_lock);
+	wake_up_all(&thread->t_ctl_waitq);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     osw->osw_busy || !thread_is_running(thread),
+			     &lwi);
+		if (!thread_is_running(thread))
+			break;
+
+		rc = osd_scrub_group(osd_oti_get(&env), osw->osw_dev, osw);
+
+		spin_lock(&scrub->os_lock);
+		osw->osw_result = rc;
+		osw->osw_busy = false;
+		spin_unlock(&scrub->os_lock);
+		wake_up_all(&scrub->os_thread.t_ctl_waitq);
+	}
+
+	lu_env_fini(&env);
+
+noenv:
+	spin_lock(&scrub->os_lock);
+	thread_set_flags(thread, SVC_STOPPED);
+	spin_unlock(&scrub->os_lock);
+	wake_up_all(&thread->t_ctl_waitq);
+	return rc;
+}
+
+static void osd_scrub_workers_stop(struct osd_scrub *scrub)
+{
+	struct osd_scrub_worker *workers = scrub->os_workers;
+	struct ptlrpc_thread	*thread;
+	struct l_wait_info	 lwi	 = { 0 };
+	int			 count	 = scrub->os_worker_count;
+	int			 i;
+
+	if (workers == NULL)
+		return;
+
+	for (i = 0; i < count; i++) {
+		thread = &workers[i].osw_thread;
+		spin_lock(&scrub->os_lock);
+		if (thread_is_running(thread))
+			thread_set_flags(thread, SVC_STOPPING);
+		spin_unlock(&scrub->os_lock);
+		wake_up_all(&thread->t_ctl_waitq);
+		l_wait_event(thread->t_ctl_waitq,
+			     thread_is_stopped(thread),
+			     &lwi);
+	}
+
+	down_write(&scrub->os_rwsem);
+	scrub->os_workers = NULL;
+	scrub->os_worker_count = 0;
+	up_write(&scrub->os_rwsem);
+	OBD_FREE(workers, sizeof(*workers) * SCRUB_THREADS_MAX);
+}
+
+static int osd_scrub_workers_start(struct osd_device *dev)
+{
+	struct osd_scrub	*scrub = &dev->od_scrub;
+	struct osd_scrub_worker *workers;
+	struct osd_scrub_worker *osw;
+	struct task_struct	*task;
+	struct l_wait_info	 lwi   = { 0 };
+	int			 count;
+	int			 i;
+
+	count = min(dev->od_scrub_threads, SCRUB_THREADS_MAX);
+	OBD_ALLOC(workers, sizeof(*workers) * SCRUB_THREADS_MAX);
+	if (workers == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < count; i++) {
+		osw = &workers[i];
+		osw->osw_dev = dev;
+		osw->osw_index = i;
+		init_waitqueue_head(&osw->osw_thread.t_ctl_waitq);
+		task = kthread_run(osd_scrub_worker_main, osw, "OI_scrub_%d",
+				   i);
+		if (IS_ERR(task)) {
+			CDEBUG(D_LFSCK, "%.16s: cannot start OI scrub worker "
+			       "%d: rc = %ld\n", osd_scrub2name(scrub), i,
+			       PTR_ERR(task));
+			break;
+		}
+
+		l_wait_event(osw->osw_thread.t_ctl_waitq,
+			     thread_is_running(&osw->osw_thread) ||
+			     thread_is_stopped(&osw->osw_thread),
+			     &lwi);
+		if (!thread_is_running(&osw->osw_thread))
+			break;
+	}
+
+	down_write(&scrub->os_rwsem);
+	scrub->os_workers = workers;
+	scrub->os_worker_count = i;
+	scrub->os_time_workers_start = cfs_time_current();
+	up_write(&scrub->os_rwsem);
+
+	/* Scan with the main thread if no enough workers. */
+	if (i < 2) {
+		osd_scrub_workers_stop(scrub);
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+/* Wake up the OI scrub main thread when some worker finished its group,
+ * or failed, or there are inconsistent items to be handled. */
+static inline bool osd_scrub_parallel_wakeup(struct osd_scrub *scrub,
+					     int nbusy)
+{
+	bool wakeup = false;
+	int  busy   = 0;
+	int  i;
+
+	if (!thread_is_running(&scrub->os_thread) ||
+	    !list_empty(&scrub->os_inconsistent_items))
+		return true;
+
+	spin_lock(&scrub->os_lock);
+	for (i = 0; i < scrub->os_worker_count; i++) {
+		if (scrub->os_workers[i].osw_result != 0)
+			wakeup = true;
+		if (scrub->os_workers[i].osw_busy)
+			busy++;
+	}
+	spin_unlock(&scrub->os_lock);
+
+	return wakeup || busy < nbusy;
+}
+
+/**
+ * The OI scrub main thread for the parallel OI scrub.
+ *
+ * The inode groups are assigned to the workers in order, and the inode
+ * tables of the next groups are read ahead. The main thread itself handles
+ * the inconsistent items found by the RPC services, and it maintains the
+ * osd_scrub::os_pos_current as the position before the oldest group that
+ * is still being scanned, so that the checkpoint, the restart and the
+ * preload of the otable-based iteration never go beyond unscanned inodes.
+ *
+ * \param[in] info	pointer to the OI scrub thread info
+ * \param[in] dev	pointer to the osd device
+ *
+ * \retval		SCRUB_IT_ALL if the whole device has been scanned
+ * \retval		SCRUB_IT_CRASH for the simulated crash
+ * \retval		0 if the OI scrub is stopped or paused
+ * \retval		negative error number on failure
+ */
+static int osd_scrub_parallel(struct osd_thread_info *info,
+			      struct osd_device *dev)
+{
+	struct osd_scrub	  *scrub  = &dev->od_scrub;
+	struct ptlrpc_thread	  *thread = &scrub->os_thread;
+	struct super_block	  *sb	  = osd_sb(dev);
+	struct osd_otable_it	  *it;
+	struct osd_scrub_worker	  *osw;
+	struct osd_scrub_worker	  *idle;
+	struct ldiskfs_group_desc *desc;
+	struct l_wait_info	   lwi	  = { 0 };
+	ldiskfs_group_t		   bg;
+	ldiskfs_group_t		   ra_bg;
+	__u32			   ipg	  = LDISKFS_INODES_PER_GROUP(sb);
+	__u32			   limit;
+	__u32			   pos	  = scrub->os_pos_current;
+	__u32			   low;
+	int			   nbusy;
+	int			   rc	  = 0;
+	int			   i;
+
+	limit = le32_to_cpu(LDISKFS_SB(sb)->s_es->s_inodes_count);
+	ra_bg = (pos - 1) / ipg;
+
+	CDEBUG(D_LFSCK, "%.16s: OI scrub scans with %d workers from %u\n",
+	       osd_scrub2name(scrub), scrub->os_worker_count, pos);
+
+	while (1) {
+		while (!list_empty(&scrub->os_inconsistent_items)) {
+			struct osd_inconsistent_item *oii;
+
+			oii = list_entry(scrub->os_inconsistent_items.next,
+					 struct osd_inconsistent_item,
+					 oii_list);
+			rc = osd_scrub_check_update(info, dev, &oii->oii_cache,
+						    0, true);
+			if (rc != 0)
+				GOTO(out, rc);
+		}
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_CRASH)) {
+			spin_lock(&scrub->os_lock);
+			thread_set_flags(thread, SVC_STOPPING);
+			spin_unlock(&scrub->os_lock);
+			GOTO(out, rc = SCRUB_IT_CRASH);
+		}
+
+		if (OBD_FAIL_CHECK(OBD_FAIL_OSD_SCRUB_FATAL))
+			GOTO(out, rc = -EINVAL);
+
+		if (unlikely(!thread_is_running(thread)))
+			GOTO(out, rc = 0);
+
+		idle = NULL;
+		nbusy = 0;
+		low = pos;
+		spin_lock(&scrub->os_lock);
+		for (i = 0; i < scrub->os_worker_count; i++) {
+			osw = &scrub->os_workers[i];
+			if (osw->osw_result != 0 && rc == 0)
+				rc = osw->osw_result;
+
+			if (osw->osw_busy) {
+				nbusy++;
+				if (osw->osw_pos_start < low)
+					low = osw->osw_pos_start;
+			} else if (idle == NULL) {
+				idle = osw;
+			}
+		}
+		scrub->os_pos_current = low - 1;
+		spin_unlock(&scrub->os_lock);
+		if (rc != 0)
+			GOTO(out, rc);
+
+		rc = osd_scrub_checkpoint(scrub);
+		if (rc != 0) {
+			CDEBUG(D_LFSCK, "%.16s: fail to checkpoint, pos = %u: "
+			       "rc = %d\n", osd_scrub2name(scrub),
+			       scrub->os_pos_current, rc);
+			/* Continue, as long as the scrub itself can go ahead. */
+			rc = 0;
+		}
+
+		it = dev->od_otable_it;
+		if (it != NULL && it->ooi_waiting &&
+		    it->ooi_cache.ooc_pos_preload < scrub->os_pos_current) {
+			spin_lock(&scrub->os_lock);
+			it->ooi_waiting = 0;
+			wake_up_all(&thread->t_ctl_waitq);
+			spin_unlock(&scrub->os_lock);
+		}
+
+		if (pos > limit && nbusy == 0) {
+			scrub->os_pos_current = pos;
+			GOTO(out, rc = SCRUB_IT_ALL);
+		}
+
+		if (pos <= limit && idle != NULL) {
+			bg = (pos - 1) / ipg;
+			desc = ldiskfs_get_group_desc(sb, bg, NULL);
+			if (desc == NULL)
+				GOTO(out, rc = -EIO);
+
+			ldiskfs_lock_group(sb, bg);
+			if (desc->bg_flags &
+			    cpu_to_le16(LDISKFS_BG_INODE_UNINIT)) {
+				ldiskfs_unlock_group(sb, bg);
+				pos = 1 + (bg + 1) * ipg;
+				continue;
+			}
+			ldiskfs_unlock_group(sb, bg);
+
+			/* Keep the inode tables of the next groups in
+			 * flight ahead of the workers. */
+			if (ra_bg < bg)
+				ra_bg = bg;
+			while (ra_bg < bg + 2 * scrub->os_worker_count)
+				osd_scrub_readahead(sb, ra_bg++);
+
+			spin_lock(&scrub->os_lock);
+			idle->osw_pos_start = pos;
+			idle->osw_pos_current = pos;
+			idle->osw_busy = true;
+			spin_unlock(&scrub->os_lock);
+			wake_up_all(&idle->osw_thread.t_ctl_waitq);
+
+			pos = 1 + (bg + 1) * ipg;
+			continue;
+		}
+
+		l_wait_event(thread->t_ctl_waitq,
+			     osd_scrub_parallel_wakeup(scrub, nbusy),
+			     &lwi);
+	}
+
+out:
+	osd_scrub_workers_stop(scrub);
+	return rc;
+}
+
 static int osd_inode_iteration(struct osd_thread_info *info,
 			       struct osd_device *dev, __u32 max, bool preload)
 {
@@ -1338,6 +1803,10 @@ full:
 			RETURN(0);
 	}
 
+	if (!preload && scrub->os_full_speed && dev->od_scrub_threads > 1 &&
+	    osd_scrub_workers_start(dev) == 0)
+		RETURN(osd_scrub_parallel(info, dev));
+
 	noslot = false;
 	if (!preload) {
 		next = osd_scrub_next;
@@ -1382,6 +1851,9 @@ full:
 			RETURN(-EIO);
 		}
 
+		if (!preload)
+			osd_scrub_readahead(param.sb, param.bg + 1);
+
 		while (param.offset < LDISKFS_INODES_PER_GROUP(param.sb) &&
 		       *count < max) {
 			if (param.offset +
@@ -2919,6 +3391,33 @@ static int scrub_pos_dump(struct seq_file *m, __u64 pos, const char *prefix)
 	return rc;
 }
 
+/* The caller should hold the osd_scrub::os_rwsem. */
+static int osd_scrub_workers_dump(struct seq_file *m, struct osd_scrub *scrub)
+{
+	struct osd_scrub_worker *osw;
+	cfs_duration_t		 duration;
+	__u64			 speed;
+	__u32			 rtime;
+	int			 rc;
+	int			 i;
+
+	duration = cfs_time_current() - scrub->os_time_workers_start;
+	rtime = cfs_duration_sec(duration + HALF_SEC);
+	rc = seq_printf(m, "workers: %d\n", scrub->os_worker_count);
+	for (i = 0; i < scrub->os_worker_count && rc >= 0; i++) {
+		osw = &scrub->os_workers[i];
+		speed = osw->osw_checked;
+		if (rtime != 0)
+			do_div(speed, rtime);
+		rc = seq_printf(m, "worker_%d_position: %u\n"
+				"worker_%d_speed: "LPU64" objects/sec\n",
+				i, osw->osw_busy ? osw->osw_pos_current : 0,
+				i, speed);
+	}
+
+	return rc;
+}
+
 int osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 {
 	struct osd_scrub  *scrub   = &dev->od_scrub;
@@ -3014,6 +3513,8 @@ int osd_scrub_dump(struct seq_file *m, struct osd_device *dev)
 			      rtime, speed, new_checked, scrub->os_pos_current,
 			      scrub->os_lf_scanned, scrub->os_lf_repaired,
 			      scrub->os_lf_failed);
+		if (rc >= 0 && scrub->os_workers != NULL)
+			rc = osd_scrub_workers_dump(m, scrub);
 	} else {
 		if (sf->sf_run_time != 0)
 			do_div(speed, sf->sf_run_time);
@@ -39,6 +39,8 @@
 #define SCRUB_CHECKPOINT_INTERVAL	60
 #define SCRUB_OI_BITMAP_SIZE		(OSD_OI_FID_NR_MAX >> 3)
 #define SCRUB_WINDOW_SIZE		1024
+#define SCRUB_THREADS_DEFAULT		1
+#define SCRUB_THREADS_MAX		16
 
 enum scrub_status {
 	/* The scrub file is new created, for new MDT, upgrading from old disk,
@@ -186,6 +188,23 @@ struct scrub_file {
 	__u8    sf_oi_bitmap[SCRUB_OI_BITMAP_SIZE];
 };
 
+/* The worker thread for the parallel OI scrub, it scans one inode group
+ * that is assigned by the OI scrub main thread at a time. */
+struct osd_scrub_worker {
+	struct ptlrpc_thread	 osw_thread;
+	struct osd_device	*osw_dev;
+	struct osd_idmap_cache	 osw_oic;
+	/* The first inode to be scanned in the assigned group. */
+	__u32			 osw_pos_start;
+	__u32			 osw_pos_current;
+	int			 osw_index;
+	int			 osw_result;
+	/* How many objects have been checked by the worker. */
+	__u64			 osw_checked;
+	/* Whether some group is assigned, protected by os_lock. */
+	bool			 osw_busy;
+};
+
 struct osd_scrub {
 	struct lvfs_run_ctxt    os_ctxt;
 	struct ptlrpc_thread    os_thread;
@@ -237,6 +256,13 @@ struct osd_scrub {
 				os_full_scrub:1;
 	__u64			os_bad_oimap_count;
 	__u64			os_bad_oimap_time;
+
+	/* The workers for the parallel OI scrub, only valid during the
+	 * full speed scanning with more than one scrub thread. */
+	struct osd_scrub_worker *os_workers;
+	int			os_worker_count;
+	/* The time when the workers started, jiffies */
+	cfs_time_t		os_time_workers_start;
 };
 
 #endif /* _OSD_SCRUB_H */
@@ -997,6 +997,7 @@ void ptlrpc_set_add_req(struct ptlrpc_request_set *set,
 	req->rq_set = set;
 	atomic_inc(&set->set_remaining);
 	req->rq_queued_time = cfs_time_current();
+	ptlrpc_req_stamp(req, RPC_STAGE_QUEUED);
 
 	if (req->rq_reqmsg != NULL)
 		lustre_msg_set_jobid(req->rq_reqmsg, NULL);
@@ -1028,6 +1029,7 @@ void ptlrpc_set_add_new_req(struct ptlrpcd_ctl *pc,
 	 */
 	req->rq_set = set;
 	req->rq_queued_time = cfs_time_current();
+	ptlrpc_req_stamp(req, RPC_STAGE_QUEUED);
 	list_add_tail(&req->rq_set_chain, &set->set_new_requests);
 	count = atomic_inc_return(&set->set_new_count);
 	spin_unlock(&set->set_new_req_lock);
@@ -1308,6 +1310,8 @@ static int after_reply(struct ptlrpc_request *req)
 				    timediff);
 		ptlrpc_lprocfs_rpc_sent(req, timediff);
 	}
+	ptlrpc_req_stamp_tv(req, RPC_STAGE_REPLIED, &work_start);
+	ptlrpc_req_stage_done(req, &obd->obd_stage_stats);
 
         if (lustre_msg_get_type(req->rq_repmsg) != PTL_RPC_MSG_REPLY &&
             lustre_msg_get_type(req->rq_repmsg) != PTL_RPC_MSG_ERR) {
@@ -1325,6 +1329,19 @@ static int after_reply(struct ptlrpc_request *req)
         rc = ptlrpc_check_status(req);
         imp->imp_connect_error = rc;
 
+	/* a reply proves that the server node is alive for all imports to
+	 * it, see ptlrpc_pinger_skip_ping().  -ENODEV or -ENOTCONN from a node
+	 * a target has left prove nothing, and a ping reply must not delay
+	 * the next ping */
+	if (!ptlrpc_recoverable_error(rc) && rc != -ESHUTDOWN &&
+	    imp->imp_state == LUSTRE_IMP_FULL && imp->imp_connection != NULL) {
+		cfs_time_t now = cfs_time_current();
+
+		imp->imp_connection->c_last_alive = now;
+		if (lustre_msg_get_opc(req->rq_reqmsg) != OBD_PING)
+			imp->imp_connection->c_last_reply = now;
+	}
+
 	if (rc) {
 		/*
 		 * Either we've been evicted, or the server has failed for
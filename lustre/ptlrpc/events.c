@@ -220,8 +220,10 @@ void client_bulk_callback (lnet_event_t *ev)
 
 	/* NB don't unlock till after wakeup; desc can disappear under us
 	 * otherwise */
-	if (desc->bd_md_count == 0)
+	if (desc->bd_md_count == 0) {
+		ptlrpc_req_stamp(desc->bd_req, RPC_STAGE_BULK_END);
 		ptlrpc_client_wake_req(desc->bd_req);
+	}
 
 	spin_unlock(&desc->bd_lock);
 	EXIT;
@@ -338,6 +340,7 @@ void request_in_callback(lnet_event_t *ev)
 	if (ev->type == LNET_EVENT_PUT && ev->status == 0)
 		req->rq_reqdata_len = ev->mlength;
 	do_gettimeofday(&req->rq_arrival_time);
+	ptlrpc_req_stamp_tv(req, RPC_STAGE_ARRIVED, &req->rq_arrival_time);
 	req->rq_peer = ev->initiator;
 	req->rq_self = ev->target.nid;
 	req->rq_rqbd = rqbd;
@@ -466,8 +469,12 @@ void server_bulk_callback (lnet_event_t *ev)
 	if (ev->unlinked) {
 		desc->bd_md_count--;
 		/* This is the last callback no matter what... */
-		if (desc->bd_md_count == 0)
+		if (desc->bd_md_count == 0) {
+			if (desc->bd_req != NULL)
+				ptlrpc_req_stamp(desc->bd_req,
+						 RPC_STAGE_BULK_END);
 			wake_up(&desc->bd_waitq);
+		}
 	}
 
 	spin_unlock(&desc->bd_lock);
@@ -70,6 +70,7 @@ static struct ll_rpc_opcode {
         { OST_QUOTACHECK,   "ost_quotacheck" },
         { OST_QUOTACTL,     "ost_quotactl" },
         { OST_QUOTA_ADJUST_QUNIT, "ost_quota_adjust_qunit" },
+	{ OST_FALLOCATE,    "ost_fallocate" },
         { MDS_GETATTR,      "mds_getattr" },
         { MDS_GETATTR_NAME, "mds_getattr_lock" },
         { MDS_CLOSE,        "mds_close" },
@@ -222,6 +223,10 @@ static void ptlrpc_lprocfs_register(struct proc_dir_entry *root, char *dir,
                              svc_counter_config, "req_timeout", "sec");
         lprocfs_counter_init(svc_stats, PTLRPC_REQBUF_AVAIL_CNTR,
                              svc_counter_config, "reqbuf_avail", "bufs");
+	lprocfs_counter_init(svc_stats, PTLRPC_THREAD_START_CNTR,
+			     svc_counter_config, "threads_created", "threads");
+	lprocfs_counter_init(svc_stats, PTLRPC_THREAD_EXIT_CNTR,
+			     svc_counter_config, "threads_retired", "threads");
         for (i = 0; i < EXTRA_LAST_OPC; i++) {
                 char *units;
 
@@ -418,6 +423,70 @@ ptlrpc_lprocfs_threads_max_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_max);
 
+static int
+ptlrpc_lprocfs_threads_idle_timeout_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	return seq_printf(m, "%d\n", svc->srv_thrs_idle_timeout);
+}
+
+static ssize_t
+ptlrpc_lprocfs_threads_idle_timeout_seq_write(struct file *file,
+					      const char __user *buffer,
+					      size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct ptlrpc_service	*svc = m->private;
+	int	val;
+	int	rc = lprocfs_write_helper(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_thrs_idle_timeout = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_idle_timeout);
+
+static int
+ptlrpc_lprocfs_threads_start_delay_seq_show(struct seq_file *m, void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	return seq_printf(m, "%d\n", svc->srv_thrs_start_delay);
+}
+
+static ssize_t
+ptlrpc_lprocfs_threads_start_delay_seq_write(struct file *file,
+					     const char __user *buffer,
+					     size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct ptlrpc_service	*svc = m->private;
+	int	val;
+	int	rc = lprocfs_write_helper(buffer, count, &val);
+
+	if (rc < 0)
+		return rc;
+
+	if (val < 0 || val > ONE_MILLION)
+		return -ERANGE;
+
+	spin_lock(&svc->srv_lock);
+	svc->srv_thrs_start_delay = val;
+	spin_unlock(&svc->srv_lock);
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_threads_start_delay);
+
 /**
  * Translates \e ptlrpc_nrs_pol_state values to human-readable strings.
  *
@@ -1060,6 +1129,131 @@ ptlrpc_lprocfs_hp_ratio_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(ptlrpc_lprocfs_hp_ratio);
 
+static int ptlrpc_lprocfs_req_capture_seq_show(struct seq_file *m, void *v)
+{
+	struct ptlrpc_service *svc = m->private;
+	return seq_printf(m, "%d\n", svc->srv_req_capture);
+}
+
+/* requests are captured to /proc/fs/lustre/rpc_capture once it is open */
+static ssize_t
+ptlrpc_lprocfs_req_capture_seq_write(struct file *file,
+				     const char __user *buffer,
+				     size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct ptlrpc_service	*svc = m->private;
+	int	rc;
+	int	val;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc < 0)
+		return rc;
+
+	svc->srv_req_capture = !!val;
+
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_req_capture);
+
+/**
+ * The RPC stage stats are in YAML format, one log2 histogram of usec per
+ * opcode and pair of stages, each bucket keyed by its upper bound:
+ * stage_stats:
+ * - snapshot_time: 1234567890.123456
+ * - ost_write:
+ *     nrs_wait_usec: { samples: 10, 8: 1, 16: 5, 32: 4 }
+ *     service_usec: { samples: 10, 512: 2, 1024: 8 }
+ *     bulk_usec: { samples: 10, 256: 3, 512: 7 }
+ */
+static int ptlrpc_lprocfs_stage_stats_show(struct seq_file *m,
+					   struct ptlrpc_stage_stats *pss)
+{
+	struct ptlrpc_opc_stages	*pos;
+	struct obd_histogram		*oh;
+	struct timeval			 now;
+	unsigned long			 tot;
+	int				 i;
+	int				 j;
+	int				 k;
+
+	/* this sampling races with updates */
+	do_gettimeofday(&now);
+	seq_printf(m, "stage_stats:\n");
+	seq_printf(m, "- %-15s %lu.%06lu\n", "snapshot_time:",
+		   now.tv_sec, now.tv_usec);
+	if (pss == NULL)
+		return 0;
+
+	for (i = 0; i < LUSTRE_MAX_OPCODES; i++) {
+		pos = pss->pss_opc[i];
+		if (pos == NULL)
+			continue;
+
+		seq_printf(m, "- %s:\n",
+			   ll_opcode2str(ll_rpc_opcode_table[i].opcode));
+		for (j = 0; j < PTLRPC_STAGE_SPANS; j++) {
+			oh = &pos->pos_hist[j];
+			tot = lprocfs_oh_sum(oh);
+			if (tot == 0)
+				continue;
+
+			seq_printf(m, "    %s: { samples: %lu",
+				   ptlrpc_stage_spans[j].pss_name, tot);
+			for (k = 0; k < OBD_HIST_MAX; k++) {
+				if (oh->oh_buckets[k] != 0)
+					seq_printf(m, ", %lu: %lu", 1UL << k,
+						   oh->oh_buckets[k]);
+			}
+			seq_printf(m, " }\n");
+		}
+	}
+
+	return 0;
+}
+
+static int ptlrpc_lprocfs_svc_stage_stats_seq_show(struct seq_file *m,
+						   void *v)
+{
+	struct ptlrpc_service *svc = m->private;
+
+	return ptlrpc_lprocfs_stage_stats_show(m, svc->srv_stage_stats);
+}
+
+static ssize_t
+ptlrpc_lprocfs_svc_stage_stats_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct ptlrpc_service	*svc = m->private;
+
+	ptlrpc_stage_stats_clear(svc->srv_stage_stats);
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_svc_stage_stats);
+
+static int ptlrpc_lprocfs_obd_stage_stats_seq_show(struct seq_file *m,
+						   void *v)
+{
+	struct obd_device *obd = m->private;
+
+	return ptlrpc_lprocfs_stage_stats_show(m, obd->obd_stage_stats);
+}
+
+static ssize_t
+ptlrpc_lprocfs_obd_stage_stats_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file		*m = file->private_data;
+	struct obd_device	*obd = m->private;
+
+	ptlrpc_stage_stats_clear(obd->obd_stage_stats);
+	return count;
+}
+LPROC_SEQ_FOPS(ptlrpc_lprocfs_obd_stage_stats);
+
 void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
                                      struct ptlrpc_service *svc)
 {
@@ -1082,12 +1276,24 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
 		{ .name = "threads_started",
 		  .fops = &ptlrpc_lprocfs_threads_started_fops,
 		  .data = svc },
+		{ .name = "threads_idle_timeout",
+		  .fops = &ptlrpc_lprocfs_threads_idle_timeout_fops,
+		  .data = svc },
+		{ .name = "threads_start_delay",
+		  .fops = &ptlrpc_lprocfs_threads_start_delay_fops,
+		  .data = svc },
 		{ .name = "timeouts",
 		  .fops = &ptlrpc_lprocfs_timeouts_fops,
 		  .data = svc },
 		{ .name = "nrs_policies",
 		  .fops = &ptlrpc_lprocfs_nrs_fops,
 		  .data = svc },
+		{ .name = "stage_stats",
+		  .fops = &ptlrpc_lprocfs_svc_stage_stats_fops,
+		  .data = svc },
+		{ .name = "req_capture",
+		  .fops = &ptlrpc_lprocfs_req_capture_fops,
+		  .data = svc },
 		{ NULL }
         };
         static struct file_operations req_history_fops = {
@@ -1116,9 +1322,19 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
 
 void ptlrpc_lprocfs_register_obd(struct obd_device *obddev)
 {
+	int rc;
+
         ptlrpc_lprocfs_register(obddev->obd_proc_entry, NULL, "stats",
                                 &obddev->obd_svc_procroot,
                                 &obddev->obd_svc_stats);
+	if (obddev->obd_svc_procroot == NULL)
+		return;
+
+	rc = lprocfs_seq_create(obddev->obd_svc_procroot, "stage_stats", 0644,
+				&ptlrpc_lprocfs_obd_stage_stats_fops, obddev);
+	if (rc)
+		CWARN("%s: error adding the stage_stats file: rc = %d\n",
+		      obddev->obd_name, rc);
 }
 EXPORT_SYMBOL(ptlrpc_lprocfs_register_obd);
 
@@ -1171,6 +1387,8 @@ void ptlrpc_lprocfs_unregister_service(struct ptlrpc_service *svc)
 
         if (svc->srv_stats)
                 lprocfs_free_stats(&svc->srv_stats);
+
+	ptlrpc_stage_stats_free(&svc->srv_stage_stats);
 }
 
 void ptlrpc_lprocfs_unregister_obd(struct obd_device *obd)
@@ -1180,6 +1398,8 @@ void ptlrpc_lprocfs_unregister_obd(struct obd_device *obd)
 
         if (obd->obd_svc_stats)
                 lprocfs_free_stats(&obd->obd_svc_stats);
+
+	ptlrpc_stage_stats_free(&obd->obd_stage_stats);
 }
 EXPORT_SYMBOL(ptlrpc_lprocfs_unregister_obd);
 
@@ -179,6 +179,7 @@ int ptlrpc_start_bulk_transfer(struct ptlrpc_bulk_desc *desc)
 
 	desc->bd_md_count = total_md;
 	desc->bd_failure = 0;
+	ptlrpc_req_stamp(desc->bd_req, RPC_STAGE_BULK_START);
 
 	md.user_ptr = &desc->bd_cbid;
 	md.eq_handle = ptlrpc_eq_h;
@@ -319,6 +320,7 @@ int ptlrpc_register_bulk(struct ptlrpc_request *req)
 		LASSERT(desc->bd_nob_transferred == 0);
 
 	desc->bd_failure = 0;
+	ptlrpc_req_stamp(req, RPC_STAGE_BULK_START);
 
 	peer = desc->bd_import->imp_connection->c_peer;
 
@@ -596,7 +598,9 @@ int ptlrpc_send_reply(struct ptlrpc_request *req, int flags)
         if (unlikely(rc))
                 goto out;
 
-        req->rq_sent = cfs_time_current_sec();
+	req->rq_sent = cfs_time_current_sec();
+	if (!(flags & PTLRPC_REPLY_EARLY))
+		ptlrpc_req_stamp(req, RPC_STAGE_REPLY_SENT);
 
         rc = ptl_send_buf (&rs->rs_md_h, rs->rs_repbuf, rs->rs_repdata_len,
                            (rs->rs_difficult && !rs->rs_no_ack) ?
@@ -815,6 +819,7 @@ int ptl_send_rpc(struct ptlrpc_request *request, int noreply)
 	OBD_FAIL_TIMEOUT(OBD_FAIL_PTLRPC_DELAY_SEND, request->rq_timeout + 5);
 
 	do_gettimeofday(&request->rq_sent_tv);
+	ptlrpc_req_stamp_tv(request, RPC_STAGE_SENT, &request->rq_sent_tv);
 	request->rq_sent = cfs_time_current_sec();
 	/* We give the server rq_timeout secs to process the req, and
 	   add the network latency for our local timeout. */
@@ -1717,7 +1717,8 @@ void lustre_swab_obdo (struct obdo  *o)
         __swab32s (&o->o_uid_h);
         __swab32s (&o->o_gid_h);
         __swab64s (&o->o_data_version);
-        CLASSERT(offsetof(typeof(*o), o_padding_4) != 0);
+	__swab32s(&o->o_falloc_mode);
+	CLASSERT(offsetof(typeof(*o), o_padding_3) != 0);
         CLASSERT(offsetof(typeof(*o), o_padding_5) != 0);
         CLASSERT(offsetof(typeof(*o), o_padding_6) != 0);
 
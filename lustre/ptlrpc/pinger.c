@@ -47,6 +47,18 @@
 static int suppress_pings;
 CFS_MODULE_PARM(suppress_pings, "i", int, 0644, "Suppress pings");
 
+static int peer_ping = 1;
+CFS_MODULE_PARM(peer_ping, "i", int, 0644,
+		"Ping each server node instead of each target when possible");
+
+/*
+ * An import skipping pings in favour of other imports to the same node
+ * still pings its own target after this many skipped pings, i.e. every
+ * 2 * obd_timeout, so that a target that failed over to another node is
+ * noticed within the recovery window of 3 * obd_timeout.
+ */
+#define PEER_PING_MAX_SKIP	7
+
 struct mutex pinger_mutex;
 static struct list_head pinger_imports =
 		LIST_HEAD_INIT(pinger_imports);
@@ -182,6 +194,55 @@ void ptlrpc_pinger_ir_down(void)
 }
 EXPORT_SYMBOL(ptlrpc_pinger_ir_down);
 
+/**
+ * Check if pinging \a imp can be skipped because its server node is
+ * already known to be alive.
+ *
+ * Servers supporting OBD_CONNECT_PEER_PING keep all exports of a client
+ * node alive as long as any request arrives from that node, see
+ * ping_evictor_main(), so one ping per server node is enough instead of
+ * one per target.  The ping is skipped if a request other than a ping got
+ * a reply on the import connection during the last ping interval, or if
+ * another import already pinged the node during this pass while it was
+ * answering.  Otherwise this import pings the node for this pass.
+ *
+ * Ping replies are not taken as activity, otherwise each ping would delay
+ * the next one.  Once the node has been silent for two ping intervals,
+ * and after PEER_PING_MAX_SKIP skipped pings, the import pings on its
+ * own, so a dead node or a target that failed over is still noticed by
+ * every import.
+ *
+ * \param[in] imp	import to be pinged
+ * \param[in] this_ping	start time of the current pinger pass
+ *
+ * \retval		true if the ping can be skipped
+ * \retval		false if the ping must be sent
+ */
+static bool ptlrpc_pinger_skip_ping(struct obd_import *imp,
+				    cfs_time_t this_ping)
+{
+	struct ptlrpc_connection *conn = imp->imp_connection;
+	cfs_duration_t interval = cfs_time_seconds(PING_INTERVAL);
+
+	if (!peer_ping || conn == NULL ||
+	    !OCD_HAS_FLAG(&imp->imp_connect_data, PEER_PING) ||
+	    imp->imp_ping_skips >= PEER_PING_MAX_SKIP)
+		return false;
+
+	if (conn->c_last_reply != 0 &&
+	    cfs_time_before(this_ping, cfs_time_add(conn->c_last_reply,
+						    interval)))
+		return true;
+
+	if (conn->c_last_ping == this_ping && conn->c_last_alive != 0 &&
+	    cfs_time_before(this_ping, cfs_time_add(conn->c_last_alive,
+						    2 * interval)))
+		return true;
+
+	conn->c_last_ping = this_ping;
+	return false;
+}
+
 static void ptlrpc_pinger_process_import(struct obd_import *imp,
                                          unsigned long this_ping)
 {
@@ -236,7 +297,19 @@ static void ptlrpc_pinger_process_import(struct obd_import *imp,
 			spin_unlock(&imp->imp_lock);
 		}
 	} else if ((imp->imp_pingable && !suppress) || force_next || force) {
-		ptlrpc_ping(imp);
+		if (!force && !force_next &&
+		    ptlrpc_pinger_skip_ping(imp, this_ping)) {
+			CDEBUG(D_INFO, "%s->%s: peer %s alive, not pinging\n",
+			       imp->imp_obd->obd_uuid.uuid,
+			       obd2cli_tgt(imp->imp_obd),
+			       libcfs_nid2str(imp->imp_connection->c_peer.nid));
+			imp->imp_ping_skips++;
+			atomic_inc(&imp->imp_pings_avoided);
+			ptlrpc_update_next_ping(imp, 0);
+		} else {
+			imp->imp_ping_skips = 0;
+			ptlrpc_ping(imp);
+		}
 	}
 }
 
@@ -395,10 +468,12 @@ void ptlrpc_pinger_commit_expected(struct obd_import *imp)
 	 * Avoid reading stale imp_connect_data.  When not sure if pings are
 	 * expected or not on next connection, we assume they are not and force
 	 * one anyway to guarantee the chance of updating
-	 * imp_peer_committed_transno.
+	 * imp_peer_committed_transno.  The same applies when pings may be
+	 * skipped in favour of other imports to the same node.
 	 */
 	if (imp->imp_state != LUSTRE_IMP_FULL ||
-	    OCD_HAS_FLAG(&imp->imp_connect_data, PINGLESS))
+	    OCD_HAS_FLAG(&imp->imp_connect_data, PINGLESS) ||
+	    OCD_HAS_FLAG(&imp->imp_connect_data, PEER_PING))
 		imp->imp_force_next_verify = 1;
 }
 
@@ -602,6 +677,19 @@ int ping_evictor_wake(struct obd_export *exp)
 	return 0;
 }
 
+/**
+ * Check if any request was received from the client node of \a exp since
+ * \a expire_time on another export sharing the same connection.  This is
+ * only trusted for clients that skip pings on the assumption it holds,
+ * see ptlrpc_pinger_skip_ping().
+ */
+static bool ping_evictor_peer_alive(struct obd_export *exp, time_t expire_time)
+{
+	return exp_connect_flags(exp) & OBD_CONNECT_PEER_PING &&
+	       exp->exp_connection != NULL &&
+	       exp->exp_connection->c_last_request_time >= expire_time;
+}
+
 static int ping_evictor_main(void *arg)
 {
         struct obd_device *obd;
@@ -644,7 +732,21 @@ static int ping_evictor_main(void *arg)
 			exp = list_entry(obd->obd_exports_timed.next,
 					 struct obd_export,
 					 exp_obd_chain_timed);
-			if (expire_time > exp->exp_last_request_time) {
+			if (expire_time > exp->exp_last_request_time &&
+			    ping_evictor_peer_alive(exp, expire_time)) {
+				/* the client node talked to us on behalf of
+				 * another export, so this one is alive too */
+				exp->exp_last_request_time =
+				       exp->exp_connection->c_last_request_time;
+				list_move_tail(&exp->exp_obd_chain_timed,
+					       &obd->obd_exports_timed);
+				CDEBUG(D_HA, "%s: client %s (at %s) alive via "
+				       "other exports, last %ld\n",
+				       obd->obd_name,
+				       obd_uuid2str(&exp->exp_client_uuid),
+				       obd_export_nid2str(exp),
+				       (long)exp->exp_last_request_time);
+			} else if (expire_time > exp->exp_last_request_time) {
 				class_export_get(exp);
 				spin_unlock(&obd->obd_dev_lock);
 				LCONSOLE_WARN("%s: haven't heard from client %s"
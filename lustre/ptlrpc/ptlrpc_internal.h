@@ -273,6 +273,58 @@ void ptlrpc_pinger_wake_up(void);
 void ptlrpc_ping_import_soon(struct obd_import *imp);
 int ping_evictor_wake(struct obd_export *exp);
 
+/* rpc_trace.c */
+extern int rpc_stage_trace;
+
+/* interval between two stages accounted in stage_stats */
+struct ptlrpc_stage_span {
+	const char	*pss_name;
+	enum rpc_stage	 pss_from;
+	enum rpc_stage	 pss_to;
+};
+
+#define PTLRPC_STAGE_SPANS	5
+extern const struct ptlrpc_stage_span ptlrpc_stage_spans[PTLRPC_STAGE_SPANS];
+
+struct ptlrpc_opc_stages {
+	struct obd_histogram		 pos_hist[PTLRPC_STAGE_SPANS];
+};
+
+struct ptlrpc_stage_stats {
+	/* indexed by opcode_offset(), allocated on first use */
+	struct ptlrpc_opc_stages	*pss_opc[LUSTRE_MAX_OPCODES];
+};
+
+int ptlrpc_rpc_trace_init(void);
+void ptlrpc_rpc_trace_fini(void);
+void ptlrpc_req_stage_done(struct ptlrpc_request *req,
+			   struct ptlrpc_stage_stats **pssp);
+void ptlrpc_stage_stats_clear(struct ptlrpc_stage_stats *pss);
+void ptlrpc_stage_stats_free(struct ptlrpc_stage_stats **pssp);
+void ptlrpc_req_capture(struct ptlrpc_service *svc,
+			struct ptlrpc_request *req);
+
+static inline void ptlrpc_req_stamp_tv(struct ptlrpc_request *req,
+				       enum rpc_stage stage,
+				       const struct timeval *tv)
+{
+	if (unlikely(rpc_stage_trace != 0))
+		req->rq_stage[stage] = (__u64)tv->tv_sec * ONE_MILLION +
+				       tv->tv_usec;
+}
+
+static inline void ptlrpc_req_stamp(struct ptlrpc_request *req,
+				    enum rpc_stage stage)
+{
+	struct timeval	tv;
+
+	if (likely(rpc_stage_trace == 0))
+		return;
+
+	do_gettimeofday(&tv);
+	ptlrpc_req_stamp_tv(req, stage, &tv);
+}
+
 /* sec_null.c */
 int  sptlrpc_null_init(void);
 void sptlrpc_null_fini(void);
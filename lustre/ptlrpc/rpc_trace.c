@@ -0,0 +1,522 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.  A copy is
+ * included in the COPYING file that accompanied this code.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/ptlrpc/rpc_trace.c
+ *
+ * RPC lifecycle tracing.
+ *
+ * With rpc_stage_trace set, client.c, niobuf.c, events.c and service.c
+ * record in ptlrpc_request::rq_stage the time an RPC reaches each
+ * enum rpc_stage.  Once the RPC is complete on a node, the intervals
+ * between stages are added to per-opcode log2 histograms of the client
+ * obd_device or of the ptlrpc_service ("stage_stats" in their lprocfs
+ * directories), and a struct rpc_trace_rec is appended to a ring that is
+ * consumed by reading /proc/fs/lustre/rpc_trace.
+ *
+ * Services with "req_capture" set also copy each request they handle to a
+ * second ring, read from /proc/fs/lustre/rpc_capture, to be replayed on
+ * another filesystem by ll_rpc_replay.
+ *
+ * A ring is only allocated once its proc file has been opened, and drops
+ * its oldest records when full.  Writers only reserve a slot under the ring
+ * lock and fill it outside of it, so that copying large requests does not
+ * serialize the service threads.
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+
+#include <linux/fs.h>
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_net.h>
+#include <lprocfs_status.h>
+#include "ptlrpc_internal.h"
+
+int rpc_stage_trace;
+CFS_MODULE_PARM(rpc_stage_trace, "i", int, 0644,
+		"record the time RPCs reach each stage of their life");
+
+static int rpc_trace_records = 8192;
+CFS_MODULE_PARM(rpc_trace_records, "i", int, 0444,
+		"number of completed RPCs kept for /proc/fs/lustre/rpc_trace");
+
+static int rpc_capture_records = 2048;
+CFS_MODULE_PARM(rpc_capture_records, "i", int, 0444,
+		"number of requests kept for /proc/fs/lustre/rpc_capture");
+
+static int rpc_capture_bytes = 4096;
+CFS_MODULE_PARM(rpc_capture_bytes, "i", int, 0444,
+		"bytes of each request message kept for "
+		"/proc/fs/lustre/rpc_capture");
+
+const struct ptlrpc_stage_span ptlrpc_stage_spans[PTLRPC_STAGE_SPANS] = {
+	{ "queue_usec",	   RPC_STAGE_QUEUED,	 RPC_STAGE_SENT },
+	{ "rpc_usec",	   RPC_STAGE_SENT,	 RPC_STAGE_REPLIED },
+	{ "nrs_wait_usec", RPC_STAGE_ARRIVED,	 RPC_STAGE_DEQUEUED },
+	{ "service_usec",  RPC_STAGE_DEQUEUED,	 RPC_STAGE_REPLY_SENT },
+	{ "bulk_usec",	   RPC_STAGE_BULK_START, RPC_STAGE_BULK_END },
+};
+
+/* a FIFO of records in fixed size slots */
+struct ptlrpc_rec_ring {
+	spinlock_t		 rr_lock;
+	struct mutex		 rr_mutex;	/* serialize allocation */
+	char			*rr_recs;
+	/** bytes per slot */
+	unsigned int		 rr_recsize;
+	/** number of slots */
+	unsigned int		 rr_size;
+	/** index of the oldest record */
+	unsigned int		 rr_start;
+	unsigned int		 rr_count;
+	/** slots being filled, protected by rr_lock */
+	unsigned long		*rr_busy;
+	/** bytes of a record to hand out, the whole slot if NULL */
+	unsigned int		(*rr_reclen)(const void *rec);
+};
+
+static struct ptlrpc_rec_ring rpc_trace_ring;
+static struct ptlrpc_rec_ring rpc_capture_ring;
+
+static void ptlrpc_rec_ring_init(struct ptlrpc_rec_ring *rr,
+				 unsigned int (*reclen)(const void *rec))
+{
+	spin_lock_init(&rr->rr_lock);
+	mutex_init(&rr->rr_mutex);
+	rr->rr_reclen = reclen;
+}
+
+static void ptlrpc_rec_ring_fini(struct ptlrpc_rec_ring *rr)
+{
+	if (rr->rr_recs != NULL) {
+		OBD_FREE_LARGE(rr->rr_recs, rr->rr_size * rr->rr_recsize);
+		rr->rr_recs = NULL;
+	}
+	if (rr->rr_busy != NULL) {
+		OBD_FREE_LARGE(rr->rr_busy,
+			       BITS_TO_LONGS(rr->rr_size) * sizeof(long));
+		rr->rr_busy = NULL;
+	}
+}
+
+static int ptlrpc_rec_ring_alloc(struct ptlrpc_rec_ring *rr,
+				 unsigned int size, unsigned int recsize)
+{
+	unsigned long	*busy;
+	char		*recs;
+
+	if (rr->rr_recs != NULL)
+		return 0;
+
+	mutex_lock(&rr->rr_mutex);
+	if (rr->rr_recs == NULL) {
+		OBD_ALLOC_LARGE(busy, BITS_TO_LONGS(size) * sizeof(long));
+		if (busy == NULL) {
+			mutex_unlock(&rr->rr_mutex);
+			return -ENOMEM;
+		}
+		OBD_ALLOC_LARGE(recs, size * recsize);
+		if (recs == NULL) {
+			OBD_FREE_LARGE(busy,
+				       BITS_TO_LONGS(size) * sizeof(long));
+			mutex_unlock(&rr->rr_mutex);
+			return -ENOMEM;
+		}
+
+		spin_lock(&rr->rr_lock);
+		rr->rr_recsize = recsize;
+		rr->rr_size = size;
+		rr->rr_start = 0;
+		rr->rr_count = 0;
+		rr->rr_busy = busy;
+		rr->rr_recs = recs;
+		spin_unlock(&rr->rr_lock);
+	}
+	mutex_unlock(&rr->rr_mutex);
+
+	return 0;
+}
+
+/**
+ * Reserve the slot of a new record, to be filled without any lock held
+ * before calling ptlrpc_rec_ring_put().
+ *
+ * \param[in] rr	ring
+ * \param[out] idx	index of the slot, to pass to ptlrpc_rec_ring_put()
+ *
+ * \retval	slot, or NULL if the ring is not allocated or the slot to
+ *		overwrite is still being filled or read
+ */
+static void *ptlrpc_rec_ring_get(struct ptlrpc_rec_ring *rr,
+				 unsigned int *idx)
+{
+	if (rr->rr_recs == NULL)
+		return NULL;
+
+	spin_lock(&rr->rr_lock);
+	*idx = (rr->rr_start + rr->rr_count) % rr->rr_size;
+	if (test_bit(*idx, rr->rr_busy)) {
+		/* the ring is full and its oldest slot still being filled
+		 * or read, drop the new record */
+		spin_unlock(&rr->rr_lock);
+		return NULL;
+	}
+
+	if (rr->rr_count == rr->rr_size)
+		/* overwrite the oldest record */
+		rr->rr_start = (rr->rr_start + 1) % rr->rr_size;
+	else
+		rr->rr_count++;
+	__set_bit(*idx, rr->rr_busy);
+	spin_unlock(&rr->rr_lock);
+
+	return rr->rr_recs + *idx * rr->rr_recsize;
+}
+
+/* the record in slot \a idx is complete and may be read */
+static void ptlrpc_rec_ring_put(struct ptlrpc_rec_ring *rr, unsigned int idx)
+{
+	spin_lock(&rr->rr_lock);
+	__clear_bit(idx, rr->rr_busy);
+	spin_unlock(&rr->rr_lock);
+}
+
+/* hand out and drop whole records, oldest first */
+static ssize_t ptlrpc_rec_ring_read(struct ptlrpc_rec_ring *rr,
+				    char __user *buf, size_t count)
+{
+	char		*rec;
+	unsigned int	 idx;
+	unsigned int	 len;
+	ssize_t		 done = 0;
+
+	OBD_ALLOC_LARGE(rec, rr->rr_recsize);
+	if (rec == NULL)
+		return -ENOMEM;
+
+	for (;;) {
+		spin_lock(&rr->rr_lock);
+		if (rr->rr_count == 0) {
+			spin_unlock(&rr->rr_lock);
+			break;
+		}
+		if (test_bit(rr->rr_start, rr->rr_busy)) {
+			/* the oldest record is being filled or read */
+			spin_unlock(&rr->rr_lock);
+			cond_resched();
+			continue;
+		}
+
+		/* writers skip a busy slot instead of overwriting it, so
+		 * rr_start does not move while the record is copied */
+		idx = rr->rr_start;
+		__set_bit(idx, rr->rr_busy);
+		spin_unlock(&rr->rr_lock);
+
+		memcpy(rec, rr->rr_recs + idx * rr->rr_recsize,
+		       rr->rr_recsize);
+		len = rr->rr_reclen != NULL ? rr->rr_reclen(rec) :
+					      rr->rr_recsize;
+
+		spin_lock(&rr->rr_lock);
+		__clear_bit(idx, rr->rr_busy);
+		if (len > count - done) {
+			spin_unlock(&rr->rr_lock);
+			if (done == 0)
+				done = -EINVAL;
+			break;
+		}
+		rr->rr_start = (rr->rr_start + 1) % rr->rr_size;
+		rr->rr_count--;
+		spin_unlock(&rr->rr_lock);
+
+		if (copy_to_user(buf + done, rec, len)) {
+			if (done == 0)
+				done = -EFAULT;
+			break;
+		}
+		done += len;
+	}
+
+	OBD_FREE_LARGE(rec, rr->rr_recsize);
+	return done;
+}
+
+static struct ptlrpc_opc_stages *
+ptlrpc_stage_stats_opc(struct ptlrpc_stage_stats **pssp, int opc)
+{
+	struct ptlrpc_stage_stats	*pss = *pssp;
+	struct ptlrpc_opc_stages	*pos;
+	int				 i;
+
+	/* may be called from ptlrpcd with spinlocks held */
+	if (unlikely(pss == NULL)) {
+		OBD_ALLOC_GFP(pss, sizeof(*pss), GFP_ATOMIC);
+		if (pss == NULL)
+			return NULL;
+		if (cmpxchg(pssp, NULL, pss) != NULL) {
+			OBD_FREE_PTR(pss);
+			pss = *pssp;
+		}
+	}
+
+	pos = pss->pss_opc[opc];
+	if (unlikely(pos == NULL)) {
+		OBD_ALLOC_GFP(pos, sizeof(*pos), GFP_ATOMIC);
+		if (pos == NULL)
+			return NULL;
+		for (i = 0; i < PTLRPC_STAGE_SPANS; i++)
+			spin_lock_init(&pos->pos_hist[i].oh_lock);
+		if (cmpxchg(&pss->pss_opc[opc], NULL, pos) != NULL) {
+			OBD_FREE_PTR(pos);
+			pos = pss->pss_opc[opc];
+		}
+	}
+
+	return pos;
+}
+
+static void ptlrpc_rpc_trace_add(struct ptlrpc_request *req, __u32 opc,
+				 bool server)
+{
+	struct rpc_trace_rec	 rec = { 0 };
+	struct rpc_trace_rec	*slot;
+	unsigned int		 idx;
+
+	if (rpc_trace_ring.rr_recs == NULL)
+		return;
+
+	rec.rtr_magic = RPC_TRACE_MAGIC;
+	rec.rtr_opc = opc;
+	rec.rtr_xid = req->rq_xid;
+	if (server) {
+		rec.rtr_flags = RPC_TRACE_SERVER;
+		rec.rtr_self_nid = req->rq_self;
+		rec.rtr_peer_nid = req->rq_peer.nid;
+		rec.rtr_peer_pid = req->rq_peer.pid;
+		rec.rtr_status = req->rq_status;
+	} else {
+		struct ptlrpc_connection *conn = req->rq_import->imp_connection;
+
+		if (conn != NULL) {
+			rec.rtr_self_nid = conn->c_self;
+			rec.rtr_peer_nid = conn->c_peer.nid;
+			rec.rtr_peer_pid = conn->c_peer.pid;
+		}
+		if (req->rq_repmsg != NULL)
+			rec.rtr_status = lustre_msg_get_status(req->rq_repmsg);
+	}
+	memcpy(rec.rtr_stage, req->rq_stage, sizeof(rec.rtr_stage));
+
+	slot = ptlrpc_rec_ring_get(&rpc_trace_ring, &idx);
+	if (slot != NULL) {
+		*slot = rec;
+		ptlrpc_rec_ring_put(&rpc_trace_ring, idx);
+	}
+}
+
+/**
+ * Account the stages \a req went through on this node.
+ *
+ * \param[in] req	completed request, on the client once its reply has
+ *			been accepted, on the server once it has been handled
+ * \param[in,out] pssp	histograms of the client obd_device or ptlrpc_service
+ *			\a req belongs to, allocated on first use
+ */
+void ptlrpc_req_stage_done(struct ptlrpc_request *req,
+			   struct ptlrpc_stage_stats **pssp)
+{
+	struct ptlrpc_opc_stages	*pos;
+	__u32				 opc;
+	int				 idx;
+	int				 i;
+
+	if (likely(rpc_stage_trace == 0) || req->rq_reqmsg == NULL)
+		return;
+
+	opc = lustre_msg_get_opc(req->rq_reqmsg);
+	idx = opcode_offset(opc);
+	if (idx >= 0 && (pos = ptlrpc_stage_stats_opc(pssp, idx)) != NULL) {
+		for (i = 0; i < PTLRPC_STAGE_SPANS; i++) {
+			const struct ptlrpc_stage_span *span;
+			__u64 from;
+			__u64 to;
+
+			span = &ptlrpc_stage_spans[i];
+			from = req->rq_stage[span->pss_from];
+			to = req->rq_stage[span->pss_to];
+			if (from == 0 || to < from)
+				continue;
+			to = min_t(__u64, to - from, UINT_MAX);
+			lprocfs_oh_tally_log2(&pos->pos_hist[i], to);
+		}
+	}
+
+	/* only incoming requests have a request buffer */
+	ptlrpc_rpc_trace_add(req, opc, req->rq_rqbd != NULL);
+}
+
+void ptlrpc_stage_stats_clear(struct ptlrpc_stage_stats *pss)
+{
+	int	i;
+	int	j;
+
+	if (pss == NULL)
+		return;
+
+	for (i = 0; i < LUSTRE_MAX_OPCODES; i++) {
+		if (pss->pss_opc[i] == NULL)
+			continue;
+		for (j = 0; j < PTLRPC_STAGE_SPANS; j++)
+			lprocfs_oh_clear(&pss->pss_opc[i]->pos_hist[j]);
+	}
+}
+
+void ptlrpc_stage_stats_free(struct ptlrpc_stage_stats **pssp)
+{
+	struct ptlrpc_stage_stats	*pss = *pssp;
+	int				 i;
+
+	if (pss == NULL)
+		return;
+
+	*pssp = NULL;
+	for (i = 0; i < LUSTRE_MAX_OPCODES; i++) {
+		if (pss->pss_opc[i] != NULL)
+			OBD_FREE_PTR(pss->pss_opc[i]);
+	}
+	OBD_FREE_PTR(pss);
+}
+
+/**
+ * Copy the request about to be handled by \a svc to the capture ring.
+ *
+ * \param[in] svc	service with srv_req_capture set
+ * \param[in] req	incoming request, its header already unpacked
+ */
+void ptlrpc_req_capture(struct ptlrpc_service *svc,
+			struct ptlrpc_request *req)
+{
+	struct rpc_capture_rec	*rec;
+	unsigned int		 msglen;
+	unsigned int		 idx;
+
+	rec = ptlrpc_rec_ring_get(&rpc_capture_ring, &idx);
+	if (rec == NULL)
+		return;
+
+	msglen = min_t(unsigned int, req->rq_reqlen,
+		       rpc_capture_ring.rr_recsize - sizeof(*rec));
+	memset(rec, 0, sizeof(*rec));
+	rec->rcr_magic = RPC_CAPTURE_MAGIC;
+	rec->rcr_reclen = sizeof(*rec) + cfs_size_round(msglen);
+	rec->rcr_arrival = (__u64)req->rq_arrival_time.tv_sec * ONE_MILLION +
+			   req->rq_arrival_time.tv_usec;
+	rec->rcr_xid = req->rq_xid;
+	rec->rcr_self_nid = req->rq_self;
+	rec->rcr_peer_nid = req->rq_peer.nid;
+	rec->rcr_peer_pid = req->rq_peer.pid;
+	rec->rcr_opc = lustre_msg_get_opc(req->rq_reqmsg);
+	if (ptlrpc_req_need_swab(req))
+		rec->rcr_flags |= RPC_CAPTURE_SWABBED;
+	rec->rcr_reqlen = req->rq_reqlen;
+	rec->rcr_msglen = msglen;
+	strlcpy(rec->rcr_service, svc->srv_name, sizeof(rec->rcr_service));
+	memcpy(rec->rcr_msg, req->rq_reqmsg, msglen);
+
+	ptlrpc_rec_ring_put(&rpc_capture_ring, idx);
+}
+
+static int ptlrpc_rpc_trace_open(struct inode *inode, struct file *file)
+{
+	return ptlrpc_rec_ring_alloc(&rpc_trace_ring,
+				     max(rpc_trace_records, 1),
+				     sizeof(struct rpc_trace_rec));
+}
+
+static ssize_t ptlrpc_rpc_trace_read(struct file *file, char __user *buf,
+				     size_t count, loff_t *ppos)
+{
+	return ptlrpc_rec_ring_read(&rpc_trace_ring, buf, count);
+}
+
+static const struct file_operations ptlrpc_rpc_trace_fops = {
+	.owner	= THIS_MODULE,
+	.open	= ptlrpc_rpc_trace_open,
+	.read	= ptlrpc_rpc_trace_read,
+};
+
+static unsigned int ptlrpc_rpc_capture_reclen(const void *rec)
+{
+	return ((const struct rpc_capture_rec *)rec)->rcr_reclen;
+}
+
+static int ptlrpc_rpc_capture_open(struct inode *inode, struct file *file)
+{
+	int bytes = clamp_t(int, rpc_capture_bytes, sizeof(struct lustre_msg),
+			    OST_IO_MAXREQSIZE);
+
+	return ptlrpc_rec_ring_alloc(&rpc_capture_ring,
+				     max(rpc_capture_records, 1),
+				     sizeof(struct rpc_capture_rec) +
+				     cfs_size_round(bytes));
+}
+
+static ssize_t ptlrpc_rpc_capture_read(struct file *file, char __user *buf,
+				       size_t count, loff_t *ppos)
+{
+	return ptlrpc_rec_ring_read(&rpc_capture_ring, buf, count);
+}
+
+static const struct file_operations ptlrpc_rpc_capture_fops = {
+	.owner	= THIS_MODULE,
+	.open	= ptlrpc_rpc_capture_open,
+	.read	= ptlrpc_rpc_capture_read,
+};
+
+int ptlrpc_rpc_trace_init(void)
+{
+	int rc;
+
+	ptlrpc_rec_ring_init(&rpc_trace_ring, NULL);
+	ptlrpc_rec_ring_init(&rpc_capture_ring, ptlrpc_rpc_capture_reclen);
+
+	rc = lprocfs_seq_create(proc_lustre_root, "rpc_trace", 0400,
+				&ptlrpc_rpc_trace_fops, NULL);
+	if (rc)
+		return rc;
+
+	rc = lprocfs_seq_create(proc_lustre_root, "rpc_capture", 0400,
+				&ptlrpc_rpc_capture_fops, NULL);
+	if (rc)
+		lprocfs_remove_proc_entry("rpc_trace", proc_lustre_root);
+
+	return rc;
+}
+
+void ptlrpc_rpc_trace_fini(void)
+{
+	lprocfs_remove_proc_entry("rpc_capture", proc_lustre_root);
+	lprocfs_remove_proc_entry("rpc_trace", proc_lustre_root);
+	ptlrpc_rec_ring_fini(&rpc_capture_ring);
+	ptlrpc_rec_ring_fini(&rpc_trace_ring);
+}
@@ -58,6 +58,16 @@ CFS_MODULE_PARM(at_early_margin, "i", int, 0644,
 CFS_MODULE_PARM(at_extra, "i", int, 0644,
                 "How much extra time to give with each early reply");
 
+static int thread_idle_timeout = 600;
+CFS_MODULE_PARM(thread_idle_timeout, "i", int, 0644,
+		"seconds an extra service thread may be idle before it exits "
+		"(0 to keep all threads)");
+
+static int thread_start_delay = 1000;
+CFS_MODULE_PARM(thread_start_delay, "i", int, 0644,
+		"usec a request must be queued before a service thread is "
+		"added (0 to add one as soon as all threads are busy)");
+
 
 /* forward ref */
 static int ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt);
@@ -778,6 +788,9 @@ ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 	service->srv_thread_name	= conf->psc_thr.tc_thr_name;
 	service->srv_ctx_tags		= conf->psc_thr.tc_ctx_tags;
 	service->srv_hpreq_ratio	= PTLRPC_SVC_HP_RATIO;
+	service->srv_thrs_idle_timeout	= max(thread_idle_timeout, 0);
+	service->srv_thrs_start_delay	=
+		clamp_t(int, thread_start_delay, 0, ONE_MILLION);
 	service->srv_ops		= conf->psc_ops;
 
 	for (i = 0; i < ncpts; i++) {
@@ -1051,6 +1064,13 @@ void ptlrpc_update_export_timer(struct obd_export *exp, long extra_delay)
 
         /* Do not pay attention on 1sec or smaller renewals. */
         new_time = cfs_time_current_sec() + extra_delay;
+
+	/* remember that the client node is alive, for all its exports
+	 * sharing this connection, see ping_evictor_main() */
+	if (exp->exp_connection != NULL &&
+	    exp->exp_connection->c_last_request_time < new_time)
+		exp->exp_connection->c_last_request_time = new_time;
+
         if (exp->exp_last_request_time + 1 /*second */ >= new_time)
                 RETURN_EXIT;
 
@@ -2032,6 +2052,7 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 		libcfs_debug_dumplog();
 
 	do_gettimeofday(&work_start);
+	ptlrpc_req_stamp_tv(request, RPC_STAGE_DEQUEUED, &work_start);
 	timediff = cfs_timeval_sub(&work_start, &request->rq_arrival_time,NULL);
 	if (likely(svc->srv_stats != NULL)) {
                 lprocfs_counter_add(svc->srv_stats, PTLRPC_REQWAIT_CNTR,
@@ -2078,6 +2099,9 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 
 	CDEBUG(D_NET, "got req "LPU64"\n", request->rq_xid);
 
+	if (unlikely(svc->srv_req_capture))
+		ptlrpc_req_capture(svc, request);
+
 	/* re-assign request and sesson thread to the current one */
 	request->rq_svc_thread = thread;
 	if (thread != NULL) {
@@ -2101,6 +2125,7 @@ put_conn:
 	}
 
 	do_gettimeofday(&work_end);
+	ptlrpc_req_stamp_tv(request, RPC_STAGE_HANDLED, &work_end);
 	timediff = cfs_timeval_sub(&work_end, &work_start, NULL);
 	CDEBUG(D_RPCTRACE, "Handled RPC pname:cluuid+ref:pid:xid:nid:opc "
 	       "%s:%s+%d:%d:x"LPU64":%s:%d Request procesed in "
@@ -2141,6 +2166,7 @@ put_conn:
                           request->rq_arrival_time.tv_sec));
         }
 
+	ptlrpc_req_stage_done(request, &svc->srv_stage_stats);
 	ptlrpc_server_finish_active_request(svcpt, request);
 
 	RETURN(1);
@@ -2305,6 +2331,36 @@ ptlrpc_threads_increasable(struct ptlrpc_service_part *svcpt)
 	       svcpt->scp_service->srv_nthrs_cpt_limit;
 }
 
+/**
+ * Check whether queued requests have waited long enough to justify another
+ * thread.  A burst that the busy threads drain within
+ * ptlrpc_service::srv_thrs_start_delay does not grow the pool.
+ */
+static int ptlrpc_threads_delayed(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_request	*req = NULL;
+	struct timeval		 now;
+	long			 delay;
+
+	delay = svcpt->scp_service->srv_thrs_start_delay;
+	if (delay == 0)
+		return 1;
+
+	do_gettimeofday(&now);
+
+	spin_lock(&svcpt->scp_req_lock);
+	if (ptlrpc_server_high_pending(svcpt, true))
+		req = ptlrpc_nrs_req_peek_nolock(svcpt, true);
+	else if (ptlrpc_server_normal_pending(svcpt, true))
+		req = ptlrpc_nrs_req_peek_nolock(svcpt, false);
+
+	if (req != NULL)
+		delay -= cfs_timeval_sub(&now, &req->rq_arrival_time, NULL);
+	spin_unlock(&svcpt->scp_req_lock);
+
+	return req != NULL && delay <= 0;
+}
+
 /**
  * too many requests and allowed to create more threads
  */
@@ -2312,7 +2368,45 @@ static inline int
 ptlrpc_threads_need_create(struct ptlrpc_service_part *svcpt)
 {
 	return !ptlrpc_threads_enough(svcpt) &&
-		ptlrpc_threads_increasable(svcpt);
+		ptlrpc_threads_increasable(svcpt) &&
+		ptlrpc_threads_delayed(svcpt);
+}
+
+/**
+ * Retire \a thread after it has been idle for
+ * ptlrpc_service::srv_thrs_idle_timeout, unless that would leave fewer than
+ * ptlrpc_service::srv_nthrs_cpt_init threads in \a svcpt.
+ *
+ * \retval 1	\a thread is no longer running and should exit
+ * \retval 0	\a thread must keep running
+ */
+static int ptlrpc_thread_retire(struct ptlrpc_service_part *svcpt,
+				struct ptlrpc_thread *thread)
+{
+	struct ptlrpc_service	*svc = svcpt->scp_service;
+	int			 rc = 0;
+
+	spin_lock(&svcpt->scp_lock);
+	if (!thread_is_stopping(thread) && !svc->srv_is_stopping &&
+	    svcpt->scp_nthrs_running > svc->srv_nthrs_cpt_init) {
+		thread_clear_flags(thread, SVC_RUNNING);
+		svcpt->scp_nthrs_running--;
+		rc = 1;
+	}
+	spin_unlock(&svcpt->scp_lock);
+
+	if (rc == 0)
+		return 0;
+
+	/* the exclusive wakeup that raced with our timeout may have been
+	 * meant for us, pass it on */
+	wake_up(&svcpt->scp_waitq);
+
+	CDEBUG(D_RPCTRACE, "%s: retiring idle thread %s, %d left\n",
+	       svc->srv_name, thread->t_name, svcpt->scp_nthrs_running);
+	if (likely(svc->srv_stats != NULL))
+		lprocfs_counter_incr(svc->srv_stats, PTLRPC_THREAD_EXIT_CNTR);
+	return 1;
 }
 
 static inline int
@@ -2346,6 +2440,14 @@ ptlrpc_server_request_incoming(struct ptlrpc_service_part *svcpt)
 	return !list_empty(&svcpt->scp_req_incoming);
 }
 
+/**
+ * Wait for work to do.
+ *
+ * \retval 0		there may be work to do
+ * \retval -EINTR	\a thread or the service is stopping
+ * \retval -ETIMEDOUT	\a thread has been idle for
+ *			ptlrpc_service::srv_thrs_idle_timeout
+ */
 static __attribute__((__noinline__)) int
 ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 		  struct ptlrpc_thread *thread)
@@ -2353,12 +2455,33 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 	/* Don't exit while there are replies to be handled */
 	struct l_wait_info lwi = LWI_TIMEOUT(svcpt->scp_rqbd_timeout,
 					     ptlrpc_retry_rqbds, svcpt);
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	int idle = 0;
+	int rc;
+
+	if (svcpt->scp_rqbd_timeout != 0) {
+		/* waiting to repost request buffers */
+	} else if (svc->srv_thrs_start_delay != 0 &&
+		   !ptlrpc_threads_enough(svcpt) &&
+		   ptlrpc_threads_increasable(svcpt) &&
+		   ptlrpc_server_request_pending(svcpt, true)) {
+		/* requests are queued while all other threads are busy,
+		 * recheck how long they have waited */
+		lwi = LWI_TIMEOUT(max_t(cfs_duration_t, 1,
+				  cfs_time_seconds(svc->srv_thrs_start_delay) /
+				  ONE_MILLION), NULL, NULL);
+	} else if (svc->srv_thrs_idle_timeout != 0 &&
+		   svcpt->scp_nthrs_running > svc->srv_nthrs_cpt_init) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(svc->srv_thrs_idle_timeout),
+				  NULL, NULL);
+		idle = 1;
+	}
 
 	lc_watchdog_disable(thread->t_watchdog);
 
 	cond_resched();
 
-	l_wait_event_exclusive_head(svcpt->scp_waitq,
+	rc = l_wait_event_exclusive_head(svcpt->scp_waitq,
 				ptlrpc_thread_stopping(thread) ||
 				ptlrpc_server_request_incoming(svcpt) ||
 				ptlrpc_server_request_pending(svcpt, false) ||
@@ -2370,7 +2493,7 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 
 	lc_watchdog_touch(thread->t_watchdog,
 			  ptlrpc_server_get_timeout(svcpt));
-	return 0;
+	return idle && rc == -ETIMEDOUT ? -ETIMEDOUT : 0;
 }
 
 /**
@@ -2387,6 +2510,7 @@ static int ptlrpc_main(void *arg)
 	struct ptlrpc_reply_state	*rs;
 	struct group_info *ginfo = NULL;
 	struct lu_env *env;
+	bool retired = false;
 	int counter = 0, rc = 0;
 	ENTRY;
 
@@ -2417,11 +2541,11 @@ static int ptlrpc_main(void *arg)
                         goto out;
         }
 
-        OBD_ALLOC_PTR(env);
-        if (env == NULL) {
-                rc = -ENOMEM;
-                goto out_srv_fini;
-        }
+	OBD_CPT_ALLOC_PTR(env, svc->srv_cptable, svcpt->scp_cpt);
+	if (env == NULL) {
+		rc = -ENOMEM;
+		goto out_srv_fini;
+	}
 
         rc = lu_context_init(&env->le_ctx,
                              svc->srv_ctx_tags|LCT_REMEMBER|LCT_NOREF);
@@ -2442,12 +2566,13 @@ static int ptlrpc_main(void *arg)
 		goto out_srv_fini;
 	}
 
-        /* Alloc reply state structure for this one */
-        OBD_ALLOC_LARGE(rs, svc->srv_max_reply_size);
-        if (!rs) {
-                rc = -ENOMEM;
-                goto out_srv_fini;
-        }
+	/* Alloc reply state structure for this one */
+	OBD_CPT_ALLOC_LARGE(rs, svc->srv_cptable, svcpt->scp_cpt,
+			    svc->srv_max_reply_size);
+	if (!rs) {
+		rc = -ENOMEM;
+		goto out_srv_fini;
+	}
 
 	spin_lock(&svcpt->scp_lock);
 
@@ -2468,6 +2593,9 @@ static int ptlrpc_main(void *arg)
 	/* wake up our creator in case he's still waiting. */
 	wake_up(&thread->t_ctl_waitq);
 
+	if (likely(svc->srv_stats != NULL))
+		lprocfs_counter_incr(svc->srv_stats, PTLRPC_THREAD_START_CNTR);
+
 	thread->t_watchdog = lc_watchdog_add(ptlrpc_server_get_timeout(svcpt),
 					     NULL, NULL);
 
@@ -2481,7 +2609,10 @@ static int ptlrpc_main(void *arg)
 
 	/* XXX maintain a list of all managed devices: insert here */
 	while (!ptlrpc_thread_stopping(thread)) {
-		if (ptlrpc_wait_event(svcpt, thread))
+		rc = ptlrpc_wait_event(svcpt, thread);
+		if (rc == -ETIMEDOUT && ptlrpc_thread_retire(svcpt, thread))
+			retired = true;
+		if (rc == -EINTR || retired)
 			break;
 
 		ptlrpc_check_rqbd_pool(svcpt);
@@ -2525,8 +2656,23 @@ static int ptlrpc_main(void *arg)
                 }
         }
 
-        lc_watchdog_delete(thread->t_watchdog);
-        thread->t_watchdog = NULL;
+	rc = 0;
+	lc_watchdog_delete(thread->t_watchdog);
+	thread->t_watchdog = NULL;
+
+	if (retired) {
+		/* give back the reply state this thread added to the pool */
+		rs = NULL;
+		spin_lock(&svcpt->scp_rep_lock);
+		if (!list_empty(&svcpt->scp_rep_idle)) {
+			rs = list_entry(svcpt->scp_rep_idle.next,
+					struct ptlrpc_reply_state, rs_list);
+			list_del(&rs->rs_list);
+		}
+		spin_unlock(&svcpt->scp_rep_lock);
+		if (rs != NULL)
+			OBD_FREE_LARGE(rs, svc->srv_max_reply_size);
+	}
 
 out_srv_fini:
         /*
@@ -2552,6 +2698,14 @@ out:
 		svcpt->scp_nthrs_running--;
 	}
 
+	if (retired && !thread_is_stopping(thread)) {
+		/* nobody is waiting for us, free the slot for a new thread */
+		list_del(&thread->t_link);
+		spin_unlock(&svcpt->scp_lock);
+		OBD_FREE_PTR(thread);
+		return 0;
+	}
+
 	thread->t_id = rc;
 	thread_add_flags(thread, SVC_STOPPED);
 
@@ -2783,6 +2937,33 @@ int ptlrpc_start_threads(struct ptlrpc_service *svc)
 	RETURN(rc);
 }
 
+/**
+ * Give \a thread the lowest t_id not used by a live thread of \a svcpt and
+ * link it into ptlrpc_service_part::scp_threads, which is kept sorted by
+ * t_id, so ids of retired threads are reused and stay contiguous.
+ * Caller must hold ptlrpc_service_part::scp_lock.
+ */
+static void ptlrpc_thread_link(struct ptlrpc_service_part *svcpt,
+			       struct ptlrpc_thread *thread)
+{
+	struct ptlrpc_thread	*tmp;
+	int			 id = 0;
+
+	list_for_each_entry(tmp, &svcpt->scp_threads, t_link) {
+		/* t_id of a stopped thread holds its exit code */
+		if (thread_is_stopped(tmp))
+			continue;
+		if (tmp->t_id != id)
+			break;
+		id++;
+	}
+
+	thread->t_id = id;
+	list_add_tail(&thread->t_link, &tmp->t_link);
+	if (id >= svcpt->scp_thr_nextid)
+		svcpt->scp_thr_nextid = id + 1;
+}
+
 int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait)
 {
 	struct l_wait_info	lwi = { 0 };
@@ -2840,11 +3021,9 @@ int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait)
 	}
 
 	svcpt->scp_nthrs_starting++;
-	thread->t_id = svcpt->scp_thr_nextid++;
+	ptlrpc_thread_link(svcpt, thread);
 	thread_add_flags(thread, SVC_STARTING);
 	thread->t_svcpt = svcpt;
-
-	list_add(&thread->t_link, &svcpt->scp_threads);
 	spin_unlock(&svcpt->scp_lock);
 
 	if (svcpt->scp_cpt >= 0) {
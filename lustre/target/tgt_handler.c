@@ -465,6 +465,7 @@ static int tgt_filter_recovery_request(struct ptlrpc_request *req,
 	case OST_CREATE:
 	case OST_DESTROY:
 	case OST_PUNCH:
+	case OST_FALLOCATE:
 	case OST_SETATTR:
 	case OST_SYNC:
 	case OST_WRITE:
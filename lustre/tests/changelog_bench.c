@@ -0,0 +1,170 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+
+/*
+ * Read a changelog to its end and report how fast records were received,
+ * either one record at a time with llapi_changelog_recv() or in batches
+ * with llapi_changelog_recv_batch().
+ *
+ * The output is a single line:
+ *   <records> records <seconds> sec <rate> records/sec last <index>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sys/time.h>
+
+#include <lustre/lustreapi.h>
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: %s [-b COUNT] [-j] [-s STARTREC] "
+		"[-t TYPE[,TYPE...]] MDTNAME\n"
+		"  -b COUNT  read up to COUNT records per call, "
+		"0 reads one record per call (default 1024)\n"
+		"  -j        ask for the jobid extension\n"
+		"  -s REC    start at record REC\n"
+		"  -t TYPES  only receive these record types, e.g. CREAT,UNLNK\n",
+		program_invocation_short_name);
+	exit(EXIT_FAILURE);
+}
+
+static __u32 str2mask(char *types)
+{
+	__u32	 mask = 0;
+	char	*type;
+	int	 i;
+
+	for (type = strtok(types, ","); type != NULL;
+	     type = strtok(NULL, ",")) {
+		for (i = 0; i < CL_LAST; i++) {
+			if (strcasecmp(type, changelog_type2str(i)) == 0)
+				break;
+		}
+		if (i == CL_LAST) {
+			fprintf(stderr, "unknown changelog type '%s'\n", type);
+			exit(EXIT_FAILURE);
+		}
+		mask |= 1 << i;
+	}
+
+	return mask;
+}
+
+int main(int argc, char **argv)
+{
+	enum changelog_send_flag	  flags = 0;
+	struct changelog_rec		**recs = NULL;
+	struct changelog_rec		 *rec;
+	struct timeval			  start;
+	struct timeval			  end;
+	long long			  startrec = 0;
+	__u64				  last = 0;
+	__u64				  total = 0;
+	double				  secs;
+	__u32				  mask = 0;
+	void				 *priv;
+	int				  count = 1024;
+	int				  rc;
+	int				  c;
+
+	while ((c = getopt(argc, argv, "b:js:t:")) != -1) {
+		switch (c) {
+		case 'b':
+			count = atoi(optarg);
+			if (count < 0)
+				usage();
+			break;
+		case 'j':
+			flags |= CHANGELOG_FLAG_JOBID;
+			break;
+		case 's':
+			startrec = strtoll(optarg, NULL, 0);
+			break;
+		case 't':
+			mask = str2mask(optarg);
+			break;
+		default:
+			usage();
+		}
+	}
+	if (optind != argc - 1)
+		usage();
+
+	if (count > 0) {
+		flags |= CHANGELOG_FLAG_BATCH;
+		recs = calloc(count, sizeof(*recs));
+		if (recs == NULL) {
+			fprintf(stderr, "cannot allocate %d records\n", count);
+			return EXIT_FAILURE;
+		}
+	}
+
+	gettimeofday(&start, NULL);
+
+	rc = llapi_changelog_start_mask(&priv, flags, argv[optind], startrec,
+					mask);
+	if (rc < 0) {
+		fprintf(stderr, "cannot start changelog on %s: %s\n",
+			argv[optind], strerror(-rc));
+		return EXIT_FAILURE;
+	}
+
+	while (1) {
+		if (count == 0) {
+			rc = llapi_changelog_recv(priv, &rec);
+			if (rc != 0)
+				break;
+			last = rec->cr_index;
+			total++;
+			llapi_changelog_free(&rec);
+			continue;
+		}
+
+		rc = llapi_changelog_recv_batch(priv, recs, count);
+		if (rc <= 0)
+			break;
+		last = recs[rc - 1]->cr_index;
+		total += rc;
+	}
+
+	gettimeofday(&end, NULL);
+	llapi_changelog_fini(&priv);
+	free(recs);
+
+	/* 1 from llapi_changelog_recv() and 0 from the batch call are EOF */
+	if (rc < 0) {
+		fprintf(stderr, "changelog read failed after "LPU64
+			" records: %s\n", total, strerror(-rc));
+		return EXIT_FAILURE;
+	}
+
+	secs = (end.tv_sec - start.tv_sec) +
+	       (end.tv_usec - start.tv_usec) / 1000000.0;
+	printf(LPU64" records %.3f sec %.0f records/sec last "LPU64"\n",
+	       total, secs, secs > 0 ? total / secs : 0.0, last);
+
+	return EXIT_SUCCESS;
+}
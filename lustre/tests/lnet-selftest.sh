@@ -163,6 +163,131 @@ test_smoke () {
 }
 run_test smoke "lst regression test"
 
+# time $2 LNet pings of $1 in milliseconds
+lnet_ping_msec () {
+	local nid=$1
+	local count=$2
+	local start=$(date +%s%N)
+	local i
+
+	for i in $(seq $count); do
+		$LCTL ping $nid > /dev/null || return 1
+	done
+	echo $((($(date +%s%N) - start) / 1000000))
+}
+
+# ping \a nid \a count times at once, so that the messages are delayed
+# together
+lnet_ping_parallel () {
+	local nid=$1
+	local count=$2
+	local pids=""
+	local rc=0
+	local pid
+	local i
+
+	for i in $(seq $count); do
+		$LCTL ping $nid > /dev/null &
+		pids="$pids $!"
+	done
+	for pid in $pids; do
+		wait $pid || rc=1
+	done
+	return $rc
+}
+
+# sum of the messages received out of order by the delay rules
+lnet_delay_reordered () {
+	$LCTL net_delay_list |
+		sed -n 's/.*, reordered \([0-9]*\),.*/\1/p' |
+		awk '{ sum += $1 } END { print sum + 0 }'
+}
+
+test_delay () {
+	local nid=$($LCTL list_nids | head -n 1)
+	local count=10
+	local base
+	local msec
+
+	lst_prepare
+	[ -n "$nid" ] || error "LNet is not up"
+
+	base=$(lnet_ping_msec $nid $count) || error "cannot ping $nid"
+
+	# a ping is a GET and its REPLY, each delayed where it is received,
+	# by 100ms give or take 20ms
+	$LCTL net_delay_add -s '*' -d '*' -l 100ms -j 20ms ||
+		error "cannot add delay rule"
+	$LCTL net_delay_list
+	msec=$(lnet_ping_msec $nid $count)
+	local rc=$?
+	$LCTL net_delay_list
+	$LCTL net_delay_del -a
+	[ $rc = 0 ] || error "cannot ping $nid with delay rule"
+
+	echo "$count pings: ${base}ms without delay, ${msec}ms with it"
+	(( msec - base >= count * 2 * 80 )) ||
+		error "pings were delayed by less than 160ms each"
+	# allow for the scheduling of the delay thread
+	(( msec - base <= count * 2 * 120 * 2 )) ||
+		error "pings were delayed by more than 480ms each"
+
+	# at 1KiB/s, the GET of a ping and its REPLY take at least 140ms to
+	# be received, the LNet header of each being 72 bytes
+	$LCTL net_delay_add -s '*' -d '*' -b 1K ||
+		error "cannot add bandwidth rule"
+	msec=$(lnet_ping_msec $nid $count)
+	rc=$?
+	$LCTL net_delay_list
+	$LCTL net_delay_del -a
+	[ $rc = 0 ] || error "cannot ping $nid with bandwidth rule"
+
+	echo "$count pings: ${msec}ms at 1KiB/s"
+	(( msec - base >= count * 140 )) ||
+		error "pings were received faster than 1KiB/s"
+
+	# a full bucket of 64KiB lets all of them through at once
+	$LCTL net_delay_add -s '*' -d '*' -b 1K -B 64K ||
+		error "cannot add bandwidth rule with burst"
+	msec=$(lnet_ping_msec $nid $count)
+	rc=$?
+	$LCTL net_delay_list
+	$LCTL net_delay_del -a
+	[ $rc = 0 ] || error "cannot ping $nid with burst rule"
+
+	echo "$count pings: ${msec}ms at 1KiB/s with a 64KiB burst"
+	(( msec - base < count * 70 )) ||
+		error "pings were limited despite the burst"
+
+	# concurrent pings with a large jitter are received in order, unless
+	# the rule allows reordering
+	local reordered
+
+	$LCTL net_delay_add -s '*' -d '*' -l 100ms -j 90ms ||
+		error "cannot add in order delay rule"
+	lnet_ping_parallel $nid $count
+	rc=$?
+	reordered=$(lnet_delay_reordered)
+	$LCTL net_delay_list
+	$LCTL net_delay_del -a
+	[ $rc = 0 ] || error "cannot ping $nid with in order delay rule"
+	[ $reordered -eq 0 ] ||
+		error "$reordered messages reordered without -o"
+
+	$LCTL net_delay_add -s '*' -d '*' -l 100ms -j 90ms -o ||
+		error "cannot add reordering delay rule"
+	lnet_ping_parallel $nid $count
+	rc=$?
+	reordered=$(lnet_delay_reordered)
+	$LCTL net_delay_list
+	$LCTL net_delay_del -a
+	[ $rc = 0 ] || error "cannot ping $nid with reordering delay rule"
+	[ $reordered -gt 0 ] || error "no message reordered with -o"
+
+	lst_cleanup_all
+}
+run_test delay "LNet delay rule latency, jitter, bandwidth and reordering"
+
 complete $SECONDS
 if [ "$RESTORE_MOUNT" = yes ]; then
     setupall
@@ -75,6 +75,7 @@ get_target() {
 mds_survey_run() {
     local layer=${1:-mdd}
     local stripe_count=${2:-0}
+    local extra=${3:-}
     local mds=$(facet_host $SINGLEMDS)
     local rc=0
 
@@ -83,7 +84,7 @@ mds_survey_run() {
     local target=$(get_target)
     local cmd="file_count=$file_count thrlo=$thrlo thrhi=$thrhi"
     local cmd+=" dir_count=$dir_count layer=$layer stripe_count=$stripe_count"
-    local cmd+=" rslt_loc=${TMP} targets=\"$mds:$target\" $MDSSURVEY"
+    local cmd+=" $extra rslt_loc=${TMP} targets=\"$mds:$target\" $MDSSURVEY"
 
     echo + $cmd
     eval $cmd || rc=$?
@@ -105,6 +106,18 @@ test_2() {
 }
 run_test 2 "Metadata survey with stripe_count = 1"
 
+test_3() {
+    local tests="tests_str=\"create lookup md_getattr destroy\""
+
+    echo "lookups of busy objects"
+    mds_survey_run "mdd" "0" "hot_lookup=1 $tests"
+    do_facet $SINGLEMDS $LCTL get_param -n mdt.$FSNAME-MDT0000.site_stats
+    echo "lookups of objects not in cache"
+    mds_survey_run "mdd" "0" "drop_cache=1 $tests"
+    do_facet $SINGLEMDS $LCTL get_param -n mdt.$FSNAME-MDT0000.site_stats
+}
+run_test 3 "Metadata survey of hot and cold object lookups"
+
 # remount the clients
 restore_mount $MOUNT
 
@@ -4021,6 +4021,58 @@ test_251() {
 }
 run_test 251 "Coordinator request timeout"
 
+get_action_queue_stat() {
+	do_facet $SINGLEMDS "$LCTL get_param -n $HSM_PARAM.action_queue" |
+		awk '/^'$1':/ { print $2 }'
+}
+
+test_252() {
+	# test needs a running copytool
+	copytool_setup
+
+	[[ $(get_action_queue_stat loaded) == "yes" ]] ||
+		error "action queue not loaded"
+
+	mkdir -p $DIR/$tdir
+	copy2archive /etc/hosts $tdir/$tfile
+	local f=$DIR/$tdir/$tfile
+	import_file $tdir/$tfile $f
+	local fid=$(path2fid $f)
+	local dispatched=$(get_action_queue_stat dispatched)
+	local cnt=10
+	local i
+
+	cdt_disable
+	for i in $(seq $cnt); do
+		dd if=/dev/urandom of=$f.$i bs=1k count=1 conv=fsync ||
+			error "cannot create $f.$i"
+		$LFS hsm_archive --archive $HSM_ARCHIVE_NUMBER $f.$i ||
+			error "cannot archive $f.$i"
+	done
+	$LFS hsm_restore $f || error "cannot restore $f"
+
+	local waiting=$(get_action_queue_stat waiting_restore)
+	[[ $waiting -eq 1 ]] || error "$waiting restores waiting, expected 1"
+	waiting=$(get_action_queue_stat waiting_archive)
+	[[ $waiting -ge $cnt ]] ||
+		error "$waiting archives waiting, expected $cnt"
+	cdt_enable
+
+	wait_request_state $fid RESTORE SUCCEED
+	for i in $(seq $cnt); do
+		wait_request_state $(path2fid $f.$i) ARCHIVE SUCCEED
+	done
+
+	waiting=$(get_action_queue_stat waiting_restore)
+	[[ $waiting -eq 0 ]] || error "$waiting restores still waiting"
+	i=$(get_action_queue_stat dispatched)
+	[[ $i -ge $((dispatched + cnt + 1)) ]] ||
+		error "$((i - dispatched)) requests dispatched, expected $((cnt + 1))"
+
+	copytool_cleanup
+}
+run_test 252 "Coordinator action queue"
+
 test_300() {
 	# the only way to test ondisk conf is to restart MDS ...
 	echo "Stop coordinator and remove coordinator state at mount"
@@ -4301,6 +4353,127 @@ test_405() {
 }
 run_test 405 "archive and release under striped directory"
 
+test_406() {
+	local agent=$(facet_active_host $SINGLEAGT)
+
+	local_node $agent ||
+		{ skip "PCC needs the copytool on the client"; return; }
+	$LCTL get_param -n llite.*.pcc > /dev/null 2>&1 ||
+		{ skip "client does not support PCC"; return; }
+
+	copytool_setup
+
+	mkdir -p $DIR/$tdir
+	local f=$DIR/$tdir/$tfile
+	local fid=$(make_small_sync $f)
+	local sum=$(md5sum < $f)
+
+	$LCTL set_param llite.*.pcc="$HSM_ARCHIVE_NUMBER $HSM_ARCHIVE" ||
+		error "cannot enable PCC"
+
+	$LFS pcc_attach --archive $HSM_ARCHIVE_NUMBER $f ||
+		error "cannot attach $f"
+	$LFS pcc_state $f | grep -q ": attached" ||
+		error "$f is not attached after pcc_attach"
+	check_hsm_flags $f "0x0000000d"
+
+	local before=$($LCTL get_param -n llite.*.stats |
+		       awk '/^pcc_read_bytes/ { sum += $7 } END { print sum+0 }')
+	[[ "$(md5sum < $f)" == "$sum" ]] ||
+		error "data read through the cache differ"
+	local after=$($LCTL get_param -n llite.*.stats |
+		      awk '/^pcc_read_bytes/ { sum += $7 } END { print sum+0 }')
+	(( after > before )) || error "read was not served by the cache"
+
+	# write through the cache, then restore back to Lustre
+	echo "pcc" >> $f || error "cannot append to $f"
+	sum=$(md5sum < $f)
+
+	$LFS pcc_detach $f || error "cannot detach $f"
+	wait_request_state $fid RESTORE SUCCEED
+	$LFS pcc_state $f | grep -q ": attached" &&
+		error "$f is still attached after pcc_detach"
+	[[ "$(md5sum < $f)" == "$sum" ]] ||
+		error "data written through the cache were lost"
+
+	$LCTL set_param llite.*.pcc=0
+	copytool_cleanup
+}
+run_test 406 "persistent client cache attach, IO and detach"
+
+pcc_stat() {
+	$LCTL get_param -n llite.*.stats |
+		awk '/^'$1' / { sum += $2 } END { print sum+0 }'
+}
+
+test_407() {
+	local agent=$(facet_active_host $SINGLEAGT)
+
+	local_node $agent ||
+		{ skip "PCC needs the copytool on the client"; return; }
+	$LCTL get_param -n llite.*.pcc > /dev/null 2>&1 ||
+		{ skip "client does not support PCC"; return; }
+
+	copytool_setup
+
+	mkdir -p $DIR/$tdir
+	local f=$DIR/$tdir/$tfile
+	local f2=$DIR/$tdir/$tfile.lustre
+	local mb=16
+	local loops=10
+
+	dd if=/dev/urandom of=$f bs=1M count=$mb conv=fsync ||
+		error "cannot create $f"
+	cp $f $f2 || error "cannot create $f2"
+
+	$LCTL set_param llite.*.pcc="$HSM_ARCHIVE_NUMBER $HSM_ARCHIVE" ||
+		error "cannot enable PCC"
+	$LFS pcc_attach --archive $HSM_ARCHIVE_NUMBER $f ||
+		error "cannot attach $f"
+	$LFS pcc_state $f | grep -q ": attached" ||
+		error "$f is not attached after pcc_attach"
+
+	local start
+	local end
+	local i
+
+	# dropping the OSC locks empties the page cache of the Lustre file,
+	# so every loop reads it from the OSTs
+	start=$(date +%s.%N)
+	for i in $(seq $loops); do
+		cancel_lru_locks osc
+		dd if=$f2 of=/dev/null bs=1M 2> /dev/null ||
+			error "cannot read $f2"
+	done
+	end=$(date +%s.%N)
+	echo "Lustre: $(echo "$mb * $loops / ($end - $start)" | bc) MB/s"
+
+	local hit=$(pcc_stat pcc_hit)
+	local miss=$(pcc_stat pcc_miss)
+
+	start=$(date +%s.%N)
+	for i in $(seq $loops); do
+		cancel_lru_locks osc
+		dd if=$f of=/dev/null bs=1M 2> /dev/null ||
+			error "cannot read $f"
+	done
+	end=$(date +%s.%N)
+	echo "PCC: $(echo "$mb * $loops / ($end - $start)" | bc) MB/s"
+
+	hit=$(($(pcc_stat pcc_hit) - hit))
+	miss=$(($(pcc_stat pcc_miss) - miss))
+	# dd reads the file in $mb reads plus one at EOF
+	(( hit >= mb * loops )) ||
+		error "only $hit of $((mb * loops)) reads were served by PCC"
+	echo "PCC hits: $hit, misses: $miss," \
+	     "hit rate: $((hit * 100 / (hit + miss)))%"
+	(( miss == 0 )) || error "$miss reads of an attached file missed"
+
+	$LCTL set_param llite.*.pcc=0
+	copytool_cleanup
+}
+run_test 407 "persistent client cache repeated read benchmark"
+
 test_500()
 {
 	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.6.92) ] &&
@@ -4219,6 +4219,104 @@ test_31h() {
 }
 run_test 31h "Repair the corrupted shard's name entry"
 
+test_32() {
+	echo "#####"
+	echo "The layout LFSCK handles the first-stage requests with more"
+	echo "than one assistant thread, all the inconsistent OST-object"
+	echo "owners should still be repaired."
+	echo "#####"
+
+	check_mount_and_prep
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "(1) Fail to create files"
+	cancel_lru_locks osc
+
+	local saved=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		      mdd.${MDT_DEV}.lfsck_assistant_threads)
+	do_facet $SINGLEMDS $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=4 ||
+		error "(2) Fail to set assistant threads"
+
+	echo "Inject failure stub to skip OST-object owner changing"
+	#define OBD_FAIL_LFSCK_BAD_OWNER	0x1613
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1613
+	for ((i = 0; i < 100; i++)); do
+		chown 1.1 $DIR/$tdir/f$i
+	done
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	echo "Trigger layout LFSCK with 4 assistant threads"
+	$START_LAYOUT -r || error "(3) Fail to start LFSCK for layout!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_layout |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_LAYOUT
+		do_facet $SINGLEMDS $LCTL set_param \
+			mdd.${MDT_DEV}.lfsck_assistant_threads=$saved
+		error "(4) unexpected status"
+	}
+
+	do_facet $SINGLEMDS $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=$saved
+
+	local repaired=$($SHOW_LAYOUT |
+			 awk '/^repaired_inconsistent_owner/ { print $2 }')
+	[ $repaired -eq 100 ] ||
+		error "(5) Fail to repair inconsistent owner: $repaired"
+}
+run_test 32 "Layout LFSCK with multiple assistant threads"
+
+test_33() {
+	echo "#####"
+	echo "The namespace LFSCK handles the first-stage requests with more"
+	echo "than one assistant thread, all the crashed linkEA entries"
+	echo "should still be repaired."
+	echo "#####"
+
+	check_mount_and_prep
+
+	echo "Inject failure stub to make the linkEA crashed"
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1603
+	createmany -o $DIR/$tdir/f 100 || {
+		do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+		error "(1) Fail to create files"
+	}
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	local saved=$(do_facet $SINGLEMDS $LCTL get_param -n \
+		      mdd.${MDT_DEV}.lfsck_assistant_threads)
+	do_facet $SINGLEMDS $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=4 ||
+		error "(2) Fail to set assistant threads"
+
+	echo "Trigger namespace LFSCK with 4 assistant threads"
+	$START_NAMESPACE -r || error "(3) Fail to start LFSCK for namespace!"
+
+	wait_update_facet $SINGLEMDS "$LCTL get_param -n \
+		mdd.${MDT_DEV}.lfsck_namespace |
+		awk '/^status/ { print \\\$2 }'" "completed" 32 || {
+		$SHOW_NAMESPACE
+		do_facet $SINGLEMDS $LCTL set_param \
+			mdd.${MDT_DEV}.lfsck_assistant_threads=$saved
+		error "(4) unexpected status"
+	}
+
+	do_facet $SINGLEMDS $LCTL set_param \
+		mdd.${MDT_DEV}.lfsck_assistant_threads=$saved
+
+	local repaired=$($SHOW_NAMESPACE |
+			 awk '/^linkea_repaired/ { print $2 }')
+	[ $repaired -eq 100 ] ||
+		error "(5) Fail to repair crashed linkEA: $repaired"
+
+	local fid=$($LFS path2fid $DIR/$tdir/f99)
+	[ "$($LFS fid2path $DIR $fid)" == "$DIR/$tdir/f99" ] ||
+		error "(6) Fail to repair linkEA: $fid"
+}
+run_test 33 "Namespace LFSCK with multiple assistant threads"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -1140,6 +1140,33 @@ test_15() {
 }
 run_test 15 "Dryrun mode OI scrub"
 
+scrub_threads() {
+	local threads=$1
+
+	do_nodes $(comma_list $(mdts_nodes)) $LCTL set_param -n \
+		osd-ldiskfs.*.scrub_threads=$threads
+}
+
+test_16() {
+	scrub_prep 100
+	scrub_backup_restore 1
+	echo "starting MDTs with OI scrub disabled"
+	scrub_start_mds 2 "$MOUNT_OPTS_NOSCRUB"
+	scrub_check_status 3 init
+	scrub_check_flags 4 inconsistent
+
+	scrub_threads 4
+	scrub_start 5
+	scrub_check_status 6 completed
+	scrub_threads 1
+	scrub_check_flags 7 ""
+	scrub_check_repaired 8 100
+
+	mount_client $MOUNT || error "(9) Fail to start client!"
+	scrub_check_data 10
+}
+run_test 16 "Parallel OI scrub with multiple threads"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -1493,6 +1493,37 @@ test_23() {
 }
 run_test 23 "test mapped ACLs"
 
+identity_stat() {
+	do_facet $SINGLEMDS "lctl get_param -n mdt.$MDT.identity_stats" |
+		awk '/^'$1':/ { print $2 }'
+}
+
+test_24() {
+	local grpfile=$TMP/$tfile.group
+	local preloaded
+	local hits
+
+	[ -z "$(identity_stat preloaded)" ] &&
+		skip "MDS without identity preload" && return
+
+	do_facet $SINGLEMDS "lctl set_param -n $IDENTITY_FLUSH=-1"
+	do_facet $SINGLEMDS "echo $tfile:x:$ID0:$USER0 > $grpfile"
+
+	preloaded=$(identity_stat preloaded)
+	do_facet $SINGLEMDS "lctl identity_preload $MDT $grpfile" ||
+		error "identity_preload failed"
+	do_facet $SINGLEMDS "rm -f $grpfile"
+	[ $(identity_stat preloaded) -gt $preloaded ] ||
+		error "no identity preloaded"
+
+	# the first request of the preloaded user needs no upcall
+	hits=$(identity_stat hits)
+	$RUNAS_CMD -u $ID0 ls $DIR > /dev/null || error "ls as $ID0 failed"
+	[ $(identity_stat hits) -gt $hits ] ||
+		error "preloaded identity not used"
+}
+run_test 24 "preload identity cache from a group file"
+
 log "cleanup: ======================================================"
 
 sec_unsetup() {
@@ -4980,6 +4980,48 @@ test_56x() {
 }
 run_test 56x "lfs migration support"
 
+test_56xa() {
+	check_swap_layouts_support && return 0
+	[[ $OSTCOUNT -lt 2 ]] &&
+		skip_env "need 2 OST, skipping test" && return
+
+	local dir0=$DIR/$tdir/$testnum
+	local ref=$TMP/$tfile.ref
+	local stripe
+	local i
+
+	mkdir -p $dir0 || error "creating dir $dir0"
+	dd if=/dev/urandom of=$ref bs=1M count=9 2>/dev/null ||
+		error "creating $ref failed"
+	for i in $(seq 1 8); do
+		$SETSTRIPE -c 2 -S 1M $dir0/file$i
+		cp $ref $dir0/file$i || error "copy to $dir0/file$i failed"
+	done
+	# a sparse file, with data past a hole and a trailing hole
+	$SETSTRIPE -c 2 $dir0/sparse
+	dd if=$ref of=$dir0/sparse bs=1M count=1 seek=5 2>/dev/null
+	$TRUNCATE $dir0/sparse $((10 * 1048576))
+	cp --sparse=always $dir0/sparse $TMP/$tfile.sparse
+
+	$LFS migrate -c 1 --threads 4 --sparse -v $dir0/file* $dir0/sparse ||
+		error "migrate failed rc = $?"
+
+	for i in $(seq 1 8); do
+		stripe=$($GETSTRIPE -c $dir0/file$i)
+		[[ $stripe == 1 ]] ||
+			error "stripe of $dir0/file$i is $stripe != 1"
+		cmp $dir0/file$i $ref ||
+			error "content mismatch $dir0/file$i differs from $ref"
+	done
+	stripe=$($GETSTRIPE -c $dir0/sparse)
+	[[ $stripe == 1 ]] || error "stripe of $dir0/sparse is $stripe != 1"
+	cmp $dir0/sparse $TMP/$tfile.sparse ||
+		error "content mismatch in $dir0/sparse"
+
+	rm -rf $dir0 $ref $TMP/$tfile.sparse
+}
+run_test 56xa "lfs migrate with several threads and files"
+
 test_56y() {
 	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.4.53) ] &&
 		skip "No HSM support on MDS of $(get_lustre_version)," \
@@ -5048,6 +5090,34 @@ test_56aa() { # LU-5937
 }
 run_test 56aa "lfs find --size under striped dir"
 
+test_56ab() {
+	local dir=$DIR/$tdir
+	local serial=$TMP/$tfile.serial
+	local parallel=$TMP/$tfile.parallel
+	local i
+
+	test_mkdir -p $dir
+	for i in $(seq 1 10); do
+		test_mkdir -p $dir/d$i/sub$i
+		createmany -o $dir/d$i/sub$i/f- 20 > /dev/null ||
+			error "createmany in $dir/d$i/sub$i failed"
+		touch $dir/d$i/file$i
+	done
+
+	$LFS find $dir | sort > $serial || error "serial find failed"
+	$LFS find $dir --threads 4 | sort > $parallel ||
+		error "find with 4 threads failed"
+	diff -q $serial $parallel || error "find output differs with 4 threads"
+
+	$LFS find $dir --maxdepth 2 -type d | sort > $serial
+	$LFS find $dir --maxdepth 2 -type d --threads 8 | sort > $parallel
+	diff -q $serial $parallel ||
+		error "find --maxdepth output differs with 8 threads"
+
+	rm -f $serial $parallel
+}
+run_test 56ab "lfs find --threads matches the serial walk"
+
 test_57a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	# note test will not do anything if MDS is not local
@@ -5948,6 +6018,47 @@ test_77j() { # bug 13805
 }
 run_test 77j "client only supporting ADLER32"
 
+test_77k() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	$GSS && skip "could not run with gss" && return
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	# the per-page speed of an algorithm is only measured once the
+	# combined page digests matched the digest of the whole buffer
+	local hash
+	local speeds
+
+	for hash in adler32 crc32 crc32c; do
+		speeds=$($LCTL get_param -n crypto_hash_speed |
+			 awk '$1 == "'$hash'" { print $2, $3 }')
+		set -- $speeds
+		[ "${1:-0}" -gt 0 ] || continue
+		[ "${2:-0}" -gt 0 ] ||
+			error "$hash: combined page digests failed: ${2:-none}"
+	done
+
+	[ ! -f $F77_TMP ] && setup_f77
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile
+	set_checksums 1
+	for algo in $CKSUM_TYPES; do
+		set_checksum_type $algo
+		# the OST gets a bad checksum, so the client checksums the
+		# pages again and resends with the new page checksums
+		#define OBD_FAIL_OST_CHECKSUM_RECEIVE       0x21a
+		do_facet ost1 $LCTL set_param fail_loc=0x8000021a
+		dd if=$F77_TMP of=$DIR/$tfile bs=1M count=$F77SZ \
+			conv=notrunc || error "$algo: write error: rc=$?"
+		do_facet ost1 $LCTL set_param fail_loc=0
+		cancel_lru_locks osc
+		cmp $F77_TMP $DIR/$tfile || error "$algo: file compare failed"
+	done
+	set_checksum_type $ORIG_CSUM_TYPE
+	set_checksums 0
+	rm -f $DIR/$tfile
+}
+run_test 77k "per-page write checksums, resent after OST checksum error"
+
 [ "$ORIG_CSUM" ] && set_checksums $ORIG_CSUM || true
 rm -f $F77_TMP
 unset F77_TMP
@@ -9417,6 +9528,120 @@ test_150() {
 }
 run_test 150 "truncate/append tests"
 
+test_150b() {
+	which fallocate > /dev/null 2>&1 ||
+		{ skip "no fallocate utility" && return; }
+	local TF=$DIR/$tfile
+
+	$SETSTRIPE -c 1 -i 0 $TF || error "setstripe $TF failed"
+	fallocate -n -l 16M $TF 2> /dev/null ||
+		{ skip "fallocate not supported by OST" && return; }
+
+	# preallocation must not change the visible size with -n
+	local size=$(stat -c %s $TF)
+	[ $size -eq 0 ] || error "fallocate -n changed size to $size"
+
+	dd if=/dev/zero of=$TF bs=1M count=16 conv=notrunc ||
+		error "dd into preallocated $TF failed"
+	cancel_lru_locks osc
+	size=$(stat -c %s $TF)
+	[ $size -eq $((16 * 1048576)) ] ||
+		error "size $size after overwriting preallocated range"
+
+	# default mode extends the file size
+	fallocate -l 32M $TF || error "fallocate $TF failed"
+	cancel_lru_locks osc
+	size=$(stat -c %s $TF)
+	[ $size -eq $((32 * 1048576)) ] ||
+		error "fallocate did not extend size, got $size"
+
+	# punching a hole frees its blocks, reads back zeroes and keeps
+	# the size, the data around it is left alone
+	yes abcdefghijklmnopqrstuvwxyz | dd of=$TF bs=1M count=4 \
+		iflag=fullblock conv=notrunc 2> /dev/null ||
+		error "dd of data into $TF failed"
+	sync
+	local blocks=$(stat -c %b $TF)
+	fallocate -p -o 1M -l 2M $TF || error "punching a hole in $TF failed"
+	cancel_lru_locks osc
+	size=$(stat -c %s $TF)
+	[ $size -eq $((32 * 1048576)) ] ||
+		error "punch changed size to $size"
+	cmp -i 1048576:0 -n 2097152 $TF /dev/zero ||
+		error "hole in $TF does not read back as zeroes"
+	dd if=$TF bs=1M count=1 2> /dev/null | grep -q abcdefghij ||
+		error "data before the hole in $TF was lost"
+	dd if=$TF bs=1M skip=3 count=1 2> /dev/null | grep -q abcdefghij ||
+		error "data after the hole in $TF was lost"
+	local new_blocks=$(stat -c %b $TF)
+	[ $new_blocks -lt $blocks ] ||
+		error "punch did not free blocks: $blocks -> $new_blocks"
+	rm -f $TF
+}
+run_test 150b "fallocate preallocates space and punches holes on the OST"
+
+# write $2 files of $3 MB in parallel with small writes, preallocating
+# them first if $1 is "yes", print the total extents and MB/s
+falloc_bench() {
+	local prealloc=$1
+	local nfiles=$2
+	local mb=$3
+	local dir=$DIR/$tdir
+	local start
+	local end
+	local extents=0
+	local i
+
+	rm -rf $dir
+	mkdir -p $dir
+	for i in $(seq $nfiles); do
+		$SETSTRIPE -c 1 -i 0 $dir/f$i || error "setstripe $dir/f$i"
+		[ $prealloc = yes ] &&
+			{ fallocate -l ${mb}M $dir/f$i ||
+				error "fallocate $dir/f$i failed"; }
+	done
+
+	start=$(date +%s.%N)
+	for i in $(seq $nfiles); do
+		dd if=/dev/zero of=$dir/f$i bs=64k count=$((mb * 16)) \
+			conv=notrunc,fsync 2> /dev/null &
+	done
+	wait
+	end=$(date +%s.%N)
+
+	for i in $(seq $nfiles); do
+		extents=$((extents +
+			   $(filefrag $dir/f$i | awk '{ print $2 }')))
+	done
+	echo "prealloc=$prealloc extents=$extents" \
+	     "MB/s=$(echo "$nfiles * $mb / ($end - $start)" | bc -l |
+		     cut -d. -f1)"
+	rm -rf $dir
+}
+
+test_150c() {
+	which fallocate > /dev/null 2>&1 ||
+		{ skip "no fallocate utility" && return; }
+	which filefrag > /dev/null 2>&1 ||
+		{ skip "no filefrag utility" && return; }
+	[ "$(facet_fstype ost1)" = "ldiskfs" ] ||
+		{ skip "ldiskfs only test" && return; }
+
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe $DIR/$tfile"
+	fallocate -l 1M $DIR/$tfile 2> /dev/null ||
+		{ skip "fallocate not supported by OST" && return; }
+	rm -f $DIR/$tfile
+
+	# interleaved writes of several files fragment the OST objects,
+	# preallocation should keep them in fewer extents
+	local nfiles=${FALLOC_BENCH_FILES:-8}
+	local mb=${FALLOC_BENCH_MB:-64}
+
+	falloc_bench no $nfiles $mb
+	falloc_bench yes $nfiles $mb
+}
+run_test 150c "fragmentation and throughput with and without fallocate"
+
 #LU-2902 roc_hit was not able to read all values from lproc
 function roc_hit_init() {
 	local list=$(comma_list $(osts_nodes))
@@ -10383,6 +10608,44 @@ test_160c() {
 }
 run_test 160c "verify that changelog log catch the truncate event"
 
+test_160d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+	which changelog_bench > /dev/null 2>&1 ||
+		{ skip "changelog_bench not built"; return; }
+
+	local USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 \
+		changelog_register -n)
+	local nr=500
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	unlinkmany $DIR/$tdir/f $((nr / 2)) || error "unlinkmany failed"
+
+	local all=$($LFS changelog $MDT0 | wc -l)
+	local creat=$($LFS changelog $MDT0 | grep -c " 01CREAT ")
+	local single=$(changelog_bench -b 0 $MDT0)
+	local batch=$(changelog_bench -b 64 $MDT0)
+	local masked=$(changelog_bench -b 64 -t CREAT $MDT0)
+
+	echo "single: $single"
+	echo "batch:  $batch"
+	echo "CREAT:  $masked"
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+
+	[ "$(echo $single | awk '{ print $1 }')" == "$all" ] ||
+		error "single read got '$single', expected $all records"
+	[ "$(echo $batch | awk '{ print $1 }')" == "$all" ] ||
+		error "batch read got '$batch', expected $all records"
+	[ "$(echo $single | awk '{ print $NF }')" == \
+	  "$(echo $batch | awk '{ print $NF }')" ] ||
+		error "last record differs: '$single' != '$batch'"
+	[ "$(echo $masked | awk '{ print $1 }')" == "$creat" ] ||
+		error "CREAT read got '$masked', expected $creat records"
+}
+run_test 160d "changelog batch read and record type mask"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
 	test_mkdir -p -c1 $DIR/$tdir
@@ -12910,6 +13173,275 @@ test_250() {
 }
 run_test 250 "Write above 16T limit"
 
+pings_avoided() {
+	lctl get_param -n osc.*.import |
+		awk '/pings_avoided:/ { sum += $2 } END { print sum }'
+}
+
+test_251() {
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+	[ -z "$(lctl get_param -n osc.*.connect_flags | grep peer_ping)" ] &&
+		skip "server does not support peer_ping" && return
+	[ $(facet_host ost1) != $(facet_host ost2) ] &&
+		skip "needs ost1 and ost2 on the same node" && return
+
+	local interval=$(($(lctl get_param -n timeout) / 4))
+	[ $interval -lt 1 ] && interval=1
+
+	# an idle client pings each server node once per interval
+	local before=$(pings_avoided)
+	echo "idle for $((interval * 3))s"
+	sleep $((interval * 3))
+	local after=$(pings_avoided)
+	[ $after -gt $before ] ||
+		error "no pings avoided while idle: $before -> $after"
+
+	# I/O to ost1 keeps the idle ost2 import from pinging, for longer
+	# than the server would take to evict a client it does not hear of
+	$SETSTRIPE -c 1 -i 0 $DIR/$tfile || error "setstripe $tfile failed"
+	before=$after
+	echo "writing to ost1 for $((interval * 8))s"
+	local end=$((SECONDS + interval * 8))
+	while [ $SECONDS -lt $end ]; do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 conv=fsync \
+			2> /dev/null || error "dd $tfile failed"
+		sleep 1
+	done
+	after=$(pings_avoided)
+	[ $after -gt $before ] ||
+		error "no pings avoided during I/O: $before -> $after"
+
+	# the client must not have been evicted by skipping pings
+	lctl get_param -n osc.*.import | grep -q "state: EVICTED" &&
+		error "client evicted"
+	$SETSTRIPE -c 1 -i 1 $DIR/$tfile.2 || error "setstripe $tfile.2 failed"
+	dd if=/dev/zero of=$DIR/$tfile.2 bs=1M count=1 conv=fsync ||
+		error "write to ost2 failed"
+	$LFS df $MOUNT > /dev/null || error "lfs df failed"
+	rm -f $DIR/$tfile $DIR/$tfile.2
+}
+run_test 251 "pinger pings each server node once"
+
+test_252() {
+	local param="llite.*.lazy_size"
+
+	$LCTL get_param -n $param > /dev/null 2>&1 ||
+		{ skip "client does not support lazy size" && return; }
+
+	local old=$($LCTL get_param -n $param | head -n 1)
+	local avoided
+
+	$LCTL set_param $param=1
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=2 || error "dd failed"
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+
+	$LCTL set_param llite.*.stats=0
+	[ $(stat -c %s $DIR/$tfile) -eq $((2 * 1048576)) ] ||
+		error "wrong lazy size after close"
+	avoided=$($LCTL get_param -n llite.*.stats |
+		  awk '/glimpse_avoided/ { sum += $2 } END { print sum + 0 }')
+	[ $avoided -gt 0 ] || error "stat still glimpsed the OSTs"
+
+	$LFS find --lazy $DIR/$tfile -size 2M | grep -q $tfile ||
+		error "lfs find --lazy did not find $tfile"
+
+	$TRUNCATE $DIR/$tfile 4096 || error "truncate failed"
+	cancel_lru_locks osc
+	cancel_lru_locks mdc
+	[ $(stat -c %s $DIR/$tfile) -eq 4096 ] ||
+		error "wrong lazy size after truncate"
+
+	# a writer that did not write does not know the size, its close must
+	# not replace the lazy size
+	: >> $DIR/$tfile || error "cannot open $DIR/$tfile for write"
+	cancel_lru_locks mdc
+	[ $(stat -c %s $DIR/$tfile) -eq 4096 ] ||
+		error "wrong lazy size after an open for write"
+
+	$LCTL set_param $param=$old
+	rm -f $DIR/$tfile
+}
+run_test 252 "stat uses lazy size-on-MDT without glimpses"
+
+test_253() {
+	local policy=$($LCTL get_param -n ldlm.namespaces.*mdc*.lru_policy \
+		       2> /dev/null | head -n 1)
+
+	[ -z "$policy" ] && skip "client does not support LRU policies" && return
+
+	local param="ldlm.namespaces.*mdc*"
+	local nr=100
+	local hits
+	local i
+
+	$LCTL set_param -n $param.lru_policy=bad 2> /dev/null &&
+		error "bad LRU policy accepted"
+	$LCTL set_param -n $param.lru_policy=2q ||
+		error "cannot set 2q LRU policy"
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f $nr || error "createmany failed"
+	ls -l $DIR/$tdir > /dev/null
+	cancel_lru_locks mdc
+
+	hits=$($LCTL get_param -n $param.lru_ghost_hits |
+	       awk '{ sum += $1 } END { print sum }')
+	ls -l $DIR/$tdir > /dev/null
+	cancel_lru_locks mdc
+	[ $($LCTL get_param -n $param.lru_ghost_hits |
+	    awk '{ sum += $1 } END { print sum }') -gt $hits ] ||
+		error "no re-enqueue of cancelled resources seen"
+
+	# a lock used twice is hot, a scan of the LRU must demote it rather
+	# than cancel it with the locks used only once after it.  New files
+	# are used, re-enqueues of the cancelled f* would make them hot too
+	$MCREATE $DIR/$tdir/$tfile || error "mcreate failed"
+	stat $DIR/$tdir/$tfile > /dev/null || error "stat failed"
+	stat $DIR/$tdir/$tfile > /dev/null || error "stat failed"
+	createmany -m $DIR/$tdir/g $nr || error "createmany -m failed"
+	for ((i = 0; i < nr; i++)); do
+		stat $DIR/$tdir/g$i > /dev/null || error "stat g$i failed"
+	done
+
+	local demoted=$($LCTL get_param -n $param.lru_demoted |
+			awk '{ sum += $1 } END { print sum }')
+
+	$LCTL set_param -n $param.lru_size=$((nr / 2))
+	sleep 1
+	[ $($LCTL get_param -n $param.lru_demoted |
+	    awk '{ sum += $1 } END { print sum }') -gt $demoted ] ||
+		error "no hot lock demoted by the LRU scan"
+
+	# the hot lock is still cached, using it does not re-enqueue it
+	hits=$($LCTL get_param -n $param.lru_ghost_hits |
+	       awk '{ sum += $1 } END { print sum }')
+	stat $DIR/$tdir/$tfile > /dev/null || error "stat failed"
+	[ $($LCTL get_param -n $param.lru_ghost_hits |
+	    awk '{ sum += $1 } END { print sum }') -eq $hits ] ||
+		error "hot lock cancelled by the LRU scan"
+
+	lru_resize_enable mdc
+	$LCTL set_param -n $param.lru_policy=$policy
+	rm -f $DIR/$tdir/$tfile
+	unlinkmany $DIR/$tdir/g $nr
+	unlinkmany $DIR/$tdir/f $nr
+}
+run_test 253 "client lock LRU policies, ghost hits and demotion"
+
+test_254() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local param=ost.OSS.ost_io
+	local idle=$(do_facet ost1 $LCTL get_param -n \
+		     $param.threads_idle_timeout 2> /dev/null)
+
+	[ -z "$idle" ] && skip "OSS does not retire idle threads" && return
+
+	local delay=$(do_facet ost1 $LCTL get_param -n \
+		      $param.threads_start_delay)
+	local before=$(do_facet ost1 $LCTL get_param -n \
+		       $param.threads_started)
+	local started
+	local i
+
+	do_facet ost1 $LCTL set_param $param.threads_idle_timeout=1 \
+		$param.threads_start_delay=0
+
+	test_mkdir -p $DIR/$tdir
+	for i in $(seq 32); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=1M count=8 \
+			oflag=direct 2> /dev/null &
+	done
+	wait
+	started=$(do_facet ost1 $LCTL get_param -n $param.threads_started)
+	echo "ost_io threads: $before before, $started after I/O"
+
+	# threads started or woken by the I/O above wait at most 1s idle
+	for i in $(seq 30); do
+		started=$(do_facet ost1 $LCTL get_param -n \
+			  $param.threads_started)
+		[ $started -le $before ] && break
+		sleep 1
+	done
+	do_facet ost1 $LCTL set_param $param.threads_idle_timeout=$idle \
+		$param.threads_start_delay=$delay
+	[ $started -le $before ] ||
+		error "$started ost_io threads still running, $before before"
+
+	rm -rf $DIR/$tdir
+}
+run_test 254 "idle service threads are retired"
+
+test_255() {
+	local param=/sys/module/ptlrpc/parameters/rpc_stage_trace
+	local trace=$TMP/$tfile.trace
+	local samples
+
+	[ -f $param ] || { skip "no RPC stage tracing" && return; }
+
+	local old=$(cat $param)
+
+	$LCTL set_param -n osc.*.stage_stats=clear
+	# the trace file only keeps records once it has been opened
+	$LL_RPC_TRACE record > /dev/null ||
+		error "cannot read the RPC trace"
+	echo 1 > $param
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=direct ||
+		{ echo $old > $param; error "dd failed"; }
+	echo $old > $param
+
+	$LCTL get_param osc.*.stage_stats
+	samples=$($LCTL get_param -n osc.*.stage_stats |
+		  awk '/ost_write:/ { w = 1; next } /^- / { w = 0 }
+		       w && /rpc_usec/ { gsub(",", ""); n += $4 }
+		       END { print n + 0 }')
+	[ $samples -ge 4 ] ||
+		error "$samples ost_write RPCs sampled, expected at least 4"
+
+	$LL_RPC_TRACE record -o $trace || error "cannot save the RPC trace"
+	[ -s $trace ] || error "no RPC trace record saved"
+	$LL_RPC_TRACE merge $trace ||
+		error "cannot merge the RPC trace"
+
+	rm -f $trace $DIR/$tfile
+}
+run_test 255 "per-stage RPC timestamps and trace records"
+
+test_256() {
+	remote_ost && skip "remote OST" && return
+
+	local param=ost.OSS.ost_io.req_capture
+	local capture=$TMP/$tfile.capture
+	local count
+
+	$LCTL get_param -n $param > /dev/null 2>&1 ||
+		{ skip "no request capture" && return; }
+
+	# requests are only kept once the capture file has been opened
+	$LL_RPC_TRACE record -c > /dev/null ||
+		error "cannot read the captured requests"
+	$LCTL set_param $param=1
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=direct ||
+		{ $LCTL set_param $param=0; error "dd failed"; }
+	$LCTL set_param $param=0
+	$LL_RPC_TRACE record -c -o $capture ||
+		error "cannot save the captured requests"
+
+	$LL_RPC_REPLAY -n $capture | grep ost_write ||
+		error "no ost_write request captured"
+
+	test_mkdir -p $DIR/$tdir
+	$LL_RPC_REPLAY -s 0 -t 2 -d $DIR/$tdir $capture |
+		tee $TMP/$tfile.replay
+	count=$(awk '$1 == "ost_write" { print $2 }' $TMP/$tfile.replay)
+	[ "${count:-0}" -ge 4 ] ||
+		error "${count:-0} ost_write requests replayed, expected 4"
+
+	rm -rf $capture $TMP/$tfile.replay $DIR/$tfile $DIR/$tdir
+}
+run_test 256 "capture and replay of ost_io requests"
+
 cleanup_test_300() {
 	trap 0
 	umask $SAVE_UMASK
@@ -256,6 +256,10 @@ init_test_env() {
     fi
     export LL_DECODE_FILTER_FID=${LL_DECODE_FILTER_FID:-"$LUSTRE/utils/ll_decode_filter_fid"}
     [ ! -f "$LL_DECODE_FILTER_FID" ] && export LL_DECODE_FILTER_FID="ll_decode_filter_fid"
+    export LL_RPC_TRACE=${LL_RPC_TRACE:-"$LUSTRE/utils/ll_rpc_trace"}
+    [ ! -f "$LL_RPC_TRACE" ] && export LL_RPC_TRACE="ll_rpc_trace"
+    export LL_RPC_REPLAY=${LL_RPC_REPLAY:-"$LUSTRE/utils/ll_rpc_replay"}
+    [ ! -f "$LL_RPC_REPLAY" ] && export LL_RPC_REPLAY="ll_rpc_replay"
     export MKFS=${MKFS:-"$LUSTRE/utils/mkfs.lustre"}
     [ ! -f "$MKFS" ] && export MKFS="mkfs.lustre"
     export TUNEFS=${TUNEFS:-"$LUSTRE/utils/tunefs.lustre"}
@@ -74,11 +74,13 @@ static char *progname;
 
 static void usage(void)
 {
-        fprintf(stderr,
-                "\nusage: %s {mdtname} {uid}\n"
-                "Normally invoked as an upcall from Lustre, set via:\n"
-                "/proc/fs/lustre/mdt/${mdtname}/identity_upcall\n",
-                progname);
+	fprintf(stderr,
+		"\nusage: %s [-p] {mdtname} {uid} [uid ...]\n"
+		"Normally invoked as an upcall from Lustre, set via:\n"
+		"/proc/fs/lustre/mdt/${mdtname}/identity_upcall\n"
+		"\t-p: preload the identities into the MDT cache, as\n"
+		"\t    done by 'lctl identity_preload'\n",
+		progname);
 }
 
 static int compare_u32(const void *v1, const void *v2)
@@ -416,82 +418,116 @@ static void show_result(struct identity_downcall_data *data)
         printf("\n");
 }
 
-int main(int argc, char **argv)
+/* resolve @uid and write its identity to @procname */
+static int downcall_one(const char *procname, unsigned long uid,
+			struct identity_downcall_data *data, int maxgroups,
+			int preload)
 {
-        char *end;
-        struct identity_downcall_data *data = NULL;
-        char procname[1024];
-        unsigned long uid;
-        int fd, rc = -EINVAL, size, maxgroups;
-
-        progname = basename(argv[0]);
-        if (argc != 3) {
-                usage();
-                goto out;
-        }
+	int fd, rc, size;
+
+	size = offsetof(struct identity_downcall_data, idd_groups[maxgroups]);
+	memset(data, 0, size);
+	data->idd_magic = preload ? IDENTITY_PRELOAD_MAGIC :
+				    IDENTITY_DOWNCALL_MAGIC;
+	data->idd_uid = uid;
+	/* get groups for uid */
+	rc = get_groups_local(data, maxgroups);
+	if (rc)
+		goto downcall;
+
+	size = offsetof(struct identity_downcall_data,
+			idd_groups[data->idd_ngroups]);
+	/* read permission database */
+	rc = get_perms(data);
 
-        uid = strtoul(argv[2], &end, 0);
-        if (*end) {
-                errlog("%s: invalid uid '%s'\n", progname, argv[2]);
-                goto out;
-        }
+downcall:
+	if (getenv("L_GETIDENTITY_TEST")) {
+		show_result(data);
+		return 0;
+	}
 
-        maxgroups = sysconf(_SC_NGROUPS_MAX);
-        if (maxgroups > NGROUPS_MAX)
-                maxgroups = NGROUPS_MAX;
-	if (maxgroups == -1) {
-		rc = -EINVAL;
-		goto out;
+	/* nobody waits for a failed preload */
+	if (preload && data->idd_err)
+		return -1;
+
+	fd = open(procname, O_WRONLY);
+	if (fd < 0) {
+		errlog("can't open file %s: %s\n", procname, strerror(errno));
+		return -1;
 	}
 
-        size = offsetof(struct identity_downcall_data, idd_groups[maxgroups]);
-        data = malloc(size);
-        if (!data) {
-                errlog("malloc identity downcall data(%d) failed!\n", size);
-                rc = -ENOMEM;
-                goto out;
-        }
+	rc = write(fd, data, size);
+	close(fd);
+	if (rc != size) {
+		errlog("partial write ret %d: %s\n", rc, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
 
-        memset(data, 0, size);
-        data->idd_magic = IDENTITY_DOWNCALL_MAGIC;
-        data->idd_uid = uid;
-        /* get groups for uid */
-        rc = get_groups_local(data, maxgroups);
-        if (rc)
-                goto downcall;
+int main(int argc, char **argv)
+{
+	char *end;
+	struct identity_downcall_data *data = NULL;
+	char procname[1024];
+	unsigned long uid;
+	int preload = 0;
+	int rc = -EINVAL, rc2, size, maxgroups, i, c;
+
+	progname = basename(argv[0]);
+	while ((c = getopt(argc, argv, "p")) != -1) {
+		switch (c) {
+		case 'p':
+			preload = 1;
+			break;
+		default:
+			usage();
+			goto out;
+		}
+	}
 
-        size = offsetof(struct identity_downcall_data,
-                        idd_groups[data->idd_ngroups]);
-        /* read permission database */
-        rc = get_perms(data);
+	/* the MDT passes several uids when misses arrive together */
+	if (argc - optind < 2) {
+		usage();
+		goto out;
+	}
 
-downcall:
-        if (getenv("L_GETIDENTITY_TEST")) {
-                show_result(data);
-                rc = 0;
-                goto out;
-        }
+	maxgroups = sysconf(_SC_NGROUPS_MAX);
+	if (maxgroups > NGROUPS_MAX)
+		maxgroups = NGROUPS_MAX;
+	if (maxgroups == -1) {
+		rc = -EINVAL;
+		goto out;
+	}
 
-        snprintf(procname, sizeof(procname),
-                 "/proc/fs/lustre/mdt/%s/identity_info", argv[1]);
-        fd = open(procname, O_WRONLY);
-        if (fd < 0) {
-                errlog("can't open file %s: %s\n", procname, strerror(errno));
-                rc = -1;
-                goto out;
-        }
+	size = offsetof(struct identity_downcall_data, idd_groups[maxgroups]);
+	data = malloc(size);
+	if (!data) {
+		errlog("malloc identity downcall data(%d) failed!\n", size);
+		rc = -ENOMEM;
+		goto out;
+	}
 
-        rc = write(fd, data, size);
-        close(fd);
-        if (rc != size) {
-                errlog("partial write ret %d: %s\n", rc, strerror(errno));
-                rc = -1;
-        } else {
-                rc = 0;
-        }
+	snprintf(procname, sizeof(procname),
+		 "/proc/fs/lustre/mdt/%s/identity_info", argv[optind]);
+
+	rc = 0;
+	for (i = optind + 1; i < argc; i++) {
+		uid = strtoul(argv[i], &end, 0);
+		if (*end) {
+			errlog("%s: invalid uid '%s'\n", progname, argv[i]);
+			rc = -EINVAL;
+			continue;
+		}
+
+		rc2 = downcall_one(procname, uid, data, maxgroups, preload);
+		if (rc2 != 0 && rc == 0)
+			rc = rc2;
+	}
 
 out:
-        if (data != NULL)
-                free(data);
-        return rc;
+	if (data != NULL)
+		free(data);
+	return rc;
 }
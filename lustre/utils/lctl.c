@@ -128,9 +128,14 @@ command_t cmdlist[] = {
 	{"net_delay_add", jt_ptl_delay_add, 0, "Add LNet delay rule\n"
 	 "usage: net_delay_add <-s | --source NID>\n"
 	 "		       <-d | --dest NID>\n"
-	 "		       <<-r | --rate DROP_RATE> |\n"
-	 "		        <-i | --interval SECONDS>>\n"
-	 "		       <-l | --latency SECONDS>\n"
+	 "		       [<-r | --rate DELAY_RATE> |\n"
+	 "		        <-i | --interval SECONDS>]\n"
+	 "		       <<-l | --latency TIME[s|ms|us]> |\n"
+	 "		        <-b | --bandwidth BYTES[K|M|G]>>\n"
+	 "		       [<-j | --jitter TIME[s|ms|us]>]\n"
+	 "		       [<-D | --distribution uniform|normal>]\n"
+	 "		       [<-B | --burst BYTES[K|M|G]>]\n"
+	 "		       [-o | --reorder]\n"
 	 "		       [<-p | --portal> PORTAL...]\n"
 	 "		       [<-m | --message> <PUT|ACK|GET|REPLY>...]\n"},
 	{"net_delay_del", jt_ptl_delay_del, 0, "remove LNet delay rule\n"
@@ -293,6 +298,15 @@ command_t cmdlist[] = {
          "deregister an existing changelog user\n"
          "usage:\tdevice <mdtname>\n\tchangelog_deregister <id>"},
 
+	/* Identity cache commands */
+	{"=== Identity cache ===", jt_noop, 0, "MDT identity cache"},
+	{"identity_preload", jt_identity_preload, 0,
+	 "resolve the users in a group file into the MDT identity cache\n"
+	 "usage: identity_preload <mdtname> [group_file]\n"
+	 "  group_file defaults to /etc/group; members of each group and\n"
+	 "  users with it as primary group are resolved by the MDT\n"
+	 "  identity_upcall, e.g. l_getidentity -p"},
+
         /* Device configuration commands */
         {"== device setup (these are not normally used post 1.4) ==",
                 jt_noop, 0, "device config"},
@@ -367,7 +381,7 @@ command_t cmdlist[] = {
         {"test_lookup", jt_obd_test_lookup, 0,
          "lookup files on MDT by echo client\n"
          "usage: test_lookup [-d parent_basedir] <-D parent_count>"
-         "[-b child_base_id] [-n count] <-t time>\n"},
+         "[-b child_base_id] [-n count] <-t time> [--shared]\n"},
         {"test_setxattr", jt_obd_test_setxattr, 0,
          "Set EA for files/directory on MDT by echo client\n"
          "usage: test_setxattr [-d parent_baseid] <-D parent_count>"
@@ -375,7 +389,7 @@ command_t cmdlist[] = {
         {"test_md_getattr", jt_obd_test_md_getattr, 0,
          "getattr files on MDT by echo client\n"
          "usage: test_md_getattr [-d parent_basedir] <-D parent_count>"
-         "[-b child_base_id] [-n count] <-t time>\n"},
+         "[-b child_base_id] [-n count] <-t time> [--shared]\n"},
         {"getattr", jt_obd_getattr, 0,
          "get attribute for OST object <objid>\n"
          "usage: getattr <objid>"},
@@ -61,6 +61,10 @@
 #include <dirent.h>
 #include <time.h>
 #include <ctype.h>
+#include <sys/time.h>
+#if HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 #ifdef HAVE_SYS_QUOTA_H
 # include <sys/quota.h>
 #endif
@@ -112,6 +116,9 @@ static int lfs_hsm_restore(int argc, char **argv);
 static int lfs_hsm_release(int argc, char **argv);
 static int lfs_hsm_remove(int argc, char **argv);
 static int lfs_hsm_cancel(int argc, char **argv);
+static int lfs_pcc_attach(int argc, char **argv);
+static int lfs_pcc_detach(int argc, char **argv);
+static int lfs_pcc_state(int argc, char **argv);
 static int lfs_swap_layouts(int argc, char **argv);
 static int lfs_mv(int argc, char **argv);
 
@@ -145,11 +152,15 @@ static int lfs_mv(int argc, char **argv);
 
 #define MIGRATE_USAGE							\
 	SSM_CMD_COMMON("migrate  ")					\
-	"                 [--block|-b]\n"				\
-	"                 <filename>\n"					\
+	"                 [--block|-b] [--threads|-t <nthreads>]\n"	\
+	"                 [--sparse] [--verbose|-v]\n"			\
+	"                 <filename> ...\n"				\
 	SSM_HELP_COMMON							\
 	"\n"								\
 	"\tblock:        Block file access during data migration\n"	\
+	"\tnthreads:     Number of threads copying data (default 1)\n"	\
+	"\tsparse:       Do not copy the holes of sparse files\n"	\
+	"\tverbose:      Print the throughput of each file and in total\n" \
 
 /* all avaialable commands */
 command_t cmdlist[] = {
@@ -223,7 +234,8 @@ command_t cmdlist[] = {
          "     [[!] --stripe-size|-S [+-]N[kMGT]] [[!] --type|-t <filetype>]\n"
          "     [[!] --gid|-g|--group|-G <gid>|<gname>]\n"
          "     [[!] --uid|-u|--user|-U <uid>|<uname>] [[!] --pool <pool>]\n"
-	 "     [[!] --layout|-L released,raid0]\n"
+	 "     [[!] --layout|-L released,raid0] [--lazy|-l]\n"
+	 "     [--threads N]\n"
          "\t !: used before an option indicates 'NOT' requested attribute\n"
          "\t -: used before a value indicates 'AT MOST' requested value\n"
          "\t +: used before a value indicates 'AT LEAST' requested value\n"},
@@ -350,6 +362,16 @@ command_t cmdlist[] = {
 	{"hsm_cancel", lfs_hsm_cancel, 0,
 	 "Cancel requests related to specified files.\n"
 	 "usage: hsm_cancel [--filelist FILELIST] [--data DATA] <file> ..."},
+	{"pcc_attach", lfs_pcc_attach, 0,
+	 "Cache files on the local storage of this client, by archiving them "
+	 "to the archive of a copytool running here and releasing them.\n"
+	 "usage: pcc_attach --archive NUM <file> ..."},
+	{"pcc_detach", lfs_pcc_detach, 0,
+	 "Write cached files back to Lustre, by restoring them.\n"
+	 "usage: pcc_detach <file> ..."},
+	{"pcc_state", lfs_pcc_state, 0,
+	 "Display whether files are served from the cache of this client.\n"
+	 "usage: pcc_state <file> ..."},
 	{"swap_layouts", lfs_swap_layouts, 0, "Swap layouts between 2 files.\n"
 	 "usage: swap_layouts <path1> <path2>"},
 	{"migrate", lfs_setstripe, 0, "migrate file from one OST layout to "
@@ -367,34 +389,128 @@ command_t cmdlist[] = {
 	{ 0, 0, 0, NULL }
 };
 
-#define MIGRATION_BLOCKS 1
+#define MIGRATION_BLOCKS	0x1
+#define MIGRATION_SPARSE	0x2
+#define MIGRATION_VERBOSE	0x4
+
+/* Upper limit of lfs migrate copy threads */
+#define MIGRATE_THREADS_MAX	64
+/* Largest piece of a file copied by one thread at a time */
+#define MIGRATE_CHUNK_MAX	(16 * 1024 * 1024)
+/* Seconds between two progress reports of lfs migrate --verbose */
+#define MIGRATE_PROGRESS_INTERVAL	10
+
+/* A file being migrated */
+struct migrate_file {
+	/* on mc_files while chunks are left to hand out */
+	struct list_head	 mf_list;
+	char			*mf_name;
+	int			 mf_fd;
+	int			 mf_fdv;
+	int			 mf_gid;
+	bool			 mf_have_gl;
+	__u64			 mf_dv;
+	__u64			 mf_size;
+	/* copy unit, the stripe size of the file up to MIGRATE_CHUNK_MAX */
+	__u64			 mf_chunk;
+	/* next offset to hand out */
+	__u64			 mf_next;
+	__u64			 mf_copied;
+	int			 mf_inflight;
+	int			 mf_rc;
+	struct timeval		 mf_start;
+};
+
+/* State shared by the threads of one lfs migrate command */
+struct migrate_ctx {
+#if HAVE_LIBPTHREAD
+	pthread_mutex_t			 mc_lock;
+	pthread_cond_t			 mc_cond;
+#endif
+	struct list_head		 mc_files;
+	char				**mc_names;
+	int				 mc_nr_names;
+	int				 mc_next_name;
+	/* files being opened or copied, not yet swapped */
+	int				 mc_active;
+	int				 mc_migrated;
+	__u64				 mc_copied;
+	/* bytes copied in all files, complete or not, for progress */
+	__u64				 mc_progress;
+	struct timeval			 mc_start;
+	struct timeval			 mc_last_report;
+	__u64				 mc_flags;
+	struct llapi_stripe_param	*mc_param;
+	int				 mc_rc;
+};
+
+static inline void migrate_lock(struct migrate_ctx *mc)
+{
+#if HAVE_LIBPTHREAD
+	pthread_mutex_lock(&mc->mc_lock);
+#endif
+}
+
+static inline void migrate_unlock(struct migrate_ctx *mc)
+{
+#if HAVE_LIBPTHREAD
+	pthread_mutex_unlock(&mc->mc_lock);
+#endif
+}
 
-static int lfs_migrate(char *name, __u64 migration_flags,
-		       struct llapi_stripe_param *param)
+static inline void migrate_wait(struct migrate_ctx *mc)
 {
-	int			 fd, fdv;
+#if HAVE_LIBPTHREAD
+	pthread_cond_wait(&mc->mc_cond, &mc->mc_lock);
+#endif
+}
+
+static inline void migrate_wakeup(struct migrate_ctx *mc)
+{
+#if HAVE_LIBPTHREAD
+	pthread_cond_broadcast(&mc->mc_cond);
+#endif
+}
+
+static double migrate_elapsed(struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - start->tv_sec) +
+	       (now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/* Open \a name and a volatile file with the new layout to copy it into. */
+static int migrate_file_open(struct migrate_ctx *mc, char *name,
+			     struct migrate_file **mfp)
+{
+	struct migrate_file	*mf;
 	char			 volatile_file[PATH_MAX +
 						LUSTRE_VOLATILE_HDR_LEN + 4];
 	char			 parent[PATH_MAX];
 	char			*ptr;
-	int			 rc;
-	__u64			 dv1;
 	struct lov_user_md	*lum = NULL;
 	int			 lumsz;
-	int			 bufsz;
-	void			*buf = NULL;
-	int			 rsize, wsize;
-	__u64			 rpos, wpos, bufoff;
-	int			 gid;
-	int			 have_gl = 0;
 	struct stat		 st, stv;
+	int			 rc;
 
-	/* find the right size for the IO and allocate the buffer */
+	mf = calloc(1, sizeof(*mf));
+	if (mf == NULL)
+		return -ENOMEM;
+	INIT_LIST_HEAD(&mf->mf_list);
+	mf->mf_name = name;
+	mf->mf_fd = -1;
+	mf->mf_fdv = -1;
+	gettimeofday(&mf->mf_start, NULL);
+
+	/* copy one stripe at a time, so that concurrent threads mostly
+	 * work on different OSTs */
 	lumsz = lov_user_md_size(LOV_MAX_STRIPE_COUNT, LOV_USER_MAGIC_V3);
 	lum = malloc(lumsz);
 	if (lum == NULL) {
 		rc = -ENOMEM;
-		goto free;
+		goto error;
 	}
 
 	rc = llapi_file_get_stripe(name, lum);
@@ -402,27 +518,24 @@ static int lfs_migrate(char *name, __u64 migration_flags,
 	 * (eg: no stripe)
 	 * in case of a real error, a later call will failed with a better
 	 * error management */
-	if (rc < 0)
-		bufsz = 1024*1024;
+	if (rc < 0 || lum->lmm_stripe_size == 0)
+		mf->mf_chunk = 1024 * 1024;
 	else
-		bufsz = lum->lmm_stripe_size;
-	rc = posix_memalign(&buf, getpagesize(), bufsz);
-	if (rc != 0) {
-		rc = -rc;
-		goto free;
-	}
+		mf->mf_chunk = lum->lmm_stripe_size < MIGRATE_CHUNK_MAX ?
+			       lum->lmm_stripe_size : MIGRATE_CHUNK_MAX;
+	free(lum);
 
 	/* search for file directory pathname */
 	if (strlen(name) > sizeof(parent)-1) {
 		rc = -E2BIG;
-		goto free;
+		goto error;
 	}
 	strncpy(parent, name, sizeof(parent));
 	ptr = strrchr(parent, '/');
 	if (ptr == NULL) {
 		if (getcwd(parent, sizeof(parent)) == NULL) {
 			rc = -errno;
-			goto free;
+			goto error;
 		}
 	} else {
 		if (ptr == parent)
@@ -434,44 +547,45 @@ static int lfs_migrate(char *name, __u64 migration_flags,
 		      LUSTRE_VOLATILE_HDR);
 	if (rc >= sizeof(volatile_file)) {
 		rc = -E2BIG;
-		goto free;
+		goto error;
 	}
 
-	/* create, open a volatile file, use caching (ie no directio) */
+	/* create, open a volatile file, direct io to keep the migrated data
+	 * out of the client cache */
 	/* exclusive create is not needed because volatile files cannot
 	 * conflict on name by construction */
-	fdv = llapi_file_open_param(volatile_file, O_CREAT | O_WRONLY, 0644,
-				    param);
-	if (fdv < 0) {
-		rc = fdv;
+	mf->mf_fdv = llapi_file_open_param(volatile_file,
+					   O_CREAT | O_WRONLY | O_DIRECT,
+					   0644, mc->mc_param);
+	if (mf->mf_fdv < 0) {
+		rc = mf->mf_fdv;
 		fprintf(stderr, "cannot create volatile file in %s (%s)\n",
 			parent, strerror(-rc));
-		goto free;
+		goto error;
 	}
 
 	/* open file, direct io */
 	/* even if the file is only read, WR mode is nedeed to allow
 	 * layout swap on fd */
-	fd = open(name, O_RDWR | O_DIRECT);
-	if (fd == -1) {
+	mf->mf_fd = open(name, O_RDWR | O_DIRECT);
+	if (mf->mf_fd == -1) {
 		rc = -errno;
 		fprintf(stderr, "cannot open %s (%s)\n", name, strerror(-rc));
-		close(fdv);
-		goto free;
+		goto error;
 	}
 
 	/* Not-owner (root?) special case.
 	 * Need to set owner/group of volatile file like original.
 	 * This will allow to pass related check during layout_swap.
 	 */
-	rc = fstat(fd, &st);
+	rc = fstat(mf->mf_fd, &st);
 	if (rc != 0) {
 		rc = -errno;
 		fprintf(stderr, "cannot stat %s (%s)\n", name,
 			strerror(errno));
 		goto error;
 	}
-	rc = fstat(fdv, &stv);
+	rc = fstat(mf->mf_fdv, &stv);
 	if (rc != 0) {
 		rc = -errno;
 		fprintf(stderr, "cannot stat %s (%s)\n", volatile_file,
@@ -479,7 +593,7 @@ static int lfs_migrate(char *name, __u64 migration_flags,
 		goto error;
 	}
 	if (st.st_uid != stv.st_uid || st.st_gid != stv.st_gid) {
-		rc = fchown(fdv, st.st_uid, st.st_gid);
+		rc = fchown(mf->mf_fdv, st.st_uid, st.st_gid);
 		if (rc != 0) {
 			rc = -errno;
 			fprintf(stderr, "cannot chown %s (%s)\n", name,
@@ -489,75 +603,126 @@ static int lfs_migrate(char *name, __u64 migration_flags,
 	}
 
 	/* get file data version */
-	rc = llapi_get_data_version(fd, &dv1, LL_DV_RD_FLUSH);
+	rc = llapi_get_data_version(mf->mf_fd, &mf->mf_dv, LL_DV_RD_FLUSH);
 	if (rc != 0) {
 		fprintf(stderr, "cannot get dataversion on %s (%s)\n",
 			name, strerror(-rc));
 		goto error;
 	}
+	/* a concurrent size change also changes the data version, so the
+	 * swap below refuses a copy made with a stale size */
+	mf->mf_size = st.st_size;
 
 	do
-		gid = random();
-	while (gid == 0);
-	if (migration_flags & MIGRATION_BLOCKS) {
+		mf->mf_gid = random();
+	while (mf->mf_gid == 0);
+	if (mc->mc_flags & MIGRATION_BLOCKS) {
 		/* take group lock to limit concurent access
 		 * this will be no more needed when exclusive access will
 		 * be implemented (see LU-2919) */
 		/* group lock is taken after data version read because it
 		 * blocks data version call */
-		rc = llapi_group_lock(fd, gid);
+		rc = llapi_group_lock(mf->mf_fd, mf->mf_gid);
 		if (rc < 0) {
 			fprintf(stderr, "cannot get group lock on %s (%s)\n",
 				name, strerror(-rc));
 			goto error;
 		}
-		have_gl = 1;
+		mf->mf_have_gl = true;
 	}
 
-	/* copy data */
-	rpos = 0;
-	wpos = 0;
-	bufoff = 0;
-	rsize = -1;
-	do {
-		/* read new data only if we have written all
-		 * previously read data */
-		if (wpos == rpos) {
-			rsize = read(fd, buf, bufsz);
-			if (rsize < 0) {
-				rc = -errno;
-				fprintf(stderr, "read failed on %s"
-					" (%s)\n", name,
-					strerror(-rc));
-				goto error;
-			}
-			rpos += rsize;
-			bufoff = 0;
+	*mfp = mf;
+	return 0;
+
+error:
+	if (mf->mf_fdv >= 0)
+		close(mf->mf_fdv);
+	if (mf->mf_fd >= 0)
+		close(mf->mf_fd);
+	free(mf);
+	return rc;
+}
+
+/* Copy the chunk of \a mf at \a off, return the number of bytes copied. */
+static ssize_t migrate_copy_chunk(struct migrate_file *mf, __u64 off,
+				  void *buf)
+{
+	size_t	rsize = 0;
+	ssize_t	bytes;
+	ssize_t	wsize;
+	size_t	len;
+	size_t	done = 0;
+	int	rc;
+
+	/* a short read is not EOF, only a read of 0 bytes is */
+	while (rsize < mf->mf_chunk) {
+		bytes = pread(mf->mf_fd, buf + rsize, mf->mf_chunk - rsize,
+			      off + rsize);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+			rc = -errno;
+			fprintf(stderr, "read failed on %s (%s)\n",
+				mf->mf_name, strerror(-rc));
+			return rc;
 		}
-		/* eof ? */
-		if (rsize == 0)
+		if (bytes == 0)
 			break;
-		wsize = write(fdv, buf + bufoff, rpos - wpos);
+		rsize += bytes;
+	}
+	if (rsize == 0)
+		return 0;
+
+	/* O_DIRECT needs page aligned sizes, the chunk size is, and the
+	 * short read at EOF is padded and cut off by ftruncate() at the end */
+
+	len = (rsize + getpagesize() - 1) & ~((size_t)getpagesize() - 1);
+	memset(buf + rsize, 0, len - rsize);
+
+	while (done < len) {
+		wsize = pwrite(mf->mf_fdv, buf + done, len - done, off + done);
 		if (wsize < 0) {
+			if (errno == EINTR)
+				continue;
 			rc = -errno;
-			fprintf(stderr, "write failed on volatile"
-				" for %s (%s)\n", name, strerror(-rc));
-			goto error;
+			fprintf(stderr, "write failed on volatile for %s (%s)\n",
+				mf->mf_name, strerror(-rc));
+			return rc;
 		}
-		wpos += wsize;
-		bufoff += wsize;
-	} while (1);
+		done += wsize;
+	}
+
+	return rsize;
+}
+
+/* Swap the layout of a fully copied file and release it. */
+static int migrate_file_close(struct migrate_ctx *mc, struct migrate_file *mf)
+{
+	int rc = mf->mf_rc;
+	int rc2;
+
+	if (rc != 0)
+		goto error;
+
+	/* restore the exact size, trailing holes and the padding of the
+	 * last direct write included */
+	if (ftruncate(mf->mf_fdv, mf->mf_size) != 0) {
+		rc = -errno;
+		fprintf(stderr, "cannot truncate volatile for %s (%s)\n",
+			mf->mf_name, strerror(-rc));
+		goto error;
+	}
 
 	/* flush data */
-	fsync(fdv);
+	fsync(mf->mf_fdv);
 
-	if (migration_flags & MIGRATION_BLOCKS) {
+	if (mf->mf_have_gl) {
 		/* give back group lock */
-		rc = llapi_group_unlock(fd, gid);
+		rc = llapi_group_unlock(mf->mf_fd, mf->mf_gid);
 		if (rc < 0)
 			fprintf(stderr, "cannot put group lock on %s (%s)\n",
-				name, strerror(-rc));
-		have_gl = 0;
+				mf->mf_name, strerror(-rc));
+		mf->mf_have_gl = false;
 	}
 
 	/* swap layouts
@@ -566,41 +731,269 @@ static int lfs_migrate(char *name, __u64 migration_flags,
 	 * - keep file mtime
 	 * - keep file atime
 	 */
-	rc = llapi_fswap_layouts(fd, fdv, dv1, 0,
+	rc = llapi_fswap_layouts(mf->mf_fd, mf->mf_fdv, mf->mf_dv, 0,
 				 SWAP_LAYOUTS_CHECK_DV1 |
 				 SWAP_LAYOUTS_KEEP_MTIME |
 				 SWAP_LAYOUTS_KEEP_ATIME);
 	if (rc == -EAGAIN) {
 		fprintf(stderr, "%s: dataversion changed during copy, "
-			"migration aborted\n", name);
+			"migration aborted\n", mf->mf_name);
 		goto error;
 	}
-	if (rc != 0)
+	if (rc != 0) {
 		fprintf(stderr, "%s: swap layout to new file failed: %s\n",
-			name, strerror(-rc));
+			mf->mf_name, strerror(-rc));
+		goto error;
+	}
+
+	if (mc->mc_flags & MIGRATION_VERBOSE) {
+		double secs = migrate_elapsed(&mf->mf_start);
+
+		printf("%s: "LPU64" bytes in %.3f sec (%.1f MB/s)\n",
+		       mf->mf_name, mf->mf_copied, secs,
+		       secs > 0 ? mf->mf_copied / secs / 1048576 : 0.0);
+	}
 
 error:
 	/* give back group lock */
-	if ((migration_flags & MIGRATION_BLOCKS) && have_gl) {
-		int rc2;
-
+	if (mf->mf_have_gl) {
 		/* we keep the original error in rc */
-		rc2 = llapi_group_unlock(fd, gid);
+		rc2 = llapi_group_unlock(mf->mf_fd, mf->mf_gid);
 		if (rc2 < 0)
 			fprintf(stderr, "cannot put group lock on %s (%s)\n",
-				name, strerror(-rc2));
+				mf->mf_name, strerror(-rc2));
 	}
 
-	close(fdv);
-	close(fd);
-free:
-	if (lum)
-		free(lum);
-	if (buf)
-		free(buf);
+	close(mf->mf_fdv);
+	close(mf->mf_fd);
+
 	return rc;
 }
 
+/* Print the overall progress every MIGRATE_PROGRESS_INTERVAL seconds, so a
+ * large file does not stay silent until it is swapped.  Called with mc_lock
+ * held. */
+static void migrate_progress(struct migrate_ctx *mc)
+{
+	double	secs;
+
+	if (!(mc->mc_flags & MIGRATION_VERBOSE) ||
+	    migrate_elapsed(&mc->mc_last_report) < MIGRATE_PROGRESS_INTERVAL)
+		return;
+
+	gettimeofday(&mc->mc_last_report, NULL);
+	secs = migrate_elapsed(&mc->mc_start);
+	printf("migrate: %d/%d files done, "LPU64" bytes copied in %.0f sec "
+	       "(%.1f MB/s)\n", mc->mc_migrated, mc->mc_nr_names,
+	       mc->mc_progress, secs,
+	       secs > 0 ? mc->mc_progress / secs / 1048576 : 0.0);
+	fflush(stdout);
+}
+
+/* Called with mc_lock held, drops it while the file is swapped. */
+static void migrate_file_done(struct migrate_ctx *mc, struct migrate_file *mf)
+{
+	int rc;
+
+	migrate_unlock(mc);
+	rc = migrate_file_close(mc, mf);
+	if (rc != 0)
+		fprintf(stderr, "error: migrate: migrate stripe file '%s' "
+			"failed\n", mf->mf_name);
+	migrate_lock(mc);
+
+	if (rc == 0) {
+		mc->mc_migrated++;
+		mc->mc_copied += mf->mf_copied;
+	} else {
+		if (mc->mc_rc == 0)
+			mc->mc_rc = rc;
+		/* as before, do not start on more files after a failure */
+		mc->mc_next_name = mc->mc_nr_names;
+	}
+	mc->mc_active--;
+	migrate_wakeup(mc);
+	free(mf);
+}
+
+/*
+ * Copy thread.  Chunks of files already open are handed out first, so all
+ * threads work on a large file together; a thread with nothing to copy
+ * opens the next file, so small files are migrated concurrently.
+ */
+static void *migrate_thread(void *arg)
+{
+	struct migrate_ctx	*mc = arg;
+	struct migrate_file	*mf;
+	void			*buf = NULL;
+	size_t			 bufsz = 0;
+	char			*name;
+	ssize_t			 copied;
+	off_t			 data;
+	__u64			 off;
+	int			 rc;
+
+	migrate_lock(mc);
+	while (1) {
+		if (!list_empty(&mc->mc_files)) {
+			mf = list_entry(mc->mc_files.next, struct migrate_file,
+					mf_list);
+			off = mf->mf_next;
+			if ((mc->mc_flags & MIGRATION_SPARSE) &&
+			    off < mf->mf_size) {
+				/* the shared offset is unused, all I/O is
+				 * done with pread/pwrite */
+				data = lseek(mf->mf_fd, off, SEEK_DATA);
+				if (data < 0 && errno == ENXIO)
+					off = mf->mf_size;
+				else if (data > off)
+					off = data - data % mf->mf_chunk;
+			}
+
+			if (off >= mf->mf_size) {
+				list_del_init(&mf->mf_list);
+				if (mf->mf_inflight == 0)
+					migrate_file_done(mc, mf);
+				continue;
+			}
+
+			mf->mf_next = off + mf->mf_chunk;
+			mf->mf_inflight++;
+			migrate_unlock(mc);
+
+			copied = -ENOMEM;
+			if (bufsz < mf->mf_chunk) {
+				free(buf);
+				buf = NULL;
+				bufsz = 0;
+				rc = posix_memalign(&buf, getpagesize(),
+						    mf->mf_chunk);
+				if (rc == 0)
+					bufsz = mf->mf_chunk;
+			}
+			if (bufsz >= mf->mf_chunk)
+				copied = migrate_copy_chunk(mf, off, buf);
+
+			migrate_lock(mc);
+			mf->mf_inflight--;
+			if (copied < 0) {
+				if (mf->mf_rc == 0)
+					mf->mf_rc = copied;
+				list_del_init(&mf->mf_list);
+			} else {
+				mf->mf_copied += copied;
+				mc->mc_progress += copied;
+				migrate_progress(mc);
+			}
+			if (mf->mf_inflight == 0 && list_empty(&mf->mf_list))
+				migrate_file_done(mc, mf);
+			continue;
+		}
+
+		if (mc->mc_next_name < mc->mc_nr_names) {
+			name = mc->mc_names[mc->mc_next_name++];
+			mc->mc_active++;
+			migrate_unlock(mc);
+
+			mf = NULL;
+			rc = migrate_file_open(mc, name, &mf);
+			if (rc != 0)
+				fprintf(stderr, "error: migrate: migrate "
+					"stripe file '%s' failed\n", name);
+
+			migrate_lock(mc);
+			if (rc == 0) {
+				list_add_tail(&mf->mf_list, &mc->mc_files);
+			} else {
+				if (mc->mc_rc == 0)
+					mc->mc_rc = rc;
+				mc->mc_next_name = mc->mc_nr_names;
+				mc->mc_active--;
+			}
+			migrate_wakeup(mc);
+			continue;
+		}
+
+		if (mc->mc_active == 0)
+			break;
+
+		/* wait for a file to be opened or to complete */
+		migrate_wait(mc);
+	}
+	migrate_unlock(mc);
+
+	free(buf);
+	return NULL;
+}
+
+/**
+ * Migrate the \a count files in \a names to the layout in \a param.
+ *
+ * Data is copied with O_DIRECT by \a threads threads, which split large
+ * files by stripe-sized chunks and take on several small files at once.
+ * The layouts are swapped only if the data version of a file did not change
+ * during its copy.
+ *
+ * \retval 0 if all files were migrated, or the first error met.
+ */
+static int lfs_migrate(char **names, int count, __u64 migration_flags,
+		       struct llapi_stripe_param *param, int threads)
+{
+	struct migrate_ctx	 mc;
+#if HAVE_LIBPTHREAD
+	pthread_t		*tids;
+	int			 started = 0;
+	int			 rc;
+	int			 i;
+#endif
+	double			 secs;
+
+	memset(&mc, 0, sizeof(mc));
+	INIT_LIST_HEAD(&mc.mc_files);
+	mc.mc_names = names;
+	mc.mc_nr_names = count;
+	mc.mc_flags = migration_flags;
+	mc.mc_param = param;
+	gettimeofday(&mc.mc_start, NULL);
+	mc.mc_last_report = mc.mc_start;
+
+#if HAVE_LIBPTHREAD
+	pthread_mutex_init(&mc.mc_lock, NULL);
+	pthread_cond_init(&mc.mc_cond, NULL);
+
+	/* the calling thread copies too */
+	tids = calloc(threads, sizeof(*tids));
+	for (i = 1; tids != NULL && i < threads; i++, started++) {
+		rc = pthread_create(&tids[i], NULL, migrate_thread, &mc);
+		if (rc != 0) {
+			fprintf(stderr, "warning: migrate: cannot start copy "
+				"thread %d (%s)\n", i, strerror(rc));
+			break;
+		}
+	}
+#endif
+
+	migrate_thread(&mc);
+
+#if HAVE_LIBPTHREAD
+	for (i = 1; i <= started; i++)
+		pthread_join(tids[i], NULL);
+	free(tids);
+	pthread_cond_destroy(&mc.mc_cond);
+	pthread_mutex_destroy(&mc.mc_lock);
+#endif
+
+	if (migration_flags & MIGRATION_VERBOSE) {
+		secs = migrate_elapsed(&mc.mc_start);
+		printf("migrated %d file%s, "LPU64" bytes in %.3f sec "
+		       "(%.1f MB/s)\n", mc.mc_migrated,
+		       mc.mc_migrated == 1 ? "" : "s", mc.mc_copied, secs,
+		       secs > 0 ? mc.mc_copied / secs / 1048576 : 0.0);
+	}
+
+	return mc.mc_rc;
+}
+
 /**
  * Parse a string containing an OST index list into an array of integers.
  *
@@ -686,6 +1079,7 @@ static int parse_targets(__u32 *osts, int size, int offset, char *arg)
 }
 
 /* functions */
+#define MIGRATE_SPARSE_OPT 3
 static int lfs_setstripe(int argc, char **argv)
 {
 	struct llapi_stripe_param	*param;
@@ -703,6 +1097,7 @@ static int lfs_setstripe(int argc, char **argv)
 	unsigned long long		 size_units = 1;
 	bool				 migrate_mode = false;
 	__u64				 migration_flags = 0;
+	int				 migrate_threads = 1;
 	__u32				 osts[LOV_MAX_STRIPE_COUNT] = { 0 };
 	int				 nr_osts = 0;
 
@@ -737,6 +1132,10 @@ static int lfs_setstripe(int argc, char **argv)
 #endif
 		{"stripe-size",  required_argument, 0, 'S'},
 		{"stripe_size",  required_argument, 0, 'S'},
+		/* valid only in migrate mode */
+		{"sparse",	 no_argument,	    0, MIGRATE_SPARSE_OPT},
+		{"threads",	 required_argument, 0, 't'},
+		{"verbose",	 no_argument,	    0, 'v'},
 		{0, 0, 0, 0}
 	};
 
@@ -747,7 +1146,7 @@ static int lfs_setstripe(int argc, char **argv)
 	if (strcmp(argv[0], "migrate") == 0)
 		migrate_mode = true;
 
-	while ((c = getopt_long(argc, argv, "bc:di:o:p:s:S:",
+	while ((c = getopt_long(argc, argv, "bc:di:o:p:s:S:t:v",
 				long_opts, NULL)) >= 0) {
 		switch (c) {
 		case 0:
@@ -807,6 +1206,30 @@ static int lfs_setstripe(int argc, char **argv)
 		case 'p':
 			pool_name_arg = optarg;
 			break;
+		case MIGRATE_SPARSE_OPT:
+		case 't':
+		case 'v':
+			if (!migrate_mode) {
+				fprintf(stderr, "error: %s: %s is valid only "
+					"for migrate mode\n", argv[0],
+					argv[optind - 1]);
+				return CMD_HELP;
+			}
+			if (c == MIGRATE_SPARSE_OPT) {
+				migration_flags |= MIGRATION_SPARSE;
+			} else if (c == 'v') {
+				migration_flags |= MIGRATION_VERBOSE;
+			} else {
+				migrate_threads = strtol(optarg, &end, 0);
+				if (*end != '\0' || migrate_threads < 1 ||
+				    migrate_threads > MIGRATE_THREADS_MAX) {
+					fprintf(stderr, "error: %s: bad thread "
+						"count '%s' (1-%d)\n", argv[0],
+						optarg, MIGRATE_THREADS_MAX);
+					return CMD_HELP;
+				}
+			}
+			break;
 		default:
 			return CMD_HELP;
 		}
@@ -891,23 +1314,25 @@ static int lfs_setstripe(int argc, char **argv)
 		memcpy(param->lsp_osts, osts, sizeof(*osts) * nr_osts);
 	}
 
+	if (migrate_mode) {
+		/* errors are reported per file */
+		result = lfs_migrate(&argv[optind], argc - optind,
+				     migration_flags, param, migrate_threads);
+		free(param);
+		return result;
+	}
+
 	do {
-		if (!migrate_mode) {
-			result = llapi_file_open_param(fname,
-						       O_CREAT | O_WRONLY,
-						       0644, param);
-			if (result >= 0) {
-				close(result);
-				result = 0;
-			}
-		} else {
-			result = lfs_migrate(fname, migration_flags, param);
+		result = llapi_file_open_param(fname, O_CREAT | O_WRONLY,
+					       0644, param);
+		if (result >= 0) {
+			close(result);
+			result = 0;
 		}
 		if (result) {
 			fprintf(stderr,
-				"error: %s: %s stripe file '%s' failed\n",
-				argv[0], migrate_mode ? "migrate" : "create",
-				fname);
+				"error: %s: create stripe file '%s' failed\n",
+				argv[0], fname);
 			break;
 		}
 		fname = argv[++optind];
@@ -1027,10 +1452,12 @@ static int name2layout(__u32 *layout, char *name)
 }
 
 #define FIND_POOL_OPT 3
+#define FIND_THREADS_OPT 4
 static int lfs_find(int argc, char **argv)
 {
 	int c, rc;
 	int ret = 0;
+	int threads = 1;
         time_t t;
 	struct find_param param = {
 		.fp_max_depth = -1,
@@ -1047,6 +1474,7 @@ static int lfs_find(int argc, char **argv)
                 {"stripe-index", required_argument, 0, 'i'},
                 {"stripe_index", required_argument, 0, 'i'},
 		{"layout",	 required_argument, 0, 'L'},
+		{"lazy",	 no_argument,	    0, 'l'},
                 {"mdt",          required_argument, 0, 'm'},
                 {"mtime",        required_argument, 0, 'M'},
                 {"name",         required_argument, 0, 'n'},
@@ -1060,6 +1488,7 @@ static int lfs_find(int argc, char **argv)
                 {"size",         required_argument, 0, 's'},
                 {"stripe-size",  required_argument, 0, 'S'},
                 {"stripe_size",  required_argument, 0, 'S'},
+                {"threads",      required_argument, 0, FIND_THREADS_OPT},
                 {"type",         required_argument, 0, 't'},
                 {"uid",          required_argument, 0, 'u'},
                 {"user",         required_argument, 0, 'U'},
@@ -1077,7 +1506,7 @@ static int lfs_find(int argc, char **argv)
 
 	/* when getopt_long_only() hits '!' it returns 1, puts "!" in optarg */
 	while ((c = getopt_long_only(argc, argv,
-				     "-A:c:C:D:g:G:i:L:m:M:n:O:Ppqrs:S:t:u:U:v",
+				     "-A:c:C:D:g:G:i:lL:m:M:n:O:Ppqrs:S:t:u:U:v",
 				     long_opts, NULL)) >= 0) {
                 xtime = NULL;
                 xsign = NULL;
@@ -1176,6 +1605,9 @@ static int lfs_find(int argc, char **argv)
 			param.fp_exclude_gid = !!neg_opt;
 			param.fp_check_gid = 1;
                         break;
+		case 'l':
+			param.fp_lazy = 1;
+			break;
 		case 'L':
 			ret = name2layout(&param.fp_layout, optarg);
 			if (ret)
@@ -1338,6 +1770,15 @@ err_free:
 			param.fp_check_stripe_size = 1;
 			param.fp_exclude_stripe_size = !!neg_opt;
 			break;
+		case FIND_THREADS_OPT:
+			threads = strtol(optarg, &endptr, 0);
+			if (*endptr != '\0' || threads < 1) {
+				fprintf(stderr, "error: bad thread count '%s'\n",
+					optarg);
+				ret = CMD_HELP;
+				goto err;
+			}
+			break;
 		case 't':
 			param.fp_exclude_type = !!neg_opt;
 			switch (optarg[0]) {
@@ -1386,7 +1827,7 @@ err_free:
         }
 
 	do {
-		rc = llapi_find(argv[pathstart], &param);
+		rc = llapi_find_parallel(argv[pathstart], &param, threads);
 		if (rc != 0 && ret == 0)
 			ret = rc;
 	} while (++pathstart < pathend);
@@ -4050,6 +4491,98 @@ static int lfs_hsm_cancel(int argc, char **argv)
 	return lfs_hsm_request(argc, argv, HUA_CANCEL);
 }
 
+static int lfs_pcc_attach(int argc, char **argv)
+{
+	struct option	 long_opts[] = {
+		{"archive", 1, 0, 'a'},
+		{0, 0, 0, 0}
+	};
+	unsigned long	 archive_id = 0;
+	char		*end;
+	int		 rc = 0;
+	int		 rc2;
+	int		 c;
+
+	while ((c = getopt_long(argc, argv, "a:", long_opts, NULL)) != -1) {
+		switch (c) {
+		case 'a':
+			archive_id = strtoul(optarg, &end, 0);
+			if (*end != '\0' || archive_id == 0) {
+				fprintf(stderr, "%s: invalid archive number "
+					"'%s'\n", argv[0], optarg);
+				return CMD_HELP;
+			}
+			break;
+		default:
+			return CMD_HELP;
+		}
+	}
+	if (archive_id == 0 || optind >= argc)
+		return CMD_HELP;
+
+	for (; optind < argc; optind++) {
+		rc2 = llapi_pcc_attach(argv[optind], archive_id);
+		if (rc2 != 0) {
+			fprintf(stderr, "%s: cannot attach '%s': %s\n",
+				argv[0], argv[optind], strerror(-rc2));
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
+static int lfs_pcc_detach(int argc, char **argv)
+{
+	int rc = 0;
+	int rc2;
+	int i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc2 = llapi_pcc_detach(argv[i]);
+		if (rc2 != 0) {
+			fprintf(stderr, "%s: cannot detach '%s': %s\n",
+				argv[0], argv[i], strerror(-rc2));
+			if (rc == 0)
+				rc = rc2;
+		}
+	}
+
+	return rc;
+}
+
+static int lfs_pcc_state(int argc, char **argv)
+{
+	struct lu_pcc_state	state;
+	int			rc;
+	int			i;
+
+	if (argc < 2)
+		return CMD_HELP;
+
+	for (i = 1; i < argc; i++) {
+		rc = llapi_pcc_state_get(argv[i], &state);
+		if (rc != 0) {
+			fprintf(stderr, "%s: cannot get cache state of '%s': "
+				"%s\n", argv[0], argv[i], strerror(-rc));
+			return rc;
+		}
+
+		if (state.pccs_flags & PCC_STATE_ATTACHED)
+			printf("%s: attached, archive_id:%u, path:%s\n",
+			       argv[i], state.pccs_archive_id,
+			       state.pccs_path);
+		else
+			printf("%s: not attached\n", argv[i]);
+	}
+
+	return 0;
+}
+
 static int lfs_swap_layouts(int argc, char **argv)
 {
 	if (argc != 3)
@@ -1535,12 +1535,9 @@ err:
         return rc;
 }
 
-typedef int (semantic_func_t)(char *path, DIR *parent, DIR **d,
-			      void *data, struct dirent64 *de);
-
 #define OBD_NOT_FOUND           (-1)
 
-static int common_param_init(struct find_param *param, char *path)
+int common_param_init(struct find_param *param, char *path)
 {
 	int lum_size = get_mds_md_size(path);
 
@@ -1575,7 +1572,7 @@ static int common_param_init(struct find_param *param, char *path)
 	return 0;
 }
 
-static void find_param_fini(struct find_param *param)
+void find_param_fini(struct find_param *param)
 {
 	if (param->fp_obd_indexes)
 		free(param->fp_obd_indexes);
@@ -1587,8 +1584,8 @@ static void find_param_fini(struct find_param *param)
 		free(param->fp_lmv_md);
 }
 
-static int cb_common_fini(char *path, DIR *parent, DIR **dirp, void *data,
-			  struct dirent64 *de)
+int cb_common_fini(char *path, DIR *parent, DIR **dirp, void *data,
+		   struct dirent64 *de)
 {
 	struct find_param *param = data;
 	param->fp_depth--;
@@ -1625,8 +1622,16 @@ static int cb_get_dirstripe(char *path, DIR *d, struct find_param *param)
 	return ioctl(dirfd(d), LL_IOC_LMV_GETSTRIPE, param->fp_lmv_md);
 }
 
-static int get_lmd_info(char *path, DIR *parent, DIR *dir,
-                 struct lov_user_mds_data *lmd, int lumlen)
+/**
+ * Get the stat and layout of \a path from the MDT, without glimpsing OSTs.
+ *
+ * If \a lazy_flags is not NULL the MDT may also return the lazy size of a
+ * regular file in lmd_st, and LMD_FL_* are stored in \a lazy_flags to tell
+ * which fields of lmd_st are lazy.  Clients that do not know the V2 ioctls
+ * fall back to the old ones, with \a lazy_flags set to 0.
+ */
+int get_lmd_info(char *path, DIR *parent, DIR *dir,
+		 struct lov_user_mds_data *lmd, int lumlen, int *lazy_flags)
 {
         lstat_t *st = &lmd->lmd_st;
         int ret = 0;
@@ -1634,8 +1639,21 @@ static int get_lmd_info(char *path, DIR *parent, DIR *dir,
         if (parent == NULL && dir == NULL)
                 return -EINVAL;
 
+	if (lazy_flags != NULL)
+		*lazy_flags = 0;
+
         if (dir) {
-                ret = ioctl(dirfd(dir), LL_IOC_MDC_GETINFO, (void *)lmd);
+		if (lazy_flags != NULL) {
+			ret = ioctl(dirfd(dir), LL_IOC_MDC_GETINFO_V2,
+				    (void *)lmd);
+			if (ret >= 0) {
+				*lazy_flags = ret;
+				ret = 0;
+			}
+		}
+		if (lazy_flags == NULL || (ret < 0 && errno == ENOTTY))
+			ret = ioctl(dirfd(dir), LL_IOC_MDC_GETINFO,
+				    (void *)lmd);
         } else if (parent) {
 		char *fname = strrchr(path, '/');
 
@@ -1648,7 +1666,17 @@ static int get_lmd_info(char *path, DIR *parent, DIR *dir,
 		fname = (fname == NULL ? path : fname + 1);
 		/* retrieve needed file info */
 		strlcpy((char *)lmd, fname, lumlen);
-		ret = ioctl(dirfd(parent), IOC_MDC_GETFILEINFO, (void *)lmd);
+		if (lazy_flags != NULL) {
+			ret = ioctl(dirfd(parent), IOC_MDC_GETFILEINFO_V2,
+				    (void *)lmd);
+			if (ret >= 0) {
+				*lazy_flags = ret;
+				ret = 0;
+			}
+		}
+		if (lazy_flags == NULL || (ret < 0 && errno == ENOTTY))
+			ret = ioctl(dirfd(parent), IOC_MDC_GETFILEINFO,
+				    (void *)lmd);
         }
 
         if (ret) {
@@ -1741,7 +1769,7 @@ static int llapi_semantic_traverse(char *path, int size, DIR *parent,
 			lstat_t *st = &param->fp_lmd->lmd_st;
 
 			rc = get_lmd_info(path, d, NULL, param->fp_lmd,
-					   param->fp_lum_size);
+					  param->fp_lum_size, NULL);
 			if (rc == 0)
 				dent->d_type = IFTODT(st->st_mode);
 			else if (ret == 0)
@@ -2940,8 +2968,8 @@ static int print_failed_tgt(struct find_param *param, char *path, int type)
 	return ret;
 }
 
-static int cb_find_init(char *path, DIR *parent, DIR **dirp,
-			void *data, struct dirent64 *de)
+int cb_find_init(char *path, DIR *parent, DIR **dirp,
+		 void *data, struct dirent64 *de)
 {
         struct find_param *param = (struct find_param *)data;
 	DIR *dir = dirp == NULL ? NULL : *dirp;
@@ -2995,7 +3023,8 @@ static int cb_find_init(char *path, DIR *parent, DIR **dirp,
 
 	if (decision == 0) {
 		ret = get_lmd_info(path, parent, dir, param->fp_lmd,
-				   param->fp_lum_size);
+				   param->fp_lum_size,
+				   param->fp_lazy ? &param->fp_lmd_flags : NULL);
 		if (ret == 0 && param->fp_mdt_uuid != NULL) {
 			if (dir != NULL) {
 				ret = llapi_file_fget_mdtidx(dirfd(dir),
@@ -3189,7 +3218,8 @@ obd_matches:
            'glimpse-size-ioctl'. */
 
 	if (param->fp_check_size && S_ISREG(st->st_mode) &&
-	    param->fp_lmd->lmd_lmm.lmm_stripe_count)
+	    param->fp_lmd->lmd_lmm.lmm_stripe_count &&
+	    !(param->fp_lazy && param->fp_lmd_flags & LMD_FL_LAZY_SIZE))
                 decision = 0;
 
 	if (param->fp_check_size && S_ISDIR(st->st_mode))
@@ -3240,11 +3270,10 @@ obd_matches:
 					  param->fp_size_units, 0);
 
         if (decision != -1) {
-                llapi_printf(LLAPI_MSG_NORMAL, "%s", path);
-		if (param->fp_zero_end)
-                        llapi_printf(LLAPI_MSG_NORMAL, "%c", '\0');
-                else
-                        llapi_printf(LLAPI_MSG_NORMAL, "\n");
+		/* One call per name, so that names printed by concurrent
+		 * llapi_find_parallel() threads are never interleaved. */
+		llapi_printf(LLAPI_MSG_NORMAL, "%s%c", path,
+			     param->fp_zero_end ? '\0' : '\n');
         }
 
 decided:
@@ -3768,7 +3797,8 @@ static int cb_quotachown(char *path, DIR *parent, DIR **dirp, void *data,
 
         LASSERT(parent != NULL || d != NULL);
 
-	rc = get_lmd_info(path, parent, d, param->fp_lmd, param->fp_lum_size);
+	rc = get_lmd_info(path, parent, d, param->fp_lmd, param->fp_lum_size,
+			  NULL);
         if (rc) {
                 if (rc == -ENODATA) {
 			if (!param->fp_obd_uuid && !param->fp_quiet)
@@ -4205,24 +4235,31 @@ int root_ioctl(const char *mdtname, int opc, void *data, int *mdtidxp,
 /****** Changelog API ********/
 
 static int changelog_ioctl(const char *mdtname, int opc, int id,
-                           long long recno, int flags)
+			   long long recno, int flags, __u32 mask)
 {
-        struct ioc_changelog data;
-        int *idx;
+	struct ioc_changelog data;
+	int *idx;
 
-        data.icc_id = id;
-        data.icc_recno = recno;
-        data.icc_flags = flags;
-        idx = (int *)(&data.icc_mdtindex);
+	memset(&data, 0, sizeof(data));
+	data.icc_id = id;
+	data.icc_recno = recno;
+	data.icc_flags = flags;
+	data.icc_mask = mask;
+	idx = (int *)(&data.icc_mdtindex);
 
-        return root_ioctl(mdtname, opc, &data, idx, WANT_ERROR);
+	return root_ioctl(mdtname, opc, &data, idx, WANT_ERROR);
 }
 
 #define CHANGELOG_PRIV_MAGIC 0xCA8E1080
 struct changelog_private {
 	int				magic;
 	enum changelog_send_flag	flags;
+	__u32				mask;
 	lustre_kernelcomm		kuc;
+	/* CL_RECORDS message being consumed, CHANGELOG_FLAG_BATCH only */
+	struct kuc_hdr			*batch;
+	char				*batch_next;
+	char				*batch_end;
 };
 
 /** Start reading from a changelog
@@ -4234,6 +4271,23 @@ struct changelog_private {
  */
 int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 			  const char *device, long long startrec)
+{
+	return llapi_changelog_start_mask(priv, flags & ~CHANGELOG_FLAG_MASK,
+					  device, startrec, 0);
+}
+
+/** Start reading some record types from a changelog
+ * @param priv Opaque private control structure
+ * @param flags Start flags (e.g. CHANGELOG_FLAG_BATCH)
+ * @param device Report changes recorded on this MDT
+ * @param startrec Report changes beginning with this record number
+ * @param mask Report only record types set in this mask (1 << CL_*), the
+ * other records are dropped by the kernel before reaching the pipe.
+ * 0 reports all types.
+ */
+int llapi_changelog_start_mask(void **priv, enum changelog_send_flag flags,
+			       const char *device, long long startrec,
+			       __u32 mask)
 {
 	struct changelog_private	*cp;
 	static bool			 warned;
@@ -4244,8 +4298,20 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 	if (cp == NULL)
 		return -ENOMEM;
 
+	if (mask != 0)
+		flags |= CHANGELOG_FLAG_MASK;
+
 	cp->magic = CHANGELOG_PRIV_MAGIC;
 	cp->flags = flags;
+	cp->mask = mask;
+
+	if (flags & CHANGELOG_FLAG_BATCH) {
+		cp->batch = malloc(KUC_CHANGELOG_BATCH_MAXSIZE);
+		if (cp->batch == NULL) {
+			rc = -ENOMEM;
+			goto out_free;
+		}
+	}
 
 	/* Set up the receiver */
 	rc = libcfs_ukuc_start(&cp->kuc, 0 /* no group registration */, 0);
@@ -4264,7 +4330,7 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 
 	/* Tell the kernel to start sending */
 	rc = changelog_ioctl(device, OBD_IOC_CHANGELOG_SEND, cp->kuc.lk_wfd,
-			     startrec, flags);
+			     startrec, flags, mask);
 	/* Only the kernel reference keeps the write side open */
 	close(cp->kuc.lk_wfd);
 	cp->kuc.lk_wfd = LK_NOFD;
@@ -4277,6 +4343,7 @@ int llapi_changelog_start(void **priv, enum changelog_send_flag flags,
 	return 0;
 
 out_free:
+	free(cp->batch);
 	free(cp);
 	return rc;
 }
@@ -4290,6 +4357,7 @@ int llapi_changelog_fini(void **priv)
                 return -EINVAL;
 
         libcfs_ukuc_stop(&cp->kuc);
+	free(cp->batch);
         free(cp);
         *priv = NULL;
         return 0;
@@ -4323,10 +4391,26 @@ int llapi_changelog_recv(void *priv, struct changelog_rec **rech)
 		return -EINVAL;
 	if (rech == NULL)
 		return -EINVAL;
-	kuch = malloc(KUC_CHANGELOG_MSG_MAXSIZE);
+	/* the record name is not NUL-terminated in the message */
+	kuch = calloc(1, KUC_CHANGELOG_MSG_MAXSIZE);
 	if (kuch == NULL)
 		return -ENOMEM;
 
+	if (cp->flags & CHANGELOG_FLAG_BATCH) {
+		struct changelog_rec *rec;
+
+		rc = llapi_changelog_recv_batch(priv, &rec, 1);
+		if (rc <= 0) {
+			/* 0 records is EOF */
+			rc = rc == 0 ? 1 : rc;
+			goto out_free;
+		}
+
+		*rech = (struct changelog_rec *)(kuch + 1);
+		memcpy(*rech, rec, changelog_rec_size(rec) + rec->cr_namelen);
+		return 0;
+	}
+
 	if (cp->flags & CHANGELOG_FLAG_JOBID)
 		rec_fmt |= CLF_JOBID;
 
@@ -4370,6 +4454,109 @@ out_free:
         return rc;
 }
 
+/* Read the next CL_RECORDS message of the changelog into cp->batch
+ * \retval 0 on success, 1 at EOF, negative errno on failure */
+static int changelog_batch_get(struct changelog_private *cp)
+{
+	struct kuc_hdr			*kuch = cp->batch;
+	struct changelog_rec		*rec;
+	enum changelog_rec_flags	 rec_fmt = DEFAULT_RECORD_FMT;
+	int				 rc;
+
+repeat:
+	rc = libcfs_ukuc_msg_get(&cp->kuc, (char *)kuch,
+				 KUC_CHANGELOG_BATCH_MAXSIZE,
+				 KUC_TRANSPORT_CHANGELOG);
+	if (rc < 0)
+		return rc;
+
+	if (kuch->kuc_transport != KUC_TRANSPORT_CHANGELOG ||
+	    (kuch->kuc_msgtype != CL_RECORDS &&
+	     kuch->kuc_msgtype != CL_RECORD &&
+	     kuch->kuc_msgtype != CL_EOF)) {
+		llapi_err_noerrno(LLAPI_MSG_ERROR,
+				  "Unknown changelog message type %d:%d\n",
+				  kuch->kuc_transport, kuch->kuc_msgtype);
+		return -EPROTO;
+	}
+
+	if (kuch->kuc_msgtype == CL_EOF) {
+		if (cp->flags & CHANGELOG_FLAG_FOLLOW)
+			goto repeat;
+		return 1;
+	}
+
+	cp->batch_next = (char *)(kuch + 1);
+	cp->batch_end = (char *)kuch + kuch->kuc_msglen;
+	if (kuch->kuc_msgtype == CL_RECORDS)
+		return 0;
+
+	/* A kernel without CHANGELOG_FLAG_BATCH support sends one record
+	 * per message in the on-disk format: remap it here, there is room
+	 * in the batch buffer for it to grow. */
+	if (cp->flags & CHANGELOG_FLAG_JOBID)
+		rec_fmt |= CLF_JOBID;
+
+	rec = (struct changelog_rec *)cp->batch_next;
+	changelog_remap_rec(rec, rec_fmt);
+	memset(changelog_rec_name(rec) + rec->cr_namelen, 0,
+	       changelog_rec_batch_size(rec) - changelog_rec_size(rec) -
+	       rec->cr_namelen);
+	cp->batch_end = cp->batch_next + changelog_rec_batch_size(rec);
+
+	return 0;
+}
+
+/** Read the next changelog records
+ * The changelog must have been started with CHANGELOG_FLAG_BATCH. Records
+ * are handed out in place from the message received from the kernel, so
+ * they are neither allocated nor freed per record, and their name is
+ * NUL-terminated. They stay valid until the next call to
+ * llapi_changelog_recv_batch(), llapi_changelog_recv() or
+ * llapi_changelog_fini(). To release them on the server, clear the
+ * changelog up to the index of the last record of the batch.
+ *
+ * @param priv Opaque private control structure
+ * @param recs Array filled with pointers to the records read
+ * @param count Size of \a recs
+ * @return >0 number of records stored in \a recs
+ *         0 EOF
+ *         <0 error code
+ */
+int llapi_changelog_recv_batch(void *priv, struct changelog_rec **recs,
+			       int count)
+{
+	struct changelog_private	*cp = (struct changelog_private *)priv;
+	struct changelog_rec		*rec;
+	int				 nr = 0;
+	int				 rc;
+
+	if (!cp || (cp->magic != CHANGELOG_PRIV_MAGIC))
+		return -EINVAL;
+	if (!(cp->flags & CHANGELOG_FLAG_BATCH) || recs == NULL || count <= 0)
+		return -EINVAL;
+
+	while (nr == 0) {
+		if (cp->batch_next >= cp->batch_end) {
+			rc = changelog_batch_get(cp);
+			if (rc != 0)
+				return rc < 0 ? rc : 0;
+		}
+
+		while (nr < count && cp->batch_next < cp->batch_end) {
+			rec = (struct changelog_rec *)cp->batch_next;
+			cp->batch_next += changelog_rec_batch_size(rec);
+			/* an older kernel may have ignored the mask */
+			if (cp->flags & CHANGELOG_FLAG_MASK &&
+			    !(cp->mask & (1 << rec->cr_type)))
+				continue;
+			recs[nr++] = rec;
+		}
+	}
+
+	return nr;
+}
+
 /** Release the changelog record when done with it. */
 int llapi_changelog_free(struct changelog_rec **rech)
 {
@@ -4406,7 +4593,8 @@ int llapi_changelog_clear(const char *mdtname, const char *idstr,
                 return -EINVAL;
         }
 
-        return changelog_ioctl(mdtname, OBD_IOC_CHANGELOG_CLEAR, id, endrec, 0);
+	return changelog_ioctl(mdtname, OBD_IOC_CHANGELOG_CLEAR, id, endrec, 0,
+			       0);
 }
 
 int llapi_fid2path(const char *device, const char *fidstr, char *buf,
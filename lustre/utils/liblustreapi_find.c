@@ -0,0 +1,495 @@
+/*
+ * LGPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Lesser General Public License
+ * (LGPL) version 2.1 or (at your discretion) any later version.
+ * (LGPL) version 2.1 accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/lgpl-2.1.html
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * LGPL HEADER END
+ */
+/*
+ * lustre/utils/liblustreapi_find.c
+ *
+ * Multi-threaded directory tree walk for llapi_find_parallel().
+ *
+ * Every thread owns a queue of directories that are still to be read.  A
+ * thread appends the subdirectories it finds to the tail of its own queue
+ * and takes its next directory from that same tail, so it keeps descending
+ * into the part of the tree it has just brought into the client cache.  A
+ * thread whose queue is empty steals from the head of another thread's
+ * queue, where the oldest and usually largest pending subtrees are.
+ *
+ * Entries are matched by the same cb_find_init() as for llapi_find(), each
+ * thread working on its own copy of struct find_param, so only the order in
+ * which names are printed differs from the serial walk.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
+
+#include <libcfs/libcfs.h>
+#include <lustre/lustreapi.h>
+#include "lustreapi_internal.h"
+
+#if HAVE_LIBPTHREAD
+
+/* Upper limit of threads walking the tree */
+#define FIND_THREADS_MAX	64
+/* Queued directories that may keep an open descriptor at the same time */
+#define FIND_QUEUED_FDS_MAX	256
+
+struct find_item {
+	struct list_head	 fi_list;
+	char			*fi_path;
+	/* opened relative to the parent directory, or -1 */
+	int			 fi_fd;
+	unsigned int		 fi_depth;
+};
+
+struct find_ctx;
+
+struct find_worker {
+	struct find_ctx		*fw_ctx;
+	pthread_t		 fw_thread;
+	pthread_mutex_t		 fw_lock;
+	/* directories to read; the owner works at the tail, thieves take
+	 * from the head */
+	struct list_head	 fw_queue;
+	struct find_param	 fw_param;
+	char			 fw_path[PATH_MAX + 1];
+	int			 fw_index;
+	int			 fw_rc;
+};
+
+struct find_ctx {
+	pthread_mutex_t		 fc_lock;
+	pthread_cond_t		 fc_cond;
+	/* directories queued or being read, the walk is over at zero */
+	unsigned long		 fc_pending;
+	/* bumped by every push, so that a thread going idle can tell that it
+	 * raced with one */
+	unsigned long		 fc_pushes;
+	int			 fc_queued_fds;
+	int			 fc_nthreads;
+	struct find_worker	*fc_workers;
+};
+
+static void find_item_free(struct find_item *fi)
+{
+	if (fi->fi_fd >= 0)
+		close(fi->fi_fd);
+	free(fi->fi_path);
+	free(fi);
+}
+
+/* Queue subdirectory \a name of the directory open on \a dirfd. */
+static int find_push(struct find_worker *fw, const char *path, int dirfd,
+		     const char *name, unsigned int depth)
+{
+	struct find_ctx		*fc = fw->fw_ctx;
+	struct find_item	*fi;
+	bool			 open_fd;
+
+	fi = calloc(1, sizeof(*fi));
+	if (fi == NULL)
+		return -ENOMEM;
+
+	fi->fi_path = strdup(path);
+	if (fi->fi_path == NULL) {
+		free(fi);
+		return -ENOMEM;
+	}
+	fi->fi_depth = depth;
+	fi->fi_fd = -1;
+
+	/* Opening the subdirectory relative to its parent, while the parent
+	 * is still open, saves a full path lookup when it is read.  This is
+	 * bounded so that a wide tree cannot use up the descriptor table. */
+	pthread_mutex_lock(&fc->fc_lock);
+	open_fd = fc->fc_queued_fds < FIND_QUEUED_FDS_MAX;
+	if (open_fd)
+		fc->fc_queued_fds++;
+	pthread_mutex_unlock(&fc->fc_lock);
+
+	if (open_fd) {
+		fi->fi_fd = openat(dirfd, name,
+				   O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+		if (fi->fi_fd < 0) {
+			pthread_mutex_lock(&fc->fc_lock);
+			fc->fc_queued_fds--;
+			pthread_mutex_unlock(&fc->fc_lock);
+		}
+	}
+
+	pthread_mutex_lock(&fw->fw_lock);
+	list_add_tail(&fi->fi_list, &fw->fw_queue);
+	pthread_mutex_unlock(&fw->fw_lock);
+
+	/* The directory being read is still pending, so fc_pending cannot
+	 * drop to zero before this item is accounted. */
+	pthread_mutex_lock(&fc->fc_lock);
+	fc->fc_pending++;
+	fc->fc_pushes++;
+	pthread_cond_signal(&fc->fc_cond);
+	pthread_mutex_unlock(&fc->fc_lock);
+
+	return 0;
+}
+
+static struct find_item *find_pop(struct find_worker *fw)
+{
+	struct find_item *fi = NULL;
+
+	pthread_mutex_lock(&fw->fw_lock);
+	if (!list_empty(&fw->fw_queue)) {
+		fi = list_entry(fw->fw_queue.prev, struct find_item, fi_list);
+		list_del(&fi->fi_list);
+	}
+	pthread_mutex_unlock(&fw->fw_lock);
+
+	return fi;
+}
+
+static struct find_item *find_steal(struct find_worker *fw)
+{
+	struct find_ctx		*fc = fw->fw_ctx;
+	struct find_worker	*victim;
+	struct find_item	*fi = NULL;
+	int			 i;
+
+	for (i = 1; i < fc->fc_nthreads && fi == NULL; i++) {
+		victim = &fc->fc_workers[(fw->fw_index + i) % fc->fc_nthreads];
+
+		pthread_mutex_lock(&victim->fw_lock);
+		if (!list_empty(&victim->fw_queue)) {
+			fi = list_entry(victim->fw_queue.next,
+					struct find_item, fi_list);
+			list_del(&fi->fi_list);
+		}
+		pthread_mutex_unlock(&victim->fw_lock);
+	}
+
+	return fi;
+}
+
+/* Match the directory \a fi and its entries, queue its subdirectories. */
+static int find_dir(struct find_worker *fw, struct find_item *fi)
+{
+	struct find_ctx		*fc = fw->fw_ctx;
+	struct find_param	*param = &fw->fw_param;
+	char			*path = fw->fw_path;
+	struct dirent64		*dent;
+	struct dirent64		 de;
+	struct dirent64		*dep = NULL;
+	unsigned int		 depth;
+	DIR			*d = NULL;
+	int			 len;
+	int			 ret = 0;
+	int			 rc;
+
+	len = strlen(fi->fi_path);
+	memcpy(path, fi->fi_path, len + 1);
+
+	if (fi->fi_fd >= 0) {
+		d = fdopendir(fi->fi_fd);
+		if (d != NULL)
+			fi->fi_fd = -1;
+
+		pthread_mutex_lock(&fc->fc_lock);
+		fc->fc_queued_fds--;
+		pthread_mutex_unlock(&fc->fc_lock);
+	}
+	if (d == NULL)
+		d = opendir(path);
+	if (d == NULL) {
+		ret = -errno;
+		llapi_error(LLAPI_MSG_ERROR, ret, "%s: Failed to open '%s'",
+			    __func__, path);
+		return ret;
+	}
+
+	/* The starting directory is matched without a dirent, as in the
+	 * serial walk. */
+	if (fi->fi_depth > 0) {
+		char *name = strrchr(path, '/');
+
+		memset(&de, 0, sizeof(de));
+		de.d_type = DT_DIR;
+		strlcpy(de.d_name, name == NULL ? path : name + 1,
+			sizeof(de.d_name));
+		dep = &de;
+	}
+
+	param->fp_depth = fi->fi_depth;
+	ret = cb_find_init(path, NULL, &d, param, dep);
+	if (ret != 0) {
+		/* 1 means do not descend */
+		if (ret > 0)
+			ret = 0;
+		goto out;
+	}
+	depth = param->fp_depth;
+
+	while ((dent = readdir64(d)) != NULL) {
+		if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, ".."))
+			continue;
+
+		/* Don't traverse .lustre directory */
+		if (!strcmp(dent->d_name, dot_lustre_name))
+			continue;
+
+		path[len] = 0;
+		if (len + strlen(dent->d_name) + 2 > sizeof(fw->fw_path)) {
+			llapi_err_noerrno(LLAPI_MSG_ERROR,
+					  "error: %s: string buffer is too small",
+					  __func__);
+			break;
+		}
+		strcat(path, "/");
+		strcat(path, dent->d_name);
+
+		if (dent->d_type == DT_UNKNOWN) {
+			lstat_t *st = &param->fp_lmd->lmd_st;
+
+			rc = get_lmd_info(path, d, NULL, param->fp_lmd,
+					  param->fp_lum_size, NULL);
+			if (rc == 0)
+				dent->d_type = IFTODT(st->st_mode);
+			else if (ret == 0)
+				ret = rc;
+
+			if (rc == -ENOENT)
+				continue;
+		}
+
+		switch (dent->d_type) {
+		case DT_UNKNOWN:
+			llapi_err_noerrno(LLAPI_MSG_ERROR,
+					  "error: %s: '%s' is UNKNOWN type %d",
+					  __func__, dent->d_name, dent->d_type);
+			break;
+		case DT_DIR:
+			rc = find_push(fw, path, dirfd(d), dent->d_name, depth);
+			if (rc != 0 && ret == 0)
+				ret = rc;
+			break;
+		default:
+			param->fp_depth = depth;
+			rc = cb_find_init(path, d, NULL, param, dent);
+			if (rc < 0 && ret == 0)
+				ret = rc;
+			if (rc == 0)
+				cb_common_fini(path, d, NULL, param, dent);
+		}
+	}
+	path[len] = 0;
+out:
+	closedir(d);
+	return ret;
+}
+
+static void *find_worker_main(void *arg)
+{
+	struct find_worker	*fw = arg;
+	struct find_ctx		*fc = fw->fw_ctx;
+	struct find_item	*fi;
+	unsigned long		 pushes;
+	int			 rc;
+
+	while (1) {
+		pthread_mutex_lock(&fc->fc_lock);
+		pushes = fc->fc_pushes;
+		pthread_mutex_unlock(&fc->fc_lock);
+
+		fi = find_pop(fw);
+		if (fi == NULL)
+			fi = find_steal(fw);
+
+		if (fi != NULL) {
+			rc = find_dir(fw, fi);
+			if (rc < 0 && fw->fw_rc == 0)
+				fw->fw_rc = rc;
+			find_item_free(fi);
+
+			pthread_mutex_lock(&fc->fc_lock);
+			if (--fc->fc_pending == 0)
+				pthread_cond_broadcast(&fc->fc_cond);
+			pthread_mutex_unlock(&fc->fc_lock);
+			continue;
+		}
+
+		pthread_mutex_lock(&fc->fc_lock);
+		if (fc->fc_pending == 0) {
+			pthread_mutex_unlock(&fc->fc_lock);
+			break;
+		}
+		if (fc->fc_pushes == pushes)
+			pthread_cond_wait(&fc->fc_cond, &fc->fc_lock);
+		pthread_mutex_unlock(&fc->fc_lock);
+	}
+
+	return NULL;
+}
+
+/**
+ * Walk the tree under \a path with \a threads threads, printing the entries
+ * that match \a param as llapi_find() does, in no particular order.
+ *
+ * \param path		file or directory to start from
+ * \param param		search criteria, as for llapi_find()
+ * \param threads	number of threads, llapi_find() is used if 1 or less
+ *
+ * \retval 0 on success.
+ * \retval -errno of the first error met, the walk goes on after errors.
+ */
+int llapi_find_parallel(char *path, struct find_param *param, int threads)
+{
+	struct find_ctx		 fc;
+	struct find_worker	*fw;
+	struct find_item	*fi;
+	int			 started = 0;
+	int			 ready = 0;
+	int			 fd;
+	int			 ret = 0;
+	int			 rc;
+	int			 i;
+
+	if (threads <= 1)
+		return llapi_find(path, param);
+	if (threads > FIND_THREADS_MAX)
+		threads = FIND_THREADS_MAX;
+
+	if (strlen(path) > PATH_MAX) {
+		ret = -EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, ret,
+			    "Path name '%s' is too long", path);
+		return ret;
+	}
+
+	/* A single file is left to the serial walk. */
+	fd = open(path, O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		if (errno == ENOTDIR)
+			return llapi_find(path, param);
+		ret = -errno;
+		llapi_error(LLAPI_MSG_ERROR, ret, "%s: Failed to open '%s'",
+			    __func__, path);
+		return ret;
+	}
+
+	memset(&fc, 0, sizeof(fc));
+	pthread_mutex_init(&fc.fc_lock, NULL);
+	pthread_cond_init(&fc.fc_cond, NULL);
+	fc.fc_nthreads = threads;
+	fc.fc_workers = calloc(threads, sizeof(*fc.fc_workers));
+	if (fc.fc_workers == NULL) {
+		close(fd);
+		ret = -ENOMEM;
+		goto out_ctx;
+	}
+
+	for (ready = 0; ready < threads; ready++) {
+		fw = &fc.fc_workers[ready];
+		fw->fw_ctx = &fc;
+		fw->fw_index = ready;
+		pthread_mutex_init(&fw->fw_lock, NULL);
+		INIT_LIST_HEAD(&fw->fw_queue);
+
+		/* buffers and target indexes are private to each thread */
+		fw->fw_param = *param;
+		fw->fw_param.fp_lmd = NULL;
+		fw->fw_param.fp_lmv_md = NULL;
+		fw->fw_param.fp_obd_indexes = NULL;
+		fw->fw_param.fp_mdt_indexes = NULL;
+		ret = common_param_init(&fw->fw_param, path);
+		if (ret != 0) {
+			find_param_fini(&fw->fw_param);
+			pthread_mutex_destroy(&fw->fw_lock);
+			close(fd);
+			goto out_workers;
+		}
+	}
+
+	fi = calloc(1, sizeof(*fi));
+	if (fi != NULL)
+		fi->fi_path = strdup(path);
+	if (fi == NULL || fi->fi_path == NULL) {
+		free(fi);
+		close(fd);
+		ret = -ENOMEM;
+		goto out_workers;
+	}
+	fi->fi_fd = fd;
+	fc.fc_queued_fds = 1;
+	fc.fc_pending = 1;
+	list_add_tail(&fi->fi_list, &fc.fc_workers[0].fw_queue);
+
+	for (started = 0; started < threads; started++) {
+		fw = &fc.fc_workers[started];
+		rc = pthread_create(&fw->fw_thread, NULL, find_worker_main, fw);
+		if (rc != 0) {
+			llapi_error(LLAPI_MSG_WARN, -rc,
+				    "cannot start find thread %d", started);
+			break;
+		}
+	}
+
+	/* The threads already running steal the queue of the others. */
+	if (started == 0) {
+		find_worker_main(&fc.fc_workers[0]);
+	} else {
+		for (i = 0; i < started; i++)
+			pthread_join(fc.fc_workers[i].fw_thread, NULL);
+	}
+
+	for (i = 0; i < threads; i++) {
+		if (fc.fc_workers[i].fw_rc != 0) {
+			ret = fc.fc_workers[i].fw_rc;
+			break;
+		}
+	}
+
+out_workers:
+	for (i = 0; i < ready; i++) {
+		fw = &fc.fc_workers[i];
+		while ((fi = find_pop(fw)) != NULL)
+			find_item_free(fi);
+		free(fw->fw_param.fp_mdt_indexes);
+		find_param_fini(&fw->fw_param);
+		pthread_mutex_destroy(&fw->fw_lock);
+	}
+	free(fc.fc_workers);
+out_ctx:
+	pthread_cond_destroy(&fc.fc_cond);
+	pthread_mutex_destroy(&fc.fc_lock);
+
+	return ret;
+}
+
+#else /* !HAVE_LIBPTHREAD */
+
+int llapi_find_parallel(char *path, struct find_param *param, int threads)
+{
+	return llapi_find(path, param);
+}
+
+#endif /* HAVE_LIBPTHREAD */
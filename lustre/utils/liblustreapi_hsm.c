@@ -1538,3 +1538,171 @@ int llapi_hsm_request(const char *path, const struct hsm_user_request *request)
 	return rc;
 }
 
+
+/* send a single file HSM request */
+static int llapi_hsm_request_one(const char *path, enum hsm_user_action action,
+				 __u32 archive_id)
+{
+	struct hsm_user_request	*hur;
+	int			 rc;
+
+	hur = llapi_hsm_user_request_alloc(1, 0);
+	if (hur == NULL)
+		return -ENOMEM;
+
+	hur->hur_request.hr_action = action;
+	hur->hur_request.hr_archive_id = archive_id;
+	hur->hur_request.hr_flags = 0;
+	hur->hur_request.hr_itemcount = 1;
+	hur->hur_request.hr_data_len = 0;
+	hur->hur_user_item[0].hui_extent.offset = 0;
+	hur->hur_user_item[0].hui_extent.length = -1;
+
+	rc = llapi_path2fid(path, &hur->hur_user_item[0].hui_fid);
+	if (rc == 0)
+		rc = llapi_hsm_request(path, hur);
+
+	free(hur);
+	return rc;
+}
+
+/**
+ * Cache a file in the persistent client cache of this client.
+ *
+ * The file is archived to \a archive_id and released.  The archive must be
+ * served by a copytool running on this client with its hsm_root on local
+ * storage, and be the cache of the mount ("lctl set_param llite.*.pcc").
+ * IO on the file from this client is then served from the archived copy,
+ * until a restore from any client brings the data back to the OSTs.
+ *
+ * \param path		file to cache
+ * \param archive_id	archive of the local copytool
+ *
+ * \retval 0 on success.
+ * \retval -EBUSY if the file is released to another archive.
+ * \retval -EAGAIN if the file was modified while it was archived.
+ * \retval -ENODATA if the archived copy is not in the cache of the mount.
+ * \retval -errno on other errors.
+ */
+int llapi_pcc_attach(const char *path, __u32 archive_id)
+{
+	struct hsm_current_action	hca;
+	struct hsm_user_state		hus;
+	struct lu_pcc_state		state;
+	int				rc;
+
+	if (archive_id == 0)
+		return -EINVAL;
+
+	rc = llapi_hsm_state_get(path, &hus);
+	if (rc != 0)
+		return rc;
+
+	if ((hus.hus_states & HS_RELEASED) && hus.hus_archive_id != archive_id) {
+		llapi_error(LLAPI_MSG_ERROR, -EBUSY,
+			    "%s: released to archive %u", path,
+			    hus.hus_archive_id);
+		return -EBUSY;
+	}
+
+	if (!(hus.hus_states & HS_ARCHIVED) || (hus.hus_states & HS_DIRTY) ||
+	    hus.hus_archive_id != archive_id) {
+		rc = llapi_hsm_request_one(path, HUA_ARCHIVE, archive_id);
+		if (rc != 0)
+			return rc;
+
+		/* the copytool reports completion to the coordinator */
+		do {
+			rc = llapi_hsm_current_action(path, &hca);
+			if (rc != 0)
+				return rc;
+			if (hca.hca_action != HUA_ARCHIVE ||
+			    (hca.hca_state != HPS_WAITING &&
+			     hca.hca_state != HPS_RUNNING))
+				break;
+			sleep(1);
+		} while (1);
+
+		rc = llapi_hsm_state_get(path, &hus);
+		if (rc != 0)
+			return rc;
+		if (hus.hus_states & HS_DIRTY)
+			return -EAGAIN;
+		if (!(hus.hus_states & HS_ARCHIVED) ||
+		    hus.hus_archive_id != archive_id)
+			return -EIO;
+	}
+
+	if (!(hus.hus_states & HS_RELEASED)) {
+		rc = llapi_hsm_request_one(path, HUA_RELEASE, 0);
+		if (rc != 0)
+			return rc;
+	}
+
+	/* getting the state attaches the copy */
+	rc = llapi_pcc_state_get(path, &state);
+	if (rc != 0)
+		return rc;
+	if (!(state.pccs_flags & PCC_STATE_ATTACHED)) {
+		llapi_error(LLAPI_MSG_ERROR, -ENODATA,
+			    "%s: archive %u is not the cache of this mount "
+			    "(archive %u)", path, archive_id,
+			    state.pccs_archive_id);
+		return -ENODATA;
+	}
+
+	return 0;
+}
+
+/**
+ * Write a cached file back to the OSTs.
+ *
+ * A restore of the file is queued, the copytool copies the local copy,
+ * including the changes made through the cache, back to Lustre.  The copy
+ * is detached on every client as soon as the restore starts.
+ *
+ * \param path		cached file
+ *
+ * \retval 0 on success (the restore is queued).
+ * \retval -errno on error.
+ */
+int llapi_pcc_detach(const char *path)
+{
+	struct hsm_user_state	hus;
+	int			rc;
+
+	rc = llapi_hsm_state_get(path, &hus);
+	if (rc != 0)
+		return rc;
+
+	if (!(hus.hus_states & HS_RELEASED))
+		return 0;
+
+	return llapi_hsm_request_one(path, HUA_RESTORE, 0);
+}
+
+/**
+ * Return the persistent client cache state of file \a path on this client.
+ *
+ * \param path		file
+ * \param state		filled with the state of \a path
+ *
+ * \retval 0 on success.
+ * \retval -errno on error.
+ */
+int llapi_pcc_state_get(const char *path, struct lu_pcc_state *state)
+{
+	int fd;
+	int rc;
+
+	fd = open(path, O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+		return -errno;
+
+	rc = ioctl(fd, LL_IOC_PCC_STATE, state);
+	/* If error, save errno value */
+	rc = rc ? -errno : 0;
+
+	close(fd);
+	return rc;
+}
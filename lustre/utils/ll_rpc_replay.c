@@ -0,0 +1,1122 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/utils/ll_rpc_replay.c
+ *
+ * Replay the requests captured on servers by "ll_rpc_trace record -c" as
+ * file operations in a directory of a test filesystem, with the original
+ * or scaled inter-arrival times, and report the latency of each kind of
+ * request.
+ *
+ * Each OST object and MDT FID of the capture is mapped to a file named
+ * after it at the top of that directory, and each name looked up in a
+ * directory FID to an entry of a subdirectory named after that FID.  The
+ * requests of a client are replayed in order by the same thread.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/types.h>
+#include <libcfs/libcfs.h>
+#include <lnet/nidstr.h>
+#include <lustre/lustre_idl.h>
+#include <lustre/lustre_user.h>
+
+/* intent opcodes of struct ldlm_intent, see obd.h */
+#define RPL_IT_OPEN	(1 << 0)
+#define RPL_IT_GETATTR	(1 << 3)
+#define RPL_IT_LOOKUP	(1 << 4)
+
+#define RPL_MAX_BUFCOUNT	16
+#define RPL_HIST_MAX		32
+#define RPL_MAX_UNKNOWN		64
+
+enum replay_type {
+	RT_OST_READ,
+	RT_OST_WRITE,
+	RT_OST_PUNCH,
+	RT_OST_GETATTR,
+	RT_OST_SETATTR,
+	RT_OST_SYNC,
+	RT_OST_DESTROY,
+	RT_OST_STATFS,
+	RT_MDS_GETATTR,
+	RT_MDS_GETATTR_NAME,
+	RT_MDS_STATFS,
+	RT_MDS_SYNC,
+	RT_REINT_SETATTR,
+	RT_REINT_CREATE,
+	RT_REINT_UNLINK,
+	RT_REINT_LINK,
+	RT_REINT_RENAME,
+	RT_INTENT_OPEN,
+	RT_INTENT_GETATTR,
+	RT_NR,
+	RT_UNKNOWN = RT_NR,
+};
+
+static const char * const replay_type_names[RT_NR] = {
+	[RT_OST_READ]		= "ost_read",
+	[RT_OST_WRITE]		= "ost_write",
+	[RT_OST_PUNCH]		= "ost_punch",
+	[RT_OST_GETATTR]	= "ost_getattr",
+	[RT_OST_SETATTR]	= "ost_setattr",
+	[RT_OST_SYNC]		= "ost_sync",
+	[RT_OST_DESTROY]	= "ost_destroy",
+	[RT_OST_STATFS]		= "ost_statfs",
+	[RT_MDS_GETATTR]	= "mds_getattr",
+	[RT_MDS_GETATTR_NAME]	= "mds_getattr_name",
+	[RT_MDS_STATFS]		= "mds_statfs",
+	[RT_MDS_SYNC]		= "mds_sync",
+	[RT_REINT_SETATTR]	= "mds_reint_setattr",
+	[RT_REINT_CREATE]	= "mds_reint_create",
+	[RT_REINT_UNLINK]	= "mds_reint_unlink",
+	[RT_REINT_LINK]		= "mds_reint_link",
+	[RT_REINT_RENAME]	= "mds_reint_rename",
+	[RT_INTENT_OPEN]	= "ldlm_intent_open",
+	[RT_INTENT_GETATTR]	= "ldlm_intent_getattr",
+};
+
+/* one captured request, decoded */
+struct replay_op {
+	const struct rpc_capture_rec	*ro_rec;
+	enum replay_type		 ro_type;
+	char				 ro_obj[64];
+	char				 ro_obj2[64];
+	const char			*ro_name;
+	const char			*ro_name2;
+	const struct niobuf_remote	*ro_nb;
+	unsigned int			 ro_nbcount;
+	__u64				 ro_size;
+	__u64				 ro_valid;
+	__u64				 ro_flags;
+	__u32				 ro_mode;
+	/* plain lock enqueues are decoded for dump only */
+	const struct ldlm_request	*ro_dlm;
+};
+
+struct replay_stats {
+	unsigned long long	rs_count;
+	unsigned long long	rs_errors;
+	unsigned long long	rs_sum;
+	unsigned long long	rs_min;
+	unsigned long long	rs_max;
+	unsigned long long	rs_hist[RPL_HIST_MAX];
+};
+
+struct replay_thread {
+	pthread_t		 rt_thread;
+	int			 rt_index;
+	char			*rt_buf;
+	size_t			 rt_buflen;
+	unsigned long long	 rt_lag_max;
+	struct replay_stats	 rt_stats[RT_NR];
+};
+
+static char *progname;
+static const char *replay_dir = ".";
+static double replay_scale = 1.0;
+static int replay_nthreads = 8;
+static const struct rpc_capture_rec **replay_recs;
+static size_t replay_count;
+static size_t replay_alloc;
+static struct timespec replay_start;
+
+static struct {
+	__u32			ru_opc;
+	unsigned long long	ru_count;
+} replay_unknown[RPL_MAX_UNKNOWN];
+static unsigned long long replay_skipped;
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: %s [-n] [-d dir] [-s scale] [-t threads] capture ...\n"
+		"\t-d: directory of the test filesystem to replay in "
+		"(default .)\n"
+		"\t-n: only print the decoded requests\n"
+		"\t-s: multiply the original times between requests, "
+		"0 to replay as fast as possible (default 1)\n"
+		"\t-t: number of replay threads (default 8)\n",
+		progname);
+}
+
+static void *msg_buf(const struct rpc_capture_rec *rec, unsigned int n,
+		     unsigned int minlen, unsigned int *lenp)
+{
+	const struct lustre_msg_v2	*msg = (const void *)rec->rcr_msg;
+	size_t				 off;
+	unsigned int			 i;
+
+	if (rec->rcr_msglen < sizeof(*msg) || n >= msg->lm_bufcount ||
+	    msg->lm_bufcount > RPL_MAX_BUFCOUNT)
+		return NULL;
+
+	/* the buffer lengths must have been captured before they are read */
+	off = offsetof(struct lustre_msg_v2, lm_buflens[msg->lm_bufcount]);
+	if (off > rec->rcr_msglen)
+		return NULL;
+
+	off = cfs_size_round(off);
+	for (i = 0; i < n; i++)
+		off += cfs_size_round(msg->lm_buflens[i]);
+	if (off + minlen > rec->rcr_msglen || msg->lm_buflens[n] < minlen)
+		return NULL;
+
+	/* the end of the message may not have been captured */
+	if (lenp != NULL)
+		*lenp = min((size_t)msg->lm_buflens[n],
+			    rec->rcr_msglen - off);
+
+	return (char *)msg + off;
+}
+
+static const char *msg_name(const struct rpc_capture_rec *rec,
+			    unsigned int n)
+{
+	unsigned int	 len;
+	const char	*name;
+
+	name = msg_buf(rec, n, 2, &len);
+	if (name == NULL || name[len - 1] != '\0' || strchr(name, '/') ||
+	    strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+		return NULL;
+
+	return name;
+}
+
+static void fid2obj(char *obj, size_t size, const struct lu_fid *fid)
+{
+	snprintf(obj, size, DFID_NOBRACE, PFID(fid));
+}
+
+static void ostid2obj(char *obj, size_t size, const struct ost_id *oi)
+{
+	snprintf(obj, size, "O"DOSTID, POSTID(oi));
+}
+
+static int decode_ost(struct replay_op *op, __u32 opc)
+{
+	const struct rpc_capture_rec	*rec = op->ro_rec;
+	const struct ost_body		*body;
+	const struct obd_ioobj		*ioo;
+	unsigned int			 len;
+
+	body = msg_buf(rec, REQ_REC_OFF, sizeof(*body), NULL);
+	if (body == NULL)
+		return -EINVAL;
+
+	ostid2obj(op->ro_obj, sizeof(op->ro_obj), &body->oa.o_oi);
+	op->ro_valid = body->oa.o_valid;
+	op->ro_size = body->oa.o_size;
+
+	switch (opc) {
+	case OST_READ:
+	case OST_WRITE:
+		op->ro_type = opc == OST_READ ? RT_OST_READ : RT_OST_WRITE;
+		ioo = msg_buf(rec, REQ_REC_OFF + 1, sizeof(*ioo), NULL);
+		op->ro_nb = msg_buf(rec, REQ_REC_OFF + 2,
+				    sizeof(*op->ro_nb), &len);
+		if (ioo == NULL || op->ro_nb == NULL)
+			return -EINVAL;
+		ostid2obj(op->ro_obj, sizeof(op->ro_obj), &ioo->ioo_oid);
+		op->ro_nbcount = min((unsigned int)(len / sizeof(*op->ro_nb)),
+				     ioo->ioo_bufcnt);
+		return 0;
+	case OST_PUNCH:
+		op->ro_type = RT_OST_PUNCH;
+		return 0;
+	case OST_GETATTR:
+		op->ro_type = RT_OST_GETATTR;
+		return 0;
+	case OST_SETATTR:
+		op->ro_type = RT_OST_SETATTR;
+		return 0;
+	case OST_SYNC:
+		op->ro_type = RT_OST_SYNC;
+		return 0;
+	case OST_DESTROY:
+		op->ro_type = RT_OST_DESTROY;
+		return 0;
+	}
+
+	return -EOPNOTSUPP;
+}
+
+static int decode_reint(struct replay_op *op, unsigned int off)
+{
+	const struct rpc_capture_rec	*rec = op->ro_rec;
+	const struct mdt_rec_reint	*rr;
+	const struct mdt_rec_setattr	*sa;
+
+	rr = msg_buf(rec, off, sizeof(*rr), NULL);
+	if (rr == NULL)
+		return -EINVAL;
+
+	fid2obj(op->ro_obj, sizeof(op->ro_obj), &rr->rr_fid1);
+	fid2obj(op->ro_obj2, sizeof(op->ro_obj2), &rr->rr_fid2);
+	op->ro_mode = rr->rr_mode;
+
+	switch (rr->rr_opcode) {
+	case REINT_SETATTR:
+		sa = (const struct mdt_rec_setattr *)rr;
+		op->ro_type = RT_REINT_SETATTR;
+		op->ro_valid = sa->sa_valid;
+		op->ro_size = sa->sa_size;
+		return 0;
+	case REINT_CREATE:
+		op->ro_type = RT_REINT_CREATE;
+		op->ro_name = msg_name(rec, off + 2);
+		/* the target of a symlink follows its name */
+		if (S_ISLNK(op->ro_mode))
+			op->ro_name2 = msg_buf(rec, off + 3, 1, NULL);
+		break;
+	case REINT_UNLINK:
+		op->ro_type = RT_REINT_UNLINK;
+		op->ro_name = msg_name(rec, off + 2);
+		break;
+	case REINT_LINK:
+		op->ro_type = RT_REINT_LINK;
+		op->ro_name = msg_name(rec, off + 3);
+		break;
+	case REINT_RENAME:
+		op->ro_type = RT_REINT_RENAME;
+		op->ro_name = msg_name(rec, off + 3);
+		op->ro_name2 = msg_name(rec, off + 4);
+		if (op->ro_name2 == NULL)
+			return -EINVAL;
+		break;
+	case REINT_OPEN:
+		op->ro_type = RT_INTENT_OPEN;
+		op->ro_flags = get_mrc_cr_flags((struct mdt_rec_create *)rr);
+		/* open by FID has an empty name */
+		op->ro_name = msg_name(rec, off + 3);
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+
+	return op->ro_name == NULL ? -EINVAL : 0;
+}
+
+static int decode_enqueue(struct replay_op *op)
+{
+	const struct rpc_capture_rec	*rec = op->ro_rec;
+	const struct ldlm_intent	*it;
+	const struct mdt_body		*body;
+
+	op->ro_dlm = msg_buf(rec, DLM_LOCKREQ_OFF, sizeof(*op->ro_dlm), NULL);
+	if (op->ro_dlm == NULL)
+		return -EINVAL;
+
+	it = msg_buf(rec, DLM_INTENT_IT_OFF, sizeof(*it), NULL);
+	if (it == NULL)
+		return -EOPNOTSUPP;
+
+	if (it->opc & RPL_IT_OPEN)
+		return decode_reint(op, DLM_INTENT_REC_OFF);
+
+	if (it->opc & (RPL_IT_GETATTR | RPL_IT_LOOKUP)) {
+		body = msg_buf(rec, DLM_INTENT_REC_OFF, sizeof(*body), NULL);
+		if (body == NULL)
+			return -EINVAL;
+		op->ro_type = RT_INTENT_GETATTR;
+		fid2obj(op->ro_obj, sizeof(op->ro_obj), &body->mbo_fid1);
+		op->ro_name = msg_name(rec, DLM_INTENT_REC_OFF + 2);
+		return 0;
+	}
+
+	return -EOPNOTSUPP;
+}
+
+/**
+ * Decode the request captured in \a op->ro_rec.
+ *
+ * \retval 0		\a op can be replayed
+ * \retval -EOPNOTSUPP	request of a type that is not replayed
+ * \retval -EINVAL	malformed or truncated request
+ */
+static int replay_decode(struct replay_op *op)
+{
+	const struct rpc_capture_rec	*rec = op->ro_rec;
+	const struct lustre_msg_v2	*msg = (const void *)rec->rcr_msg;
+	const struct mdt_body		*body;
+	__u32				 opc = rec->rcr_opc;
+
+	op->ro_type = RT_UNKNOWN;
+	if (rec->rcr_flags & RPC_CAPTURE_SWABBED ||
+	    rec->rcr_msglen < sizeof(*msg) ||
+	    msg->lm_magic != LUSTRE_MSG_MAGIC_V2)
+		return -EINVAL;
+
+	switch (opc) {
+	case OST_STATFS:
+		op->ro_type = RT_OST_STATFS;
+		return 0;
+	case MDS_STATFS:
+		op->ro_type = RT_MDS_STATFS;
+		return 0;
+	case MDS_GETATTR:
+	case MDS_GETATTR_NAME:
+	case MDS_SYNC:
+		body = msg_buf(rec, REQ_REC_OFF, sizeof(*body), NULL);
+		if (body == NULL)
+			return -EINVAL;
+		fid2obj(op->ro_obj, sizeof(op->ro_obj), &body->mbo_fid1);
+		if (opc == MDS_GETATTR) {
+			op->ro_type = RT_MDS_GETATTR;
+		} else if (opc == MDS_SYNC) {
+			op->ro_type = RT_MDS_SYNC;
+		} else {
+			op->ro_type = RT_MDS_GETATTR_NAME;
+			op->ro_name = msg_name(rec, REQ_REC_OFF + 2);
+			if (op->ro_name == NULL)
+				return -EINVAL;
+		}
+		return 0;
+	case MDS_REINT:
+		return decode_reint(op, REQ_REC_OFF);
+	case LDLM_ENQUEUE:
+		return decode_enqueue(op);
+	}
+
+	if (opc >= OST_FIRST_OPC && opc < OST_LAST_OPC)
+		return decode_ost(op, opc);
+
+	return -EOPNOTSUPP;
+}
+
+static void replay_dump(const struct replay_op *op, int rc)
+{
+	const struct rpc_capture_rec	*rec = op->ro_rec;
+	const struct ldlm_lock_desc	*ld;
+	__u64				 rel;
+	unsigned int			 i;
+
+	rel = rec->rcr_arrival - replay_recs[0]->rcr_arrival;
+	printf("%llu.%06llu %s x"LPU64" %.*s ",
+	       (unsigned long long)rel / 1000000,
+	       (unsigned long long)rel % 1000000,
+	       libcfs_nid2str(rec->rcr_peer_nid), rec->rcr_xid,
+	       RPC_CAPTURE_SVC_LEN, rec->rcr_service);
+
+	if (rc == -EINVAL) {
+		printf("opc %u: cannot decode\n", rec->rcr_opc);
+		return;
+	}
+	if (op->ro_type == RT_UNKNOWN) {
+		printf("opc %u", rec->rcr_opc);
+		if (op->ro_dlm != NULL) {
+			ld = &op->ro_dlm->lock_desc;
+			printf(" type %u mode %u res "LPX64":"LPX64,
+			       ld->l_resource.lr_type, ld->l_req_mode,
+			       ld->l_resource.lr_name.name[0],
+			       ld->l_resource.lr_name.name[1]);
+			if (ld->l_resource.lr_type == LDLM_EXTENT)
+				printf(" ["LPU64"-"LPU64"]",
+				       ld->l_policy_data.l_extent.start,
+				       ld->l_policy_data.l_extent.end);
+		}
+		printf("\n");
+		return;
+	}
+
+	printf("%s", replay_type_names[op->ro_type]);
+	if (op->ro_obj[0] != '\0')
+		printf(" %s", op->ro_obj);
+	if (op->ro_name != NULL)
+		printf("/%s", op->ro_name);
+	switch (op->ro_type) {
+	case RT_OST_READ:
+	case RT_OST_WRITE:
+		for (i = 0; i < op->ro_nbcount; i++)
+			printf(" "LPU64"+%u", op->ro_nb[i].rnb_offset,
+			       op->ro_nb[i].rnb_len);
+		if (op->ro_nbcount == 0)
+			printf(" (niobufs not captured)");
+		break;
+	case RT_OST_PUNCH:
+	case RT_REINT_SETATTR:
+		printf(" valid "LPX64" size "LPU64, op->ro_valid, op->ro_size);
+		break;
+	case RT_REINT_CREATE:
+		printf(" mode %#o", op->ro_mode);
+		break;
+	case RT_REINT_LINK:
+	case RT_REINT_RENAME:
+		printf(" -> %s/%s", op->ro_obj2,
+		       op->ro_name2 != NULL ? op->ro_name2 : op->ro_name);
+		break;
+	case RT_INTENT_OPEN:
+		printf(" flags "LPX64" mode %#o", op->ro_flags, op->ro_mode);
+		break;
+	default:
+		break;
+	}
+	printf("\n");
+}
+
+static void replay_path(char *path, size_t size, const char *obj,
+			const char *name)
+{
+	if (name == NULL || name[0] == '\0')
+		snprintf(path, size, "%s/%s", replay_dir, obj);
+	else
+		snprintf(path, size, "%s/%s/%s", replay_dir, obj, name);
+}
+
+/* entries are created in a directory named after their parent FID */
+static void replay_mkparent(const char *obj)
+{
+	char path[PATH_MAX];
+
+	replay_path(path, sizeof(path), obj, NULL);
+	mkdir(path, 0755);
+}
+
+static int replay_buf(struct replay_thread *rt, size_t len)
+{
+	char *buf;
+
+	if (len <= rt->rt_buflen)
+		return 0;
+
+	buf = realloc(rt->rt_buf, len);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	memset(buf + rt->rt_buflen, 0, len - rt->rt_buflen);
+	rt->rt_buf = buf;
+	rt->rt_buflen = len;
+
+	return 0;
+}
+
+static inline unsigned long long ts_usec(const struct timespec *ts)
+{
+	return (unsigned long long)ts->tv_sec * 1000000 + ts->tv_nsec / 1000;
+}
+
+static int replay_brw(struct replay_thread *rt, const struct replay_op *op,
+		      const char *path, struct timespec *start)
+{
+	const struct niobuf_remote	*nb;
+	unsigned int			 i;
+	ssize_t				 rc = 0;
+	int				 fd;
+
+	fd = open(path, op->ro_type == RT_OST_READ ? O_RDONLY :
+						     O_WRONLY | O_CREAT, 0644);
+	if (fd < 0)
+		return -errno;
+
+	clock_gettime(CLOCK_MONOTONIC, start);
+	for (i = 0; i < op->ro_nbcount; i++) {
+		nb = &op->ro_nb[i];
+		rc = replay_buf(rt, nb->rnb_len);
+		if (rc < 0)
+			break;
+		if (op->ro_type == RT_OST_READ)
+			rc = pread(fd, rt->rt_buf, nb->rnb_len,
+				   nb->rnb_offset);
+		else
+			rc = pwrite(fd, rt->rt_buf, nb->rnb_len,
+				    nb->rnb_offset);
+		if (rc < 0) {
+			rc = -errno;
+			break;
+		}
+		/* a short write means the target filesystem is full */
+		if (op->ro_type != RT_OST_READ && rc < nb->rnb_len) {
+			rc = -ENOSPC;
+			break;
+		}
+	}
+	close(fd);
+
+	return rc < 0 ? rc : 0;
+}
+
+static int replay_open(const struct replay_op *op, const char *path)
+{
+	int flags = 0;
+	int fd;
+
+	if ((op->ro_flags & (FMODE_READ | FMODE_WRITE)) ==
+	    (FMODE_READ | FMODE_WRITE))
+		flags = O_RDWR;
+	else if (op->ro_flags & FMODE_WRITE)
+		flags = O_WRONLY;
+	if (op->ro_flags & MDS_OPEN_CREAT)
+		flags |= O_CREAT;
+	if (op->ro_flags & MDS_OPEN_EXCL)
+		flags |= O_EXCL;
+	if (op->ro_flags & MDS_OPEN_TRUNC)
+		flags |= O_TRUNC;
+	if (op->ro_flags & MDS_OPEN_APPEND)
+		flags |= O_APPEND;
+	if (op->ro_flags & MDS_OPEN_DIRECTORY)
+		flags |= O_DIRECTORY;
+
+	fd = open(path, flags, op->ro_mode & 07777);
+	if (fd < 0)
+		return -errno;
+
+	close(fd);
+	return 0;
+}
+
+static int replay_sync(const char *path)
+{
+	int rc = 0;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	if (fsync(fd) < 0)
+		rc = -errno;
+	close(fd);
+
+	return rc;
+}
+
+/**
+ * Do the file operation closest to the request in \a op.
+ *
+ * \param[out] start	time the operation was started, once any setup not
+ *			part of the request was done
+ */
+static int replay_exec(struct replay_thread *rt, const struct replay_op *op,
+		       struct timespec *start)
+{
+	char		path[PATH_MAX];
+	char		path2[PATH_MAX];
+	struct stat	st;
+	struct statfs	sfs;
+	int		rc;
+
+	if (op->ro_name != NULL && op->ro_name[0] != '\0' &&
+	    op->ro_type != RT_REINT_LINK)
+		replay_mkparent(op->ro_obj);
+	replay_path(path, sizeof(path), op->ro_obj,
+		    op->ro_type == RT_REINT_LINK ? NULL : op->ro_name);
+
+	switch (op->ro_type) {
+	case RT_OST_READ:
+	case RT_OST_WRITE:
+		return replay_brw(rt, op, path, start);
+	case RT_REINT_LINK:
+		replay_mkparent(op->ro_obj2);
+		replay_path(path2, sizeof(path2), op->ro_obj2, op->ro_name);
+		break;
+	case RT_REINT_RENAME:
+		replay_mkparent(op->ro_obj2);
+		replay_path(path2, sizeof(path2), op->ro_obj2, op->ro_name2);
+		break;
+	default:
+		break;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, start);
+	switch (op->ro_type) {
+	case RT_OST_PUNCH:
+		rc = truncate(path, op->ro_size);
+		break;
+	case RT_REINT_SETATTR:
+		if (op->ro_valid & MDS_ATTR_SIZE)
+			rc = truncate(path, op->ro_size);
+		else
+			rc = utimes(path, NULL);
+		break;
+	case RT_OST_SETATTR:
+		rc = utimes(path, NULL);
+		break;
+	case RT_OST_GETATTR:
+	case RT_MDS_GETATTR:
+	case RT_MDS_GETATTR_NAME:
+	case RT_INTENT_GETATTR:
+		rc = stat(path, &st);
+		break;
+	case RT_OST_SYNC:
+	case RT_MDS_SYNC:
+		return replay_sync(path);
+	case RT_OST_DESTROY:
+		rc = unlink(path);
+		break;
+	case RT_OST_STATFS:
+	case RT_MDS_STATFS:
+		rc = statfs(replay_dir, &sfs);
+		break;
+	case RT_REINT_CREATE:
+		if (S_ISDIR(op->ro_mode))
+			rc = mkdir(path, op->ro_mode & 07777);
+		else if (S_ISLNK(op->ro_mode) && op->ro_name2 != NULL)
+			rc = symlink(op->ro_name2, path);
+		else
+			rc = mknod(path, S_IFREG | (op->ro_mode & 07777), 0);
+		break;
+	case RT_REINT_UNLINK:
+		rc = S_ISDIR(op->ro_mode) ? rmdir(path) : unlink(path);
+		break;
+	case RT_REINT_LINK:
+		rc = link(path, path2);
+		break;
+	case RT_REINT_RENAME:
+		rc = rename(path, path2);
+		break;
+	case RT_INTENT_OPEN:
+		return replay_open(op, path);
+	default:
+		return -EOPNOTSUPP;
+	}
+
+	return rc < 0 ? -errno : 0;
+}
+
+static void replay_account(struct replay_stats *rs, unsigned long long usec,
+			   int rc)
+{
+	int bucket = 0;
+
+	if (rc < 0)
+		rs->rs_errors++;
+
+	if (rs->rs_count == 0 || usec < rs->rs_min)
+		rs->rs_min = usec;
+	if (usec > rs->rs_max)
+		rs->rs_max = usec;
+	rs->rs_count++;
+	rs->rs_sum += usec;
+
+	while (bucket < RPL_HIST_MAX - 1 && (1ULL << bucket) < usec)
+		bucket++;
+	rs->rs_hist[bucket]++;
+}
+
+/* all requests from the same client are replayed by the same thread */
+static int replay_thread_of(const struct rpc_capture_rec *rec)
+{
+	__u64 key = rec->rcr_peer_nid ^ ((__u64)rec->rcr_peer_pid << 32);
+
+	key ^= key >> 29;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 32;
+
+	return key % replay_nthreads;
+}
+
+static void *replay_thread_main(void *arg)
+{
+	struct replay_thread	*rt = arg;
+	struct replay_op	 op;
+	struct timespec		 due = { 0 };
+	struct timespec		 start;
+	struct timespec		 end;
+	unsigned long long	 delay;
+	size_t			 i;
+	int			 rc;
+
+	for (i = 0; i < replay_count; i++) {
+		if (replay_thread_of(replay_recs[i]) != rt->rt_index)
+			continue;
+
+		memset(&op, 0, sizeof(op));
+		op.ro_rec = replay_recs[i];
+		if (replay_decode(&op) < 0)
+			continue;
+
+		if (replay_scale > 0) {
+			delay = (replay_recs[i]->rcr_arrival -
+				 replay_recs[0]->rcr_arrival) * replay_scale;
+			due = replay_start;
+			due.tv_sec += delay / 1000000;
+			due.tv_nsec += (delay % 1000000) * 1000;
+			if (due.tv_nsec >= 1000000000) {
+				due.tv_sec++;
+				due.tv_nsec -= 1000000000;
+			}
+			while (clock_nanosleep(CLOCK_MONOTONIC,
+					       TIMER_ABSTIME, &due,
+					       NULL) == EINTR)
+				;
+		}
+
+		memset(&start, 0, sizeof(start));
+		rc = replay_exec(rt, &op, &start);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		if (start.tv_sec == 0 && start.tv_nsec == 0)
+			start = end;
+
+		if (replay_scale > 0 && ts_usec(&start) > ts_usec(&due) &&
+		    ts_usec(&start) - ts_usec(&due) > rt->rt_lag_max)
+			rt->rt_lag_max = ts_usec(&start) - ts_usec(&due);
+		replay_account(&rt->rt_stats[op.ro_type],
+			       ts_usec(&end) - ts_usec(&start), rc);
+	}
+
+	return NULL;
+}
+
+static unsigned long long replay_percentile(const struct replay_stats *rs,
+					    int pct)
+{
+	unsigned long long	want = (rs->rs_count * pct + 99) / 100;
+	unsigned long long	seen = 0;
+	int			i;
+
+	for (i = 0; i < RPL_HIST_MAX; i++) {
+		seen += rs->rs_hist[i];
+		if (seen >= want)
+			return min(1ULL << i, rs->rs_max);
+	}
+
+	return rs->rs_max;
+}
+
+static void replay_report(struct replay_thread *threads)
+{
+	struct replay_stats	 total;
+	struct replay_stats	*rs;
+	unsigned long long	 lag = 0;
+	int			 i;
+	int			 j;
+	int			 k;
+
+	printf("%-20s %10s %8s %10s %10s %10s %10s %10s\n", "request",
+	       "count", "errors", "min_usec", "avg_usec", "p50_usec",
+	       "p99_usec", "max_usec");
+	for (i = 0; i < RT_NR; i++) {
+		memset(&total, 0, sizeof(total));
+		for (j = 0; j < replay_nthreads; j++) {
+			rs = &threads[j].rt_stats[i];
+			if (rs->rs_count == 0)
+				continue;
+			if (total.rs_count == 0 || rs->rs_min < total.rs_min)
+				total.rs_min = rs->rs_min;
+			if (rs->rs_max > total.rs_max)
+				total.rs_max = rs->rs_max;
+			total.rs_count += rs->rs_count;
+			total.rs_errors += rs->rs_errors;
+			total.rs_sum += rs->rs_sum;
+			for (k = 0; k < RPL_HIST_MAX; k++)
+				total.rs_hist[k] += rs->rs_hist[k];
+		}
+		if (total.rs_count == 0)
+			continue;
+
+		printf("%-20s %10llu %8llu %10llu %10llu %10llu %10llu "
+		       "%10llu\n", replay_type_names[i], total.rs_count,
+		       total.rs_errors, total.rs_min,
+		       total.rs_sum / total.rs_count,
+		       replay_percentile(&total, 50),
+		       replay_percentile(&total, 99), total.rs_max);
+	}
+
+	for (j = 0; j < replay_nthreads; j++)
+		lag = max(lag, threads[j].rt_lag_max);
+	if (replay_scale > 0)
+		printf("replay fell behind the schedule by up to %llu usec\n",
+		       lag);
+
+	for (i = 0; i < RPL_MAX_UNKNOWN && replay_unknown[i].ru_count; i++)
+		printf("opc %u: %llu requests not replayed\n",
+		       replay_unknown[i].ru_opc, replay_unknown[i].ru_count);
+	if (replay_skipped > 0)
+		printf("%llu requests could not be decoded\n", replay_skipped);
+}
+
+static int replay_load(const char *path, char **data, size_t *size)
+{
+	struct stat	 st;
+	char		*buf;
+	size_t		 done = 0;
+	ssize_t		 len;
+	int		 rc = 0;
+	int		 fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open %s: %s\n", progname, path,
+			strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return rc;
+	}
+
+	buf = malloc(st.st_size + 1);
+	if (buf == NULL) {
+		close(fd);
+		return -ENOMEM;
+	}
+
+	while (done < st.st_size) {
+		len = read(fd, buf + done, st.st_size - done);
+		if (len <= 0) {
+			rc = len < 0 ? -errno : -EIO;
+			fprintf(stderr, "%s: cannot read %s: %s\n", progname,
+				path, strerror(-rc));
+			free(buf);
+			close(fd);
+			return rc;
+		}
+		done += len;
+	}
+	close(fd);
+
+	*data = buf;
+	*size = done;
+	return 0;
+}
+
+static int replay_index(const char *path, char *data, size_t size)
+{
+	const struct rpc_capture_rec	**recs;
+	const struct rpc_capture_rec	 *rec;
+	size_t				  off;
+
+	for (off = 0; off + sizeof(*rec) <= size; off += rec->rcr_reclen) {
+		rec = (const void *)(data + off);
+		if (rec->rcr_magic != RPC_CAPTURE_MAGIC ||
+		    rec->rcr_reclen < sizeof(*rec) + rec->rcr_msglen ||
+		    off + rec->rcr_reclen > size) {
+			fprintf(stderr, "%s: %s: bad record at offset %zu\n",
+				progname, path, off);
+			return -EINVAL;
+		}
+
+		if (replay_count == replay_alloc) {
+			replay_alloc = replay_alloc == 0 ? 4096 :
+						replay_alloc * 2;
+			recs = realloc(replay_recs,
+				       replay_alloc * sizeof(*recs));
+			if (recs == NULL)
+				return -ENOMEM;
+			replay_recs = recs;
+		}
+		replay_recs[replay_count++] = rec;
+	}
+
+	return 0;
+}
+
+static int replay_cmp(const void *a, const void *b)
+{
+	const struct rpc_capture_rec *ra = *(const struct rpc_capture_rec **)a;
+	const struct rpc_capture_rec *rb = *(const struct rpc_capture_rec **)b;
+
+	if (ra->rcr_arrival != rb->rcr_arrival)
+		return ra->rcr_arrival < rb->rcr_arrival ? -1 : 1;
+	if (ra->rcr_xid != rb->rcr_xid)
+		return ra->rcr_xid < rb->rcr_xid ? -1 : 1;
+	return 0;
+}
+
+/* count the requests that are not replayed, and fill the ranges read */
+static int replay_prepare(int dump)
+{
+	struct replay_thread	 rt = { 0 };
+	struct replay_op	 op;
+	struct stat		 st;
+	const struct niobuf_remote *nb;
+	char			 path[PATH_MAX];
+	ssize_t			 written;
+	size_t			 i;
+	unsigned int		 j;
+	int			 rc = 0;
+	int			 k;
+	int			 fd;
+
+	for (i = 0; i < replay_count; i++) {
+		memset(&op, 0, sizeof(op));
+		op.ro_rec = replay_recs[i];
+		rc = replay_decode(&op);
+		if (dump)
+			replay_dump(&op, rc);
+		if (rc == -EINVAL) {
+			replay_skipped++;
+			continue;
+		}
+		if (rc < 0) {
+			for (k = 0; k < RPL_MAX_UNKNOWN - 1; k++) {
+				if (replay_unknown[k].ru_count == 0 ||
+				    replay_unknown[k].ru_opc ==
+				    op.ro_rec->rcr_opc)
+					break;
+			}
+			replay_unknown[k].ru_opc = op.ro_rec->rcr_opc;
+			replay_unknown[k].ru_count++;
+			continue;
+		}
+		if (dump || op.ro_type != RT_OST_READ || op.ro_nbcount == 0)
+			continue;
+
+		/* reads of data never written would only find holes */
+		nb = &op.ro_nb[op.ro_nbcount - 1];
+		replay_path(path, sizeof(path), op.ro_obj, NULL);
+		if (stat(path, &st) == 0 &&
+		    st.st_size >= nb->rnb_offset + nb->rnb_len)
+			continue;
+
+		fd = open(path, O_WRONLY | O_CREAT, 0644);
+		if (fd < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: cannot create %s: %s\n",
+				progname, path, strerror(-rc));
+			break;
+		}
+		for (j = 0, rc = 0; j < op.ro_nbcount && rc == 0; j++) {
+			nb = &op.ro_nb[j];
+			rc = replay_buf(&rt, nb->rnb_len);
+			if (rc < 0)
+				break;
+			written = pwrite(fd, rt.rt_buf, nb->rnb_len,
+					 nb->rnb_offset);
+			if (written < 0)
+				rc = -errno;
+			else if (written < nb->rnb_len)
+				rc = -ENOSPC;
+		}
+		close(fd);
+		if (rc < 0) {
+			fprintf(stderr, "%s: cannot write %s: %s\n",
+				progname, path, strerror(-rc));
+			break;
+		}
+	}
+
+	free(rt.rt_buf);
+
+	return rc < 0 ? rc : 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct replay_thread	*threads;
+	char			**data;
+	int			 nstarted;
+	size_t			 size = 0;
+	char			*end;
+	int			 dump = 0;
+	int			 rc = 0;
+	int			 c;
+	int			 i;
+
+	progname = basename(argv[0]);
+	while ((c = getopt(argc, argv, "d:ns:t:")) != -1) {
+		switch (c) {
+		case 'd':
+			replay_dir = optarg;
+			break;
+		case 'n':
+			dump = 1;
+			break;
+		case 's':
+			replay_scale = strtod(optarg, &end);
+			if (*end != '\0' || replay_scale < 0) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			break;
+		case 't':
+			replay_nthreads = strtol(optarg, &end, 0);
+			if (*end != '\0' || replay_nthreads < 1) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			break;
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind == argc) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	data = calloc(argc - optind, sizeof(*data));
+	if (data == NULL)
+		return EXIT_FAILURE;
+	for (i = optind; i < argc; i++) {
+		rc = replay_load(argv[i], &data[i - optind], &size);
+		if (rc == 0)
+			rc = replay_index(argv[i], data[i - optind], size);
+		if (rc < 0)
+			goto out;
+	}
+	if (replay_count == 0)
+		goto out;
+
+	qsort(replay_recs, replay_count, sizeof(*replay_recs), replay_cmp);
+	rc = replay_prepare(dump);
+	if (rc < 0 || dump)
+		goto out;
+
+	threads = calloc(replay_nthreads, sizeof(*threads));
+	if (threads == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &replay_start);
+	for (nstarted = 0; nstarted < replay_nthreads; nstarted++) {
+		threads[nstarted].rt_index = nstarted;
+		rc = -pthread_create(&threads[nstarted].rt_thread, NULL,
+				     replay_thread_main, &threads[nstarted]);
+		if (rc < 0) {
+			fprintf(stderr, "%s: cannot start thread: %s\n",
+				progname, strerror(-rc));
+			break;
+		}
+	}
+	for (i = 0; i < nstarted; i++) {
+		pthread_join(threads[i].rt_thread, NULL);
+		free(threads[i].rt_buf);
+	}
+
+	/* a partial replay would not be comparable */
+	if (rc == 0)
+		replay_report(threads);
+	free(threads);
+out:
+	for (i = 0; i < argc - optind; i++)
+		free(data[i]);
+	free(data);
+	free(replay_recs);
+
+	return rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,331 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/utils/ll_rpc_trace.c
+ *
+ * Save the RPC lifecycle records of a node from /proc/fs/lustre/rpc_trace,
+ * and merge the records saved on clients and servers into a per-RPC
+ * breakdown of where the time went.  Also save the requests captured by
+ * servers from /proc/fs/lustre/rpc_capture, for ll_rpc_replay.
+ *
+ * Client and server clocks are never compared: the network time of an RPC
+ * is the time the client waited for its reply less the time the server
+ * held the request, each measured with its own clock.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libcfs/libcfs.h>
+#include <lnet/nidstr.h>
+#include <lustre/lustre_user.h>
+
+#define RPC_TRACE_PROC		"/proc/fs/lustre/rpc_trace"
+#define RPC_CAPTURE_PROC	"/proc/fs/lustre/rpc_capture"
+/* large enough for a whole captured request */
+#define RPC_TRACE_BUFSIZE	(1 << 20)
+
+static char *progname;
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: %s record [-c] [-f] [-o outfile]\n"
+		"       %s merge tracefile ...\n"
+		"\trecord: save the RPC records of this node, to stdout by "
+		"default\n"
+		"\t  -c: save the captured requests instead\n"
+		"\t  -f: keep waiting for new records until interrupted\n"
+		"\tmerge: print the stages of each RPC, matching the records "
+		"saved on clients and servers\n", progname, progname);
+}
+
+static int trace_record(int argc, char **argv)
+{
+	const char		*path = RPC_TRACE_PROC;
+	char			*outfile = NULL;
+	char			*buf;
+	int			 follow = 0;
+	int			 infd;
+	int			 outfd = STDOUT_FILENO;
+	ssize_t			 len;
+	int			 rc = 0;
+	int			 c;
+
+	while ((c = getopt(argc, argv, "cfo:")) != -1) {
+		switch (c) {
+		case 'c':
+			path = RPC_CAPTURE_PROC;
+			break;
+		case 'f':
+			follow = 1;
+			break;
+		case 'o':
+			outfile = optarg;
+			break;
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	buf = malloc(RPC_TRACE_BUFSIZE);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	infd = open(path, O_RDONLY);
+	if (infd < 0) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open %s: %s\n", progname,
+			path, strerror(errno));
+		goto out_buf;
+	}
+
+	if (outfile != NULL) {
+		outfd = open(outfile, O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if (outfd < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: cannot open %s: %s\n", progname,
+				outfile, strerror(errno));
+			goto out_in;
+		}
+	}
+
+	for (;;) {
+		len = read(infd, buf, RPC_TRACE_BUFSIZE);
+		if (len < 0) {
+			rc = -errno;
+			fprintf(stderr, "%s: cannot read %s: %s\n", progname,
+				path, strerror(errno));
+			break;
+		}
+		if (len == 0) {
+			if (!follow)
+				break;
+			sleep(1);
+			continue;
+		}
+		if (write(outfd, buf, len) != len) {
+			rc = -errno;
+			fprintf(stderr, "%s: cannot write records: %s\n",
+				progname, strerror(errno));
+			break;
+		}
+	}
+
+	if (outfd != STDOUT_FILENO)
+		close(outfd);
+out_in:
+	close(infd);
+out_buf:
+	free(buf);
+	return rc;
+}
+
+static int trace_load(const char *path, struct rpc_trace_rec **recs,
+		      size_t *count, size_t *alloc)
+{
+	struct rpc_trace_rec	 rec;
+	FILE			*fp;
+	int			 rc = 0;
+
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open %s: %s\n", progname, path,
+			strerror(errno));
+		return rc;
+	}
+
+	while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+		if (rec.rtr_magic != RPC_TRACE_MAGIC) {
+			fprintf(stderr, "%s: %s: bad record magic %#x\n",
+				progname, path, rec.rtr_magic);
+			rc = -EINVAL;
+			break;
+		}
+		if (*count == *alloc) {
+			struct rpc_trace_rec *tmp;
+
+			*alloc = *alloc == 0 ? 4096 : *alloc * 2;
+			tmp = realloc(*recs, *alloc * sizeof(*tmp));
+			if (tmp == NULL) {
+				rc = -ENOMEM;
+				break;
+			}
+			*recs = tmp;
+		}
+		(*recs)[(*count)++] = rec;
+	}
+
+	fclose(fp);
+	return rc;
+}
+
+/* the nid of the client that sent the RPC */
+static inline __u64 trace_client_nid(const struct rpc_trace_rec *rec)
+{
+	return rec->rtr_flags & RPC_TRACE_SERVER ? rec->rtr_peer_nid :
+						   rec->rtr_self_nid;
+}
+
+/* order by client nid and xid, with the client record first */
+static int trace_cmp(const void *a, const void *b)
+{
+	const struct rpc_trace_rec *ra = a;
+	const struct rpc_trace_rec *rb = b;
+	__u64 na = trace_client_nid(ra);
+	__u64 nb = trace_client_nid(rb);
+
+	if (na != nb)
+		return na < nb ? -1 : 1;
+	if (ra->rtr_xid != rb->rtr_xid)
+		return ra->rtr_xid < rb->rtr_xid ? -1 : 1;
+	return (int)(ra->rtr_flags & RPC_TRACE_SERVER) -
+	       (int)(rb->rtr_flags & RPC_TRACE_SERVER);
+}
+
+static long long trace_span(const struct rpc_trace_rec *rec,
+			    enum rpc_stage from, enum rpc_stage to)
+{
+	if (rec == NULL || rec->rtr_stage[from] == 0 ||
+	    rec->rtr_stage[to] < rec->rtr_stage[from])
+		return -1;
+
+	return rec->rtr_stage[to] - rec->rtr_stage[from];
+}
+
+static void trace_print_span(long long usec)
+{
+	if (usec < 0)
+		printf(" %10s", "-");
+	else
+		printf(" %10lld", usec);
+}
+
+static void trace_print(const struct rpc_trace_rec *cli,
+			const struct rpc_trace_rec *srv)
+{
+	const struct rpc_trace_rec *any = cli != NULL ? cli : srv;
+	long long rpc = trace_span(cli, RPC_STAGE_SENT, RPC_STAGE_REPLIED);
+	long long held = trace_span(srv, RPC_STAGE_ARRIVED,
+				    RPC_STAGE_REPLY_SENT);
+	long long queue = trace_span(cli, RPC_STAGE_QUEUED, RPC_STAGE_SENT);
+	long long bulk;
+
+	/* the server does the bulk transfers of the RPCs it handles */
+	bulk = trace_span(srv, RPC_STAGE_BULK_START, RPC_STAGE_BULK_END);
+	if (bulk < 0)
+		bulk = trace_span(cli, RPC_STAGE_BULK_START,
+				  RPC_STAGE_BULK_END);
+
+	printf("%-20s %-20s "LPX64" %5u %5d",
+	       libcfs_nid2str(trace_client_nid(any)),
+	       cli != NULL ? libcfs_nid2str(cli->rtr_peer_nid) :
+			     libcfs_nid2str(srv->rtr_self_nid),
+	       any->rtr_xid, any->rtr_opc, any->rtr_status);
+	trace_print_span(queue);
+	trace_print_span(rpc >= 0 && held >= 0 && rpc >= held ?
+			 rpc - held : -1);
+	trace_print_span(trace_span(srv, RPC_STAGE_ARRIVED,
+				    RPC_STAGE_DEQUEUED));
+	trace_print_span(trace_span(srv, RPC_STAGE_DEQUEUED,
+				    RPC_STAGE_REPLY_SENT));
+	trace_print_span(bulk);
+	trace_print_span(queue >= 0 && rpc >= 0 ? queue + rpc : held);
+	printf("\n");
+}
+
+static int trace_merge(int argc, char **argv)
+{
+	struct rpc_trace_rec	*recs = NULL;
+	size_t			 count = 0;
+	size_t			 alloc = 0;
+	size_t			 i;
+	int			 rc;
+
+	if (argc < 2) {
+		usage();
+		return -EINVAL;
+	}
+
+	for (i = 1; i < argc; i++) {
+		rc = trace_load(argv[i], &recs, &count, &alloc);
+		if (rc < 0)
+			goto out;
+	}
+
+	qsort(recs, count, sizeof(*recs), trace_cmp);
+
+	printf("%-20s %-20s %-18s %5s %5s %10s %10s %10s %10s %10s %10s\n",
+	       "client", "server", "xid", "opc", "rc", "queue", "network",
+	       "nrs_wait", "service", "bulk", "total");
+	for (i = 0; i < count; i++) {
+		struct rpc_trace_rec *cli = NULL;
+		struct rpc_trace_rec *srv = NULL;
+
+		if (recs[i].rtr_flags & RPC_TRACE_SERVER) {
+			srv = &recs[i];
+		} else {
+			cli = &recs[i];
+			if (i + 1 < count &&
+			    recs[i + 1].rtr_flags & RPC_TRACE_SERVER &&
+			    trace_client_nid(&recs[i + 1]) ==
+			    cli->rtr_self_nid &&
+			    recs[i + 1].rtr_xid == cli->rtr_xid)
+				srv = &recs[++i];
+		}
+		trace_print(cli, srv);
+	}
+	rc = 0;
+out:
+	free(recs);
+	return rc;
+}
+
+int main(int argc, char **argv)
+{
+	int rc;
+
+	progname = basename(argv[0]);
+	if (argc < 2) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	if (strcmp(argv[1], "record") == 0) {
+		rc = trace_record(argc - 1, argv + 1);
+	} else if (strcmp(argv[1], "merge") == 0) {
+		rc = trace_merge(argc - 1, argv + 1);
+	} else {
+		usage();
+		rc = -EINVAL;
+	}
+
+	return rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
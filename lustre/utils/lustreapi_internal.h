@@ -35,6 +35,8 @@
 #ifndef _LUSTREAPI_INTERNAL_H_
 #define _LUSTREAPI_INTERNAL_H_
 
+#include <dirent.h>
+
 #define WANT_PATH   0x1
 #define WANT_FSNAME 0x2
 #define WANT_FD     0x4
@@ -46,6 +48,19 @@ int root_ioctl(const char *mdtname, int opc, void *data, int *mdtidxp,
 int get_param(const char *param_path, char *result,
 	      unsigned int result_size);
 
+/* Directory walk callbacks in liblustreapi.c, shared with the threaded
+ * traversal in liblustreapi_find.c */
+typedef int (semantic_func_t)(char *path, DIR *parent, DIR **d,
+			      void *data, struct dirent64 *de);
+int common_param_init(struct find_param *param, char *path);
+void find_param_fini(struct find_param *param);
+int get_lmd_info(char *path, DIR *parent, DIR *dir,
+		 struct lov_user_mds_data *lmd, int lumlen, int *lazy_flags);
+int cb_find_init(char *path, DIR *parent, DIR **dirp,
+		 void *data, struct dirent64 *de);
+int cb_common_fini(char *path, DIR *parent, DIR **dirp, void *data,
+		   struct dirent64 *de);
+
 #define LLAPI_LAYOUT_MAGIC 0x11AD1107 /* LLAPILOT */
 
 /* Helper functions for testing validity of stripe attributes. */
@@ -54,6 +54,8 @@
 #include <fcntl.h>
 #include <getopt.h>
 #include <glob.h>
+#include <grp.h>
+#include <pwd.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -1141,6 +1143,7 @@ int jt_obd_md_common(int argc, char **argv, int cmd)
         char                  *name = NULL;
         struct jt_fid_space    fid_space = {0};
         int                    version = 0;
+	int		       shared = 0;
         struct option          long_opts[] = {
                 {"child_base_id",     required_argument, 0, 'b'},
                 {"stripe_count",      required_argument, 0, 'c'},
@@ -1149,12 +1152,13 @@ int jt_obd_md_common(int argc, char **argv, int cmd)
                 {"stripe_index",      required_argument, 0, 'i'},
                 {"mode",              required_argument, 0, 'm'},
                 {"count",             required_argument, 0, 'n'},
+		{"shared",	      no_argument,	 0, 's'},
                 {"time",              required_argument, 0, 't'},
                 {"version",           no_argument,       0, 'v'},
                 {0, 0, 0, 0}
         };
 
-        while ((c = getopt_long(argc, argv, "b:c:d:D:m:n:t:v",
+	while ((c = getopt_long(argc, argv, "b:c:d:D:m:n:st:v",
                                 long_opts, NULL)) >= 0) {
                 switch (c) {
                 case 'b':
@@ -1208,6 +1212,9 @@ int jt_obd_md_common(int argc, char **argv, int cmd)
                                 return CMD_HELP;
                         }
                         break;
+		case 's':
+			shared = 1;
+			break;
                 case 't':
                         seconds = strtoull(optarg, &end, 0);
                         if (*end) {
@@ -1257,14 +1264,21 @@ int jt_obd_md_common(int argc, char **argv, int cmd)
                 return CMD_HELP;
         }
 
+	if (shared && cmd != ECHO_MD_LOOKUP && cmd != ECHO_MD_GETATTR) {
+		fprintf(stderr, "%s: --shared is only for lookup and getattr\n",
+			jt_cmdname(argv[0]));
+		return CMD_HELP;
+	}
+
 #ifdef MAX_THREADS
         if (thread) {
                 shmem_lock();
-                /* threads interleave */
-                if (parent_base_id != -1)
+		/* threads interleave, unless they all work on the files
+		 * of the first thread to measure lookups of busy objects */
+		if (parent_base_id != -1 && !shared)
                         parent_base_id += (thread - 1) % parent_count;
 
-                if (child_base_id != -1)
+		if (child_base_id != -1 && !shared)
                         child_base_id +=  (thread - 1) * \
                                           (MAX_BASE_ID / nthreads);
 
@@ -4364,4 +4378,198 @@ int jt_changelog_deregister(int argc, char **argv)
         return 0;
 }
 
+/* uids passed to one identity upcall by identity_preload */
+#define IDENTITY_PRELOAD_BATCH	64
+
+static int identity_preload_add(uid_t **uids, int *nuids, int *size, uid_t uid)
+{
+	uid_t *tmp;
+
+	if (*nuids == *size) {
+		tmp = realloc(*uids, (*size + 1024) * sizeof(**uids));
+		if (tmp == NULL)
+			return -ENOMEM;
+		*uids = tmp;
+		*size += 1024;
+	}
+	(*uids)[(*nuids)++] = uid;
+	return 0;
+}
+
+static int identity_preload_cmp(const void *p1, const void *p2)
+{
+	uid_t u1 = *(const uid_t *)p1;
+	uid_t u2 = *(const uid_t *)p2;
+
+	return u1 < u2 ? -1 : u1 > u2;
+}
+
+/* run @upcall in preload mode for @nuids uids */
+static int identity_preload_run(char *upcall, char *mdtname, uid_t *uids,
+				int nuids)
+{
+	char uidstr[IDENTITY_PRELOAD_BATCH][16];
+	char *argv[IDENTITY_PRELOAD_BATCH + 4];
+	int status;
+	pid_t pid;
+	int i;
+
+	argv[0] = upcall;
+	argv[1] = "-p";
+	argv[2] = mdtname;
+	for (i = 0; i < nuids; i++) {
+		snprintf(uidstr[i], sizeof(uidstr[i]), "%u", uids[i]);
+		argv[i + 3] = uidstr[i];
+	}
+	argv[nuids + 3] = NULL;
+
+	pid = fork();
+	if (pid < 0)
+		return -errno;
+	if (pid == 0) {
+		execv(upcall, argv);
+		exit(errno);
+	}
+
+	if (waitpid(pid, &status, 0) < 0)
+		return -errno;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		return -EIO;
+
+	return 0;
+}
+
+/**
+ * Fill the identity cache of an MDT with the users listed in a group file,
+ * i.e. the members of each group and the users whose primary group it is,
+ * so that a job start after failover doesn't stall on one upcall per uid.
+ * The identities are resolved by the MDT's identity_upcall in preload mode.
+ */
+int jt_identity_preload(int argc, char **argv)
+{
+	char *file = "/etc/group";
+	char upcall[PATH_MAX];
+	char path[PATH_MAX];
+	struct passwd *pw;
+	struct group *gr;
+	uid_t *uids = NULL;
+	gid_t *gids = NULL;
+	int nuids = 0, uids_size = 0;
+	int ngids = 0, gids_size = 0;
+	int i, n, rc = 0, rc2;
+	FILE *fp;
+	char *p;
+
+	if (argc < 2 || argc > 3)
+		return CMD_HELP;
+	if (argc == 3)
+		file = argv[2];
+
+	snprintf(path, sizeof(path), "/proc/fs/lustre/mdt/%s/identity_upcall",
+		 argv[1]);
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open '%s': %s\n",
+			jt_cmdname(argv[0]), path, strerror(errno));
+		return rc;
+	}
+	p = fgets(upcall, sizeof(upcall), fp);
+	fclose(fp);
+	if (p == NULL) {
+		fprintf(stderr, "%s: cannot read '%s'\n",
+			jt_cmdname(argv[0]), path);
+		return -EIO;
+	}
+	p = strchr(upcall, '\n');
+	if (p != NULL)
+		*p = '\0';
+	if (strcmp(upcall, "NONE") == 0) {
+		fprintf(stderr, "%s: %s has no identity upcall\n",
+			jt_cmdname(argv[0]), argv[1]);
+		return -EINVAL;
+	}
+
+	fp = fopen(file, "r");
+	if (fp == NULL) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot open '%s': %s\n",
+			jt_cmdname(argv[0]), file, strerror(errno));
+		return rc;
+	}
+
+	while ((gr = fgetgrent(fp)) != NULL) {
+		if (ngids == gids_size) {
+			gid_t *tmp;
+
+			tmp = realloc(gids, (gids_size + 1024) * sizeof(*gids));
+			if (tmp == NULL) {
+				rc = -ENOMEM;
+				goto out;
+			}
+			gids = tmp;
+			gids_size += 1024;
+		}
+		gids[ngids++] = gr->gr_gid;
+
+		for (i = 0; gr->gr_mem[i] != NULL; i++) {
+			pw = getpwnam(gr->gr_mem[i]);
+			if (pw == NULL)
+				continue;
+			rc = identity_preload_add(&uids, &nuids, &uids_size,
+						  pw->pw_uid);
+			if (rc != 0)
+				goto out;
+		}
+	}
+
+	setpwent();
+	while ((pw = getpwent()) != NULL) {
+		for (i = 0; i < ngids; i++) {
+			if (pw->pw_gid != gids[i])
+				continue;
+			rc = identity_preload_add(&uids, &nuids, &uids_size,
+						  pw->pw_uid);
+			if (rc != 0) {
+				endpwent();
+				goto out;
+			}
+			break;
+		}
+	}
+	endpwent();
+
+	if (nuids == 0) {
+		fprintf(stderr, "%s: no users found in '%s'\n",
+			jt_cmdname(argv[0]), file);
+		rc = -ENOENT;
+		goto out;
+	}
 
+	/* drop duplicates, users are usually in several groups */
+	qsort(uids, nuids, sizeof(*uids), identity_preload_cmp);
+	for (i = 1, n = 1; i < nuids; i++)
+		if (uids[i] != uids[n - 1])
+			uids[n++] = uids[i];
+	nuids = n;
+
+	for (i = 0; i < nuids; i += IDENTITY_PRELOAD_BATCH) {
+		n = nuids - i;
+		if (n > IDENTITY_PRELOAD_BATCH)
+			n = IDENTITY_PRELOAD_BATCH;
+		rc2 = identity_preload_run(upcall, argv[1], uids + i, n);
+		if (rc2 != 0 && rc == 0) {
+			fprintf(stderr, "%s: preloading uids %u-%u failed: "
+				"%s\n", jt_cmdname(argv[0]), uids[i],
+				uids[i + n - 1], strerror(-rc2));
+			rc = rc2;
+		}
+	}
+
+	printf("%s: preloaded %d identities from %s\n", argv[1], nuids, file);
+out:
+	fclose(fp);
+	free(uids);
+	free(gids);
+	return rc;
+}
@@ -135,6 +135,7 @@ int jt_nodemap_del_idmap(int argc, char **argv);
 int jt_nodemap_test_id(int argc, char **argv);
 int jt_changelog_register(int argc, char **argv);
 int jt_changelog_deregister(int argc, char **argv);
+int jt_identity_preload(int argc, char **argv);
 
 /* lustre_lfsck.c */
 int jt_lfsck_start(int argc, char **argv);
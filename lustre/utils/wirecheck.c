@@ -530,6 +530,8 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_UNLINK_CLOSE);
 	CHECK_DEFINE_64X(OBD_CONNECT_MULTIMODRPCS);
 	CHECK_DEFINE_64X(OBD_CONNECT_DIR_STRIPE);
+	CHECK_DEFINE_64X(OBD_CONNECT_FALLOCATE);
+	CHECK_DEFINE_64X(OBD_CONNECT_PEER_PING);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -566,7 +568,8 @@ check_obdo(void)
 	CHECK_MEMBER(obdo, o_uid_h);
 	CHECK_MEMBER(obdo, o_gid_h);
 	CHECK_MEMBER(obdo, o_data_version);
-	CHECK_MEMBER(obdo, o_padding_4);
+	CHECK_MEMBER(obdo, o_falloc_mode);
+	CHECK_MEMBER(obdo, o_padding_3);
 	CHECK_MEMBER(obdo, o_padding_5);
 	CHECK_MEMBER(obdo, o_padding_6);
 
@@ -2273,6 +2276,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(OST_QUOTACHECK);
 	CHECK_VALUE(OST_QUOTACTL);
 	CHECK_VALUE(OST_QUOTA_ADJUST_QUNIT);
+	CHECK_VALUE(OST_FALLOCATE);
 	CHECK_VALUE(OST_LAST_OPC);
 
 	CHECK_DEFINE_64X(OBD_OBJECT_EOF);